@@ -1,6 +1,8 @@
 #include <Wire.h>
 #include <WiFi.h>
 #include <HTTPClient.h>
+#include <Preferences.h>
+#include <LaundryDetector.h>
 #include <credentials.h>
 
 #define MPU_ADDR 0x68 // I2C address from datasheet (AD0 should be logic low, wire to GND)
@@ -13,42 +15,58 @@
 // ACCEL_SCALE = 0      1    2    3
 // Range is   +- 2g     4g   8g   16g
 // sens (LSB/g)= 16384  8192 4096 2048
-static const int LSB_SENS_TABLE[4] {16384, 8192, 4096, 2048};
+static constexpr int LSB_SENS_TABLE[4] {16384, 8192, 4096, 2048};
 #define ACCEL_SCALE 3
-const float LSB_SENS = LSB_SENS_TABLE[ACCEL_SCALE];
 
+// The MPU samples at MPU_FIFO_RATE (200 Hz) into its FIFO. An esp_timer notifies the FIFO task every FIFO_DRAIN_TIME ms,
+// the task drains it in one burst and runs the detector -- apart from the loop, whose HTTPS requests block for seconds,
+// longer than the FIFO holds (850 ms). The loop takes the status of the detector under fifoMux
+#define FIFO_DRAIN_TIME 250         // ms
+#define FIFO_TASK_STACK 6144        // the NVS and the trace are written from it
+#define FIFO_TASK_PRIORITY 3        // above the loop
+#define FIFO_STATS_TIME 60000       // ms between the stats of the FIFO
+MpuFifo fifo;
+TaskHandle_t fifoTask;
+esp_timer_handle_t fifoTimer;
+portMUX_TYPE fifoMux = portMUX_INITIALIZER_UNLOCKED;
+
+typedef struct {
+  bool running;
+  bool empty;
+  float activity;
+  float magnitude;
+  MPU_FIFO_STATS_T stats;
+} DETECTOR_STATUS_T;
+DETECTOR_STATUS_T detectorStatus;
+
+// Detector of the running/empty state out of the vibration (libraries/LaundryDetector): the windows and
+// thresholds of AccelerometerConfig (SketchConfig.h, shared with the benches), the clothes were removed if the door
+// was open for more than 90 samples (4.5 s)
+// Each sample of 50 ms is made of the 10 samples of the FIFO, their magnitude is taken from the raw values in fixed point
+typedef SensorConfig<AccelerometerConfig, MPU_FIFO_RATE / 20, LSB_SENS_TABLE[ACCEL_SCALE]> DetectorConfig;
+ActivityDetector<DetectorConfig> detector;
+
+// Calibration of the thresholds to this machine (libraries/LaundryDetector/ActivityCalibration.h), derived after
+// 30 min at rest and 15 min running. Its estimates are kept in the NVS, saved when the machine stops
+#define CALIBRATION_NVS_NAMESPACE "calibration"
+ActivityCalibration<> calibration;
+
+// Vibration bands of the raw samples (libraries/LaundryDetector/VibrationBands.h): the drum at 1, 2, 3 and 5 Hz and the
+// spin at 12 and 16 Hz over blocks of 1 s. Once they are still for 3 s the detector stops the machine without waiting for its average
+typedef SensorBandConfig<MPU_FIFO_RATE, LSB_SENS_TABLE[ACCEL_SCALE]> FifoBandConfig;
+VibrationBands<FifoBandConfig> bands;
+
+// Recording of the raw samples for trace-replay on the host (libraries/LaundryDetector/extras/host):
+// TRACE_SERIAL as TRCH:/TRC: lines between the output (about 2.5 KB/s), TRACE_FLASH into TRACE_FILE (about 20 minutes)
+#define TRACE_MODE TRACE_OFF
+#if TRACE_MODE == TRACE_FLASH
+#include <LittleFS.h>
+File traceFile;
+#endif
+TraceRecorder trace;
 bool empty = true; //Two status booleans sent to website
 bool running = false;
-bool dooropened = false; //Two door latch booleans to help determine if clothes have been taken out
-bool doorclosed = false;
-const int WINDOW = 20;   // 20 samples × 50 ms = 1 second, used to make activity variable
-const int WINDOWTWO = 15;   // 15 samples of activity variable = 15 seconds of data
-const int WINDOWTHREE = 4;   // 4 samples × 50 ms = 0.2, used to make activity small variable, shorter time frame here to detect quick things like door latch
-int idx = 0; //Index variables to store array values
-int idxtwo = 0;
-int idxthree = 0;
-int activitysmallIdx = 0;
-int quiettime = 0; //Time between door opening and door opening, used to detect each event properly (seperatly) and to catch niche cases
-int doorCooldown = 0; //Used to stop door opening from becoming true due to the closing vibration in the case where the user is closing the door right after opening it
-
-float
-  mpu_a_x,
-  mpu_a_y,
-  mpu_a_z,
-  mpu_a_mag,
-  prev_mag = 0.0,
-  activitysmall = 0,
-  activity = 0,
-  deltas[WINDOW], //Arrays that hold the values which make up the activity variables
-  deltastwo[WINDOWTHREE],
-  activities[WINDOWTWO], //Used to caluclates avg of last 15 seconds of activity
-  DYRERONTHRESHHOLD = 3, //Thresholds
-  DOOROPENINGCHANGE = 0.45,
-  DOORCLOSINGCHANGE = 0.9,
-  activitysmallHistory[6], //Holds history of last six small acitivties to capture the small activity 0.3s ago (6 x 50ms)
-  avg15 = 0, //Average activity over last 15 seconds (easier way just always keep track of the average)
-  sum15 = 0 //used to calucate a new average every second
-;
+
 
 int thresholdForOn = 14;
 
@@ -59,22 +77,12 @@ const char* serverUrl = "https://laun-dryer.vercel.app/api/machines";
 // Timing for sending updates (send every 5 seconds)
 unsigned long lastSendTime = 0;
 const unsigned long sendInterval = 5000; // 5 seconds in milliseconds
+unsigned long lastStatsTime = 0;
+#define LOOP_TIME 250               // ms between the outputs
 
 void setup() {
-  for (int i = 0; i < WINDOW; i++) { //Initializing arrays
-    deltas[i] = 0.0;
-  }
-  for (int i = 0; i < WINDOWTWO; i++) {
-  activities[i] = 0.0;
-}
-  for (int i = 0; i < WINDOWTHREE; i++) {
-    deltastwo[i] = 0.0;
-  }
-  for (int i = 0; i < 6; i++) {
-  activitysmallHistory[i] = 0.0;
-}
-  
   Serial.begin(38400);
+  Wire.setBufferSize(MPU_FIFO_BURST);
   Wire.begin(21, 22);  // SDA, SCL
 
   // Connect to WiFi
@@ -88,74 +96,27 @@ void setup() {
   Serial.print("IP: ");
   Serial.println(WiFi.localIP());
   setup_mpu();
-}
+  if (!fifo.begin(mpu_read, mpu_write)) {
+    Serial.println("❌ Failed to start the FIFO of the MPU-6050");
+  }
 
-void loop() {
+  // Restore the calibration of this machine
+  load_calibration();
 
-  record_mpu_accel();
-  mpu_a_mag = sqrt(mpu_a_x * mpu_a_x + mpu_a_y * mpu_a_y + mpu_a_z * mpu_a_z);
-
-  float delta = abs(mpu_a_mag - prev_mag);
-  prev_mag = mpu_a_mag;
-
-  activity -= deltas[idx]; //Minusing the delta 20 samples ago to keep the activity limited to just the most recent 20 samples
-  deltas[idx] = delta; //record the delta now (to delete in 20 samples from now)
-  activity += delta; //add it to variable
-  idx = (idx + 1) % WINDOW; //increment index
-
-  activitysmall -= deltastwo[idxthree]; 
-  deltastwo[idxthree] = delta; 
-  activitysmall += delta;
-  idxthree = (idxthree + 1) % WINDOWTHREE;
-  
-  activitysmallHistory[activitysmallIdx] = activitysmall; //Store the value of small acitivty so later we can compre the old one (0.3s ago) to the current
-  activitysmallIdx = (activitysmallIdx + 1) % 6; //increment index
-
-  if (idx == 0){ //Once every second, do this:
-    sum15 -= activities[idxtwo];
-    activities[idxtwo] = activity;
-    sum15 += activities[idxtwo]; //sum15 holds sum of last 15 activities recorded
-    idxtwo = (idxtwo + 1) % WINDOWTWO;
-
-    avg15 = sum15 / WINDOWTWO;
-    if (avg15 > DYRERONTHRESHHOLD){
-      running = true;
-      empty = false;
-      dooropened = false;
-      doorclosed = false;
-    }
-    else {
-      running = false;
-    }
-  }
-  
-  float activitysmall6ago = activitysmallHistory[activitysmallIdx]; //This stores value of small acitivty change from 0.3 seconds ago to compare it to current small activity change to see if door opened/closed
-  //As idxthree was incremented before this, it now points to the item of the array that was recorded last, 6 cycles ago (0.3s)
-
-  //Detect door opening when machine is stopped and not empty (with cooldown**)
-  if (running == false && empty == false && dooropened == false && doorCooldown == 0){
-      if (activitysmall > (activitysmall6ago + DOOROPENINGCHANGE)) dooropened = true;
-      quiettime = 0; // reset timer after opening event
-  }
-  // Detect door closing after it has been opened
-  if (running == false && empty == false && dooropened == true && doorclosed == false){
-      if (activitysmall > (activitysmall6ago + DOORCLOSINGCHANGE) && quiettime > 40) doorclosed = true; //quiettime > 40 so that looks for door closing only after door opened has fully finished
-      quiettime++; // count time between open and close
-      if (quiettime > 2400) empty = true; //Machine is empty because door has been left open for > 2 minutes
-  }
-  // Decide if machine is empty based on open–close duration
-  if (dooropened == true && doorclosed == true){
-      if (quiettime > 90) empty = true;
-      else{ //Niche case, door was closed too fast, user is just checking if clothes are inside, not actually taking them out
-        dooropened = false; doorclosed = false;
-        doorCooldown = 20; //**so that it doesn't go back to first if statement right away so that condition won't be incorrectly satisfied
-      } 
+  // Start the recording of the samples
+  if (TRACE_MODE != TRACE_OFF && !trace.begin(trace_write, 3, MPU_FIFO_RATE, LSB_SENS_TABLE[ACCEL_SCALE])) {
+    Serial.println("❌ Failed to start the recording of the samples");
   }
 
-  //20 -> 0, one second cooldown for niche case
-  if (doorCooldown > 0) {
-  doorCooldown--;
-  }
+  start_fifo();
+}
+
+void loop() {
+  DETECTOR_STATUS_T status;
+
+  take_status(&status);
+  running = status.running;
+  empty = status.empty;
 
   // Send status update to server every 5 seconds
   unsigned long currentTime = millis();
@@ -164,8 +125,79 @@ void loop() {
     lastSendTime = currentTime;
   }
 
-  print_accels();
-  delay(50);
+  if (currentTime - lastStatsTime >= FIFO_STATS_TIME) {
+    print_fifo(&status.stats);
+    lastStatsTime = currentTime;
+  }
+
+  print_accels(&status);
+  delay(LOOP_TIME);
+}
+
+void onFifoTimer(void *arg) {
+  xTaskNotifyGive(fifoTask);
+}
+
+// Drains the FIFO per notification of the timer, the calibration learns from every window of the detector. The frames
+// lost by an overflow are held as the last sample, so the windows of the detector stay a second of time
+void fifo_task(void *arg) {
+  int16_t last[3] = { 0, 0, 0 };
+
+  for (;;) {
+    unsigned events = 0;
+    bool calibrated = false;
+    auto sample = [&](int16_t a_x_raw, int16_t a_y_raw, int16_t a_z_raw) {
+      trace.add(a_x_raw, a_y_raw, a_z_raw);
+      if (bands.update(a_x_raw, a_y_raw, a_z_raw) & BANDS_BLOCK) detector.setStill(bands.still());
+      unsigned sampleEvents = detector.updateRaw(a_x_raw, a_y_raw, a_z_raw);
+      if (sampleEvents & ACTIVITY_TICK) calibrated |= calibration.update(detector);
+      events |= sampleEvents;
+      last[0] = a_x_raw;
+      last[1] = a_y_raw;
+      last[2] = a_z_raw;
+    };
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    fifo.drain(sample, esp_timer_get_time());
+    if (fifo.lost()) {
+      Serial.printf("❌ FIFO overflow, %u samples lost\n", fifo.lost());
+      for (unsigned n = 0; n < fifo.lost(); n++) sample(last[0], last[1], last[2]);
+    }
+
+    if (calibrated) print_thresholds("✅ Calibrated for this machine");
+    if (calibrated || (events & ACTIVITY_STOPPED)) save_calibration();
+
+    portENTER_CRITICAL(&fifoMux);
+    detectorStatus.running = detector.running();
+    detectorStatus.empty = detector.empty();
+    detectorStatus.activity = detector.activity();
+    detectorStatus.magnitude = detector.magnitude();
+    fifo.stats(&detectorStatus.stats);
+    portEXIT_CRITICAL(&fifoMux);
+  }
+}
+
+void start_fifo() {
+  esp_timer_create_args_t args = {};
+
+  args.callback = onFifoTimer;
+  args.name = "fifo";
+  detectorStatus.empty = true;
+  xTaskCreate(fifo_task, "fifo", FIFO_TASK_STACK, NULL, FIFO_TASK_PRIORITY, &fifoTask);
+  esp_timer_create(&args, &fifoTimer);
+  esp_timer_start_periodic(fifoTimer, FIFO_DRAIN_TIME * 1000);
+}
+
+// The status of the detector as the FIFO task left it
+void take_status(DETECTOR_STATUS_T *status) {
+  portENTER_CRITICAL(&fifoMux);
+  *status = detectorStatus;
+  portEXIT_CRITICAL(&fifoMux);
+}
+
+void print_fifo(const MPU_FIFO_STATS_T *stats) {
+  Serial.printf("📊 FIFO: %lu samples in %lu drains (%lu bursts), %lu overflows (%lu samples lost), %lu errors\n",
+                stats->frames, stats->drains, stats->bursts, stats->overflows, stats->lost, stats->errors);
 }
 
 void setup_mpu() {
@@ -176,42 +208,34 @@ void setup_mpu() {
   write_to(ACCEL_SCALE_REG, ACCEL_SCALE);
 }
 
-void read_from(const byte from_register, const int num_bytes, byte read_data[]) {
+bool read_from(const byte from_register, const int num_bytes, byte read_data[]) {
   // First send address of register from which to read
   Wire.beginTransmission(MPU_ADDR);
-  Wire.write(from_register); 
+  Wire.write(from_register);
   // Keep control of bus to immediately read data
-  Wire.endTransmission(false); 
-
-  Wire.requestFrom(MPU_ADDR, num_bytes, true); // Releases bus after
+  if (Wire.endTransmission(false) != 0) return false;
+  if ((int) Wire.requestFrom(MPU_ADDR, num_bytes, true) != num_bytes) return false; // Releases bus after
   for (int i = 0; Wire.available(); ++i) {
     read_data[i] = Wire.read();
   }
-  return;
+  return true;
 }
 
-void write_to(const byte to_register, const byte write_value) {
+bool write_to(const byte to_register, const byte write_value) {
   Wire.beginTransmission(MPU_ADDR);
   // First send address of register to which to write
-  Wire.write(to_register); 
+  Wire.write(to_register);
   Wire.write(write_value);
-  Wire.endTransmission(true);
-  return;
+  return Wire.endTransmission(true) == 0;
+}
+
+// Access to the registers for the FIFO
+bool mpu_read(uint8_t reg, uint8_t *data, size_t length) {
+  return read_from(reg, length, data);
 }
 
-void record_mpu_accel() {
-  // x high byte 3B, x low 3C, y high 3D, y low 3E, z high 3F, z low 40
-  // ACCEL_REG is 3B
-  byte buffer[6];
-  read_from(ACCEL_REG, 6, buffer);
-  int16_t a_x_raw = (buffer[0] << 8) | buffer[1];
-  int16_t a_y_raw = (buffer[2] << 8) | buffer[3];
-  int16_t a_z_raw = (buffer[4] << 8) | buffer[5];
-  // Combine high byte and low byte into 16-bit accel value, then divide by LSB sensitivity to get accel in g-forces
-  // Also factor in offsets
-  mpu_a_x = a_x_raw / LSB_SENS;
-  mpu_a_y = a_y_raw / LSB_SENS;
-  mpu_a_z = a_z_raw / LSB_SENS;
+bool mpu_write(uint8_t reg, uint8_t value) {
+  return write_to(reg, value);
 }
 
 void sendStatusUpdate() {
@@ -244,7 +268,7 @@ void sendStatusUpdate() {
   }
 }
 
- void print_accels() {
+ void print_accels(const DETECTOR_STATUS_T *status) {
     /*Serial.print("mpu_a_x:");
     Serial.print(mpu_a_x);
     Serial.print(' ');
@@ -255,12 +279,67 @@ void sendStatusUpdate() {
     Serial.print(mpu_a_z);
     Serial.print(' '); */
     Serial.print("change over last second:");
-    Serial.print(activity);
+    Serial.print(status->activity);
     Serial.print(' ');
     Serial.print("mpu_a_mag:");
-    Serial.print(mpu_a_mag);
+    Serial.print(status->magnitude);
     Serial.println();
     Serial.print("Running:");
     Serial.println(running ? 1 : 0);
     Serial.println();
   } 
+
+// Output of the recording, false if the block is lost
+bool trace_write(const uint8_t *data, size_t length, bool header) {
+#if TRACE_MODE == TRACE_FLASH
+  if (header) {
+    traceFile = (LittleFS.begin(true)) ? LittleFS.open(TRACE_FILE, "w") : File();
+  }
+  if (!traceFile || traceFile.size() + length > TRACE_FILE_MAX) {
+    return false;
+  }
+  bool written = traceFile.write(data, length) == length;
+  traceFile.flush();
+  return written;
+#else
+  char line[TRACE_LINE_MAX];
+
+  TraceLine(line, data, length, header);
+  Serial.println(line);
+  return true;
+#endif
+}
+
+// Restore the estimates of the calibration from the NVS, the thresholds of the configuration until it is derived
+void load_calibration() {
+  Preferences prefs;
+  ACTIVITY_CALIBRATION_T saved;
+
+  prefs.begin(CALIBRATION_NVS_NAMESPACE, true);
+  bool restored = prefs.getBytes("estimates", &saved, sizeof(saved)) == sizeof(saved) && calibration.restore(&saved);
+  prefs.end();
+
+  if (restored) {
+    calibration.apply(detector);
+  }
+  print_thresholds((restored) ? "📐 Calibration restored" : "📐 Calibration learning");
+}
+
+void save_calibration() {
+  Preferences prefs;
+  ACTIVITY_CALIBRATION_T saved;
+
+  calibration.save(&saved);
+  prefs.begin(CALIBRATION_NVS_NAMESPACE, false);
+  prefs.putBytes("estimates", &saved, sizeof(saved));
+  prefs.end();
+}
+
+void print_thresholds(const char *what) {
+  ACTIVITY_THRESHOLDS_T thresholds;
+
+  detector.thresholds(&thresholds);
+  Serial.printf("%s - running above %.2f g, stopped below %.2f g, door %.2f g%s\n", what,
+                (float) thresholds.running / ACTIVITY_UNITS_PER_G, (float) thresholds.stopped / ACTIVITY_UNITS_PER_G,
+                (float) thresholds.closing / ACTIVITY_UNITS_PER_G, calibration.calibrated() ? " (calibrated)" : "");
+}
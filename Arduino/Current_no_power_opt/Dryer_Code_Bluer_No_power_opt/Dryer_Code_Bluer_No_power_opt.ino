@@ -2,6 +2,8 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <MPU6050.h>
+#include <Preferences.h>
+#include <LaundryDetector.h>
 #include "esp_eap_client.h"
 #include "secrets.h"
 #include <NimBLEDevice.h>
@@ -24,9 +26,8 @@ const char* EXPECTED_SERVER_NAME = "eduroam.uwaterloo.ca";
 // ACCEL_SCALE = 0      1    2    3
 // Range is   +- 2g     4g   8g   16g
 // sens (LSB/g)= 16384  8192 4096 2048
-static const int LSB_SENS_TABLE[4]{ 16384, 8192, 4096, 2048 };
+static constexpr int LSB_SENS_TABLE[4]{ 16384, 8192, 4096, 2048 };
 #define ACCEL_SCALE 3
-const float LSB_SENS = LSB_SENS_TABLE[ACCEL_SCALE];  //SAMEPLE TIME 10s, SLEEPTIME CYCLE, 10min
 
 MPU6050 mpu;
 
@@ -52,34 +53,55 @@ NimBLEScan* pBLEScan;
 // Wi-Fi reconnect timing
 unsigned long lastWifiReconnectAttempt = 0;
 const unsigned long wifiReconnectInterval = 15000;
-const int WINDOW = 20;      // 20 samples × 50 ms = 1 second, used to make activity variable
-const int WINDOWTWO = 10;   // 10 samples of activity variable = 10 seconds of data
-const int WINDOWTHREE = 4;  // 4 samples × 50 ms = 0.2, used to make activity small variable, shorter time frame here to detect quick things like door latch
-int idx = 0;                //Index variables to store array values
-int idxtwo = 0;
-int idxthree = 0;
-int activitysmallIdx = 0;
-//int quiettime = 0;     //Time between door opening and door opening, used to detect each event properly (seperatly)
-//int doorCooldown = 0;  //Used to stop door opening from becoming true due to the closing vibration in the case where the user is closing the door right after opening it
-
-float
-  mpu_a_x,
-  mpu_a_y,
-  mpu_a_z,
-  mpu_a_mag,
-  prev_mag = 0.0,
-  activitysmall = 0,
-  activity = 0,
-  deltas[WINDOW],         //Arrays that hold the values which make up the activity variables
-  activities[WINDOWTWO],  //Used to caluclates avg of last 15 seconds of activity
-  deltastwo[WINDOWTHREE],
-  activitysmallHistory[3],  //Holds history of last three small acitivties to capture the small activity 0.15s ago (3 x 50ms)
-  DYRERONTHRESHHOLD = 2.5,  //Thresholds
-  //DOOROPENINGCHANGE = 0.45,
-  DOORCLOSINGCHANGE = 0.55,
-  avg10 = 0,  //Average activity over last 15 seconds (easier way just always keep track of the average)
-  sum10 = 0   //used to calucate a new average every second
-  ;
+
+// The MPU samples at MPU_FIFO_RATE (200 Hz) into its FIFO. An esp_timer notifies the FIFO task every FIFO_DRAIN_TIME ms,
+// the task drains it in one burst and runs the detector -- apart from the loop, whose BLE scans and HTTPS requests
+// block for seconds, longer than the FIFO holds (850 ms). The loop takes the status of the detector under fifoMux
+#define FIFO_DRAIN_TIME 250         // ms
+#define FIFO_TASK_STACK 6144        // the NVS and the trace are written from it
+#define FIFO_TASK_PRIORITY 3        // above the loop
+#define FIFO_STATS_TIME 60000       // ms between the stats of the FIFO
+MpuFifo fifo;
+TaskHandle_t fifoTask;
+esp_timer_handle_t fifoTimer;
+portMUX_TYPE fifoMux = portMUX_INITIALIZER_UNLOCKED;
+
+typedef struct {
+  bool running;
+  bool empty;
+  unsigned events;            // since the loop took the status
+  float average;
+  float small;
+  MPU_FIFO_STATS_T stats;
+} DETECTOR_STATUS_T;
+DETECTOR_STATUS_T detectorStatus;
+
+// Detector of the running/empty state out of the vibration (libraries/LaundryDetector) with the thresholds of
+// DryerConfig (SketchConfig.h, shared with the benches): 10 s of activity for running, the opening isn't detected,
+// any door event while stopped means empty
+// Each sample of 50 ms is made of the 10 samples of the FIFO, their magnitude is taken from the raw values in fixed point
+typedef SensorConfig<DryerConfig, MPU_FIFO_RATE / 20, LSB_SENS_TABLE[ACCEL_SCALE]> DetectorConfig;
+ActivityDetector<DetectorConfig> detector;
+
+// Calibration of the thresholds to this machine (libraries/LaundryDetector/ActivityCalibration.h), derived after
+// 30 min at rest and 15 min running. Its estimates are kept in the NVS, saved when the machine stops
+#define CALIBRATION_NVS_NAMESPACE "calibration"
+ActivityCalibration<> calibration;
+
+// Vibration bands of the raw samples (libraries/LaundryDetector/VibrationBands.h): the drum at 1, 2, 3 and 5 Hz and the
+// spin at 12 and 16 Hz over blocks of 1 s. Once they are still for 3 s the detector stops the machine without waiting for its average
+typedef SensorBandConfig<MPU_FIFO_RATE, LSB_SENS_TABLE[ACCEL_SCALE]> FifoBandConfig;
+VibrationBands<FifoBandConfig> bands;
+
+// Recording of the raw samples for trace-replay on the host (libraries/LaundryDetector/extras/host):
+// TRACE_SERIAL as TRCH:/TRC: lines between the output (about 2.5 KB/s), TRACE_FLASH into TRACE_FILE (about 20 minutes)
+#define TRACE_MODE TRACE_OFF
+#if TRACE_MODE == TRACE_FLASH
+#include <LittleFS.h>
+File traceFile;
+#endif
+TraceRecorder trace;
+
 
 // Machine identification and server configuration
 const char* machineId = "a1-m4";  // VARIES
@@ -89,6 +111,8 @@ const char* washerMachineId = "a1-m5";  //VARIES
 // Timing for sending updates (send every 5 seconds)
 unsigned long lastSendTime = 0;
 const unsigned long sendInterval = 300000;  // 5 min
+unsigned long lastStatsTime = 0;
+#define LOOP_TIME 250               // ms between the outputs
 
 class MyAdvertisedDeviceCallbacks : public NimBLEScanCallbacks {
   void onResult(const NimBLEAdvertisedDevice* advertisedDevice) override {
@@ -208,24 +232,10 @@ void setup() {
   Serial.printf("   Machine ID: %s\n", machineId);
   Serial.println("========================================\n");
 
-  // Initialize arrays
-  for (int i = 0; i < WINDOW; i++) {
-    deltas[i] = 0.0;
-  }
-  for (int i = 0; i < WINDOWTWO; i++) {
-    activities[i] = 0.0;
-  }
-  for (int i = 0; i < WINDOWTHREE; i++) {
-    deltastwo[i] = 0.0;
-  }
-  for (int i = 0; i < 3; i++) {
-    activitysmallHistory[i] = 0.0;
-  }
-  prev_mag = 0;
-  idx = 0;
   running = false;
 
   // Initialize I2C for accelerometer
+  Wire.setBufferSize(MPU_FIFO_BURST);
   Wire.begin(21, 22);
 
   // Connect securely to University of Waterloo eduroam
@@ -235,6 +245,18 @@ void setup() {
 
   // Initialize accelerometer
   setup_mpu();
+  if (!fifo.begin(mpu_read, mpu_write)) {
+    Serial.println("[MPU] Failed to start the FIFO");
+  }
+
+  // Restore the calibration of this machine
+  load_calibration();
+
+  // Start the recording of the samples
+  if (TRACE_MODE != TRACE_OFF && !trace.begin(trace_write, 3, MPU_FIFO_RATE, LSB_SENS_TABLE[ACCEL_SCALE])) {
+    Serial.println("[MPU] Failed to start the recording of the samples");
+  }
+  start_fifo();
 
   // Initialize background Bluetooth Sniffer engine
   NimBLEDevice::init("");
@@ -250,12 +272,6 @@ void setup() {
 void loop() {
   maintainWiFiConnection();
 
-  record_mpu_accel();
-  mpu_a_mag = sqrt(mpu_a_x * mpu_a_x + mpu_a_y * mpu_a_y + mpu_a_z * mpu_a_z);
-
-  float delta = abs(mpu_a_mag - prev_mag);
-  prev_mag = mpu_a_mag;
-
   if (running && !wasRunning) {
     Serial.println("▶️ Machine started running");
   }
@@ -263,49 +279,18 @@ void loop() {
   wasRunning = running;
   wasEmpty = empty;
 
-  activity -= deltas[idx];   //Minusing the delta 20 samples ago to keep the activity limited to just the most recent 20 samples
-  deltas[idx] = delta;       //record the delta now (to delete in 20 samples from now)
-  activity += delta;         //add it to variable
-  idx = (idx + 1) % WINDOW;  //increment index
-
-  activitysmall -= deltastwo[idxthree];
-  deltastwo[idxthree] = delta;
-  activitysmall += delta;
-  idxthree = (idxthree + 1) % WINDOWTHREE;
-
-  activitysmallHistory[activitysmallIdx] = activitysmall;  //Store the value of small acitivty so later we can compre the old one (0.3s ago) to the current
-  activitysmallIdx = (activitysmallIdx + 1) % 3;           //increment index
+  DETECTOR_STATUS_T status;
 
-  if (idx == 0) {  //Once every second, do this:
-    sum10 -= activities[idxtwo];
-    activities[idxtwo] = activity;
-    sum10 += activities[idxtwo];  //sum10 holds sum of last 10 activities recorded
-    idxtwo = (idxtwo + 1) % WINDOWTWO;
-
-    avg10 = sum10 / WINDOWTWO;
-
-    if (avg10 > DYRERONTHRESHHOLD) {
-      running = true;
-      empty = false;
-      //dooropened = false;
-      //doorclosed = false;
-    } else {
-      running = false;
-    }
-  }
-
-  float activitysmall3ago = activitysmallHistory[activitysmallIdx];  //This stores value of small acitivty change from 0.15 seconds ago to compare it to current small activity change to see if door opened/closed
-  //As idxthree was incremented before this, it now points to the item of the array that was recorded last, 3 cycles ago (0.15s)
+  take_status(&status);
+  running = status.running;
+  empty = status.empty;
 
   if (!running && wasRunning) {
     Serial.println("🛑 Machine stopped");
   }
 
-  if (!running && !empty){
-    if (activitysmall > (activitysmall3ago + DOORCLOSINGCHANGE)){
-      empty = true;
-      Serial.println("[STATE] Door event detected -> marking EMPTY");
-    }
+  if (status.events & ACTIVITY_EMPTIED) {
+    Serial.println("[STATE] Door event detected -> marking EMPTY");
   }
 
   // Send status update to server every 5 min
@@ -351,8 +336,81 @@ void loop() {
     lastSendTime = currentTime;
   }
 
-  print_accels();
-  delay(50);
+  if (currentTime - lastStatsTime >= FIFO_STATS_TIME) {
+    print_fifo(&status.stats);
+    lastStatsTime = currentTime;
+  }
+
+  print_accels(&status);
+  delay(LOOP_TIME);
+}
+
+void onFifoTimer(void *arg) {
+  xTaskNotifyGive(fifoTask);
+}
+
+// Drains the FIFO per notification of the timer, the calibration learns from every window of the detector. The frames
+// lost by an overflow are held as the last sample, so the windows of the detector stay a second of time
+void fifo_task(void *arg) {
+  int16_t last[3] = { 0, 0, 0 };
+
+  for (;;) {
+    unsigned events = 0;
+    bool calibrated = false;
+    auto sample = [&](int16_t a_x_raw, int16_t a_y_raw, int16_t a_z_raw) {
+      trace.add(a_x_raw, a_y_raw, a_z_raw);
+      if (bands.update(a_x_raw, a_y_raw, a_z_raw) & BANDS_BLOCK) detector.setStill(bands.still());
+      unsigned sampleEvents = detector.updateRaw(a_x_raw, a_y_raw, a_z_raw);
+      if (sampleEvents & ACTIVITY_TICK) calibrated |= calibration.update(detector);
+      events |= sampleEvents;
+      last[0] = a_x_raw;
+      last[1] = a_y_raw;
+      last[2] = a_z_raw;
+    };
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    fifo.drain(sample, esp_timer_get_time());
+    if (fifo.lost()) {
+      Serial.printf("[MPU] FIFO overflow, %u samples lost\n", fifo.lost());
+      for (unsigned n = 0; n < fifo.lost(); n++) sample(last[0], last[1], last[2]);
+    }
+
+    if (calibrated) print_thresholds("[CALIBRATION] Derived for this machine");
+    if (calibrated || (events & ACTIVITY_STOPPED)) save_calibration();
+
+    portENTER_CRITICAL(&fifoMux);
+    detectorStatus.running = detector.running();
+    detectorStatus.empty = detector.empty();
+    detectorStatus.events |= events;
+    detectorStatus.average = detector.average();
+    detectorStatus.small = detector.small();
+    fifo.stats(&detectorStatus.stats);
+    portEXIT_CRITICAL(&fifoMux);
+  }
+}
+
+void start_fifo() {
+  esp_timer_create_args_t args = {};
+
+  args.callback = onFifoTimer;
+  args.name = "fifo";
+  detectorStatus.empty = true;
+  xTaskCreate(fifo_task, "fifo", FIFO_TASK_STACK, NULL, FIFO_TASK_PRIORITY, &fifoTask);
+  esp_timer_create(&args, &fifoTimer);
+  esp_timer_start_periodic(fifoTimer, FIFO_DRAIN_TIME * 1000);
+}
+
+// The status of the detector as the FIFO task left it, with the events since the last call
+void take_status(DETECTOR_STATUS_T *status) {
+  portENTER_CRITICAL(&fifoMux);
+  *status = detectorStatus;
+  detectorStatus.events = 0;
+  portEXIT_CRITICAL(&fifoMux);
+}
+
+void print_fifo(const MPU_FIFO_STATS_T *stats) {
+  Serial.printf("[MPU] FIFO: %lu samples in %lu drains (%lu bursts), %lu overflows (%lu samples lost), %lu errors\n",
+                stats->frames, stats->drains, stats->bursts, stats->overflows, stats->lost, stats->errors);
 }
 
 void setup_mpu() {
@@ -362,41 +420,34 @@ void setup_mpu() {
   write_to(ACCEL_SCALE_REG, ACCEL_SCALE);
 }
 
-void read_from(const byte from_register, const int num_bytes, byte read_data[]) {
+bool read_from(const byte from_register, const int num_bytes, byte read_data[]) {
   // First send address of register from which to read
   Wire.beginTransmission(MPU_ADDR);
   Wire.write(from_register);
   // Keep control of bus to immediately read data
-  Wire.endTransmission(false);
-  Wire.requestFrom(MPU_ADDR, num_bytes, true);  // Releases bus after
+  if (Wire.endTransmission(false) != 0) return false;
+  if ((int) Wire.requestFrom(MPU_ADDR, num_bytes, true) != num_bytes) return false; // Releases bus after
   for (int i = 0; Wire.available(); ++i) {
     read_data[i] = Wire.read();
   }
-  return;
+  return true;
 }
 
-void write_to(const byte to_register, const byte write_value) {
+bool write_to(const byte to_register, const byte write_value) {
   Wire.beginTransmission(MPU_ADDR);
   // First send address of register to which to write
   Wire.write(to_register);
   Wire.write(write_value);
-  Wire.endTransmission(true);
-  return;
+  return Wire.endTransmission(true) == 0;
 }
 
-void record_mpu_accel() {
-  // x high byte 3B, x low 3C, y high 3D, y low 3E, z high 3F, z low 40
-  // ACCEL_REG is 3B
-  byte buffer[6];
-  read_from(ACCEL_REG, 6, buffer);
-  int16_t a_x_raw = (buffer[0] << 8) | buffer[1];
-  int16_t a_y_raw = (buffer[2] << 8) | buffer[3];
-  int16_t a_z_raw = (buffer[4] << 8) | buffer[5];
-  // Combine high byte and low byte into 16-bit accel value, then divide by LSB sensitivity to get accel in g-forces
-  // Also factor in offsets
-  mpu_a_x = a_x_raw / LSB_SENS;
-  mpu_a_y = a_y_raw / LSB_SENS;
-  mpu_a_z = a_z_raw / LSB_SENS;
+// Access to the registers for the FIFO
+bool mpu_read(uint8_t reg, uint8_t *data, size_t length) {
+  return read_from(reg, length, data);
+}
+
+bool mpu_write(uint8_t reg, uint8_t value) {
+  return write_to(reg, value);
 }
 
 void sendCustomStatusUpdate(const char* targetMachineId, bool isRunning, bool isEmpty) {
@@ -443,12 +494,12 @@ void sendCustomStatusUpdate(const char* targetMachineId, bool isRunning, bool is
   }
 }
 
-void print_accels() {
+void print_accels(const DETECTOR_STATUS_T *status) {
   Serial.print("Avg10:");
-  Serial.print(avg10);
+  Serial.print(status->average);
   Serial.print(",");
   Serial.print("ActivitySmall:");
-  Serial.println(activitysmall);
+  Serial.println(status->small);
 }
 
 /*//Detect door opening when machine is stopped and not empty (with cooldown**)
@@ -498,3 +549,58 @@ void print_accels() {
     doorCooldown--;
   }
 */
+
+// Output of the recording, false if the block is lost
+bool trace_write(const uint8_t *data, size_t length, bool header) {
+#if TRACE_MODE == TRACE_FLASH
+  if (header) {
+    traceFile = (LittleFS.begin(true)) ? LittleFS.open(TRACE_FILE, "w") : File();
+  }
+  if (!traceFile || traceFile.size() + length > TRACE_FILE_MAX) {
+    return false;
+  }
+  bool written = traceFile.write(data, length) == length;
+  traceFile.flush();
+  return written;
+#else
+  char line[TRACE_LINE_MAX];
+
+  TraceLine(line, data, length, header);
+  Serial.println(line);
+  return true;
+#endif
+}
+
+// Restore the estimates of the calibration from the NVS, the thresholds of the configuration until it is derived
+void load_calibration() {
+  Preferences prefs;
+  ACTIVITY_CALIBRATION_T saved;
+
+  prefs.begin(CALIBRATION_NVS_NAMESPACE, true);
+  bool restored = prefs.getBytes("estimates", &saved, sizeof(saved)) == sizeof(saved) && calibration.restore(&saved);
+  prefs.end();
+
+  if (restored) {
+    calibration.apply(detector);
+  }
+  print_thresholds((restored) ? "[CALIBRATION] Restored" : "[CALIBRATION] Learning");
+}
+
+void save_calibration() {
+  Preferences prefs;
+  ACTIVITY_CALIBRATION_T saved;
+
+  calibration.save(&saved);
+  prefs.begin(CALIBRATION_NVS_NAMESPACE, false);
+  prefs.putBytes("estimates", &saved, sizeof(saved));
+  prefs.end();
+}
+
+void print_thresholds(const char *what) {
+  ACTIVITY_THRESHOLDS_T thresholds;
+
+  detector.thresholds(&thresholds);
+  Serial.printf("%s - running above %.2f g, stopped below %.2f g, door %.2f g%s\n", what,
+                (float) thresholds.running / ACTIVITY_UNITS_PER_G, (float) thresholds.stopped / ACTIVITY_UNITS_PER_G,
+                (float) thresholds.closing / ACTIVITY_UNITS_PER_G, calibration.calibrated() ? " (calibrated)" : "");
+}
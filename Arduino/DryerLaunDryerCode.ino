@@ -2,6 +2,9 @@
 #include <BLEDevice.h>
 #include <BLEAdvertising.h>
 #include <MPU6050.h>
+#include <Preferences.h>
+#include <esp_timer.h>
+#include <LaundryDetector.h>
 
 #define MPU_ADDR 0x68 // I2C address from datasheet (AD0 should be logic low, wire to GND)
 // x high 3B, x low 3C, y high 3D, y low 3E, z high 3F, z low 40
@@ -13,58 +16,118 @@
 // ACCEL_SCALE = 0      1    2    3
 // Range is   +- 2g     4g   8g   16g
 // sens (LSB/g)= 16384  8192 4096 2048
-static const int LSB_SENS_TABLE[4] {16384, 8192, 4096, 2048};
+static constexpr int LSB_SENS_TABLE[4] {16384, 8192, 4096, 2048};
 #define ACCEL_SCALE 3
-const float LSB_SENS = LSB_SENS_TABLE[ACCEL_SCALE];
 
 #define SAMPLE_TIME   200     // stay awake for 10 seconds (200x50ms)
-#define SLEEP_TIME_CYCLE   15       // sleep for 10 min
+
+// Sampling (libraries/LaundryDetector/SampleClock.h): an esp_timer notifies the sampling task every 50 ms, the task
+// reads the MPU and queues the raw values with the periods they stand for. The loop holds a sample over the periods
+// missed or dropped, so a window of the detector stays a second whatever the loop does in between
+#define SAMPLE_PERIOD 50000         // us
+#define SAMPLE_QUEUE 20             // 1 s of samples
+#define SAMPLE_TASK_STACK 3072
+#define SAMPLE_TASK_PRIORITY 3      // above the loop
+
+typedef struct {
+  int16_t x, y, z;
+  uint16_t periods;
+} ACCEL_SAMPLE_T;
+
+SampleClock sampleClock;
+QueueHandle_t sampleQueue;
+TaskHandle_t sampleTask;
+esp_timer_handle_t sampleTimer;
+
+// Deep sleep schedule (libraries/LaundryDetector/SleepPolicy.h): while running, sleeps of up to 10 min until 5 min
+// before the end of the shortest of the last 8 cycles, then sleeps of 15 s; without a history 12 s, 4 × 15 s, then
+// awake until stopped. Stopped, it sleeps until motion, the door left open is checked again after 30 s.
+// extras/host/sleep-bench simulates the delay of the stop and the charge per day of the policies
+typedef AdaptiveSleepPolicy<> SleepPolicy;
+SleepHistory sleepHistory;
+time_t cycleStart = 0; // the time of the RTC runs on in the deep sleep
 
 MPU6050 mpu;
 const int intPin = 15;
 volatile bool motionDetected = false;
 
-RTC_DATA_ATTR bool empty = true; //Two status booleans sent to website
-RTC_DATA_ATTR bool running = false;
-RTC_DATA_ATTR bool dooropened = false; //Two door latch booleans to help determine if clothes have been taken out
-RTC_DATA_ATTR bool doorclosed = false;
-RTC_DATA_ATTR bool wasRunning = false;
-RTC_DATA_ATTR bool wasEmpty = true;
-RTC_DATA_ATTR bool monitoringContinuously = false;
-RTC_DATA_ATTR bool waitingForDoorClose = false;
-const int WINDOW = 20;   // 20 samples × 50 ms = 1 second, used to make activity variable
-const int WINDOWTWO = 10;   // 10 samples of activity variable = 10 seconds of data
-const int fiveCycle = 5;
-RTC_DATA_ATTR int idx = 0; //Index variables to store array values
-RTC_DATA_ATTR int idxtwo = 0;
-RTC_DATA_ATTR int cycleCounter = 0;
-RTC_DATA_ATTR int quiettime = 0; //Time between door opening and door opening, used to detect each event properly (seperatly)
-RTC_DATA_ATTR int wakeStart = 0;
+bool empty = true; //Two status booleans sent to website
+bool running = false;
+bool dooropened = false; //Two door latch booleans to help determine if clothes have been taken out
+bool doorclosed = false;
+bool wasRunning = false;
+bool wasEmpty = true;
+bool monitoringContinuously = false;
+bool waitingForDoorClose = false;
+unsigned cycleCounter = 0; // sleeps since the machine started
+int quiettime = 0; //Time between door opening and door opening, used to detect each event properly (seperatly)
 int timeWake = 0;
-RTC_DATA_ATTR esp_sleep_wakeup_cause_t lastWakeReason;
-
-float
+esp_sleep_wakeup_cause_t lastWakeReason;
+
+// Detector of the running state out of the vibration (libraries/LaundryDetector), kept over the deep sleep in the
+// snapshot below -- 10 s of activity for running by WakeConfig (SketchConfig.h, shared with the benches), the door
+// is detected by the motion interrupt of the MPU, not by the detector
+typedef SensorConfig<WakeConfig, 1, LSB_SENS_TABLE[ACCEL_SCALE]> DetectorConfig;
+ActivityDetector<DetectorConfig> detector;
+
+// Calibration of the running thresholds to this machine (libraries/LaundryDetector/ActivityCalibration.h), learned
+// in the wake ups. Kept in the snapshot over the deep sleep and in the NVS over a power cycle, saved when it stops
+#define CALIBRATION_NVS_NAMESPACE "calibration"
+ActivityCalibration<> calibration;
+
+// Vibration bands of the raw samples (libraries/LaundryDetector/VibrationBands.h): the drum at 1, 2, 3 and 5 Hz over
+// blocks of 1 s, started over in every wake up. Once they are still for 3 s the detector stops the machine without
+// waiting for its average, and the sensor goes to sleep earlier
+typedef SensorBandConfig<20, LSB_SENS_TABLE[ACCEL_SCALE]> WakeBandConfig;
+VibrationBands<WakeBandConfig> bands;
+
+// The state over the deep sleep (libraries/LaundryDetector/RtcSnapshot.h): saved in one block with its version and
+// a CRC into the RTC memory right before the deep sleep, restored at the wake up if it is valid. Resumed, the detector
+// is aged by the time slept -- the windows slept through are taken to be the first one of the wake up, the calibration,
+// the history and the flags of the door are kept -- and decides at its first window; a state that isn't valid (a cold
+// boot, a brown out, another build) starts over with the calibration of the NVS and decides after kAverage windows
+#define WAKE_STATE_VERSION 2
+
+typedef struct {
+  ActivityDetector<DetectorConfig> detector;
+  ActivityCalibration<> calibration;
+  SleepHistory sleepHistory;
+  time_t cycleStart;
+  time_t savedAt;
+  unsigned cycleCounter;
+  int quiettime;
+  bool empty;
+  bool running;
+  bool dooropened;
+  bool doorclosed;
+  bool wasRunning;
+  bool wasEmpty;
+  bool monitoringContinuously;
+  bool waitingForDoorClose;
+} WAKE_STATE_T;
+
+RTC_DATA_ATTR RtcSnapshot<WAKE_STATE_T, WAKE_STATE_VERSION> wakeSnapshot;
+bool resumed = false;
+unsigned wakeWindows = 0; // windows of the detector since the wake up, until it decided
+
+// The raw values of the last sample, the detector takes their magnitude in fixed point
+int16_t
   mpu_a_x,
   mpu_a_y,
-  mpu_a_z,
-  mpu_a_mag,
-  RTC_DATA_ATTR prev_mag = 0.0,
-  RTC_DATA_ATTR activity = 0,
-  RTC_DATA_ATTR deltas[WINDOW], //Arrays that hold the values which make up the activity variables
-  RTC_DATA_ATTR activities[WINDOWTWO], //Used to caluclates avg of last 15 seconds of activity
-  DYRERONTHRESHHOLD = 4, //Thresholds
-  avg10 = 0, //Average activity over last 15 seconds (easier way just always keep track of the average)
-  RTC_DATA_ATTR sum10 = 0 //used to calucate a new average every second
+  mpu_a_z
 ;
 
 // Machine identification
 const char* machineId = "a1-m1"; // e.g., "a1-m1", "a2-m5", "b1-m3"
+#define MACHINE_ID_MAX_LEN 16    // Max length for machineId in BLE advertisement
 
 // BLE Advertising object
 BLEAdvertising *pAdvertising;
 
 void IRAM_ATTR motionISR(); 
+void sample_task(void *arg);
 void sleepWaitForPin();
+void sleepFor(SLEEP_WAKE_T wake);
 
 void setup() {
   Serial.begin(38400);
@@ -80,19 +143,17 @@ void setup() {
   esp_sleep_wakeup_cause_t wakeReason = esp_sleep_get_wakeup_cause();
   bool coldBoot = (wakeReason == ESP_SLEEP_WAKEUP_UNDEFINED);
 
-  if (coldBoot){
+  resumed = !coldBoot && restore_state();
+  if (!resumed){
+    Serial.println(coldBoot ? "[WAKE] Cold boot, starting over" : "[WAKE] State of the RTC memory not valid, starting over");
     cycleCounter = 0;
-    // Initialize arrays
-    for (int i = 0; i < WINDOW; i++) {
-      deltas[i] = 0.0;
-    }
-    for (int i = 0; i < WINDOWTWO; i++) {
-      activities[i] = 0.0;
-    }
-    prev_mag = 0;
-    idx = 0;
+    detector.clear();
+    sleepHistory.clear();
     running = false;
+    calibration.clear();
+    load_calibration();
   }
+  detector.setStill(false);   // until the bands of this wake up are
 
   timeWake = 0;
   motionDetected = false;
@@ -133,79 +194,73 @@ void setup() {
   // Start advertising
   BLEDevice::startAdvertising();
   Serial.println("[BLE] Advertising started!");
+
+  start_sampling();
 }
 
 void loop() {
-  // Clear MPU interrupt latch after waking
-  mpu.getIntStatus(); 
-
-  record_mpu_accel();
-  mpu_a_mag = sqrt(mpu_a_x * mpu_a_x + mpu_a_y * mpu_a_y + mpu_a_z * mpu_a_z);
+  ACCEL_SAMPLE_T sample;
 
-  float delta = abs(mpu_a_mag - prev_mag);
-  prev_mag = mpu_a_mag;
+  // The next sample of the timer, a second one in the same period stands for none
+  xQueueReceive(sampleQueue, &sample, portMAX_DELAY);
+  if (!sample.periods) {
+    return;
+  }
+  mpu_a_x = sample.x;
+  mpu_a_y = sample.y;
+  mpu_a_z = sample.z;
 
   if (running && !wasRunning){
     Serial.println("▶️ Machine started running");
     monitoringContinuously = false;
+    cycleStart = time(NULL);
   }
 
   if (running && timeWake > SAMPLE_TIME && !monitoringContinuously){
-    int sleepSeconds = 0;
-    if (cycleCounter == 0) {
-        sleepSeconds = 12;   // 2 minutes
-        Serial.println("⏳ Stage 0 → Sleeping 2 minutes");
-      }
-    else if (cycleCounter < 5) {
-       sleepSeconds = SLEEP_TIME_CYCLE;   // 10 minutes
-       Serial.println("⏳ Stage 1–4 → Sleeping 10 minutes");
-    }
-    else {
+    SLEEP_WAKE_T wake = SleepPolicy::next({ true, false, (uint32_t) (time(NULL) - cycleStart), cycleCounter }, sleepHistory);
+
+    if (!wake.sources) {
        Serial.println("👀 Entering continuous monitoring mode");
        monitoringContinuously = true; //Now that this is true it wont sleep anymore and will search until machine stops
        return;   // stay awake
-     }
+    }
+    Serial.printf("⏳ Stage %u → Sleeping %u seconds\n", cycleCounter, (unsigned) wake.seconds);
     cycleCounter++;
     timeWake = 0;
-
-    // Configure timer wakeup
-    mpu.getIntStatus();
-    delay(5);
-    esp_sleep_enable_timer_wakeup((uint64_t)sleepSeconds * 1000000ULL);
-    delay(100);
-    esp_deep_sleep_start();
+    sleepFor(wake);
   }
 
   wasRunning = running;
   wasEmpty = empty;
 
-  activity -= deltas[idx]; //Minusing the delta 20 samples ago to keep the activity limited to just the most recent 20 samples
-  deltas[idx] = delta; //record the delta now (to delete in 20 samples from now)
-  activity += delta; //add it to variable
-  idx = (idx + 1) % WINDOW; //increment index
-
-  if (idx == 0){ //Once every second, do this:
-    sum10 -= activities[idxtwo];
-    activities[idxtwo] = activity;
-    sum10 += activities[idxtwo]; //sum10 holds sum of last 10 activities recorded
-    idxtwo = (idxtwo + 1) % WINDOWTWO;
-
-    avg10 = sum10 / WINDOWTWO;
-
-    if (avg10 > DYRERONTHRESHHOLD){
-      running = true;
-      empty = false;
-      dooropened = false;
-      doorclosed = false;
+  for (unsigned period = 0; period < sample.periods; period++) {
+    if (bands.update(mpu_a_x, mpu_a_y, mpu_a_z) & BANDS_BLOCK) detector.setStill(bands.still());
+    if (!(detector.updateRaw(mpu_a_x, mpu_a_y, mpu_a_z) & ACTIVITY_TICK)) {
+      continue;
+    }
+    if (calibration.update(detector)) {
+      print_thresholds("📐 Calibrated for this machine");
+      save_calibration();
     }
-    else {
-      running = false;
+    // Time from the boot of the wake up to the first decision over full windows
+    if (wakeWindows < WakeConfig::kAverage && ++wakeWindows == (resumed ? 1 : WakeConfig::kAverage)) {
+      wakeWindows = WakeConfig::kAverage;
+      Serial.printf("[WAKE] %s, decided %s after %lu ms\n", resumed ? "Resumed" : "Started over",
+                    detector.running() ? "running" : "stopped", (unsigned long) (esp_timer_get_time() / 1000));
     }
   }
+  if (detector.running()) {
+    dooropened = false;
+    doorclosed = false;
+  }
+  running = detector.running();
+  empty = detector.empty();
 
   //Go to sleep when stopped running and wait for door open triggered by int pin
   if (!running && wasRunning) {
     Serial.println("🛑 Machine stopped");
+    sleepHistory.add(time(NULL) - cycleStart);
+    save_calibration();
     timeWake = 0;
     sleepWaitForPin();
   }
@@ -227,21 +282,18 @@ void loop() {
         waitingForDoorClose = false;
         Serial.printf("[DOOR] Door closed");
       }
-      quiettime++; // count time between open and close
+      quiettime += sample.periods; // count time between open and close
       if (quiettime > 200){
         waitingForDoorClose = true;
         Serial.println("😴 Sleeping waiting for door to be closed");
-        mpu.getIntStatus();
-        delay(5);
-        esp_sleep_enable_timer_wakeup(30ULL * 1000000ULL); //then it will reach condition below in 30s
-        esp_sleep_enable_ext0_wakeup((gpio_num_t)intPin, 1);  // wake when INT goes HIGH
-        esp_deep_sleep_start();
+        sleepFor(SleepPolicy::next({ false, true, 0, 0 }, sleepHistory)); //then it will reach condition below in 30s
       }
   }
 
   //Between or after the 30 s that we just went to sleep for after door opened
   if (waitingForDoorClose) {
     // If we slept, door was open long enough
+    detector.setEmpty();
     empty = true;
     Serial.println("[STATE] Machine is now EMPTY (slept while door open)");
     if (empty != wasEmpty || running != wasRunning) { //Update before sleeping
@@ -260,6 +312,7 @@ void loop() {
   // Decide if machine is empty based on open–close duration
   if (dooropened && doorclosed && !empty){
       if (quiettime > 85) {
+        detector.setEmpty();
         empty = true;
         Serial.println("[STATE] Machine is now EMPTY (clothes removed)");
         if (empty != wasEmpty || running != wasRunning) { //Update before sleeping
@@ -301,11 +354,10 @@ void loop() {
     Serial.println();
   }
 
-  timeWake++;
+  timeWake += sample.periods;
   motionDetected = false;
 
   print_accels();
-  delay(50);
 }
 
 void IRAM_ATTR motionISR() {
@@ -314,9 +366,18 @@ void IRAM_ATTR motionISR() {
 
 void sleepWaitForPin() {
   Serial.println("😴 Machine idle — sleeping waiting for door interrupt");
+  sleepFor(SleepPolicy::next({ false, false, 0, 0 }, sleepHistory));
+}
+
+void sleepFor(SLEEP_WAKE_T wake) {
+  stop_sampling();
+  save_state();
   mpu.getIntStatus();
   delay(5);
-  esp_sleep_enable_ext0_wakeup((gpio_num_t)intPin, 1);  // wake when INT goes HIGH
+  if (wake.sources & SLEEP_WAKE_TIMER)
+    esp_sleep_enable_timer_wakeup((uint64_t)wake.seconds * 1000000ULL);
+  if (wake.sources & SLEEP_WAKE_MOTION)
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)intPin, 1);  // wake when INT goes HIGH
   esp_deep_sleep_start();
 }
 
@@ -349,53 +410,94 @@ void write_to(const byte to_register, const byte write_value) {
   return;
 }
 
-void record_mpu_accel() {
+void record_mpu_accel(ACCEL_SAMPLE_T *sample) {
   // x high byte 3B, x low 3C, y high 3D, y low 3E, z high 3F, z low 40
   // ACCEL_REG is 3B
   byte buffer[6];
   read_from(ACCEL_REG, 6, buffer);
-  int16_t a_x_raw = (buffer[0] << 8) | buffer[1];
-  int16_t a_y_raw = (buffer[2] << 8) | buffer[3];
-  int16_t a_z_raw = (buffer[4] << 8) | buffer[5];
-  // Combine high byte and low byte into 16-bit accel value, then divide by LSB sensitivity to get accel in g-forces
-  // Also factor in offsets
-  mpu_a_x = a_x_raw / LSB_SENS;
-  mpu_a_y = a_y_raw / LSB_SENS;
-  mpu_a_z = a_z_raw / LSB_SENS;
+  // Combine high byte and low byte into 16-bit accel value, the detector scales it by LSB_SENS_TABLE[ACCEL_SCALE]
+  sample->x = (buffer[0] << 8) | buffer[1];
+  sample->y = (buffer[2] << 8) | buffer[3];
+  sample->z = (buffer[4] << 8) | buffer[5];
+}
+
+void onSampleTimer(void *arg) {
+  xTaskNotifyGive(sampleTask);
+}
+
+// Takes a sample per notification of the timer -- the notifications while it was blocked are taken at once, the
+// clock counts the periods missed. A sample the queue has no room for is dropped, its periods go with the next one
+void sample_task(void *arg) {
+  ACCEL_SAMPLE_T sample;
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    uint64_t now = esp_timer_get_time();
+    record_mpu_accel(&sample);
+    mpu.getIntStatus();   // clear the latch of the motion interrupt
+    sample.periods = sampleClock.tick(now);
+    if (xQueueSend(sampleQueue, &sample, 0) != pdTRUE) {
+      sampleClock.drop(sample.periods);
+    }
+  }
+}
+
+void start_sampling() {
+  esp_timer_create_args_t args = {};
+
+  args.callback = onSampleTimer;
+  args.name = "sample";
+  sampleQueue = xQueueCreate(SAMPLE_QUEUE, sizeof(ACCEL_SAMPLE_T));
+  xTaskCreate(sample_task, "sample", SAMPLE_TASK_STACK, NULL, SAMPLE_TASK_PRIORITY, &sampleTask);
+  esp_timer_create(&args, &sampleTimer);
+  sampleClock.begin(SAMPLE_PERIOD, esp_timer_get_time());
+  esp_timer_start_periodic(sampleTimer, SAMPLE_PERIOD);
+}
+
+// Stops the timer before the deep sleep and reports the sampling of this wake up
+void stop_sampling() {
+  SAMPLE_CLOCK_STATS_T stats;
+
+  esp_timer_stop(sampleTimer);
+  sampleClock.stats(&stats);
+  Serial.printf("[SAMPLE] %lu samples, %lu missed, %lu dropped, jitter %u us (max. %u us)\n", stats.samples,
+                stats.missed, stats.dropped, (unsigned) sampleClock.jitter(), (unsigned) stats.jitterMax);
 }
 
 void updateAdvertisement() {
-  // Create manufacturer data packet
-  // Format: Company ID (2 bytes) + MAC address (6 bytes) + Machine ID char (1 byte) + Status (1 byte)
-  uint8_t manufData[10];
+  // Create manufacturer data packet, the layout of machineESP that the scanner decodes
+  // Format: Company ID (2 bytes) + Machine ID (16 bytes, null-padded) + Thresholds (3 bytes) + Status (1 byte)
+  // Total: 22 bytes (room mapping is done on backend based on machineId prefix), the status byte stays the last one
+  const int MANUF_DATA_LEN = 2 + MACHINE_ID_MAX_LEN + 3 + 1;
+  uint8_t manufData[MANUF_DATA_LEN];
+  memset(manufData, 0, MANUF_DATA_LEN);
+
   // Company ID (0xFFFF for custom/testing)
   manufData[0] = 0xFF;
   manufData[1] = 0xFF;
-  // MAC address (device identification)
-  uint64_t mac = ESP.getEfuseMac();
-  for(int i = 0; i < 6; i++) {
-    manufData[2 + i] = (mac >> (i * 8)) & 0xFF;
-  }
 
-  // Machine ID (extract last character from machineId, e.g., '1' from "a1-m1")
-  const char* idPtr = machineId;
-  char machineChar = '0';
-  while (*idPtr != '\0') {
-    if (*idPtr >= '0' && *idPtr <= '9') {
-      machineChar = *idPtr;
-    }
-    idPtr++;
-  }
-  manufData[8] = (uint8_t)machineChar;
+  // Machine ID (full string, null-padded to MACHINE_ID_MAX_LEN bytes)
+  int idLen = strlen(machineId);
+  if (idLen > MACHINE_ID_MAX_LEN) idLen = MACHINE_ID_MAX_LEN;
+  memcpy(&manufData[2], machineId, idLen);
 
-  // Status byte (bit 0: running, bit 1: empty)
-  manufData[9] = (running ? 0x01 : 0x00) | (empty ? 0x02 : 0x00);
+  // Thresholds of the detector: running and stopped in 1/16 g, the door closing in 1/64 g (0, the MPU detects it)
+  ACTIVITY_THRESHOLDS_T thresholds;
+  detector.thresholds(&thresholds);
+  manufData[2 + MACHINE_ID_MAX_LEN] = CalibrationByte(thresholds.running, CALIBRATION_BYTE_RUNNING);
+  manufData[2 + MACHINE_ID_MAX_LEN + 1] = CalibrationByte(thresholds.stopped, CALIBRATION_BYTE_RUNNING);
+  manufData[2 + MACHINE_ID_MAX_LEN + 2] = CalibrationByte(thresholds.closing, CALIBRATION_BYTE_DOOR);
+
+  // Status byte (bit 0: running, bit 1: empty, bit 2: the thresholds are calibrated, bits 3-7: no estimate of the
+  // minutes remaining, the sensor sleeps through the cycle)
+  manufData[MANUF_DATA_LEN - 1] = (running ? 0x01 : 0x00) | (empty ? 0x02 : 0x00) | (calibration.calibrated() ? 0x04 : 0x00);
 
   // Set manufacturer data in advertisement
   BLEAdvertisementData advData;
-  //advData.setManufacturerData(std::string((char*)manufData, 10));
+  //advData.setManufacturerData(std::string((char*)manufData, sizeof(manufData)));
   String mfg;
-  for (int i = 0; i < 10; i++) {
+  for (int i = 0; i < (int) sizeof(manufData); i++) {
     mfg += (char)manufData[i];
   }
   advData.setManufacturerData(mfg);
@@ -407,6 +509,89 @@ void updateAdvertisement() {
                empty ? "YES" : "NO");
 }
 
+// Save the state into the snapshot of the RTC memory before the deep sleep -- static, it's too big for the stack
+void save_state() {
+  static WAKE_STATE_T state;
+
+  state.detector = detector;
+  state.calibration = calibration;
+  state.sleepHistory = sleepHistory;
+  state.cycleStart = cycleStart;
+  state.savedAt = time(NULL);
+  state.cycleCounter = cycleCounter;
+  state.quiettime = quiettime;
+  state.empty = empty;
+  state.running = running;
+  state.dooropened = dooropened;
+  state.doorclosed = doorclosed;
+  state.wasRunning = wasRunning;
+  state.wasEmpty = wasEmpty;
+  state.monitoringContinuously = monitoringContinuously;
+  state.waitingForDoorClose = waitingForDoorClose;
+  wakeSnapshot.save(state);
+}
+
+// Resume the state of the snapshot after the wake up, false if it isn't valid
+bool restore_state() {
+  static WAKE_STATE_T state;
+
+  if (!wakeSnapshot.restore(&state)) {
+    return false;
+  }
+  // The windows of before the sleep are as old as the sleep, the RTC runs on in it
+  time_t slept = time(NULL) - state.savedAt;
+  detector = state.detector;
+  detector.age((slept > 0) ? (unsigned) (slept * (1000000 / SAMPLE_PERIOD)) : 0);
+  calibration = state.calibration;
+  sleepHistory = state.sleepHistory;
+  cycleStart = state.cycleStart;
+  cycleCounter = state.cycleCounter;
+  quiettime = state.quiettime;
+  empty = state.empty;
+  running = state.running;
+  dooropened = state.dooropened;
+  doorclosed = state.doorclosed;
+  wasRunning = state.wasRunning;
+  wasEmpty = state.wasEmpty;
+  monitoringContinuously = state.monitoringContinuously;
+  waitingForDoorClose = state.waitingForDoorClose;
+  return true;
+}
+
+// Restore the estimates of the calibration from the NVS after a power cycle
+void load_calibration() {
+  Preferences prefs;
+  ACTIVITY_CALIBRATION_T saved;
+
+  prefs.begin(CALIBRATION_NVS_NAMESPACE, true);
+  bool restored = prefs.getBytes("estimates", &saved, sizeof(saved)) == sizeof(saved) && calibration.restore(&saved);
+  prefs.end();
+
+  if (restored) {
+    calibration.apply(detector);
+  }
+  print_thresholds((restored) ? "📐 Calibration restored" : "📐 Calibration learning");
+}
+
+void save_calibration() {
+  Preferences prefs;
+  ACTIVITY_CALIBRATION_T saved;
+
+  calibration.save(&saved);
+  prefs.begin(CALIBRATION_NVS_NAMESPACE, false);
+  prefs.putBytes("estimates", &saved, sizeof(saved));
+  prefs.end();
+}
+
+void print_thresholds(const char *what) {
+  ACTIVITY_THRESHOLDS_T thresholds;
+
+  detector.thresholds(&thresholds);
+  Serial.printf("%s - running above %.2f g, stopped below %.2f g%s\n", what,
+                (float) thresholds.running / ACTIVITY_UNITS_PER_G, (float) thresholds.stopped / ACTIVITY_UNITS_PER_G,
+                calibration.calibrated() ? " (calibrated)" : "");
+}
+
  void print_accels() {
     /*Serial.print("mpu_a_x:");
     Serial.print(mpu_a_x);
@@ -418,9 +603,9 @@ void updateAdvertisement() {
     Serial.print(mpu_a_z);
     Serial.print(' '); 
     Serial.print("change over last second:");
-    Serial.print(activity);
+    Serial.print(detector.activity());
     Serial.print(' ');
     Serial.print("mpu_a_mag:");
-    Serial.print(mpu_a_mag);
+    Serial.print(detector.magnitude());
     Serial.println();*/
   }
\ No newline at end of file
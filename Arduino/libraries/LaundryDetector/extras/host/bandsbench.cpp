@@ -0,0 +1,306 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the vibration bands
+
+  Loads of a dryer at 200 Hz (the FIFO) are run through the detectors of
+  the sketches, deciding on the average of 10 s (the dryer, avg10) and of
+  15 s (machineESP, avg15), each once alone and once told by the
+  VibrationBands when the machine is still. The drum turns at 0.8 to 1 Hz
+  under the tumbling of the clothes, pauses for 1.5 to 2.5 s when it
+  reverses and coasts for 2 s when the cycle ends.
+
+  The transitions are scored against the truth like trace-replay does:
+  within the tolerance of the same event is a hit, the others are false
+  positives or negatives.
+
+  checks
+    - a sine at the bin of a band is measured within 2 % in the band and
+      below 1 % of it in the others, the gravity and the tilt on the axes
+      are below 0.001 g
+    - the bands are still at rest and not while running
+    - with the bands, the detectors stop earlier and miss or mistake no
+      more than alone
+
+  measures
+    - hits, false positives and negatives and the delay per event
+    - cost of a sample of the bands and of the detector
+
+  usage: bands-bench [-n <loads>] [-w <tolerance s>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+#define BANDSBENCH_RATE         200
+#define BANDSBENCH_LSB_PER_G    2048
+
+/*
+   the configurations of the sketches, sampled from the FIFO
+*/
+typedef SensorConfig<DryerConfig, BANDSBENCH_RATE / 20> BandsBenchDryerConfig;
+typedef SensorConfig<MachineEspConfig, BANDSBENCH_RATE / 20> BandsBenchMachineConfig;
+
+static int _loads = 20;
+static double _tolerance = 60;
+static unsigned _seed = 1;
+
+static int16_t BandsBenchRaw(float g)
+{
+  return (int16_t) std::max(-32768L, std::min(32767L, lroundf(g * BANDSBENCH_LSB_PER_G)));
+}
+
+/*
+   a sine at the bin of every band, on the gravity
+*/
+static bool BandsBenchSine(void)
+{
+  static VibrationBands<> bands;
+  bool ok = true;
+  float leak = 0, error = 0;
+
+  for (unsigned band = 0; band < BandConfig::kBands; band++) {
+    float phase = BenchUniform(0, 2 * M_PI);
+
+    bands.clear();
+    for (unsigned n = 0; n < 3 * BandConfig::kBlock; n++)
+      bands.update(BandsBenchRaw(0.05 + 0.1 * sinf(2 * M_PI * BandConfig::Bin(band) * n / BANDSBENCH_RATE + phase)),
+                   BandsBenchRaw(-0.02), BandsBenchRaw(1.0));
+    error = std::max(error, fabsf(bands.amplitude(band) - 0.1f) / 0.1f);
+    for (unsigned other = 0; other < BandConfig::kBands; other++)
+      if (other != band)
+        leak = std::max(leak, bands.amplitude(other) / 0.1f);
+  }
+  ok = error < 0.02 && leak < 0.01;
+  printf("BANDS: sine of 0.1 g, amplitude off by %.2f %%, %.2f %% in the other bands %s\n", error * 100, leak * 100,
+         (ok) ? "ok" : "FAILED");
+
+  bands.clear();
+  for (unsigned n = 0; n < 3 * BandConfig::kBlock; n++)
+    bands.update(BandsBenchRaw(0.05), BandsBenchRaw(-0.02), BandsBenchRaw(1.0));
+
+  bool flat = bands.level() < 0.001;
+
+  printf("BANDS: gravity, %.5f g in all bands %s\n", bands.level(), (flat) ? "ok" : "FAILED");
+  return ok && flat;
+}
+
+/*
+   a detector fed the samples, told by the bands or not
+*/
+template <class Config>
+struct BandsBenchDetector {
+  const char *name;
+  bool still;
+  ActivityDetector<Config> detector;
+  std::vector<BENCH_TRANSITION_T> transitions;
+  bool running;
+
+  void sample(int16_t x, int16_t y, int16_t z, double time, unsigned bandEvents, bool bandsStill)
+  {
+    if (still && (bandEvents & BANDS_BLOCK))
+      detector.setStill(bandsStill);
+    detector.updateRaw(x, y, z);
+    if (detector.running() != running)
+      transitions.push_back({ time, (running) ? BENCH_STOPPED : BENCH_STARTED, false });
+    running = detector.running();
+  }
+};
+
+/*
+   the loads through the detectors
+*/
+static bool BandsBenchLoads(void)
+{
+  static VibrationBands<> bands;
+  static BandsBenchDetector<BandsBenchDryerConfig> dryer[2] = { { "avg10", false, {}, {}, false },
+                                                                { "avg10+bands", true, {}, {}, false } };
+  static BandsBenchDetector<BandsBenchMachineConfig> machine[2] = { { "avg15", false, {}, {}, false },
+                                                                    { "avg15+bands", true, {}, {}, false } };
+  std::vector<BENCH_TRANSITION_T> truth;
+  unsigned long samples = 0, idleBlocks = 0, idleStill = 0, runBlocks = 0, runStill = 0;
+  bool running = false;
+
+  bands.clear();
+  for (int d = 0; d < 2; d++) {
+    dryer[d].detector.clear();
+    machine[d].detector.clear();
+  }
+
+  float tilt = BenchNoise(0.05);
+  auto sample = [&](float x, float y, float z) {
+    int16_t rx = BandsBenchRaw(x + tilt + BenchNoise(0.003));
+    int16_t ry = BandsBenchRaw(y + BenchNoise(0.003));
+    int16_t rz = BandsBenchRaw(z + 1.0 + BenchNoise(0.003));
+    double time = samples++ / (double) BANDSBENCH_RATE;
+    unsigned events = bands.update(rx, ry, rz);
+
+    if (events & BANDS_BLOCK) {
+      (running) ? runBlocks++ : idleBlocks++;
+      if (bands.still())
+        (running) ? runStill++ : idleStill++;
+    }
+    for (int d = 0; d < 2; d++) {
+      dryer[d].sample(rx, ry, rz, time, events, bands.still());
+      machine[d].sample(rx, ry, rz, time, events, bands.still());
+    }
+  };
+  auto idle = [&](long n) {
+    while (n-- > 0)
+      sample(0, 0, 0);
+  };
+  auto label = [&](int event) {
+    truth.push_back({ samples / (double) BANDSBENCH_RATE, event, false });
+  };
+
+  /*
+     the drum at f Hz and its first harmonic under the tumbling, scaled by gain
+  */
+  float level = 0.5, frequency = 1, phase = 0;
+  auto turn = [&](float gain) {
+    if (samples % 20 == 0)
+      level = std::max(0.2f, std::min(0.8f, level + BenchNoise(0.02)));
+    phase += 2 * M_PI * frequency / BANDSBENCH_RATE;
+
+    float drum = level / 2 * (sinf(phase) + 0.5 * sinf(2 * phase + 1));
+
+    sample(gain * (drum + BenchNoise(level / 2)), gain * BenchNoise(level / 2),
+           gain * (drum + BenchNoise(level)));
+  };
+
+  for (int load = 0; load < _loads; load++) {
+    idle(BenchRandom(5, 20) * 60L * BANDSBENCH_RATE);
+    label(BENCH_STARTED);
+    running = true;
+    frequency = BenchUniform(0.8, 1.0);
+
+    long end = samples + BenchRandom(20, 40) * 60L * BANDSBENCH_RATE;
+
+    while ((long) samples < end) {
+      for (long n = BenchRandom(60, 180) * BANDSBENCH_RATE; n > 0; n--)
+        turn(1);
+      idle(BenchRandom(15, 25) * BANDSBENCH_RATE / 10);    // the drum reverses
+    }
+    label(BENCH_STOPPED);
+    running = false;
+    for (long n = 0; n < 2 * BANDSBENCH_RATE; n++)               // and coasts
+      turn(1 - (float) n / (2 * BANDSBENCH_RATE));
+  }
+  idle(10 * 60L * BANDSBENCH_RATE);
+
+  /*
+     still at rest, not while running -- a reversal is running
+  */
+  bool ok = idleStill > 0.99 * idleBlocks && runStill < 0.01 * runBlocks;
+
+  printf("\nBANDS: %d loads, still in %.1f %% of the blocks at rest, %.2f %% running %s\n", _loads,
+         100.0 * idleStill / idleBlocks, 100.0 * runStill / runBlocks, (ok) ? "ok" : "FAILED");
+  printf("%-12s %-10s %8s %8s %8s %10s\n", "detector", "event", "hits", "false +", "false -", "delay");
+
+  auto score = [&](const char *name, std::vector<BENCH_TRANSITION_T> &transitions, BENCH_SCORE_T *score) {
+    BenchScore(transitions, truth, _tolerance, score);
+    for (int event = BENCH_STARTED; event <= BENCH_STOPPED; event++)
+      printf("%-12s %-10s %8lu %8lu %8lu %8.1f s\n", (event) ? "" : name, _bench_events[event],
+             score->hits[event], score->positives[event], score->negatives[event], BenchDelay(*score, event));
+  };
+  auto compare = [&](const char *name, const BENCH_SCORE_T *scores) {
+    double delays[2];
+
+    for (int d = 0; d < 2; d++)
+      delays[d] = BenchDelay(scores[d], BENCH_STOPPED);
+
+    bool better = BenchErrors(scores[1]) <= BenchErrors(scores[0]) && delays[1] < delays[0];
+
+    printf("BANDS: %s stopped after %.1f s, with the bands after %.1f s, %lu errors, %lu with the bands %s\n", name,
+           delays[0], delays[1], BenchErrors(scores[0]), BenchErrors(scores[1]), (better) ? "ok" : "FAILED");
+    return better;
+  };
+
+  BENCH_SCORE_T dryers[2], machines[2];
+
+  for (int d = 0; d < 2; d++)
+    score(dryer[d].name, dryer[d].transitions, &dryers[d]);
+  for (int d = 0; d < 2; d++)
+    score(machine[d].name, machine[d].transitions, &machines[d]);
+  ok &= compare("avg10", dryers);
+  ok &= compare("avg15", machines);
+  return ok;
+}
+
+/*
+   the cost of a sample of the bands and of the detector
+*/
+static void BandsBenchCost(void)
+{
+  static VibrationBands<> bands;
+  static ActivityDetector<BandsBenchDryerConfig> detector;
+  std::vector<int16_t> values(3 * 100000);
+  unsigned long events = 0;
+
+  for (int16_t &value : values)
+    value = BandsBenchRaw(BenchNoise(0.5));
+  bands.clear();
+  detector.clear();
+
+  double t = BenchTime();
+
+  for (int pass = 0; pass < 10; pass++)
+    for (size_t n = 0; n < values.size(); n += 3)
+      events += bands.update(values[n], values[n + 1], values[n + 2]);
+
+  double banded = BenchTime() - t;
+
+  t = BenchTime();
+  for (int pass = 0; pass < 10; pass++)
+    for (size_t n = 0; n < values.size(); n += 3)
+      events += detector.updateRaw(values[n], values[n + 1], values[n + 2]);
+
+  double detected = BenchTime() - t;
+  double count = 10.0 * values.size() / 3;
+
+  printf("\nBANDS: %u bands x 3 axes, %.1f ns per sample, the detector %.1f ns per sample (%lu events), "
+         "%zu bytes of state\n", BandConfig::kBands, banded * 1e9 / count, detected * 1e9 / count, events,
+         sizeof(bands));
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:w:s:")) != -1) {
+    switch (opt) {
+      case 'n': _loads = std::max(1, atoi(optarg)); break;
+      case 'w': _tolerance = atof(optarg); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-n <loads>] [-w <tolerance s>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool failed = false;
+
+  failed |= !BandsBenchSine();
+  failed |= !BandsBenchLoads();
+  BandsBenchCost();
+
+  printf("BANDS: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
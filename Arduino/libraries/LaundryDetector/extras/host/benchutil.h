@@ -0,0 +1,139 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  the helpers of the benches on the host
+
+  The random numbers of the synthetic machines -- one generator, seeded
+  by -s of the bench, so a run can be repeated -- the time to measure
+  the costs, and the score of the transitions of a detector against the
+  truth or the labels of a trace: a transition within the tolerance of a
+  label of the same event is a hit, the nearest one, the others are
+  false positives, the labels without one are false negatives.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __BENCHUTIL_H__
+#define __BENCHUTIL_H__ 1
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/*
+   the random numbers
+*/
+static std::mt19937 _bench_rng;
+
+static inline void BenchSeed(unsigned seed)
+{
+  _bench_rng.seed(seed);
+}
+
+static inline float BenchNoise(float sigma)
+{
+  return std::normal_distribution<float>(0, sigma)(_bench_rng);
+}
+
+static inline double BenchUniform(double min, double max)
+{
+  return std::uniform_real_distribution<double>(min, max)(_bench_rng);
+}
+
+static inline int BenchRandom(int min, int max)
+{
+  return std::uniform_int_distribution<int>(min, max)(_bench_rng);
+}
+
+/*
+   get the real time in seconds
+*/
+static inline double BenchTime(void)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+   the events
+*/
+#define BENCH_STARTED           0
+#define BENCH_STOPPED           1
+#define BENCH_EMPTIED           2
+#define BENCH_EVENTS            3
+
+static const char *const _bench_events[BENCH_EVENTS] = { "started", "stopped", "emptied" };
+
+typedef struct _bench_transition {
+  double time;
+  int event;
+  bool hit;
+} BENCH_TRANSITION_T;
+
+typedef struct _bench_score {
+  unsigned long hits[BENCH_EVENTS];
+  unsigned long positives[BENCH_EVENTS];
+  unsigned long negatives[BENCH_EVENTS];
+  double delay[BENCH_EVENTS];
+} BENCH_SCORE_T;
+
+/*
+   score the transitions against the truth within the tolerance in seconds -- the hits are
+   marked in both, the ones left are the false positives resp. negatives
+*/
+static inline void BenchScore(std::vector<BENCH_TRANSITION_T> &transitions, std::vector<BENCH_TRANSITION_T> &truth,
+                              double tolerance, BENCH_SCORE_T *score)
+{
+  *score = BENCH_SCORE_T();
+  for (BENCH_TRANSITION_T &label : truth)
+    label.hit = false;
+  for (BENCH_TRANSITION_T &transition : transitions) {
+    BENCH_TRANSITION_T *nearest = NULL;
+
+    for (BENCH_TRANSITION_T &label : truth)
+      if (label.event == transition.event && !label.hit && fabs(label.time - transition.time) <= tolerance &&
+          (!nearest || fabs(label.time - transition.time) < fabs(nearest->time - transition.time)))
+        nearest = &label;
+    transition.hit = nearest != NULL;
+    if (nearest) {
+      nearest->hit = true;
+      score->delay[transition.event] += transition.time - nearest->time;
+      score->hits[transition.event]++;
+    }
+    else
+      score->positives[transition.event]++;
+  }
+  for (BENCH_TRANSITION_T &label : truth)
+    if (!label.hit)
+      score->negatives[label.event]++;
+}
+
+/*
+   the false positives and negatives
+*/
+static inline unsigned long BenchErrors(const BENCH_SCORE_T &score)
+{
+  unsigned long errors = 0;
+
+  for (int event = 0; event < BENCH_EVENTS; event++)
+    errors += score.positives[event] + score.negatives[event];
+  return errors;
+}
+
+/*
+   the mean delay of the hits of an event in seconds
+*/
+static inline double BenchDelay(const BENCH_SCORE_T &score, int event)
+{
+  return (score.hits[event]) ? score.delay[event] / score.hits[event] : 0;
+}
+
+#endif
+
+/**/
@@ -0,0 +1,299 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the calibration of the thresholds
+
+  Days of laundry cycles at 20 Hz are run through the detector with the
+  thresholds of the configuration (of machineESP) and through one which
+  is calibrated, on machines which vibrate differently:
+
+    reference   the machine the thresholds were tuned on
+    weak        a dryer on a heavy floor, running below kRunning
+    noisy       next to a running machine, at rest near kRunning and
+                with the noise of the small activity above kDoorOpening
+
+  The transitions are scored against the truth like trace-replay does:
+  within the tolerance of the same event is a hit, the others are false
+  positives or negatives.
+
+  checks
+    - the median and the MAD of the estimate are on average within 10 %
+      of the ones of the values, for a normal and an exponential
+      distribution, and follow a step of the values within 10 minutes
+    - the saved estimates restore the same thresholds, another version
+      isn't restored
+    - the calibrated detector misses and mistakes no more than the one
+      of the configuration on the reference, and less on the others
+
+  measures
+    - hits, false positives and negatives and the delay per event
+    - the derived thresholds
+    - cost of an update of the calibration
+
+  usage: calibration-bench [-d <days>] [-w <tolerance s>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+/*
+   a machine -- the noise at rest, the vibration running and the door, in g
+*/
+typedef struct _calibrationbench_machine {
+  const char *name;
+  float idle;
+  float low, high;
+  float look, slam;
+} CALIBRATIONBENCH_MACHINE_T;
+
+static const CALIBRATIONBENCH_MACHINE_T _machines[] = {
+  { "reference", 0.003, 0.2, 0.8, 0.3, 0.6 },
+  { "weak", 0.003, 0.05, 0.1, 0.3, 0.6 },
+  { "noisy", 0.1, 0.4, 1.0, 0.6, 1.2 },
+};
+
+static int _days = 7;
+static double _tolerance = 60;
+static unsigned _seed = 1;
+
+/*
+   the estimate of values against their exact median and MAD
+*/
+template <typename D>
+static bool CalibrationBenchEstimate(const char *name, D distribution, float offset)
+{
+  ACTIVITY_ESTIMATE_T estimate = {};
+  std::vector<uint32_t> values, deviations;
+  double medians = 0, mads = 0;
+
+  for (int n = 0; n < 20000; n++) {
+    uint32_t value = ActivityUnits(offset + distribution(_bench_rng));
+
+    ActivityEstimate(&estimate, value, CalibrationConfig::kRate);
+    if (n >= 10000) {
+      values.push_back(value);
+      medians += estimate.median;
+      mads += estimate.mad;
+    }
+  }
+  medians /= values.size();
+  mads /= values.size();
+  std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+
+  uint32_t median = values[values.size() / 2];
+
+  for (uint32_t value : values)
+    deviations.push_back((value > median) ? value - median : median - value);
+  std::nth_element(deviations.begin(), deviations.begin() + deviations.size() / 2, deviations.end());
+
+  uint32_t mad = deviations[deviations.size() / 2];
+  bool ok = fabs(medians - median) < 0.1 * median && fabs(mads - mad) < 0.1 * mad;
+
+  printf("CALIBRATION: %-12s median %6.3f g (%6.3f), MAD %6.3f g (%6.3f) %s\n", name,
+         medians / ACTIVITY_UNITS_PER_G, (double) median / ACTIVITY_UNITS_PER_G, mads / ACTIVITY_UNITS_PER_G,
+         (double) mad / ACTIVITY_UNITS_PER_G, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   the estimate follows a step of the values
+*/
+static bool CalibrationBenchStep(void)
+{
+  ACTIVITY_ESTIMATE_T estimate = {};
+  int windows = 0;
+
+  for (int n = 0; n < 3600; n++)
+    ActivityEstimate(&estimate, ActivityUnits(0.1 + BenchNoise(0.01)), CalibrationConfig::kRate);
+  while (estimate.median < ActivityUnits(0.9) && windows < 100000) {
+    ActivityEstimate(&estimate, ActivityUnits(1.0 + BenchNoise(0.01)), CalibrationConfig::kRate);
+    windows++;
+  }
+
+  bool ok = windows < 600;
+
+  printf("CALIBRATION: step 0.1 g to 1.0 g followed in %d windows %s\n", windows, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   the days of a machine through the configured and the calibrated detector
+*/
+static bool CalibrationBenchMachine(const CALIBRATIONBENCH_MACHINE_T &machine)
+{
+  static ActivityDetector<> configured, calibrated;
+  static ActivityCalibration<> calibration;
+  std::vector<BENCH_TRANSITION_T> truth, transitions[2];
+  ActivityDetector<> *detectors[2] = { &configured, &calibrated };
+  bool running[2] = {}, empty[2] = { true, true };
+  unsigned long samples = 0, ticks = 0;
+  double cost = 0;
+
+  configured.clear();
+  calibrated.clear();
+  calibrated.setThresholds(NULL);
+  calibration.clear();
+
+  float tilt = BenchNoise(0.05);
+  auto sample = [&](float x, float y, float z) {
+    x += tilt + BenchNoise(machine.idle);
+    y += BenchNoise(machine.idle);
+    z += 1.0 + BenchNoise(machine.idle);
+
+    float magnitude = sqrtf(x * x + y * y + z * z);
+    double time = samples++ / 20.0;
+
+    for (int d = 0; d < 2; d++) {
+      unsigned events = detectors[d]->update(magnitude);
+
+      if (d && (events & ACTIVITY_TICK)) {
+        double t = BenchTime();
+
+        calibration.update(calibrated);
+        cost += BenchTime() - t;
+        ticks++;
+      }
+      if (detectors[d]->running() != running[d])
+        transitions[d].push_back({ time, (running[d]) ? BENCH_STOPPED : BENCH_STARTED, false });
+      if (detectors[d]->empty() && !empty[d])
+        transitions[d].push_back({ time, BENCH_EMPTIED, false });
+      running[d] = detectors[d]->running();
+      empty[d] = detectors[d]->empty();
+    }
+  };
+  auto idle = [&](long n) {
+    while (n-- > 0)
+      sample(0, 0, 0);
+  };
+  auto run = [&](long n) {
+    float level = (machine.low + machine.high) / 2;
+
+    for (long i = 0; i < n; i++) {
+      if (i % 20 == 0)
+        level = std::max(machine.low, std::min(machine.high, level + BenchNoise(0.02)));
+      sample(BenchNoise(level / 2), BenchNoise(level / 2), BenchNoise(level));
+    }
+  };
+  auto slam = [&](float level) {
+    for (int n = 0; n < 3; n++)
+      sample(0, 0, (n & 1) ? -level : level);
+  };
+  auto label = [&](int event) {
+    truth.push_back({ samples / 20.0, event, false });
+  };
+
+  for (int day = 0; day < _days; day++) {
+    unsigned long end = (day + 1) * 86400UL * 20;
+
+    idle(BenchRandom(7, 10) * 3600L * 20);
+    for (int load = BenchRandom(1, 4); load > 0; load--) {
+      label(BENCH_STARTED);
+      run(BenchRandom(40, 80) * 60L * 20);
+      label(BENCH_STOPPED);
+      idle(BenchRandom(1, 60) * 60L * 20);
+      if (BenchRandom(0, 3) == 0) {    // a look first
+        slam(machine.look);
+        idle(BenchRandom(45, 75));
+        slam(machine.slam);
+        idle(BenchRandom(100, 2000));
+      }
+      slam(machine.look);
+      idle(BenchRandom(200, 1500));
+      label(BENCH_EMPTIED);
+      slam(machine.slam);
+      idle(BenchRandom(10, 60) * 60L * 20);
+    }
+    if (samples < end)
+      idle(end - samples);
+  }
+
+  /*
+     the saved estimates restore the same thresholds
+  */
+  static ActivityDetector<> restored;
+  static ActivityCalibration<> copy;
+  ACTIVITY_CALIBRATION_T saved;
+  ACTIVITY_THRESHOLDS_T thresholds, again;
+
+  calibration.save(&saved);
+  copy.clear();
+  restored.setThresholds(NULL);
+  bool ok = copy.restore(&saved);
+
+  copy.apply(restored);
+  calibrated.thresholds(&thresholds);
+  restored.thresholds(&again);
+  ok = ok && !memcmp(&thresholds, &again, sizeof(thresholds));
+  saved.version++;
+  ok = ok && !copy.restore(&saved);
+
+  BENCH_SCORE_T scores[2];
+
+  for (int d = 0; d < 2; d++)
+    BenchScore(transitions[d], truth, _tolerance, &scores[d]);
+
+  unsigned long errors[2] = { BenchErrors(scores[0]), BenchErrors(scores[1]) };
+
+  ok = ok && errors[1] <= errors[0] && (!strcmp(machine.name, "reference") || errors[1] < errors[0]);
+
+  printf("\nCALIBRATION: %s, %d days, %zu loads, %s, thresholds running %.2f g, stopped %.2f g, "
+         "opening %.2f g, closing %.2f g\n", machine.name, _days, truth.size() / BENCH_EVENTS,
+         (calibration.calibrated()) ? "calibrated" : "not calibrated",
+         (double) thresholds.running / ACTIVITY_UNITS_PER_G, (double) thresholds.stopped / ACTIVITY_UNITS_PER_G,
+         (double) thresholds.opening / ACTIVITY_UNITS_PER_G, (double) thresholds.closing / ACTIVITY_UNITS_PER_G);
+  printf("%-12s %-10s %8s %8s %8s %10s\n", "detector", "event", "hits", "false +", "false -", "delay");
+  for (int d = 0; d < 2; d++)
+    for (int event = 0; event < BENCH_EVENTS; event++)
+      printf("%-12s %-10s %8lu %8lu %8lu %8.1f s\n", (event) ? "" : (d) ? "calibrated" : "configured",
+             _bench_events[event], scores[d].hits[event], scores[d].positives[event],
+             scores[d].negatives[event], BenchDelay(scores[d], event));
+  printf("CALIBRATION: %s, %lu errors configured, %lu calibrated, %.1f ns per update %s\n", machine.name,
+         errors[0], errors[1], cost * 1e9 / ticks, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "d:w:s:")) != -1) {
+    switch (opt) {
+      case 'd': _days = std::max(2, atoi(optarg)); break;
+      case 'w': _tolerance = atof(optarg); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-d <days>] [-w <tolerance s>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool failed = false;
+
+  failed |= !CalibrationBenchEstimate("normal", std::normal_distribution<float>(0, 0.2), 2.0);
+  failed |= !CalibrationBenchEstimate("exponential", std::exponential_distribution<float>(5), 0.1);
+  failed |= !CalibrationBenchStep();
+  for (const CALIBRATIONBENCH_MACHINE_T &machine : _machines)
+    failed |= !CalibrationBenchMachine(machine);
+
+  printf("CALIBRATION: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
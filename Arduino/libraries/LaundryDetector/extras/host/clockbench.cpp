@@ -0,0 +1,310 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the sampling by a periodic timer
+
+  The sampling of DryerLaunDryerCode is simulated in us: a timer every
+  50 ms notifies the sampling task, which is late by the latency of the
+  scheduler and the I2C transaction, and now and then blocked by a task
+  of a higher priority (BLE, a write of the flash) -- the notifications
+  meanwhile are taken by one wake up. The samples go through a queue of
+  20 to the loop, which is stalled by the Serial output, an update of
+  the advertisement and a save to the NVS, and holds every sample for
+  the periods it stands for in the detector.
+
+  checks
+    - undisturbed, no sample is missed nor dropped and the jitter is
+      within the latency of the task
+    - the missed and the dropped samples are counted, the periods passed
+      to the loop add up to the slots of the timer
+    - the windows of the detector are a second of time, whatever the loop
+      does in between
+
+  measures
+    - the jitter, the missed and the dropped samples
+    - the length of a window of the detector, against the loop with
+      delay(50) after its work
+    - the cost of a sample of the clock
+
+  usage: clock-bench [-m <minutes>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+/*
+   the period of the timer and the queue of the sketch
+*/
+#define CLOCKBENCH_PERIOD       50000
+#define CLOCKBENCH_QUEUE        20
+
+struct ClockConfig : ActivityConfig {
+  static constexpr unsigned kAverage = 10;
+};
+
+/*
+   the disturbances of the sampling task and of the loop
+*/
+typedef struct _clockbench_load {
+  const char *name;
+  double blocked;               // chance per period the task is blocked
+  double blockMax;              // for up to ... us
+  double stalled;               // chance per sample the loop is stalled
+  double stallMax;              // for up to ... us
+} CLOCKBENCH_LOAD_T;
+
+typedef struct _clockbench_sample {
+  uint64_t us;
+  unsigned periods;
+  int16_t x, y, z;
+} CLOCKBENCH_SAMPLE_T;
+
+typedef struct _clockbench_result {
+  SAMPLE_CLOCK_STATS_T stats;
+  unsigned long slots;          // the notifications up to the last sample
+  unsigned long merged;         // taken by the wake up of a later one
+  unsigned long late;           // samples more than half a period after their notification
+  unsigned long dropped;
+  unsigned long periods;        // passed to the loop
+  unsigned long owed;           // of the last samples, dropped
+  unsigned long ticks;          // windows of the detector
+  double seconds;
+  double cost;                  // of a tick() in s
+} CLOCKBENCH_RESULT_T;
+
+static int _minutes = 60;
+static unsigned _seed = 1;
+
+static bool ClockBenchChance(double p)
+{
+  return std::bernoulli_distribution(p)(_bench_rng);
+}
+
+/*
+   the latency of the sampling task after a notification -- the scheduler and the I2C transaction
+*/
+static double ClockBenchLatency(void)
+{
+  return std::max(20.0, 120 + 30.0 * BenchNoise(1));
+}
+
+/*
+   the work of the loop per sample, the Serial output and now and then an update of the advertisement
+*/
+static double ClockBenchWork(void)
+{
+  return std::max(200.0, 1500 + 300.0 * BenchNoise(1)) + ((ClockBenchChance(0.02)) ? 30000 : 0);
+}
+
+/*
+   the sampling of a load through the clock, the queue and the loop
+*/
+static void ClockBenchRun(const CLOCKBENCH_LOAD_T &load, CLOCKBENCH_RESULT_T *result)
+{
+  static ActivityDetector<ClockConfig> detector;
+  SampleClock clock;
+  std::deque<CLOCKBENCH_SAMPLE_T> queue;
+  unsigned long slots = (unsigned long) _minutes * 60 * 1000000 / CLOCKBENCH_PERIOD;
+  double blockedUntil = 0, freeAt = 0, cost = 0;
+
+  *result = CLOCKBENCH_RESULT_T();
+  detector.clear();
+  clock.begin(CLOCKBENCH_PERIOD, 1000000 - CLOCKBENCH_PERIOD);
+
+  /*
+     the loop takes the samples it got to by then
+  */
+  auto consume = [&](double until) {
+    while (!queue.empty() && std::max((double) queue.front().us, freeAt) <= until) {
+      const CLOCKBENCH_SAMPLE_T &sample = queue.front();
+
+      freeAt = std::max((double) sample.us, freeAt) + ClockBenchWork() +
+               ((ClockBenchChance(load.stalled)) ? BenchUniform(0, load.stallMax) : 0);
+      for (unsigned n = 0; n < sample.periods; n++)
+        if (detector.updateRaw(sample.x, sample.y, sample.z) & ACTIVITY_TICK)
+          result->ticks++;
+      result->periods += sample.periods;
+      queue.pop_front();
+    }
+  };
+
+  for (unsigned long slot = 0; slot < slots; ) {
+    double notified = 1000000.0 + slot * (double) CLOCKBENCH_PERIOD + std::max(0.0, 40 + 15.0 * BenchNoise(1));
+
+    if (ClockBenchChance(load.blocked))
+      blockedUntil = notified + BenchUniform(0, load.blockMax);
+
+    /*
+       the task wakes up once for all the notifications until then
+    */
+    double awake = std::max(notified, blockedUntil);
+    unsigned long last = slot;
+
+    while (1000000.0 + (last + 1) * (double) CLOCKBENCH_PERIOD <= awake)
+      last++;
+    result->merged += last - slot;
+    result->slots = last + 1;
+
+    double taken = awake + ClockBenchLatency();
+    CLOCKBENCH_SAMPLE_T sample = { (uint64_t) taken, 0, (int16_t) BenchNoise(20), (int16_t) BenchNoise(20),
+                                   (int16_t) (2048 + BenchNoise(20)) };
+
+    if (taken - (1000000.0 + last * (double) CLOCKBENCH_PERIOD) > CLOCKBENCH_PERIOD / 2)
+      result->late++;
+
+    double t = BenchTime();
+
+    sample.periods = clock.tick(sample.us);
+    cost += BenchTime() - t;
+
+    consume(taken);
+    if (queue.size() < CLOCKBENCH_QUEUE) {
+      queue.push_back(sample);
+      result->owed = 0;
+    }
+    else {
+      clock.drop(sample.periods);
+      result->dropped++;
+      result->owed = sample.periods;   // with the ones dropped before
+    }
+    slot = last + 1;
+  }
+  consume(1e300);
+  clock.stats(&result->stats);
+  result->seconds = result->slots * (double) CLOCKBENCH_PERIOD / 1000000;
+  result->cost = cost / std::max(1UL, result->stats.samples);
+}
+
+/*
+   the loop with delay(50) -- a window is 20 turns of the loop, each the
+   work and the stalls plus 50 ms
+*/
+static double ClockBenchDelay(const CLOCKBENCH_LOAD_T &load)
+{
+  unsigned long turns = (unsigned long) _minutes * 60 * 1000000 / CLOCKBENCH_PERIOD;
+  double time = 0;
+
+  for (unsigned long turn = 0; turn < turns; turn++) {
+    time += CLOCKBENCH_PERIOD + ClockBenchLatency() + ClockBenchWork() +
+            ((ClockBenchChance(load.stalled)) ? BenchUniform(0, load.stallMax) : 0);
+    if (ClockBenchChance(load.blocked))
+      time += BenchUniform(0, load.blockMax);
+  }
+  return time / 1000000 / (turns / ClockConfig::kWindow);
+}
+
+static bool ClockBenchLoads(void)
+{
+  static const CLOCKBENCH_LOAD_T loads[] = {
+    { "idle", 0, 0, 0, 0 },
+    { "busy", 0.01, 200000, 0.005, 400000 },
+    { "stalled", 0.02, 400000, 0.002, 3000000 },
+  };
+  double cost = 0;
+  bool ok = true;
+
+  printf("%-8s %8s %8s %8s %8s %10s %10s %10s\n", "load", "samples", "missed", "dropped", "jitter", "max.",
+         "window", "delay(50)");
+  for (const CLOCKBENCH_LOAD_T &load : loads) {
+    CLOCKBENCH_RESULT_T result;
+
+    ClockBenchRun(load, &result);
+
+    double window = result.seconds / std::max(1UL, result.ticks);
+    double delayed = ClockBenchDelay(load);
+
+    printf("%-8s %8lu %8lu %8lu %5.0f us %5u us %8.3f s %8.3f s\n", load.name, result.stats.samples,
+           result.stats.missed, result.stats.dropped,
+           (double) result.stats.jitterSum / std::max(1UL, result.stats.samples), result.stats.jitterMax,
+           window, delayed);
+
+    /*
+       the clock against the truth of the simulation -- a sample more than
+       half a period late is counted in the slot after its notification
+    */
+    bool counted = result.stats.dropped == result.dropped &&
+                   (unsigned long) labs((long) result.stats.missed - (long) result.merged) <= result.late &&
+                   (unsigned long) labs((long) (result.periods + result.owed) - (long) result.slots) <= 1;
+    bool windows = fabs(result.ticks - result.seconds) <= 1 + ClockConfig::kWindow * result.late;
+    bool quiet = load.blocked || (!result.stats.missed && !result.stats.dropped && result.stats.jitterMax < 1000);
+
+    if (!counted || !windows || !quiet) {
+      printf("CLOCK: %s, %lu missed of %lu merged (%lu late), %lu dropped of %lu, %lu periods (%lu owed) of %lu slots, "
+             "%lu windows in %.0f s FAILED\n", load.name, result.stats.missed, result.merged, result.late,
+             result.stats.dropped, result.dropped, result.periods, result.owed, result.slots, result.ticks, result.seconds);
+      ok = false;
+    }
+    cost = std::max(cost, result.cost);
+  }
+  printf("\nCLOCK: %.1f ns per sample\n", cost * 1e9);
+  printf("CLOCK: the samples are counted, the windows are a second %s\n", (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   a sample in a slot that has one stands for no period, a schedule shifted
+   by a late sample comes back
+*/
+static bool ClockBenchSlots(void)
+{
+  SampleClock clock;
+  SAMPLE_CLOCK_STATS_T stats;
+  unsigned periods[6];
+  static const uint64_t times[6] = { 51000, 101000, 231000, 251100, 301000, 351000 };
+  static const unsigned expected[6] = { 1, 1, 3, 0, 1, 1 };
+  bool ok = true;
+
+  clock.begin(CLOCKBENCH_PERIOD, 0);
+  for (int n = 0; n < 6; n++) {
+    periods[n] = clock.tick(times[n]);
+    ok = ok && periods[n] == expected[n];
+  }
+  clock.drop(clock.tick(401000));
+  ok = ok && clock.tick(501000) == 3;
+  clock.stats(&stats);
+  ok = ok && stats.samples == 8 && stats.missed == 2 + 1 && stats.dropped == 1 && stats.jitterMax == 19000;
+  printf("CLOCK: periods %u %u %u %u %u %u, %lu missed, %lu dropped, max. jitter %u us %s\n", periods[0],
+         periods[1], periods[2], periods[3], periods[4], periods[5], stats.missed, stats.dropped, stats.jitterMax,
+         (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "m:s:")) != -1) {
+    switch (opt) {
+      case 'm': _minutes = std::max(1, atoi(optarg)); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-m <minutes>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool failed = !ClockBenchSlots();
+
+  failed = !ClockBenchLoads() || failed;
+  printf("CLOCK: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
@@ -0,0 +1,274 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the cycle tracker
+
+  Loads of a machine with three programmes are run at 20 Hz through the
+  detector (of machineESP) and the tracker. A programme is a sequence of
+  phases, each with its length and its vibration; per load every phase
+  is stretched by up to 10 % and its vibration scaled by up to 10 %, and
+  some have a pause of the drum within.
+
+  The estimate of the minutes remaining is scored against the truth once
+  a minute while the machine runs, after the first kWarmup loads, and
+  against the naive one -- the mean length of the cycles before, less the
+  minutes elapsed.
+
+  checks
+    - the saved templates restore the same ones, another version
+      isn't restored
+    - a template per programme is learned
+    - the mean error of the estimate is below 5 minutes and below the
+      one of the naive estimate, and there is an estimate for 80 % of the
+      minutes
+    - the tracker is within its budget: 4 KB of memory, 1 us per window
+      and 1 ms per minute and per cycle learned on the host
+
+  measures
+    - the mean error and the coverage per programme
+    - the memory and the cost per window, per minute and per cycle
+
+  usage: cycle-bench [-n <loads>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+/*
+   a phase of a programme -- its minutes and the vibration in g, 0 is a pause
+*/
+typedef struct _cyclebench_phase {
+  float minutes;
+  float level;
+} CYCLEBENCH_PHASE_T;
+
+typedef struct _cyclebench_programme {
+  const char *name;
+  std::vector<CYCLEBENCH_PHASE_T> phases;
+} CYCLEBENCH_PROGRAMME_T;
+
+static const CYCLEBENCH_PROGRAMME_T _programmes[] = {
+  { "cotton", { { 8, 0.3 }, { 20, 0.5 }, { 2, 0 }, { 6, 0.3 }, { 10, 0.45 }, { 8, 0.8 } } },
+  { "quick", { { 4, 0.3 }, { 10, 0.5 }, { 5, 0.8 } } },
+  { "heavy", { { 12, 0.25 }, { 35, 0.45 }, { 3, 0 }, { 12, 0.6 }, { 15, 0.35 }, { 12, 0.8 } } },
+};
+
+#define CYCLEBENCH_PROGRAMMES   (sizeof(_programmes) / sizeof(_programmes[0]))
+
+typedef struct _cyclebench_score {
+  double error;                 // summed up absolute error in minutes
+  double naive;
+  unsigned long estimates;      // minutes with an estimate
+  unsigned long minutes;        // minutes running
+} CYCLEBENCH_SCORE_T;
+
+static int _loads = 60;
+static int _warmup = 15;
+static unsigned _seed = 1;
+
+/*
+   the loads through the detector and the tracker
+*/
+static bool CycleBenchLoads(void)
+{
+  static ActivityDetector<> detector;
+  static CycleTracker<> tracker;
+  CYCLEBENCH_SCORE_T scores[CYCLEBENCH_PROGRAMMES] = {};
+  std::vector<double> lengths;
+  unsigned long samples = 0, windows = 0, minutes = 0, learned = 0;
+  double windowCost = 0, minuteCost = 0, learnCost = 0, minuteMax = 0, learnMax = 0;
+  double end = 0;
+  int load = 0, programme = 0;
+  bool running = false;
+
+  detector.clear();
+  tracker.clear();
+
+  float tilt = BenchNoise(0.05);
+  auto sample = [&](float x, float y, float z) {
+    x += tilt + BenchNoise(0.003);
+    y += BenchNoise(0.003);
+    z += 1.0 + BenchNoise(0.003);
+
+    double time = samples++ / 20.0;
+
+    if (!(detector.update(sqrtf(x * x + y * y + z * z)) & ACTIVITY_TICK))
+      return;
+
+    double t = BenchTime();
+    unsigned events = tracker.update(detector);
+
+    t = BenchTime() - t;
+    if (events & CYCLE_LEARNED) {
+      learnCost += t;
+      learnMax = std::max(learnMax, t);
+      learned++;
+    }
+    else if (events & CYCLE_MINUTE) {
+      minuteCost += t;
+      minuteMax = std::max(minuteMax, t);
+      minutes++;
+    }
+    else {
+      windowCost += t;
+      windows++;
+    }
+
+    /*
+       the estimate against the truth once a minute while running
+    */
+    if (!(events & CYCLE_MINUTE) || !running || !detector.running() || load < _warmup)
+      return;
+
+    CYCLEBENCH_SCORE_T &score = scores[programme];
+    double truth = (end - time) / 60;
+    double mean = 0;
+
+    for (double length : lengths)
+      mean += length;
+    mean /= lengths.size();
+    score.minutes++;
+    score.naive += fabs(std::max(0.0, mean - tracker.elapsed()) - truth);
+    if (tracker.remaining() != CYCLE_UNKNOWN) {
+      score.error += fabs(tracker.remaining() - truth);
+      score.estimates++;
+    }
+  };
+  auto idle = [&](long n) {
+    while (n-- > 0)
+      sample(0, 0, 0);
+  };
+  auto run = [&](long n, float vibration) {
+    float level = vibration;
+
+    for (long i = 0; i < n; i++) {
+      if (i % 20 == 0)
+        level = std::max(0.8f * vibration, std::min(1.2f * vibration, level + BenchNoise(0.02)));
+      sample(BenchNoise(level / 2), BenchNoise(level / 2), BenchNoise(level));
+    }
+  };
+
+  for (load = 0; load < _loads; load++) {
+    const CYCLEBENCH_PROGRAMME_T &current = _programmes[programme = BenchRandom(0, CYCLEBENCH_PROGRAMMES - 1)];
+    std::vector<long> durations;
+    double length = 0;
+
+    /*
+       the phases are stretched first, the length of the load is the truth
+    */
+    idle(BenchRandom(10, 60) * 60L * 20);
+    for (const CYCLEBENCH_PHASE_T &phase : current.phases) {
+      durations.push_back(lround(phase.minutes * 60 * 20 * BenchUniform(0.9, 1.1)));
+      length += durations.back() / 20.0;
+    }
+    end = samples / 20.0 + length;
+    running = true;
+    for (size_t p = 0; p < current.phases.size(); p++) {
+      if (current.phases[p].level > 0)
+        run(durations[p], current.phases[p].level * BenchUniform(0.9, 1.1));
+      else
+        idle(durations[p]);
+    }
+    running = false;
+    lengths.push_back(length / 60);
+  }
+  idle(30 * 60L * 20);
+
+  /*
+     the saved templates restore the same ones
+  */
+  static CycleTracker<> copy;
+  static CYCLE_TEMPLATES_T saved;
+
+  tracker.save(&saved);
+  copy.clear();
+  bool restored = copy.restore(&saved);
+
+  saved.version++;
+  restored = restored && !copy.restore(&saved) && copy.templates() == tracker.templates();
+
+  static CYCLE_TEMPLATES_T again;
+
+  saved.version--;
+  copy.save(&again);
+  restored = restored && !memcmp(&saved, &again, sizeof(saved));
+  printf("CYCLE: %u templates saved in %zu bytes, restored %s\n", copy.templates(), sizeof(CYCLE_TEMPLATES_T),
+         (restored) ? "ok" : "FAILED");
+
+  bool ok = restored;
+  bool all = tracker.templates() >= CYCLEBENCH_PROGRAMMES;
+
+  printf("CYCLE: %d loads, %u templates learned for %zu programmes %s\n", _loads, tracker.templates(),
+         CYCLEBENCH_PROGRAMMES, (all) ? "ok" : "FAILED");
+  ok = ok && all;
+
+  CYCLEBENCH_SCORE_T total = {};
+
+  printf("\n%-10s %10s %10s %10s\n", "programme", "error", "naive", "estimated");
+  for (size_t p = 0; p < CYCLEBENCH_PROGRAMMES; p++) {
+    const CYCLEBENCH_SCORE_T &score = scores[p];
+
+    printf("%-10s %6.1f min %6.1f min %8.1f %%\n", _programmes[p].name,
+           (score.estimates) ? score.error / score.estimates : 0, (score.minutes) ? score.naive / score.minutes : 0,
+           (score.minutes) ? 100.0 * score.estimates / score.minutes : 0);
+    total.error += score.error;
+    total.naive += score.naive;
+    total.estimates += score.estimates;
+    total.minutes += score.minutes;
+  }
+
+  double error = (total.estimates) ? total.error / total.estimates : 1e9;
+  double naive = (total.minutes) ? total.naive / total.minutes : 0;
+  double coverage = (total.minutes) ? (double) total.estimates / total.minutes : 0;
+  bool better = error < 5 && error < naive && coverage >= 0.8;
+
+  printf("CYCLE: the estimate is off by %.1f min, the naive one by %.1f min, estimated %.1f %% of the minutes %s\n",
+         error, naive, coverage * 100, (better) ? "ok" : "FAILED");
+  ok = ok && better;
+
+  double perWindow = windowCost * 1e6 / std::max(1UL, windows), perMinute = minuteCost * 1e6 / std::max(1UL, minutes);
+  double perCycle = learnCost * 1e6 / std::max(1UL, learned);
+  bool budget = sizeof(tracker) <= 4096 && perWindow < 1 && minuteMax < 1e-3 && learnMax < 1e-3;
+
+  printf("\nCYCLE: %zu bytes, %.3f us per window, %.1f us per minute (max. %.1f), %.1f us per cycle learned "
+         "(max. %.1f) %s\n", sizeof(tracker), perWindow, perMinute, minuteMax * 1e6, perCycle, learnMax * 1e6,
+         (budget) ? "ok" : "FAILED");
+  return ok && budget;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+    switch (opt) {
+      case 'n': _loads = std::max(_warmup + 1, atoi(optarg)); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-n <loads>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool failed = !CycleBenchLoads();
+
+  printf("CYCLE: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
@@ -0,0 +1,334 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the detector
+
+  The detector runs natively on Linux over synthetic traces of laundry
+  cycles -- idle, running, the door opened and closed after a while or
+  just for a look -- in the configurations of the sketches.
+
+  checks
+    - the sum of a rolling window equals the sum of its last N values,
+      also with negative values
+    - the values read back with ago() are the values pushed
+    - the detector decides the same as the hand-rolled windows of the
+      sketches (% indices) on the same fixed point magnitudes, sample by
+      sample
+
+  measures
+    - cost of a sample of the detector and of the hand-rolled float windows
+    - drift of the float windows against the exact sum
+
+  usage: detector-bench [-c <cycles>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+static int _cycles = 20;
+static volatile bool _sink;
+static unsigned _seed = 1;
+
+/*
+   the rolling window against the sum of its last N values
+*/
+template <unsigned N>
+static bool DetectorBenchWindow(void)
+{
+  static RollingWindow<int32_t, N, int64_t> window;
+  std::vector<int32_t> values;
+  unsigned long failed = 0;
+
+  window.clear();
+  for (int n = 0; n < 100000; n++) {
+    int32_t value = std::uniform_int_distribution<int32_t>(INT32_MIN, INT32_MAX)(_bench_rng);
+    int64_t sum = 0;
+
+    values.push_back(value);
+    window.push(value);
+    for (size_t m = (values.size() > N) ? values.size() - N : 0; m < values.size(); m++)
+      sum += values[m];
+    if (window.sum() != sum)
+      failed++;
+    for (unsigned m = 0; m < window.kSize && m < values.size(); m++)
+      if (window.ago(m) != values[values.size() - 1 - m])
+        failed++;
+  }
+  return !failed;
+}
+
+/*
+   a synthetic trace of laundry cycles -- the magnitude in g every 50 ms
+*/
+static void DetectorBenchTrace(std::vector<float> &trace, int cycles)
+{
+  auto idle = [&](int samples) {
+    for (int n = 0; n < samples; n++)
+      trace.push_back(std::fabs(1.0 + BenchNoise(0.004)));
+  };
+  auto run = [&](int samples, float level) {
+    for (int n = 0; n < samples; n++)
+      trace.push_back(std::fabs(1.0 + BenchNoise(level)));
+  };
+  auto slam = [&](float level) {
+    for (int n = 0; n < 3; n++)
+      trace.push_back(1.0 + ((n & 1) ? -level : level));
+  };
+
+  idle(BenchRandom(200, 2000));
+  for (int cycle = 0; cycle < cycles; cycle++) {
+    run(BenchRandom(20 * 60 * 20, 60 * 60 * 20), 0.2 + BenchRandom(0, 8) / 20.0);
+    idle(BenchRandom(100, 6000));
+    switch (BenchRandom(0, 3)) {
+      case 0:   // clothes removed
+        slam(0.3);
+        idle(BenchRandom(100, 1500));
+        slam(0.6);
+        break;
+      case 1:   // a look
+        slam(0.3);
+        idle(BenchRandom(45, 75));
+        slam(0.6);
+        idle(BenchRandom(100, 300));
+        slam(0.3);
+        idle(BenchRandom(100, 1500));
+        slam(0.6);
+        break;
+      case 2:   // the door left open
+        slam(0.3);
+        idle(3000);
+        break;
+      default:  // a bump while loaded
+        slam(0.5);
+        idle(BenchRandom(100, 300));
+        slam(0.3);
+        idle(BenchRandom(100, 1500));
+        slam(0.6);
+        break;
+    }
+    idle(BenchRandom(200, 12000));
+  }
+}
+
+/*
+   the hand-rolled windows of the sketches, on the values of type T
+*/
+template <class Config, typename T>
+class DetectorBenchReference {
+  public:
+    DetectorBenchReference(T running, T opening, T closing) :
+      _runningSum(running), _opening(opening), _closing(closing)
+    {
+    }
+
+    void update(T magnitude)
+    {
+      T delta = (magnitude > _previous) ? magnitude - _previous : _previous - magnitude;
+
+      _previous = magnitude;
+      _activity -= _deltas[_idx];
+      _deltas[_idx] = delta;
+      _activity += delta;
+      _idx = (_idx + 1) % Config::kWindow;
+
+      _small -= _deltasSmall[_idxSmall];
+      _deltasSmall[_idxSmall] = delta;
+      _small += delta;
+      _idxSmall = (_idxSmall + 1) % Config::kSmall;
+
+      _history[_idxHistory] = _small;
+      _idxHistory = (_idxHistory + 1) % (Config::kLag + 1);
+
+      if (_idx == 0) {
+        _sum -= _activities[_idxAverage];
+        _activities[_idxAverage] = _activity;
+        _sum += _activities[_idxAverage];
+        _idxAverage = (_idxAverage + 1) % Config::kAverage;
+
+        if (_sum > _runningSum) {
+          running = true;
+          empty = false;
+          _opened = false;
+          _closed = false;
+        }
+        else
+          running = false;
+      }
+
+      T ago = _history[_idxHistory];
+
+      if (Config::kDoorClosing == 0)
+        return;
+      if (Config::kDoorOpening == 0) {
+        if (!running && !empty && _small > ago + _closing)
+          empty = true;
+        return;
+      }
+      if (!running && !empty && !_opened && _cooldown == 0) {
+        if (_small > ago + _opening)
+          _opened = true;
+        _quiet = 0;
+      }
+      if (!running && !empty && _opened && !_closed) {
+        if (_small > ago + _closing && _quiet > (int) Config::kQuietMin)
+          _closed = true;
+        _quiet++;
+        if (_quiet > (int) Config::kQuietOpen)
+          empty = true;
+      }
+      if (_opened && _closed) {
+        if (_quiet > (int) Config::kQuietEmpty)
+          empty = true;
+        else {
+          _opened = _closed = false;
+          _cooldown = Config::kCooldown;
+        }
+      }
+      if (_cooldown > 0)
+        _cooldown--;
+    }
+
+    /*
+       the difference of the running sum of the activity to the sum of its deltas
+    */
+    double drift(void) const
+    {
+      T sum = 0;
+
+      for (unsigned n = 0; n < Config::kWindow; n++)
+        sum += _deltas[n];
+      return std::fabs((double) _activity - (double) sum);
+    }
+
+    bool running = false;
+    bool empty = true;
+
+  private:
+    T _runningSum, _opening, _closing;
+    T _previous = 0, _activity = 0, _small = 0, _sum = 0;
+    T _deltas[Config::kWindow] = {}, _deltasSmall[Config::kSmall] = {};
+    T _activities[Config::kAverage] = {}, _history[Config::kLag + 1] = {};
+    int _idx = 0, _idxSmall = 0, _idxAverage = 0, _idxHistory = 0;
+    int _quiet = 0, _cooldown = 0;
+    bool _opened = false, _closed = false;
+};
+
+/*
+   run a configuration over the trace
+*/
+template <class Config>
+static bool DetectorBenchConfig(const char *name, const std::vector<float> &trace)
+{
+  static ActivityDetector<Config> detector;
+  DetectorBenchReference<Config, uint32_t> exact(ActivityDetector<Config>::kRunningSum,
+      ActivityDetector<Config>::kDoorOpening, ActivityDetector<Config>::kDoorClosing);
+  DetectorBenchReference<Config, float> inexact(Config::kRunning * Config::kAverage,
+      Config::kDoorOpening, Config::kDoorClosing);
+  std::vector<uint32_t> units;
+  unsigned long mismatches = 0, disagreements = 0, transitions = 0;
+  double drift = 0;
+
+  for (float magnitude : trace)
+    units.push_back(ActivityUnits(magnitude));
+
+  detector.clear();
+  for (size_t n = 0; n < units.size(); n++) {
+    bool running = detector.running(), empty = detector.empty();
+
+    detector.updateUnits(units[n]);
+    exact.update(units[n]);
+    inexact.update(trace[n]);
+    if (detector.running() != exact.running || detector.empty() != exact.empty) {
+      if (!mismatches)
+        printf("DETECTOR: %s: sample %zu: running %d/%d empty %d/%d\n", name, n,
+               detector.running(), exact.running, detector.empty(), exact.empty);
+      mismatches++;
+    }
+    if (detector.running() != inexact.running || detector.empty() != inexact.empty)
+      disagreements++;
+    if (detector.running() != running || detector.empty() != empty)
+      transitions++;
+    drift = std::max(drift, inexact.drift());
+  }
+
+  /*
+     the cost of a sample
+  */
+  double t = BenchTime();
+
+  detector.clear();
+  for (uint32_t magnitude : units)
+    detector.updateUnits(magnitude);
+  _sink = detector.running() ^ detector.empty();
+
+  double fixed = BenchTime() - t;
+  DetectorBenchReference<Config, float> reference(Config::kRunning * Config::kAverage,
+      Config::kDoorOpening, Config::kDoorClosing);
+
+  t = BenchTime();
+  for (float magnitude : trace)
+    reference.update(magnitude);
+  _sink = reference.running ^ reference.empty;
+
+  double floating = BenchTime() - t;
+
+  printf("%-12s %8lu transitions %10.2f ns/sample %10.2f ns/sample (float) %8.2f%% float agrees, drift %.2e g %s\n",
+         name, transitions, fixed * 1e9 / units.size(), floating * 1e9 / trace.size(),
+         100.0 - disagreements * 100.0 / trace.size(), drift,
+         (mismatches) ? "FAILED" : "ok");
+  return !mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "c:s:")) != -1) {
+    switch (opt) {
+      case 'c': _cycles = std::max(1, atoi(optarg)); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-c <cycles>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool windows = DetectorBenchWindow<1>() && DetectorBenchWindow<3>() && DetectorBenchWindow<4>() &&
+                 DetectorBenchWindow<6>() && DetectorBenchWindow<15>() && DetectorBenchWindow<20>() &&
+                 DetectorBenchWindow<32>();
+
+  printf("DETECTOR: rolling windows %s\n", (windows) ? "ok" : "FAILED");
+
+  std::vector<float> trace;
+
+  DetectorBenchTrace(trace, _cycles);
+  printf("DETECTOR: %d cycles, %zu samples (%.1f hours)\n", _cycles, trace.size(), trace.size() / 20.0 / 3600);
+
+  bool failed = !windows;
+
+  failed |= !DetectorBenchConfig<MachineEspConfig>("machineESP", trace);
+  failed |= !DetectorBenchConfig<AccelerometerConfig>("1MPU", trace);
+  failed |= !DetectorBenchConfig<DryerConfig>("dryer", trace);
+  failed |= !DetectorBenchConfig<WakeConfig>("wake", trace);
+
+  printf("DETECTOR: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
@@ -0,0 +1,310 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the burst acquisition through the FIFO
+
+  The MPU is simulated: its FIFO is filled at MPU_FIFO_RATE with frames
+  of synthetic laundry cycles, overwrites its oldest bytes when it is
+  full, and is read through the register functions of MpuFifo.
+
+  checks
+    - every frame is passed once, in order, drained every 250 ms
+    - a FIFO which was drained too late is reset, the frames after it are
+      aligned again, the frames lost are the ones since the last drain
+    - an error of the bus is counted and doesn't lose the alignment
+    - the door latches -- 15 ms each -- are detected at 200 Hz, which are
+      missed between the samples every 50 ms
+
+  measures
+    - drains (CPU wakeups) and I2C transactions per second
+    - cost of a drain and of a sample through the detector
+    - running and door detection of 200 Hz against 20 Hz
+
+  usage: fifo-bench [-d <doors>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <cmath>
+#include <deque>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+/*
+   the sensitivity at +-16g
+*/
+#define FIFOBENCH_LSB           2048
+
+/*
+   the FIFO is drained every ... ms
+*/
+#define FIFOBENCH_DRAIN         250
+
+/*
+   the samples of the FIFO per sample of 50 ms
+*/
+#define FIFOBENCH_DECIMATE      (MPU_FIFO_RATE / 20)
+
+typedef SensorConfig<MachineEspConfig, FIFOBENCH_DECIMATE> FifoConfig;
+
+typedef struct _fifobench_frame {
+  int16_t x, y, z;
+} FIFOBENCH_FRAME_T;
+
+static int _doors = 200;
+static unsigned _seed = 1;
+static std::deque<uint8_t> _fifo;
+static bool _fifoEnabled = false;
+static bool _busError = false;
+static volatile uint32_t _sink;
+
+/*
+   the registers of the simulated MPU
+*/
+static bool FifoBenchRead(uint8_t reg, uint8_t *data, size_t length)
+{
+  if (_busError) {
+    _busError = false;
+    return false;
+  }
+  if (reg == MPU_REG_FIFO_COUNTH && length == 2) {
+    data[0] = _fifo.size() >> 8;
+    data[1] = _fifo.size() & 0xff;
+    return true;
+  }
+  if (reg == MPU_REG_FIFO_R_W && length <= MPU_FIFO_BURST) {
+    for (size_t n = 0; n < length; n++) {
+      data[n] = (_fifo.empty()) ? 0 : _fifo.front();
+      if (!_fifo.empty())
+        _fifo.pop_front();
+    }
+    return true;
+  }
+  return false;
+}
+
+static bool FifoBenchWrite(uint8_t reg, uint8_t value)
+{
+  if (reg == MPU_REG_USER_CTRL) {
+    if (value & MPU_USER_CTRL_FIFO_RST)
+      _fifo.clear();
+    _fifoEnabled = value & MPU_USER_CTRL_FIFO_EN;
+  }
+  return true;
+}
+
+/*
+   the MPU samples a frame
+*/
+static void FifoBenchSample(const FIFOBENCH_FRAME_T &frame)
+{
+  if (!_fifoEnabled)
+    return;
+  for (int16_t value : { frame.x, frame.y, frame.z }) {
+    _fifo.push_back(value >> 8);
+    _fifo.push_back(value & 0xff);
+  }
+  while (_fifo.size() > MPU_FIFO_SIZE)
+    _fifo.pop_front();
+}
+
+static FIFOBENCH_FRAME_T FifoBenchFrame(float x, float y, float z)
+{
+  auto raw = [](float g) {
+    return (int16_t) std::max(-32768.0f, std::min(32767.0f, std::round(g * FIFOBENCH_LSB)));
+  };
+
+  return { raw(x), raw(y), raw(z) };
+}
+
+static float FifoBenchMagnitude(int16_t x, int16_t y, int16_t z)
+{
+  return std::sqrt((float) x * x + (float) y * y + (float) z * z) / FIFOBENCH_LSB;
+}
+
+/*
+   the frames are numbered, so a lost or a misaligned frame is seen
+*/
+static bool FifoBenchOrder(void)
+{
+  static MpuFifo fifo;
+  MPU_FIFO_STATS_T stats;
+  int32_t next = 0, expected = 0;
+  unsigned long failed = 0;
+  uint64_t us = 1;
+  unsigned lost;
+  auto check = [&](int16_t x, int16_t y, int16_t z) {
+    if (x != (int16_t) expected || y != (int16_t) ~expected || z != 0x1234)
+      failed++;
+    expected++;
+  };
+  auto fill = [&](int frames) {
+    for (int n = 0; n < frames; n++, next++)
+      FifoBenchSample({ (int16_t) next, (int16_t) ~next, 0x1234 });
+    us += (uint64_t) frames * 1000000 / MPU_FIFO_RATE;
+  };
+
+  _fifo.clear();
+  fifo.begin(FifoBenchRead, FifoBenchWrite);
+
+  /*
+     drained in time, also with the bursts split
+  */
+  for (int n = 0; n < 1000; n++) {
+    fill(BenchRandom(0, MPU_FIFO_RATE * FIFOBENCH_DRAIN / 1000 * 3));
+    fifo.drain(check, us);
+  }
+
+  /*
+     an error of the bus
+  */
+  fill(17);
+  _busError = true;
+  fifo.drain(check, us);
+  fifo.drain(check, us);
+
+  /*
+     too late -- the frames in the FIFO are lost
+  */
+  fill(MPU_FIFO_SIZE / MPU_FIFO_FRAME + 7);
+  fifo.drain(check, us);
+  lost = fifo.lost();
+  fill(33);
+  expected = next - 33;
+  fifo.drain(check, us);
+  fifo.stats(&stats);
+
+  bool ok = !failed && expected == next && stats.overflows == 1 && stats.errors == 1 &&
+            lost == MPU_FIFO_SIZE / MPU_FIFO_FRAME + 7 && stats.lost == lost && !fifo.lost();
+
+  printf("FIFO: order and alignment of %lu frames in %lu bursts, %lu overflows (%lu frames lost), %lu errors %s\n",
+         stats.frames, stats.bursts, stats.overflows, stats.lost, stats.errors, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   a loaded machine stops, the door is opened and closed after a while -- the latches are 3 frames
+*/
+static void FifoBenchDoor(std::vector<FIFOBENCH_FRAME_T> &frames)
+{
+  auto idle = [&](int samples) {
+    for (int n = 0; n < samples; n++)
+      frames.push_back(FifoBenchFrame(BenchNoise(0.003), BenchNoise(0.003), 1.0 + BenchNoise(0.003)));
+  };
+  auto run = [&](int samples) {
+    for (int n = 0; n < samples; n++)
+      frames.push_back(FifoBenchFrame(BenchNoise(0.2), BenchNoise(0.2), 1.0 + BenchNoise(0.4)));
+  };
+  auto latch = [&](float level) {
+    for (int n = 0; n < 3; n++)
+      frames.push_back(FifoBenchFrame(0, 0, 1.0 + ((n == 1) ? -level : level)));
+  };
+
+  run(MPU_FIFO_RATE * 60);
+  idle(MPU_FIFO_RATE * BenchRandom(20, 30) + BenchRandom(0, FIFOBENCH_DECIMATE - 1));
+  latch(0.6);
+  idle(MPU_FIFO_RATE * BenchRandom(6, 20) + BenchRandom(0, FIFOBENCH_DECIMATE - 1));
+  latch(1.2);
+  idle(MPU_FIFO_RATE * 10);
+}
+
+/*
+   the cycles through the FIFO at 200 Hz and every 50 ms
+*/
+static bool FifoBenchDetect(void)
+{
+  static MpuFifo fifo;
+  static ActivityDetector<FifoConfig> fast;
+  static ActivityDetector<> slow;
+  unsigned long emptiedFast = 0, emptiedSlow = 0, startedFast = 0, startedSlow = 0;
+  unsigned long samples = 0, drains = 0;
+  double drain = 0;
+
+  _fifo.clear();
+  fifo.begin(FifoBenchRead, FifoBenchWrite);
+
+  for (int door = 0; door < _doors; door++) {
+    std::vector<FIFOBENCH_FRAME_T> frames;
+    int phase = BenchRandom(0, FIFOBENCH_DECIMATE - 1);
+
+    FifoBenchDoor(frames);
+    fast.clear();
+    slow.clear();
+
+    for (size_t n = 0; n < frames.size(); n++) {
+      const FIFOBENCH_FRAME_T &frame = frames[n];
+
+      FifoBenchSample(frame);
+      if (n % FIFOBENCH_DECIMATE == (size_t) phase) {
+        unsigned events = slow.update(FifoBenchMagnitude(frame.x, frame.y, frame.z));
+
+        emptiedSlow += !!(events & ACTIVITY_EMPTIED);
+        startedSlow += !!(events & ACTIVITY_STARTED);
+      }
+      if ((n + 1) % (MPU_FIFO_RATE * FIFOBENCH_DRAIN / 1000) == 0) {
+        double t = BenchTime();
+
+        samples += fifo.drain([&](int16_t x, int16_t y, int16_t z) {
+          unsigned events = fast.update(FifoBenchMagnitude(x, y, z));
+
+          emptiedFast += !!(events & ACTIVITY_EMPTIED);
+          startedFast += !!(events & ACTIVITY_STARTED);
+        });
+        drain += BenchTime() - t;
+        drains++;
+      }
+    }
+  }
+
+  MPU_FIFO_STATS_T stats;
+
+  fifo.stats(&stats);
+  printf("FIFO: %d doors, %lu samples at %d Hz\n", _doors, samples, MPU_FIFO_RATE);
+  printf("%-40s %12.1f /s (%d /s sampled every 50 ms)\n", "drains (wakeups)", 1000.0 / FIFOBENCH_DRAIN, 20);
+  printf("%-40s %12.1f /s\n", "I2C transactions", (stats.bursts + stats.drains) * 1000.0 / FIFOBENCH_DRAIN / drains);
+  printf("%-40s %12.1f us/drain %8.1f ns/sample\n", "drain and detector", drain * 1e6 / drains, drain * 1e9 / samples);
+  printf("%-40s %12lu of %d (%lu every 50 ms)\n", "started", startedFast, _doors, startedSlow);
+  printf("%-40s %12lu of %d (%lu every 50 ms)\n", "emptied", emptiedFast, _doors, emptiedSlow);
+
+  bool ok = stats.overflows == 0 && startedFast == (unsigned long) _doors &&
+            emptiedFast == (unsigned long) _doors && emptiedFast >= emptiedSlow;
+
+  printf("FIFO: detection %s\n", (ok) ? "ok" : "FAILED");
+  _sink = fast.running();
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "d:s:")) != -1) {
+    switch (opt) {
+      case 'd': _doors = std::max(1, atoi(optarg)); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-d <doors>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool failed = !FifoBenchOrder();
+
+  failed |= !FifoBenchDetect();
+
+  printf("FIFO: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
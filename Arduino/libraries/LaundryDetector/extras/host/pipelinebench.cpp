@@ -0,0 +1,368 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the integer pipeline from the raw values
+
+  The sketches passed the magnitude in g to the detector: the raw values
+  divided by the sensitivity and sqrt() in float. updateRaw() takes the
+  raw values of the MPU as they are, sums their squares in 32 bit and
+  takes the integer square root, refined by one step of Taylor to the
+  fixed point.
+
+  checks
+    - the integer square root is floor(sqrt(n)), for every n < 2^24 and
+      around every square up to 2^32
+    - the magnitude is within 1 unit (1/65536 g) of the exact one, over
+      the whole range of the raw values
+    - the detector decides the same on the raw values as on the float
+      magnitude of the sketches -- the events, running and empty, sample
+      by sample, in the configurations of the sketches
+
+  measures
+    - cost of the magnitude and of a sample through the detector, float
+      against integer, in ns and in cycles of the host (x86-64)
+
+  usage: pipeline-bench [-c <cycles>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+/*
+   the sensitivity at +-16g
+*/
+#define PIPELINEBENCH_LSB       2048
+
+/*
+   the samples of the FIFO per sample of 50 ms
+*/
+#define PIPELINEBENCH_DECIMATE  (MPU_FIFO_RATE / 20)
+
+/*
+   the configuration of machineESP sampled from the FIFO -- the others of the sketches at 20 Hz
+*/
+typedef SensorConfig<MachineEspConfig, PIPELINEBENCH_DECIMATE> FifoConfig;
+
+typedef struct _pipelinebench_frame {
+  int16_t x, y, z;
+} PIPELINEBENCH_FRAME_T;
+
+static int _cycles = 10;
+static unsigned _seed = 1;
+static volatile uint32_t _sink;
+
+/*
+   get the cycles of the host, 0 if there is no counter
+*/
+static uint64_t PipelineBenchCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static int16_t PipelineBenchRaw(float g)
+{
+  return (int16_t) std::max(-32768.0f, std::min(32767.0f, std::round(g * PIPELINEBENCH_LSB)));
+}
+
+/*
+   the magnitude of the sketches -- divided by the sensitivity, sqrt() in float
+*/
+static float PipelineBenchFloat(int16_t x, int16_t y, int16_t z)
+{
+  const float lsb = PIPELINEBENCH_LSB;
+  float a_x = x / lsb, a_y = y / lsb, a_z = z / lsb;
+
+  return std::sqrt(a_x * a_x + a_y * a_y + a_z * a_z);
+}
+
+/*
+   the exact magnitude in the fixed point
+*/
+static uint32_t PipelineBenchExact(int16_t x, int16_t y, int16_t z, uint32_t scale)
+{
+  double square = (double) x * x + (double) y * y + (double) z * z;
+
+  return (uint32_t) std::llround(scale * std::sqrt(square));
+}
+
+/*
+   a synthetic trace of laundry cycles -- the raw values of the MPU at rate Hz,
+   the machine tilts a bit, the drum spins up and down
+*/
+static void PipelineBenchTrace(std::vector<PIPELINEBENCH_FRAME_T> &trace, int cycles, int rate)
+{
+  float tilt = BenchNoise(0.05);
+  auto frame = [&](float x, float y, float z) {
+    trace.push_back({ PipelineBenchRaw(tilt + x), PipelineBenchRaw(y), PipelineBenchRaw(1.0 + z) });
+  };
+  auto idle = [&](int samples) {
+    for (int n = 0; n < samples * rate / 20; n++)
+      frame(BenchNoise(0.003), BenchNoise(0.003), BenchNoise(0.003));
+  };
+  auto run = [&](int samples) {
+    float level = 0.2;
+
+    for (int n = 0; n < samples * rate / 20; n++) {
+      if (n % rate == 0)
+        level = std::max(0.02f, std::min(0.8f, level + BenchNoise(0.03)));
+      frame(BenchNoise(level / 2), BenchNoise(level / 2), BenchNoise(level));
+    }
+  };
+  auto slam = [&](float level) {
+    for (int n = 0; n < 3; n++)
+      frame(0, 0, (n & 1) ? -level : level);
+  };
+
+  idle(BenchRandom(200, 2000));
+  for (int cycle = 0; cycle < cycles; cycle++) {
+    run(BenchRandom(20 * 60 * 20, 50 * 60 * 20));
+    idle(BenchRandom(100, 6000));
+    switch (BenchRandom(0, 2)) {
+      case 0:   // clothes removed
+        slam(0.3);
+        idle(BenchRandom(100, 1500));
+        slam(0.6);
+        break;
+      case 1:   // a look
+        slam(0.3);
+        idle(BenchRandom(45, 75));
+        slam(0.6);
+        idle(BenchRandom(100, 300));
+        slam(0.3);
+        idle(BenchRandom(100, 1500));
+        slam(0.6);
+        break;
+      default:  // a bump while loaded
+        slam(0.5);
+        idle(BenchRandom(100, 300));
+        slam(0.3);
+        idle(BenchRandom(100, 1500));
+        slam(0.6);
+        break;
+    }
+    idle(BenchRandom(200, 6000));
+  }
+}
+
+/*
+   the integer square root against the double one
+*/
+static bool PipelineBenchSqrt(void)
+{
+  unsigned long failed = 0, checked = 0;
+  auto check = [&](uint32_t n) {
+    uint64_t root = (uint64_t) std::sqrt((double) n);
+
+    while (root * root > n)
+      root--;
+    while ((root + 1) * (root + 1) <= n)
+      root++;
+    failed += ActivitySqrt(n) != root;
+    checked++;
+  };
+
+  for (uint32_t n = 0; n < (1UL << 24); n++)
+    check(n);
+  for (uint32_t root = 1; root <= 0xffff; root++) {
+    check(root * root - 1);
+    check(root * root);
+    check(root * root + 2 * root);
+  }
+  check(0xffffffff);
+
+  printf("PIPELINE: integer square root of %lu values %s\n", checked, (failed) ? "FAILED" : "ok");
+  return !failed;
+}
+
+/*
+   the magnitude against the exact one, also for the other ranges of the MPU
+*/
+static bool PipelineBenchMagnitude(void)
+{
+  static const int16_t extremes[] = { -32768, -32767, -2048, -1, 0, 1, 2048, 32767 };
+  unsigned long failed = 0, checked = 0, exact = 0;
+  long worst = 0, worstFloat = 0;
+  auto check = [&](int16_t x, int16_t y, int16_t z, uint32_t scale) {
+    long error = (long) ActivityMagnitude(x, y, z, scale) - (long) PipelineBenchExact(x, y, z, scale);
+
+    failed += std::labs(error) > 1;
+    exact += !error;
+    worst = std::max(worst, std::labs(error));
+    checked++;
+  };
+
+  for (int16_t x : extremes)
+    for (int16_t y : extremes)
+      for (int16_t z : extremes)
+        for (uint32_t scale : { 4, 8, 16, 32 })
+          check(x, y, z, scale);
+
+  std::uniform_int_distribution<int> full(-32768, 32767);
+
+  for (int n = 0; n < 10000000; n++) {
+    int16_t x = full(_bench_rng), y = full(_bench_rng), z = full(_bench_rng);
+
+    check(x, y, z, 32);
+    check(x >> 4, y >> 4, z >> 4, 32);
+  }
+
+  /*
+     the float magnitude of the sketches around 1 g
+  */
+  for (int n = 0; n < 10000000; n++) {
+    int16_t x = PipelineBenchRaw(BenchNoise(0.5));
+    int16_t y = PipelineBenchRaw(BenchNoise(0.5));
+    int16_t z = PipelineBenchRaw(1.0 + BenchNoise(0.5));
+    long error = (long) ActivityUnits(PipelineBenchFloat(x, y, z)) - (long) PipelineBenchExact(x, y, z, 32);
+
+    check(x, y, z, 32);
+    worstFloat = std::max(worstFloat, std::labs(error));
+  }
+
+  printf("PIPELINE: magnitude of %lu raw values, %.4f%% exact, max. error %ld units (%ld of the float) %s\n",
+         checked, exact * 100.0 / checked, worst, worstFloat, (failed) ? "FAILED" : "ok");
+  return !failed;
+}
+
+/*
+   the float pipeline of the sketches and the integer one side by side
+*/
+template <class Config>
+static bool PipelineBenchConfig(const char *name, const std::vector<PIPELINEBENCH_FRAME_T> &trace)
+{
+  static ActivityDetector<Config> floating, integer;
+  unsigned long mismatches = 0, transitions = 0;
+
+  floating.clear();
+  integer.clear();
+  for (size_t n = 0; n < trace.size(); n++) {
+    const PIPELINEBENCH_FRAME_T &frame = trace[n];
+    bool running = integer.running(), empty = integer.empty();
+    unsigned events = floating.update(PipelineBenchFloat(frame.x, frame.y, frame.z));
+
+    if (integer.updateRaw(frame.x, frame.y, frame.z) != events ||
+        integer.running() != floating.running() || integer.empty() != floating.empty()) {
+      if (!mismatches)
+        printf("PIPELINE: %s: sample %zu: running %d/%d empty %d/%d\n", name, n,
+               integer.running(), floating.running(), integer.empty(), floating.empty());
+      mismatches++;
+    }
+    if (integer.running() != running || integer.empty() != empty)
+      transitions++;
+  }
+
+  /*
+     the cost of the magnitude alone and of a sample through the detector
+  */
+  uint32_t sum = 0;
+  double t = BenchTime();
+  uint64_t c = PipelineBenchCycles();
+
+  for (const PIPELINEBENCH_FRAME_T &frame : trace)
+    sum += ActivityUnits(PipelineBenchFloat(frame.x, frame.y, frame.z));
+
+  double magnitudeFloat = BenchTime() - t;
+  uint64_t cyclesFloat = PipelineBenchCycles() - c;
+
+  t = BenchTime();
+  c = PipelineBenchCycles();
+  for (const PIPELINEBENCH_FRAME_T &frame : trace)
+    sum += ActivityMagnitude(frame.x, frame.y, frame.z, ACTIVITY_UNITS_PER_G / Config::kLsbPerG);
+
+  double magnitudeInteger = BenchTime() - t;
+  uint64_t cyclesInteger = PipelineBenchCycles() - c;
+
+  _sink = sum;
+  floating.clear();
+  t = BenchTime();
+  c = PipelineBenchCycles();
+  for (const PIPELINEBENCH_FRAME_T &frame : trace)
+    floating.update(PipelineBenchFloat(frame.x, frame.y, frame.z));
+
+  double sampleFloat = BenchTime() - t;
+  uint64_t cyclesSampleFloat = PipelineBenchCycles() - c;
+
+  _sink = floating.running();
+  integer.clear();
+  t = BenchTime();
+  c = PipelineBenchCycles();
+  for (const PIPELINEBENCH_FRAME_T &frame : trace)
+    integer.updateRaw(frame.x, frame.y, frame.z);
+
+  double sampleInteger = BenchTime() - t;
+  uint64_t cyclesSampleInteger = PipelineBenchCycles() - c;
+
+  _sink = integer.running();
+
+  double samples = trace.size();
+
+  printf("%-12s %8lu transitions, %lu decisions differ %s\n", name, transitions, mismatches,
+         (mismatches) ? "FAILED" : "ok");
+  printf("%-12s %-18s %8.2f ns %8.1f cycles/sample (float %8.2f ns %8.1f cycles)\n", "", "magnitude",
+         magnitudeInteger * 1e9 / samples, cyclesInteger / samples,
+         magnitudeFloat * 1e9 / samples, cyclesFloat / samples);
+  printf("%-12s %-18s %8.2f ns %8.1f cycles/sample (float %8.2f ns %8.1f cycles)\n", "", "sample",
+         sampleInteger * 1e9 / samples, cyclesSampleInteger / samples,
+         sampleFloat * 1e9 / samples, cyclesSampleFloat / samples);
+  return !mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "c:s:")) != -1) {
+    switch (opt) {
+      case 'c': _cycles = std::max(1, atoi(optarg)); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-c <cycles>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool failed = !PipelineBenchSqrt();
+
+  failed |= !PipelineBenchMagnitude();
+
+  std::vector<PIPELINEBENCH_FRAME_T> slow, fast;
+
+  PipelineBenchTrace(slow, _cycles, 20);
+  PipelineBenchTrace(fast, std::max(1, _cycles / 4), MPU_FIFO_RATE);
+  printf("PIPELINE: %d cycles, %zu samples (%.1f hours) every 50 ms, %zu samples at %d Hz\n",
+         _cycles, slow.size(), slow.size() / 20.0 / 3600, fast.size(), MPU_FIFO_RATE);
+
+  failed |= !PipelineBenchConfig<MachineEspConfig>("machineESP", slow);
+  failed |= !PipelineBenchConfig<AccelerometerConfig>("1MPU", slow);
+  failed |= !PipelineBenchConfig<DryerConfig>("dryer", slow);
+  failed |= !PipelineBenchConfig<WakeConfig>("wake", slow);
+  failed |= !PipelineBenchConfig<FifoConfig>("fifo", fast);
+
+  printf("PIPELINE: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
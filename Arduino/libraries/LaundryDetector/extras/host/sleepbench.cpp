@@ -0,0 +1,258 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  simulation of the deep sleep policies of a sensor on battery
+
+  The sensor is simulated by its wake ups, as DryerLaunDryerCode runs
+  it: it wakes up on the motion of the start of the machine or of the
+  door, is awake for SLEEPBENCH_AWAKE s to decide, then sleeps as the
+  policy says. The stop of the machine is decided SLEEPBENCH_DETECT s
+  after the sensor is awake and the machine is quiet -- the average of
+  the detector. The lengths of the cycles are those of a file (minutes,
+  one per line) or of the synthetic programs of a machine.
+
+  measures per policy
+    - the delay of the stop: mean, 95 percentile, max.
+    - wake ups and time awake per day
+    - the charge per day (estimated currents) and the days on a battery
+
+  usage: sleep-bench [-d <days>] [-l <loads per day>] [-f <cycles>]
+                     [-a <awake mA>] [-z <sleep mA>] [-b <battery mAh>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+/*
+   the sensor: awake per wake up (SAMPLE_TIME of 200 samples of 50 ms), the
+   average of the detector, the boot and the start of BLE per wake up
+*/
+#define SLEEPBENCH_AWAKE        10.0
+#define SLEEPBENCH_DETECT       10.0
+#define SLEEPBENCH_BOOT         0.3
+
+#define SLEEPBENCH_DAY          (24 * 3600.0)
+
+/*
+   the policies
+*/
+struct ContinuousConfig : SleepConfig {
+  static constexpr uint32_t kFirst = 0;
+};
+
+struct LabelledConfig : SleepConfig {
+  static constexpr uint32_t kFirst = 120;
+  static constexpr uint32_t kStage = 600;
+};
+
+struct ShortConfig : SleepConfig {
+  static constexpr uint32_t kLong = 300;
+  static constexpr uint32_t kMargin = 180;
+};
+
+typedef struct _sleepbench_load {
+  double start, length;         // of the cycle
+  double door, open;            // the door is opened after the stop, for ...
+} SLEEPBENCH_LOAD_T;
+
+typedef struct _sleepbench_result {
+  std::vector<double> delays;   // of the stops
+  unsigned long wakes;
+  double awake;                 // s
+} SLEEPBENCH_RESULT_T;
+
+static int _days = 30;
+static int _loads = 3;
+static const char *_file = NULL;
+static double _awakeCurrent = 80;       // mA, ESP32 with BLE advertising
+static double _sleepCurrent = 3.9;      // mA, the MPU (accel and gyro) and the ESP32 in deep sleep
+static double _battery = 2500;          // mAh
+static unsigned _seed = 1;
+
+/*
+   the loads of the days -- the cycles of the file in turn, or one of the programs of the machine
+*/
+static bool SleepBenchLoads(std::vector<SLEEPBENCH_LOAD_T> &loads)
+{
+  static const double programs[] = { 45, 60, 75 };
+  std::vector<double> cycles;
+
+  if (_file) {
+    FILE *fp = fopen(_file, "r");
+    double minutes;
+
+    if (!fp) {
+      perror(_file);
+      return false;
+    }
+    while (fscanf(fp, "%lf", &minutes) == 1)
+      if (minutes > 0)
+        cycles.push_back(minutes);
+    fclose(fp);
+    if (cycles.empty()) {
+      fprintf(stderr, "%s: no cycles\n", _file);
+      return false;
+    }
+  }
+
+  for (int day = 0; day < _days; day++) {
+    double t = day * SLEEPBENCH_DAY + BenchUniform(7, 10) * 3600;
+
+    for (int n = 0; n < _loads; n++) {
+      SLEEPBENCH_LOAD_T load;
+
+      if (cycles.empty())
+        load.length = (programs[_bench_rng() % 3] + std::normal_distribution<double>(0, 2)(_bench_rng)) * 60;
+      else
+        load.length = cycles[loads.size() % cycles.size()] * 60;
+      load.start = t;
+      load.door = BenchUniform(1, 60) * 60;
+      load.open = BenchUniform(20, 180);
+      loads.push_back(load);
+      t += load.length + load.door + load.open + BenchUniform(0.5, 3) * 3600;
+    }
+  }
+  return true;
+}
+
+/*
+   the sensor with the policy P through the loads
+*/
+template <class P>
+static void SleepBenchRun(const std::vector<SLEEPBENCH_LOAD_T> &loads, SLEEPBENCH_RESULT_T &result)
+{
+  static SleepHistory history;
+  auto wake = [&](double awake) {
+    result.wakes++;
+    result.awake += SLEEPBENCH_BOOT + awake;
+  };
+
+  history.clear();
+  result = SLEEPBENCH_RESULT_T();
+
+  for (const SLEEPBENCH_LOAD_T &load : loads) {
+    double stop = load.start + load.length, detected;
+
+    /*
+       woken up by the start, then on the timer while running
+    */
+    wake(SLEEPBENCH_AWAKE);
+
+    double started = load.start + SLEEPBENCH_DETECT, t = load.start + SLEEPBENCH_AWAKE;
+    unsigned stage = 0;
+
+    for (;;) {
+      SLEEP_WAKE_T next = P::next({ true, false, (uint32_t) (t - started), stage }, history);
+
+      if (!next.sources) {
+        detected = std::max(t, stop) + SLEEPBENCH_DETECT;
+        result.awake += detected - t;
+        break;
+      }
+      t += next.seconds;
+      if (t >= stop) {
+        detected = t + SLEEPBENCH_DETECT;
+        wake(SLEEPBENCH_DETECT);
+        break;
+      }
+      if (t + SLEEPBENCH_AWAKE > stop) {
+        detected = stop + SLEEPBENCH_DETECT;
+        wake(detected - t);
+        break;
+      }
+      wake(SLEEPBENCH_AWAKE);
+      t += SLEEPBENCH_AWAKE;
+      stage++;
+    }
+    result.delays.push_back(detected - stop);
+    history.add((uint32_t) (detected - started));
+
+    /*
+       stopped until the door is opened, then the door left open is checked, closed on motion
+    */
+    wake(SLEEPBENCH_AWAKE);
+    if (load.open > SLEEPBENCH_AWAKE) {
+      SLEEP_WAKE_T next = P::next({ false, true, 0, 0 }, history);
+
+      if (load.open > SLEEPBENCH_AWAKE + next.seconds)
+        wake(0);
+    }
+    wake(SLEEPBENCH_AWAKE);
+  }
+}
+
+template <class P>
+static void SleepBenchPolicy(const char *name, const std::vector<SLEEPBENCH_LOAD_T> &loads)
+{
+  SLEEPBENCH_RESULT_T result;
+
+  SleepBenchRun<P>(loads, result);
+
+  std::vector<double> &delays = result.delays;
+  double mean = 0;
+
+  for (double delay : delays)
+    mean += delay;
+  mean /= delays.size();
+  std::sort(delays.begin(), delays.end());
+
+  double p95 = delays[std::min(delays.size() - 1, (size_t) (delays.size() * 0.95))];
+  double awake = result.awake / _days;
+  double charge = (awake * _awakeCurrent + (SLEEPBENCH_DAY - awake) * _sleepCurrent) / 3600;
+
+  printf("%-22s %8.1f %8.1f %8.1f s %8.1f %8.1f min %10.1f mAh %8.1f days\n", name,
+         mean, p95, delays.back(), (double) result.wakes / _days, awake / 60, charge, _battery / charge);
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "d:l:f:a:z:b:s:")) != -1) {
+    switch (opt) {
+      case 'd': _days = std::max(1, atoi(optarg)); break;
+      case 'l': _loads = std::max(1, atoi(optarg)); break;
+      case 'f': _file = optarg; break;
+      case 'a': _awakeCurrent = atof(optarg); break;
+      case 'z': _sleepCurrent = atof(optarg); break;
+      case 'b': _battery = atof(optarg); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-d <days>] [-l <loads per day>] [-f <cycles>] "
+                "[-a <awake mA>] [-z <sleep mA>] [-b <battery mAh>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  std::vector<SLEEPBENCH_LOAD_T> loads;
+
+  if (!SleepBenchLoads(loads))
+    return 1;
+  printf("SLEEP: %d days, %zu loads, %.0f mA awake, %.1f mA asleep\n", _days, loads.size(), _awakeCurrent, _sleepCurrent);
+  printf("%-22s %8s %8s %8s   %8s %8s     %10s     %8s\n", "policy", "delay", "95%", "max.", "wakes", "awake", "charge", "battery");
+
+  SleepBenchPolicy<StagedSleepPolicy<ContinuousConfig>>("awake while running", loads);
+  SleepBenchPolicy<StagedSleepPolicy<>>("staged 12 s, 4 x 15 s", loads);
+  SleepBenchPolicy<StagedSleepPolicy<LabelledConfig>>("staged 2 min, 10 min", loads);
+  SleepBenchPolicy<AdaptiveSleepPolicy<>>("adaptive 10 min", loads);
+  SleepBenchPolicy<AdaptiveSleepPolicy<ShortConfig>>("adaptive 5 min", loads);
+  return 0;
+}
+
+/**/
@@ -0,0 +1,365 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the snapshot of the state over the deep sleep
+
+  The state of DryerLaunDryerCode -- the detector, the calibration, the
+  history of the cycles and the flags of the sketch -- is saved into a
+  snapshot before every sleep of simulated loads and restored at the
+  wake up, as the sketch does with the RTC memory.
+
+  checks
+    - the CRC of the check string of CRC-32, also in pieces
+    - a restored state is the same byte for byte, and the detector
+      resumed from it decides every sample like the one never stopped
+    - every bit flipped in the snapshot, another version, another size
+      of the state and a snapshot of zeros aren't restored, and leave
+      the state alone
+    - resumed and aged by the sleep, the detector decides a machine
+      stopped in the sleep at the first window of a wake up, and one
+      running faster than started over
+
+  measures
+    - the time from the wake up to the decision, resumed after a sleep
+      of 12 s to 10 min and started over, for a machine running and one
+      stopped in the sleep
+    - the size of the snapshot and the cost of a save and a restore
+
+  usage: snapshot-bench [-w <wake ups>] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+
+/*
+   the samples of a wake up, 10 s at 20 Hz
+*/
+#define SNAPSHOTBENCH_AWAKE     200
+
+/*
+   the bands of DryerLaunDryerCode at 20 Hz
+*/
+typedef SensorBandConfig<20> WakeBandConfig;
+
+/*
+   the state of the sketch over the deep sleep
+*/
+typedef struct _snapshotbench_state {
+  ActivityDetector<WakeConfig> detector;
+  ActivityCalibration<> calibration;
+  SleepHistory sleepHistory;
+  int64_t cycleStart;
+  int64_t savedAt;
+  unsigned cycleCounter;
+  int quiettime;
+  bool empty;
+  bool running;
+  bool dooropened;
+  bool doorclosed;
+  bool monitoringContinuously;
+  bool waitingForDoorClose;
+} SNAPSHOTBENCH_STATE_T;
+
+/*
+   the same with a flag more -- a build with another state
+*/
+typedef struct _snapshotbench_bigger {
+  SNAPSHOTBENCH_STATE_T state;
+  bool more;
+} SNAPSHOTBENCH_BIGGER_T;
+
+typedef RtcSnapshot<SNAPSHOTBENCH_STATE_T, 1> Snapshot;
+
+/*
+   the decisions of the wake ups, in windows after the wake up
+*/
+typedef struct _snapshotbench_decision {
+  unsigned long wakes;
+  unsigned long windows;        // summed up
+  unsigned long first;          // decided at the first window
+  unsigned long undecided;      // not decided within the wake up
+} SNAPSHOTBENCH_DECISION_T;
+
+static int _wakes = 2000;
+static unsigned _seed = 1;
+static volatile uint32_t _sink;
+
+/*
+   a raw sample of a machine running with a vibration in g or stopped
+*/
+static void SnapshotBenchSample(float vibration, int16_t *x, int16_t *y, int16_t *z)
+{
+  float sigma = (vibration > 0) ? vibration : 0.003;
+
+  *x = (int16_t) lroundf(BenchNoise(sigma / 2) * 2048);
+  *y = (int16_t) lroundf(BenchNoise(sigma / 2) * 2048);
+  *z = (int16_t) lroundf((1 + BenchNoise(sigma)) * 2048);
+}
+
+static bool SnapshotBenchCrc(void)
+{
+  static const char check[] = "123456789";
+  uint32_t whole = SnapshotCrc32(0, check, 9);
+  uint32_t pieces = SnapshotCrc32(SnapshotCrc32(SnapshotCrc32(0, check, 2), check + 2, 4), check + 6, 3);
+  bool ok = whole == 0xcbf43926 && pieces == whole && SnapshotCrc32(0, check, 0) == 0;
+
+  printf("SNAPSHOT: CRC-32 of \"%s\" %08x, in pieces %08x %s\n", check, whole, pieces, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   a warm state -- the detector after a load, the calibration and the history after some cycles
+*/
+static void SnapshotBenchWarm(SNAPSHOTBENCH_STATE_T *state, float vibration)
+{
+  memset(state, 0, sizeof(*state));
+  state->detector.clear();
+  state->calibration.clear();
+  state->sleepHistory.clear();
+  for (int cycle = 0; cycle < 5; cycle++)
+    state->sleepHistory.add(BenchRandom(2400, 4200));
+
+  for (int n = 0; n < 60 * 20; n++) {
+    int16_t x, y, z;
+
+    SnapshotBenchSample(vibration, &x, &y, &z);
+    if (state->detector.updateRaw(x, y, z) & ACTIVITY_TICK)
+      state->calibration.update(state->detector);
+  }
+  state->running = state->detector.running();
+  state->empty = state->detector.empty();
+  state->cycleStart = 1700000000;
+  state->cycleCounter = 3;
+  state->quiettime = 17;
+}
+
+/*
+   a detector resumed from the snapshot decides every sample like the one never stopped
+*/
+static bool SnapshotBenchResume(void)
+{
+  static SNAPSHOTBENCH_STATE_T state, restored;
+  static Snapshot snapshot;
+  unsigned long samples = 0, differ = 0;
+  bool same = true;
+
+  for (int wake = 0; wake < 50; wake++) {
+    float vibration = (wake % 4 == 3) ? 0 : 0.3f + 0.1f * BenchRandom(0, 4);
+
+    SnapshotBenchWarm(&state, 0.4);
+    snapshot.save(state);
+    memset(&restored, 0xa5, sizeof(restored));
+    same = same && snapshot.restore(&restored) && !memcmp(&state, &restored, sizeof(state));
+
+    for (int n = 0; n < 30 * 20; n++) {
+      int16_t x, y, z;
+
+      SnapshotBenchSample(vibration, &x, &y, &z);
+      if (state.detector.updateRaw(x, y, z) != restored.detector.updateRaw(x, y, z) ||
+          state.detector.running() != restored.detector.running() ||
+          state.detector.activityUnits() != restored.detector.activityUnits())
+        differ++;
+      samples++;
+    }
+  }
+  bool ok = same && !differ;
+
+  printf("SNAPSHOT: %lu samples resumed, the state %s, %lu decisions differ %s\n", samples,
+         (same) ? "the same" : "DIFFERS", differ, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   a broken snapshot isn't restored
+*/
+static bool SnapshotBenchBroken(void)
+{
+  static SNAPSHOTBENCH_STATE_T state, restored, untouched;
+  static Snapshot snapshot, flipped;
+  unsigned long bits = 0, restoredFlipped = 0;
+  bool left = true;
+
+  SnapshotBenchWarm(&state, 0.4);
+  snapshot.save(state);
+  memset(&restored, 0x5a, sizeof(restored));
+  memcpy(&untouched, &restored, sizeof(untouched));
+
+  /*
+     every bit flipped
+  */
+  for (size_t byte = 0; byte < sizeof(Snapshot); byte++)
+    for (int bit = 0; bit < 8; bit++) {
+      flipped = snapshot;
+      ((uint8_t *) &flipped)[byte] ^= 1 << bit;
+      bits++;
+      if (flipped.restore(&restored))
+        restoredFlipped++;
+    }
+  left = left && !memcmp(&restored, &untouched, sizeof(restored));
+
+  /*
+     another version, another size, zeros, invalidated
+  */
+  static RtcSnapshot<SNAPSHOTBENCH_STATE_T, 2> other;
+  static RtcSnapshot<SNAPSHOTBENCH_BIGGER_T, 1> bigger;
+  static SNAPSHOTBENCH_BIGGER_T big;
+  static Snapshot zeros, invalidated;
+
+  other.save(state);
+  memcpy((void *) &flipped, &other, sizeof(flipped));
+  bool version = !flipped.restore(&restored);
+
+  memset(&big, 0, sizeof(big));
+  big.state = state;
+  bigger.save(big);
+  memcpy((void *) &flipped, &bigger, sizeof(flipped));
+  bool size = !flipped.restore(&restored);
+
+  memset(&zeros, 0, sizeof(zeros));
+  bool zero = !zeros.restore(&restored);
+
+  left = left && !memcmp(&restored, &untouched, sizeof(restored));
+  invalidated = snapshot;
+  invalidated.invalidate();
+  bool invalid = !invalidated.restore(&restored) && snapshot.restore(&restored);
+
+  bool ok = !restoredFlipped && version && size && zero && invalid && left;
+
+  printf("SNAPSHOT: %lu of %lu bit flips restored, another version %s, another size %s, zeros %s, invalidated %s, the state %s %s\n",
+         restoredFlipped, bits, (version) ? "not" : "RESTORED", (size) ? "not" : "RESTORED",
+         (zero) ? "not" : "RESTORED", (invalid) ? "not" : "RESTORED", (left) ? "left alone" : "CHANGED",
+         (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   the windows from the wake up until the detector decides right and stays so for the wake up
+*/
+static void SnapshotBenchWake(ActivityDetector<WakeConfig> *detector, float vibration, SNAPSHOTBENCH_DECISION_T *decision)
+{
+  static VibrationBands<WakeBandConfig> bands;
+  unsigned windows = 0, decided = 0;
+  bool running = vibration > 0;
+
+  bands.clear();
+  detector->setStill(false);
+  for (int n = 0; n < SNAPSHOTBENCH_AWAKE; n++) {
+    int16_t x, y, z;
+
+    SnapshotBenchSample(vibration, &x, &y, &z);
+    if (bands.update(x, y, z) & BANDS_BLOCK)
+      detector->setStill(bands.still());
+    if (!(detector->updateRaw(x, y, z) & ACTIVITY_TICK))
+      continue;
+    windows++;
+    if (detector->running() != running)
+      decided = 0;
+    else if (!decided)
+      decided = windows;
+  }
+  decision->wakes++;
+  if (decided)
+    decision->windows += decided;
+  else
+    decision->undecided++;
+  if (decided == 1)
+    decision->first++;
+}
+
+static bool SnapshotBenchDecision(void)
+{
+  static SNAPSHOTBENCH_STATE_T state;
+  static Snapshot snapshot;
+  static ActivityDetector<WakeConfig> cold;
+  SNAPSHOTBENCH_DECISION_T resumed[2] = {}, started[2] = {};
+  double saveCost = 0, restoreCost = 0;
+
+  for (int wake = 0; wake < _wakes; wake++) {
+    float before = 0.3f + 0.1f * BenchRandom(0, 4);
+    bool stopped = BenchRandom(0, 3) == 0;
+    int sleep = BenchRandom(12, 600);
+    float vibration = (stopped) ? 0 : before * (0.8f + 0.1f * BenchRandom(0, 4));
+
+    /*
+       running before the sleep, saved and restored and aged by the sleep, or started over
+    */
+    SnapshotBenchWarm(&state, before);
+    state.savedAt = state.cycleStart;
+
+    double t = BenchTime();
+
+    snapshot.save(state);
+    t = BenchTime() - t;
+    saveCost += t;
+    memset(&state, 0, sizeof(state));
+    t = BenchTime();
+    _sink = snapshot.restore(&state);
+    restoreCost += BenchTime() - t;
+    state.detector.age((state.cycleStart + sleep - state.savedAt) * 20);
+
+    cold.clear();
+    SnapshotBenchWake(&state.detector, vibration, &resumed[stopped]);
+    SnapshotBenchWake(&cold, vibration, &started[stopped]);
+  }
+
+  static const char *names[2] = { "running", "stopped" };
+  bool ok = true;
+
+  printf("\n%-8s %6s %14s %14s\n", "machine", "wakes", "resumed", "started over");
+  for (int stopped = 0; stopped < 2; stopped++) {
+    const SNAPSHOTBENCH_DECISION_T &r = resumed[stopped], &s = started[stopped];
+
+    printf("%-8s %6lu %9.1f s %2lu %9.1f s %2lu\n", names[stopped], r.wakes,
+           (double) r.windows / std::max(1UL, r.wakes - r.undecided), r.undecided,
+           (double) s.windows / std::max(1UL, s.wakes - s.undecided), s.undecided);
+  }
+  ok = !resumed[0].undecided && resumed[0].windows * started[0].wakes < started[0].windows * resumed[0].wakes &&
+       !resumed[1].undecided && resumed[1].first == resumed[1].wakes;
+  printf("SNAPSHOT: resumed, a stopped machine is decided at the first window of every wake up, a running one of "
+         "%lu of %lu, %lu of %lu not decided started over %s\n", resumed[0].first, resumed[0].wakes,
+         started[0].undecided, started[0].wakes, (ok) ? "ok" : "FAILED");
+
+  printf("\nSNAPSHOT: %zu bytes of state, %zu of snapshot, %.0f ns per save, %.0f ns per restore\n",
+         sizeof(SNAPSHOTBENCH_STATE_T), sizeof(Snapshot), saveCost * 1e9 / _wakes, restoreCost * 1e9 / _wakes);
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "w:s:")) != -1) {
+    switch (opt) {
+      case 'w': _wakes = std::max(1, atoi(optarg)); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-w <wake ups>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool failed = !SnapshotBenchCrc();
+
+  failed = !SnapshotBenchResume() || failed;
+  failed = !SnapshotBenchBroken() || failed;
+  failed = !SnapshotBenchDecision() || failed;
+  printf("SNAPSHOT: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
@@ -0,0 +1,321 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  benchmark and check of the recording of the traces
+
+  checks
+    - the frames read back from the binary file and from a Serial log are
+      the frames recorded, for 1 to 4 channels and the whole range of the
+      values
+    - the lines of a Serial log which are not of the trace are skipped, a
+      corrupt line costs the frames of its block, which are seen as lost
+    - a restart of the recording starts a new one in the log
+
+  measures
+    - bytes per frame of the raw x, y, z of the MPU at rest and running,
+      against 6 bytes raw
+    - cost of the recording per frame
+
+  With -o a synthetic trace of the raw values at 20 Hz over <days> is
+  written to <file> and its labels to <file>.labels, for trace-replay.
+
+  usage: trace-bench [-o <file> [-d <days>]] [-s <seed>]
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+#include "tracereader.h"
+
+/*
+   the sensitivity at +-16g
+*/
+#define TRACEBENCH_LSB          2048
+
+static const char *_output = NULL;
+static int _days = 7;
+static unsigned _seed = 1;
+
+/*
+   the output of the recorder
+*/
+static FILE *_file = NULL;
+static bool _serial = false;
+static unsigned long _corrupt = 0;      // the block to corrupt, 0 is none
+static unsigned long _writes = 0;
+
+static int16_t TraceBenchRaw(float g)
+{
+  return (int16_t) std::max(-32768.0f, std::min(32767.0f, std::round(g * TRACEBENCH_LSB)));
+}
+
+static bool TraceBenchWrite(const uint8_t *data, size_t length, bool header)
+{
+  _writes++;
+  if (!_serial)
+    return fwrite(data, 1, length, _file) == length;
+
+  char line[TRACE_LINE_MAX];
+
+  TraceLine(line, data, length, header);
+  if (_corrupt && _writes == _corrupt)
+    line[strlen(TRACE_SERIAL_BLOCK) + 2] ^= 0x01;
+  fprintf(_file, "%s\n", line);
+  if (_writes % 7 == 0)
+    fprintf(_file, "change over last second:%.2f mpu_a_mag:%.2f\nRunning:0\n", 0.01, 1.0);
+  return true;
+}
+
+/*
+   record frames and read them back
+*/
+static bool TraceBenchRoundTrip(bool serial, unsigned channels)
+{
+  static TraceRecorder recorder;
+  std::vector<int32_t> recorded, read;
+  std::vector<uint32_t> indexes;
+  TRACE_READ_STATS_T stats;
+  TRACE_HEADER_T header = {};
+  unsigned long frames = 5000 + BenchRandom(0, TRACE_BLOCK_FRAMES - 1);
+
+  _file = tmpfile();
+  _serial = serial;
+  _writes = 0;
+  _corrupt = (serial) ? 40 : 0;
+  if (serial)
+    fprintf(_file, "\n\n========================================\n   Laundry Machine Monitor\n");
+
+  recorder.begin(TraceBenchWrite, channels, 200, TRACEBENCH_LSB);
+  for (unsigned long n = 0; n < frames; n++) {
+    int32_t values[TRACE_CHANNELS_MAX];
+
+    for (unsigned c = 0; c < TRACE_CHANNELS_MAX; c++)
+      switch (BenchRandom(0, 3)) {
+        case 0: values[c] = (BenchRandom(0, 1)) ? INT32_MAX : INT32_MIN; break;
+        case 1: values[c] = (int32_t) _bench_rng(); break;
+        default: values[c] = BenchRandom(-40000, 40000); break;
+      }
+    recorder.add(values[0], values[1], values[2], values[3]);
+    recorded.insert(recorded.end(), values, values + channels);
+  }
+  recorder.end();
+
+  rewind(_file);
+  bool ok = TraceRead(_file, [&](const TRACE_HEADER_T &h) { header = h; },
+                      [&](uint32_t index, const int32_t *values) {
+                        indexes.push_back(index);
+                        read.insert(read.end(), values, values + channels);
+                      }, &stats);
+  fclose(_file);
+
+  /*
+     the frames of the corrupt block are missing
+  */
+  unsigned long lost = (serial) ? TRACE_BLOCK_FRAMES : 0, first = (serial) ? (_corrupt - 2) * TRACE_BLOCK_FRAMES : 0;
+
+  ok = ok && header.channels == channels && header.rate == 200 && header.scale == TRACEBENCH_LSB &&
+       stats.frames == frames - lost && stats.lost == lost && stats.bad == (serial ? 1 : 0);
+  for (size_t n = 0; ok && n < indexes.size(); n++) {
+    uint32_t index = (n < first) ? n : n + lost;
+
+    ok = indexes[n] == index && !memcmp(&read[n * channels], &recorded[index * channels], channels * sizeof(int32_t));
+  }
+
+  printf("TRACE: %-6s %u channels, %lu frames, %lu blocks, %lu lost, %lu bad %s\n", (serial) ? "serial" : "binary",
+         channels, stats.frames, stats.blocks, stats.lost, stats.bad, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   a restart of the recording in a Serial log
+*/
+static bool TraceBenchRestart(void)
+{
+  static TraceRecorder recorder;
+  TRACE_READ_STATS_T stats;
+  unsigned long headers = 0, frames = 0;
+
+  _file = tmpfile();
+  _serial = true;
+  _writes = 0;
+  _corrupt = 0;
+  for (int recording = 0; recording < 3; recording++) {
+    recorder.begin(TraceBenchWrite, 3, 20, TRACEBENCH_LSB);
+    for (int n = 0; n < 55; n++)
+      recorder.add(n, -n, 2048);
+    if (recording < 2)
+      recorder.end();
+  }
+
+  rewind(_file);
+  bool ok = TraceRead(_file, [&](const TRACE_HEADER_T &) { headers++; },
+                      [&](uint32_t index, const int32_t *values) {
+                        frames += values[0] == (int32_t) index && values[1] == -(int32_t) index;
+                      }, &stats);
+
+  fclose(_file);
+
+  /*
+     the last recording wasn't ended, its partial block is missing
+  */
+  ok = ok && headers == 3 && frames == 55 + 55 + 40 && stats.lost == 0;
+  printf("TRACE: restarts, %lu recordings, %lu frames %s\n", headers, frames, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   the size and the cost of a recording of the MPU at 200 Hz
+*/
+static void TraceBenchSize(void)
+{
+  static TraceRecorder recorder;
+  TRACE_STATS_T stats;
+
+  for (float level : { 0.003f, 0.2f, 0.6f }) {
+    std::vector<int16_t> frames;
+
+    for (int n = 0; n < 200 * 600; n++) {
+      frames.push_back(TraceBenchRaw(BenchNoise(level / 2)));
+      frames.push_back(TraceBenchRaw(BenchNoise(level / 2)));
+      frames.push_back(TraceBenchRaw(1.0 + BenchNoise(level)));
+    }
+
+    _file = fopen("/dev/null", "w");
+    _serial = false;
+    recorder.begin(TraceBenchWrite, 3, 200, TRACEBENCH_LSB);
+
+    double t = BenchTime();
+
+    for (size_t n = 0; n < frames.size(); n += 3)
+      recorder.add(frames[n], frames[n + 1], frames[n + 2]);
+    recorder.end();
+    t = BenchTime() - t;
+    recorder.stats(&stats);
+    fclose(_file);
+
+    printf("TRACE: noise %5.3f g  %6.2f bytes/frame (6 raw) %8.1f KB/hour %8.2f ns/frame\n", level,
+           (double) stats.bytes / stats.frames, stats.bytes * 6.0 / 1024, t * 1e9 / stats.frames);
+  }
+}
+
+/*
+   a synthetic trace of laundry cycles at 20 Hz and its labels
+*/
+static bool TraceBenchSynthetic(const char *path)
+{
+  static TraceRecorder recorder;
+  std::string labels = std::string(path) + ".labels";
+  FILE *fp = fopen(labels.c_str(), "w");
+  unsigned long frames = 0;
+
+  if (!fp || !(_file = fopen(path, "wb"))) {
+    perror((fp) ? path : labels.c_str());
+    return false;
+  }
+  _serial = false;
+  recorder.begin(TraceBenchWrite, 3, 20, TRACEBENCH_LSB);
+
+  float tilt = BenchNoise(0.05);
+  auto frame = [&](float x, float y, float z) {
+    recorder.add(TraceBenchRaw(tilt + x), TraceBenchRaw(y), TraceBenchRaw(1.0 + z));
+    frames++;
+  };
+  auto idle = [&](long samples) {
+    for (long n = 0; n < samples; n++)
+      frame(BenchNoise(0.003), BenchNoise(0.003), BenchNoise(0.003));
+  };
+  auto run = [&](long samples) {
+    float level = 0.3;
+
+    for (long n = 0; n < samples; n++) {
+      if (n % 20 == 0)
+        level = std::max(0.2f, std::min(0.8f, level + BenchNoise(0.02)));
+      frame(BenchNoise(level / 2), BenchNoise(level / 2), BenchNoise(level));
+    }
+  };
+  auto slam = [&](float level) {
+    for (int n = 0; n < 3; n++)
+      frame(0, 0, (n & 1) ? -level : level);
+  };
+  auto label = [&](const char *event) {
+    fprintf(fp, "%.2f %s\n", frames / 20.0, event);
+  };
+
+  fprintf(fp, "# %s -- synthetic, %d days at 20 Hz\n", path, _days);
+  for (int day = 0; day < _days; day++) {
+    long end = (day + 1) * 86400L * 20;
+
+    idle(BenchRandom(7, 10) * 3600L * 20);
+    for (int load = BenchRandom(1, 4); load > 0; load--) {
+      label("started");
+      run(BenchRandom(40, 80) * 60L * 20);
+      label("stopped");
+      idle(BenchRandom(1, 60) * 60L * 20);
+      if (BenchRandom(0, 3) == 0) {    // a look first
+        slam(0.3);
+        idle(BenchRandom(45, 75));
+        slam(0.6);
+        idle(BenchRandom(100, 2000));
+      }
+      slam(0.3);
+      idle(BenchRandom(200, 1500));
+      label("emptied");
+      slam(0.6);
+      idle(BenchRandom(10, 60) * 60L * 20);
+    }
+    if ((long) frames < end)
+      idle(end - frames);
+  }
+  recorder.end();
+  fclose(_file);
+  fclose(fp);
+  printf("TRACE: %s, %d days, %lu frames, labels %s\n", path, _days, frames, labels.c_str());
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "o:d:s:")) != -1) {
+    switch (opt) {
+      case 'o': _output = optarg; break;
+      case 'd': _days = std::max(1, atoi(optarg)); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-o <file> [-d <days>]] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+  BenchSeed(_seed);
+
+  bool failed = false;
+
+  for (unsigned channels = 1; channels <= TRACE_CHANNELS_MAX; channels++) {
+    failed |= !TraceBenchRoundTrip(false, channels);
+    failed |= !TraceBenchRoundTrip(true, channels);
+  }
+  failed |= !TraceBenchRestart();
+  TraceBenchSize();
+
+  if (_output && !TraceBenchSynthetic(_output))
+    failed = true;
+
+  printf("TRACE: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
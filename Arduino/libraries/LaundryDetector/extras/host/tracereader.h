@@ -0,0 +1,158 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  reading of the recorded traces on the host
+
+  A trace (see SensorTrace.h) is either the binary file of the flash or
+  a Serial log with the TRCH:/TRC: lines between the other output of the
+  sketch. Both are read in pieces, so a month of samples isn't held in
+  memory: header() is called for every header -- the sketch restarted
+  the recording -- and frame() for every frame.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __TRACEREADER_H__
+#define __TRACEREADER_H__ 1
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "SensorTrace.h"
+
+/*
+   statistics
+*/
+typedef struct _trace_read_stats {
+  unsigned long headers;
+  unsigned long blocks;
+  unsigned long frames;
+  unsigned long lost;           // frames missing in the index
+  unsigned long bad;            // blocks or lines which couldn't be decoded
+} TRACE_READ_STATS_T;
+
+/*
+   decode the hex of a Serial line and check its sum, returns the bytes without the sum
+*/
+static size_t TraceReadLine(const char *hex, uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  uint8_t sum = 0;
+
+  auto nibble = [](char c) {
+    return (c <= '9') ? c - '0' : (c | 0x20) - 'a' + 10;
+  };
+
+  while (n < size && isxdigit(hex[0]) && isxdigit(hex[1])) {
+    buffer[n++] = (nibble(hex[0]) << 4) | nibble(hex[1]);
+    hex += 2;
+  }
+  if (n < 2 || (*hex && *hex != '\r' && *hex != '\n'))
+    return 0;
+  for (size_t i = 0; i < n - 1; i++)
+    sum += buffer[i];
+  return (sum == buffer[n - 1]) ? n - 1 : 0;
+}
+
+/*
+   read a trace -- header(const TRACE_HEADER_T &) and frame(index, values) are called in turn,
+   false if it couldn't be read or has no header
+*/
+template <typename H, typename F>
+static bool TraceRead(FILE *fp, H header, F frame, TRACE_READ_STATS_T *stats)
+{
+  TRACE_HEADER_T current = {};
+  uint32_t next = 0;
+  uint8_t magic[6];
+  auto frames = [&](uint32_t index, const int32_t *values) {
+    if (index > next)
+      stats->lost += index - next;
+    next = index + 1;
+    stats->frames++;
+    frame(index, values);
+  };
+
+  *stats = TRACE_READ_STATS_T();
+
+  /*
+     binary -- the blocks are decoded out of a buffer which is refilled
+  */
+  if (fread(magic, 1, sizeof(magic), fp) == sizeof(magic) && !memcmp(magic, TRACE_MAGIC, sizeof(magic))) {
+    std::vector<uint8_t> buffer(magic, magic + sizeof(magic));
+    size_t n = 0, length;
+    bool eof = false;
+
+    for (;;) {
+      if (!eof && buffer.size() - n < 64 * 1024) {
+        uint8_t chunk[256 * 1024];
+
+        buffer.erase(buffer.begin(), buffer.begin() + n);
+        n = 0;
+        length = fread(chunk, 1, sizeof(chunk), fp);
+        buffer.insert(buffer.end(), chunk, chunk + length);
+        eof = !length;
+      }
+      if (n >= buffer.size())
+        break;
+      if (!stats->headers) {
+        if (!TraceDecodeHeader(buffer.data(), buffer.size(), &current))
+          return false;
+        header(current);
+        stats->headers++;
+        n = TRACE_HEADER_SIZE;
+        continue;
+      }
+      if (!(length = TraceDecodeBlock(&buffer[n], buffer.size() - n, current.channels, frames))) {
+        fprintf(stderr, "TRACE: truncated at block %lu\n", stats->blocks);
+        stats->bad++;
+        break;
+      }
+      stats->blocks++;
+      n += length;
+    }
+    return true;
+  }
+
+  /*
+     a Serial log
+  */
+  char line[4096];
+
+  rewind(fp);
+  while (fgets(line, sizeof(line), fp)) {
+    uint8_t buffer[TRACE_BLOCK_MAX + 1];
+    const char *tag;
+    size_t length;
+
+    if ((tag = strstr(line, TRACE_SERIAL_HEADER))) {
+      length = TraceReadLine(tag + strlen(TRACE_SERIAL_HEADER), buffer, sizeof(buffer));
+      if (!TraceDecodeHeader(buffer, length, &current)) {
+        stats->bad++;
+        continue;
+      }
+      header(current);
+      stats->headers++;
+      next = 0;
+    }
+    else if ((tag = strstr(line, TRACE_SERIAL_BLOCK)) && stats->headers) {
+      length = TraceReadLine(tag + strlen(TRACE_SERIAL_BLOCK), buffer, sizeof(buffer));
+      if (!length || TraceDecodeBlock(buffer, length, current.channels, frames) != length) {
+        stats->bad++;
+        continue;
+      }
+      stats->blocks++;
+    }
+  }
+  return stats->headers;
+}
+
+#endif
+
+/**/
@@ -0,0 +1,337 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  replay of recorded traces through the detector
+
+  reads traces of the raw x, y, z of the MPU (see SensorTrace.h) -- the
+  binary file of the flash or a Serial log with the TRCH:/TRC: lines --
+  and passes every frame to the detector in the configuration of a
+  sketch, with updateRaw() as the sketch does. The traces of several
+  files follow each other, as do the recordings of a file; the time is
+  the index of the frames at the rate of the trace.
+
+  The transitions (started, stopped, emptied) are printed with their time
+  and, with a file of labels, scored: a transition within the tolerance
+  of a label of the same event is a hit, the others are false positives,
+  the labels without one are false negatives. A line of the labels is
+  "<seconds> <started|stopped|emptied>", # starts a comment.
+
+  With -a the thresholds are calibrated to the machine while replaying
+  (see ActivityCalibration.h), as the sketches do. With -b the detector
+  is told when the VibrationBands of the trace are still, and stops the
+  machine without waiting for its average.
+
+  The replay runs as fast as possible (-x 0) or paced at a multiple of
+  real time (-x <factor>). -p prints the frames as CSV instead, eg. to
+  plot the band energies of the microphone.
+
+  usage: trace-replay [-c <machineESP|1MPU|dryer|wake>] [-a] [-b] [-l <labels>] [-w <tolerance s>]
+                      [-x <speed, 0 = max>] [-q] [-p] <trace>...
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LaundryDetector.h"
+#include "benchutil.h"
+#include "tracereader.h"
+
+/*
+   the detector of a configuration behind a common interface
+*/
+class ReplayDetector {
+  public:
+    virtual ~ReplayDetector() {}
+    virtual void update(const int32_t *values) = 0;
+    virtual bool running(void) const = 0;
+    virtual bool empty(void) const = 0;
+};
+
+template <class Config>
+class ReplayDetectorOf : public ReplayDetector {
+  public:
+    ReplayDetectorOf(bool calibrate, bool still) : _calibrate(calibrate), _still(still)
+    {
+      _detector.clear();
+      _calibration.clear();
+      _bands.clear();
+    }
+
+    void update(const int32_t *values) override
+    {
+      if (_still && (_bands.update(values[0], values[1], values[2]) & BANDS_BLOCK))
+        _detector.setStill(_bands.still());
+      if ((_detector.updateRaw(values[0], values[1], values[2]) & ACTIVITY_TICK) && _calibrate)
+        _calibration.update(_detector);
+    }
+
+    bool running(void) const override
+    {
+      return _detector.running();
+    }
+
+    bool empty(void) const override
+    {
+      return _detector.empty();
+    }
+
+  private:
+    ActivityDetector<Config> _detector;
+    ActivityCalibration<> _calibration;
+    VibrationBands<SensorBandConfig<20 * Config::kDecimate, Config::kLsbPerG>> _bands;
+    bool _calibrate;
+    bool _still;
+};
+
+static std::string _config = "machineESP";
+static bool _calibrate = false;
+static bool _still = false;
+static const char *_labels = NULL;
+static double _tolerance = 60;
+static double _speed = 0;
+static bool _quiet = false;
+static bool _print = false;
+
+static std::vector<BENCH_TRANSITION_T> _transitions;
+static std::vector<BENCH_TRANSITION_T> _truth;
+
+static const char *ReplayClock(double seconds)
+{
+  static char clock[32];
+  long s = (long) seconds;
+
+  snprintf(clock, sizeof(clock), "%ld+%02ld:%02ld:%06.3f", s / 86400, s / 3600 % 24, s / 60 % 60,
+           fmod(seconds, 60));
+  return clock;
+}
+
+template <class Base, unsigned D>
+static ReplayDetector *ReplayCreateScaled(unsigned scale)
+{
+  switch (scale) {
+    case 2048: return new ReplayDetectorOf<SensorConfig<Base, D, 2048>>(_calibrate, _still);
+    case 4096: return new ReplayDetectorOf<SensorConfig<Base, D, 4096>>(_calibrate, _still);
+    case 8192: return new ReplayDetectorOf<SensorConfig<Base, D, 8192>>(_calibrate, _still);
+    case 16384: return new ReplayDetectorOf<SensorConfig<Base, D, 16384>>(_calibrate, _still);
+  }
+  return NULL;
+}
+
+template <class Base>
+static ReplayDetector *ReplayCreateRated(const TRACE_HEADER_T &header)
+{
+  switch (header.rate) {
+    case 20: return ReplayCreateScaled<Base, 1>(header.scale);
+    case 200: return ReplayCreateScaled<Base, 10>(header.scale);
+  }
+  return NULL;
+}
+
+/*
+   the detector for the configuration and the trace, NULL if there is none
+*/
+static ReplayDetector *ReplayCreate(const TRACE_HEADER_T &header)
+{
+  if (header.channels != 3)
+    return NULL;
+  if (_config == "machineESP")
+    return ReplayCreateRated<MachineEspConfig>(header);
+  if (_config == "1MPU")
+    return ReplayCreateRated<AccelerometerConfig>(header);
+  if (_config == "dryer")
+    return ReplayCreateRated<DryerConfig>(header);
+  if (_config == "wake")
+    return ReplayCreateRated<WakeConfig>(header);
+  return NULL;
+}
+
+/*
+   read the labels
+*/
+static bool ReplayReadLabels(const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  char line[256], name[32];
+  double time;
+
+  if (!fp) {
+    perror(path);
+    return false;
+  }
+  while (fgets(line, sizeof(line), fp)) {
+    if (line[0] == '#' || sscanf(line, "%lf %31s", &time, name) != 2)
+      continue;
+    for (int event = 0; event < BENCH_EVENTS; event++)
+      if (!strcmp(name, _bench_events[event]))
+        _truth.push_back({ time, event, false });
+  }
+  fclose(fp);
+  return true;
+}
+
+/*
+   match the transitions with the labels -- the nearest label within the tolerance
+*/
+static void ReplayScore(void)
+{
+  BENCH_SCORE_T score;
+
+  BenchScore(_transitions, _truth, _tolerance, &score);
+  if (!_quiet) {
+    for (const BENCH_TRANSITION_T &transition : _transitions)
+      if (!transition.hit)
+        printf("%s %-8s false positive\n", ReplayClock(transition.time), _bench_events[transition.event]);
+    for (const BENCH_TRANSITION_T &label : _truth)
+      if (!label.hit)
+        printf("%s %-8s false negative\n", ReplayClock(label.time), _bench_events[label.event]);
+  }
+
+  printf("%-10s %8s %8s %8s %10s\n", "event", "hits", "false +", "false -", "delay");
+  for (int event = 0; event < BENCH_EVENTS; event++)
+    printf("%-10s %8lu %8lu %8lu %8.1f s\n", _bench_events[event], score.hits[event], score.positives[event],
+           score.negatives[event], BenchDelay(score, event));
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "c:abl:w:x:qp")) != -1) {
+    switch (opt) {
+      case 'c': _config = optarg; break;
+      case 'a': _calibrate = true; break;
+      case 'b': _still = true; break;
+      case 'l': _labels = optarg; break;
+      case 'w': _tolerance = atof(optarg); break;
+      case 'x': _speed = atof(optarg); break;
+      case 'q': _quiet = true; break;
+      case 'p': _print = true; break;
+      default:
+        optind = argc + 1;
+        break;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-c <machineESP|1MPU|dryer|wake>] [-a] [-b] [-l <labels>] [-w <tolerance s>] "
+            "[-x <speed, 0 = max>] [-q] [-p] <trace>...\n", argv[0]);
+    return 1;
+  }
+  if (_labels && !ReplayReadLabels(_labels))
+    return 1;
+
+  std::unique_ptr<ReplayDetector> detector;
+  TRACE_HEADER_T first = {};
+  TRACE_READ_STATS_T total = {};
+  double offset = 0, end = 0, start = BenchTime();
+  bool running = false, empty = true;
+
+  for (int file = optind; file < argc; file++) {
+    FILE *fp = fopen(argv[file], "rb");
+    TRACE_READ_STATS_T stats;
+    bool failed = false;
+
+    if (!fp) {
+      perror(argv[file]);
+      return 1;
+    }
+
+    auto header = [&](const TRACE_HEADER_T &header) {
+      offset = end;
+      if (_print) {
+        if (!first.channels)
+          printf("time,%s\n", (header.channels == 3) ? "x,y,z" : "a,b,c,d");
+        first = header;
+        return;
+      }
+      if (first.channels && (header.channels != first.channels || header.rate != first.rate ||
+                             header.scale != first.scale)) {
+        fprintf(stderr, "%s: the recordings differ in channels, rate or range\n", argv[file]);
+        failed = true;
+        return;
+      }
+      if (!first.channels) {
+        detector.reset(ReplayCreate(header));
+        if (!detector) {
+          fprintf(stderr, "%s: no detector %s for %u channels at %u Hz, %u LSB/g\n", argv[file],
+                  _config.c_str(), header.channels, header.rate, header.scale);
+          failed = true;
+          return;
+        }
+      }
+      first = header;
+    };
+    auto frame = [&](uint32_t index, const int32_t *values) {
+      double time = offset + (double) index / first.rate;
+
+      end = time + 1.0 / first.rate;
+      if (_print) {
+        printf("%.3f", time);
+        for (unsigned c = 0; c < first.channels; c++)
+          printf(",%d", values[c]);
+        printf("\n");
+        return;
+      }
+      if (failed)
+        return;
+      detector->update(values);
+      if (detector->running() != running)
+        _transitions.push_back({ time, (running) ? BENCH_STOPPED : BENCH_STARTED, false });
+      if (detector->empty() && !empty)
+        _transitions.push_back({ time, BENCH_EMPTIED, false });
+      running = detector->running();
+      empty = detector->empty();
+
+      if (_speed > 0 && index % first.rate == 0) {
+        double ahead = start + time / _speed - BenchTime();
+
+        if (ahead > 0)
+          std::this_thread::sleep_for(std::chrono::duration<double>(ahead));
+      }
+    };
+
+    if (!TraceRead(fp, header, frame, &stats) || failed) {
+      if (!failed)
+        fprintf(stderr, "%s: not a trace\n", argv[file]);
+      fclose(fp);
+      return 1;
+    }
+    fclose(fp);
+    total.headers += stats.headers;
+    total.blocks += stats.blocks;
+    total.frames += stats.frames;
+    total.lost += stats.lost;
+    total.bad += stats.bad;
+  }
+  if (_print)
+    return 0;
+
+  double wall = BenchTime() - start;
+
+  if (!_quiet)
+    for (const BENCH_TRANSITION_T &transition : _transitions)
+      printf("%s %s\n", ReplayClock(transition.time), _bench_events[transition.event]);
+
+  printf("REPLAY: %s%s%s, %lu recordings, %lu frames (%s) at %u Hz, %lu lost, %lu bad blocks\n",
+         _config.c_str(), (_calibrate) ? " calibrated" : "", (_still) ? " bands" : "", total.headers, total.frames, ReplayClock(end), first.rate, total.lost, total.bad);
+  printf("REPLAY: %zu transitions in %.2f s, %.1f M samples/s, %.0f x real time\n", _transitions.size(),
+         wall, total.frames / wall / 1e6, end / wall);
+  if (_labels)
+    ReplayScore();
+  return 0;
+}
+
+/**/
@@ -0,0 +1,248 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  calibration of the thresholds of the detector to the machine
+
+  The thresholds of the configuration (kRunning, kDoorOpening,
+  kDoorClosing) differ per sketch, and a machine vibrates more or less
+  than the one they were tuned on. The calibration learns the machine
+  from the activities of the detector, one per window (1 s):
+
+    idle      the activities at rest
+    running   the activities above the rest -- once the rest is learned
+    jumps     the peak jumps of the small activity at rest, the noise
+              under the door
+
+  Of each it keeps an estimate of the median and of the MAD (the median
+  of the deviations from the median) in O(1): every value moves the
+  estimate by a step towards it, the step is 1/2^kRate of the MAD, so the
+  estimate follows a change of the machine exponentially and a door slam
+  or a neighbour moves it by a step and no more.
+
+  After kLearnIdle windows at rest the door thresholds are raised above
+  the noise (median + kDoorMads MAD), if it is above them -- the closing
+  as much as the opening. After kLearnRunning windows running the
+  machine is started half way between the bound of the rest (median +
+  kIdleMads MAD) and the one of running (median - kRunningMads MAD), and
+  kept running down to a quarter of the way -- a quiet phase of the
+  cycle doesn't stop it. If the two don't separate, the thresholds of the
+  configuration are kept. The derived ones stay within 1/kRange to kRange
+  of the configured.
+
+  The estimates are a few bytes (ACTIVITY_CALIBRATION_T), the sketch keeps
+  them in the NVS or the RTC memory and restores them after a boot, so
+  the calibration isn't learned again. A new calibration is zero, like
+  the detector, and learns from scratch.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __ACTIVITYCALIBRATION_H__
+#define __ACTIVITYCALIBRATION_H__ 1
+
+#include <stdint.h>
+#include "ActivityDetector.h"
+
+/*
+   the version of the saved estimates -- others are not restored
+*/
+#define CALIBRATION_VERSION     1
+
+/*
+   the thresholds in a byte of the advertisement of a sensor -- the average in 1/16 g, the door in 1/64 g
+*/
+#define CALIBRATION_BYTE_RUNNING 16
+#define CALIBRATION_BYTE_DOOR   64
+
+/*
+   an estimate of the median and the MAD in the fixed point
+*/
+typedef struct _activity_estimate {
+  uint32_t median;
+  uint32_t mad;
+  uint32_t count;               // values since cleared
+} ACTIVITY_ESTIMATE_T;
+
+/*
+   the saved estimates
+*/
+typedef struct _activity_calibration {
+  uint32_t version;
+  ACTIVITY_ESTIMATE_T idle;
+  ACTIVITY_ESTIMATE_T running;
+  ACTIVITY_ESTIMATE_T jumps;
+} ACTIVITY_CALIBRATION_T;
+
+/*
+   move the estimate by a step of 1/2^rate MAD towards the value
+*/
+static inline void ActivityEstimate(ACTIVITY_ESTIMATE_T *estimate, uint32_t value, unsigned rate)
+{
+  auto towards = [](uint32_t current, uint32_t target, uint32_t step) {
+    if (target > current)
+      return current + ((target - current < step) ? target - current : step);
+    return current - ((current - target < step) ? current - target : step);
+  };
+
+  if (!estimate->count) {
+    estimate->median = value;
+    estimate->mad = value / 8;
+  }
+
+  uint32_t step = (estimate->mad >> rate) + 1;
+
+  estimate->median = towards(estimate->median, value, step);
+  estimate->mad = towards(estimate->mad, (value > estimate->median) ? value - estimate->median : estimate->median - value,
+                          step);
+  if (estimate->count < UINT32_MAX)
+    estimate->count++;
+}
+
+/*
+   a threshold in a byte of the advertisement, saturated -- per_g is one of CALIBRATION_BYTE_*
+*/
+static inline uint8_t CalibrationByte(uint32_t units, unsigned per_g)
+{
+  uint64_t value = ((uint64_t) units * per_g + ACTIVITY_UNITS_PER_G / 2) / ACTIVITY_UNITS_PER_G;
+
+  return (value > 255) ? 255 : value;
+}
+
+/*
+   the configuration -- derive from it and override what differs
+*/
+struct CalibrationConfig {
+  static constexpr unsigned kRate = 6;            // the estimates move by 1/64 MAD per window
+  static constexpr uint32_t kLearnIdle = 1800;    // windows at rest before the door is calibrated (30 min)
+  static constexpr uint32_t kLearnRunning = 900;  // windows running before running is calibrated (15 min)
+  static constexpr unsigned kIdleMads = 8;        // the rest is below its median + kIdleMads MAD
+  static constexpr unsigned kRunningMads = 2;     // running is above its median - kRunningMads MAD
+  static constexpr unsigned kDoorMads = 10;       // the door is above the median jump + kDoorMads MAD
+  static constexpr unsigned kRange = 4;           // the thresholds stay within 1/kRange to kRange of the configured
+};
+
+template <class Config = CalibrationConfig>
+class ActivityCalibration {
+  public:
+    /*
+       forget the machine
+    */
+    void clear(void)
+    {
+      _state = ACTIVITY_CALIBRATION_T();
+    }
+
+    /*
+       learn from the last window of the detector and set its thresholds -- called on every ACTIVITY_TICK,
+       returns true if the running thresholds were derived for the first time
+    */
+    template <class Detector>
+    bool update(Detector &detector)
+    {
+      uint32_t activity = detector.activityUnits();
+      bool calibrated = this->calibrated();
+
+      if (_state.idle.count >= Config::kLearnIdle && activity > idle())
+        ActivityEstimate(&_state.running, activity, Config::kRate);
+      else {
+        ActivityEstimate(&_state.idle, activity, Config::kRate);
+        if (!detector.running())
+          ActivityEstimate(&_state.jumps, detector.jump(), Config::kRate);
+      }
+      apply(detector);
+      return !calibrated && this->calibrated();
+    }
+
+    /*
+       set the thresholds of the detector -- the configured ones while learning
+    */
+    template <class Detector>
+    void apply(Detector &detector) const
+    {
+      ACTIVITY_THRESHOLDS_T thresholds = {};
+
+      if (_state.idle.count >= Config::kLearnIdle) {
+        uint32_t noise = _state.jumps.median + Config::kDoorMads * _state.jumps.mad;
+
+        /*
+           the closing is raised as much as the opening, it is the louder one
+        */
+        if (Detector::kDoorOpening && noise > Detector::kDoorOpening) {
+          thresholds.opening = noise;
+          thresholds.closing = (uint64_t) Detector::kDoorClosing * noise / Detector::kDoorOpening;
+        }
+        else if (!Detector::kDoorOpening && noise > Detector::kDoorClosing)
+          thresholds.closing = noise;
+      }
+      if (calibrated()) {
+        uint32_t low = idle(), high = running();
+
+        thresholds.running = Clamp(low + (high - low) / 2, Detector::kRunning);
+        thresholds.stopped = Clamp(low + (high - low) / 4, Detector::kRunning);
+      }
+      detector.setThresholds(&thresholds);
+    }
+
+    /*
+       the running thresholds are derived
+    */
+    bool calibrated(void) const
+    {
+      return _state.idle.count >= Config::kLearnIdle && _state.running.count >= Config::kLearnRunning &&
+             running() > idle();
+    }
+
+    /*
+       save/restore the estimates -- restoring fails if they are of another version
+    */
+    void save(ACTIVITY_CALIBRATION_T *state) const
+    {
+      *state = _state;
+      state->version = CALIBRATION_VERSION;
+    }
+
+    bool restore(const ACTIVITY_CALIBRATION_T *state)
+    {
+      if (state->version != CALIBRATION_VERSION)
+        return false;
+      _state = *state;
+      return true;
+    }
+
+  private:
+    /*
+       the bound of the rest and of running
+    */
+    uint32_t idle(void) const
+    {
+      return _state.idle.median + Config::kIdleMads * _state.idle.mad;
+    }
+
+    uint32_t running(void) const
+    {
+      uint32_t spread = Config::kRunningMads * _state.running.mad;
+
+      return (_state.running.median > spread) ? _state.running.median - spread : 0;
+    }
+
+    static uint32_t Clamp(uint32_t value, uint32_t configured)
+    {
+      if (value < configured / Config::kRange)
+        return configured / Config::kRange;
+      if (value > configured * Config::kRange)
+        return configured * Config::kRange;
+      return value;
+    }
+
+    ACTIVITY_CALIBRATION_T _state;
+};
+
+#endif
+
+/**/
@@ -0,0 +1,497 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  detector of the machine state out of the vibration
+
+  The detector is fed with the magnitude of the acceleration every sample
+  (50 ms). The change of the magnitude to the previous sample is summed
+  up in three rolling windows:
+
+    activity        the changes of the last kWindow samples (1 s)
+    average         the activities of the last kAverage windows, updated
+                    once per window -- the machine is running while it is
+                    above kRunning
+    small activity  the changes of the last kSmall samples (0.2 s) -- a
+                    jump of it to the one kLag samples ago is the door
+
+  While the machine is stopped and loaded, the door is watched: it is
+  opened, it stays open for a quiet time and it is closed again. If it
+  was open for more than kQuietEmpty samples (or is still open after
+  kQuietOpen samples), the clothes were removed and the machine is empty.
+  If it was closed quickly, somebody just had a look, and the door is
+  ignored for kCooldown samples. With kDoorOpening 0 the opening is not
+  detected, every jump of kDoorClosing empties the machine, with
+  kDoorClosing 0 the door is not detected by the vibration at all.
+
+  The magnitudes are fixed point (ACTIVITY_UNITS_PER_G), the thresholds
+  are converted at compile time, so the windows don't drift and the
+  comparisons are integer. All times are in samples.
+
+  The raw values of the MPU are passed without float and without sqrt():
+  the square of the magnitude is summed in 32 bit, its integer square
+  root is refined by one step of Taylor, sqrt(r² + d) = r + d / 2r, to
+  the fixed point -- within 1 unit of the exact value.
+
+  Sampled faster (eg. from the FIFO of the MPU), the detector is passed
+  kDecimate magnitudes per sample of 50 ms. The change is then taken
+  over kDecimate magnitudes, ie. still over 50 ms, so the thresholds keep
+  their scale. Of a block of kDecimate changes, the activity gets the
+  mean -- the same value as sampled every 50 ms, with less noise -- and
+  the small activity gets the max., so a door latch of a few ms is not
+  missed between two samples.
+
+  The thresholds of the configuration can be replaced at run time
+  (setThresholds(), eg. by the ActivityCalibration of the machine), also
+  with a lower one to stop than to start. The modes of the door stay the
+  ones of the configuration, clear() keeps the thresholds.
+
+  A machine that is still by other means (setStill(), eg. by the
+  VibrationBands) is stopped at the first window below the threshold,
+  instead of when the average is.
+
+  A detector left alone for a while (age(), eg. over the deep sleep of a
+  sensor) doesn't take the windows of before as if no time had passed:
+  the window begun and the small activity start over, and the activities
+  of the windows slept through are taken to be the one of the next
+  window -- after a sleep of kAverage windows and more, the first window
+  of the wake up decides alone. The state of the machine, the door and
+  the thresholds are kept, the door counts the time slept.
+
+  The peak jump of the small activity of the last window is kept (jump())
+  -- at rest, the noise the door thresholds have to be above.
+
+  The detector has no constructor, like the RollingWindow. A new detector
+  is a stopped, empty machine with the thresholds of the configuration.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __ACTIVITYDETECTOR_H__
+#define __ACTIVITYDETECTOR_H__ 1
+
+#include <stdint.h>
+#include "RollingWindow.h"
+
+/*
+   the fixed point of the magnitudes -- 1 g, max. 16 g * sqrt(3) per axis
+*/
+#define ACTIVITY_UNITS_PER_G    65536
+
+/*
+   the events of an update
+*/
+#define ACTIVITY_TICK           0x01    // the average was updated
+#define ACTIVITY_STARTED        0x02
+#define ACTIVITY_STOPPED        0x04
+#define ACTIVITY_DOOR_OPENED    0x08
+#define ACTIVITY_DOOR_CLOSED    0x10
+#define ACTIVITY_EMPTIED        0x20    // the clothes were removed
+#define ACTIVITY_CHECKED        0x40    // the door was closed quickly
+
+/*
+   thresholds in the fixed point, 0 is the one of the configuration
+*/
+typedef struct _activity_thresholds {
+  uint32_t running;             // average activity to start
+  uint32_t stopped;             // average activity to keep running, at most running
+  uint32_t opening;             // jumps of the small activity
+  uint32_t closing;
+} ACTIVITY_THRESHOLDS_T;
+
+/*
+   convert g into the fixed point
+*/
+constexpr uint32_t ActivityUnits(float g)
+{
+  return (uint32_t) (g * ACTIVITY_UNITS_PER_G + 0.5f);
+}
+
+/*
+   the integer square root -- floor(sqrt(n)), 16 steps without a branch
+*/
+static inline uint32_t ActivitySqrt(uint32_t n)
+{
+  uint32_t root = 0;
+
+  for (uint32_t bit = 1UL << 30; bit; bit >>= 2) {
+    uint32_t mask = -(uint32_t) (n >= root + bit);
+
+    n -= (root + bit) & mask;
+    root = (root >> 1) + (bit & mask);
+  }
+  return root;
+}
+
+/*
+   the magnitude of the raw values in the fixed point -- scale is ACTIVITY_UNITS_PER_G / LSB per g
+*/
+static inline uint32_t ActivityMagnitude(int16_t x, int16_t y, int16_t z, uint32_t scale)
+{
+  uint32_t square = (uint32_t) ((int32_t) x * x) + (uint32_t) ((int32_t) y * y) + (uint32_t) ((int32_t) z * z);
+
+  if (!square)
+    return 0;
+
+  /*
+     the square in the top bits, so the root has 16 bits and the step of Taylor is off by less than 1/1000 units
+  */
+  unsigned shift = __builtin_clz(square) & ~1;
+  uint32_t root = ActivitySqrt(square << shift);
+  uint32_t fine = scale * root + (scale * ((square << shift) - root * root) + root) / (2 * root);
+
+  shift /= 2;
+  return (shift) ? (fine + (1UL << (shift - 1))) >> shift : fine;
+}
+
+/*
+   the configuration -- derive from it and override what differs
+*/
+struct ActivityConfig {
+  static constexpr unsigned kLsbPerG = 2048;      // of the raw values, +-16g
+  static constexpr unsigned kDecimate = 1;        // magnitudes per sample
+  static constexpr unsigned kWindow = 20;         // samples of the activity
+  static constexpr unsigned kAverage = 15;        // activities of the average
+  static constexpr unsigned kSmall = 4;           // samples of the small activity
+  static constexpr unsigned kLag = 5;             // the small activity is compared with the one kLag samples ago
+  static constexpr float kRunning = 3.0;          // average activity in g
+  static constexpr float kDoorOpening = 0.45;     // jump of the small activity in g, 0 if not detected
+  static constexpr float kDoorClosing = 0.9;      // jump of the small activity in g, 0 if not detected
+  static constexpr unsigned kQuietMin = 40;       // the closing is looked for after the door was open for ...
+  static constexpr unsigned kQuietEmpty = 80;     // the door was open longer: the clothes were removed
+  static constexpr unsigned kQuietOpen = 2400;    // the door is still open: the clothes were removed
+  static constexpr unsigned kCooldown = 20;       // the door is ignored after a quick look
+};
+
+template <class Config = ActivityConfig>
+class ActivityDetector {
+  static_assert(ACTIVITY_UNITS_PER_G % Config::kLsbPerG == 0, "the raw values are scaled to the fixed point by an integer");
+
+  public:
+    /*
+       the thresholds in the fixed point -- the average is compared as the sum of kAverage activities
+    */
+    static constexpr uint32_t kRunning = ActivityUnits(Config::kRunning);
+    static constexpr uint32_t kRunningSum = kRunning * Config::kAverage;
+    static constexpr uint32_t kDoorOpening = ActivityUnits(Config::kDoorOpening);
+    static constexpr uint32_t kDoorClosing = ActivityUnits(Config::kDoorClosing);
+
+    /*
+       reset to a stopped, empty machine
+    */
+    void clear(void)
+    {
+      _deltas.clear();
+      _activities.clear();
+      _small.clear();
+      _history.clear();
+      _magnitudes.clear();
+      _block = 0;
+      _peak = 0;
+      _jump = 0;
+      _jumpPeak = 0;
+      _phase = 0;
+      _sample = 0;
+      _quiet = 0;
+      _cooldown = 0;
+      _stale = 0;
+      _still = false;
+      _running = false;
+      _loaded = false;
+      _opened = false;
+      _closed = false;
+    }
+
+    /*
+       the detector was left alone for samples -- the windows slept through are taken to be the next one
+    */
+    void age(unsigned samples)
+    {
+      unsigned windows = (_sample + samples) / Config::kWindow + _stale;
+
+      _deltas.clear();
+      _small.clear();
+      _history.clear();
+      _block = 0;
+      _peak = 0;
+      _jump = 0;
+      _phase = 0;
+      _sample = 0;
+      _stale = (windows < Config::kAverage) ? windows : Config::kAverage - 1;
+      if (_opened && !_closed)
+        _quiet += samples;
+      _cooldown = (_cooldown > samples) ? _cooldown - samples : 0;
+    }
+
+    /*
+       pass the next magnitude in g -- returns the events
+    */
+    unsigned update(float magnitude)
+    {
+      return updateUnits(ActivityUnits(magnitude));
+    }
+
+    /*
+       pass the next raw values of the MPU -- returns the events
+    */
+    unsigned updateRaw(int16_t x, int16_t y, int16_t z)
+    {
+      return updateUnits(ActivityMagnitude(x, y, z, ACTIVITY_UNITS_PER_G / Config::kLsbPerG));
+    }
+
+    /*
+       pass the next magnitude in the fixed point -- returns the events
+    */
+    unsigned updateUnits(uint32_t magnitude)
+    {
+      uint32_t previous = _magnitudes.ago(Config::kDecimate - 1);
+      uint32_t delta = (magnitude > previous) ? magnitude - previous : previous - magnitude;
+      unsigned events = 0;
+
+      _magnitudes.push(magnitude);
+      _block += delta;
+      if (delta > _peak)
+        _peak = delta;
+      if (++_phase < Config::kDecimate)
+        return 0;
+
+      _deltas.push(_block / Config::kDecimate);
+      _history.push(_small.push(_peak));
+      _block = 0;
+      _peak = 0;
+      _phase = 0;
+      if (_history.ago(0) > _history.ago(Config::kLag) + _jump)
+        _jump = _history.ago(0) - _history.ago(Config::kLag);
+
+      if (++_sample >= Config::kWindow) {
+        _sample = 0;
+        _jumpPeak = _jump;
+        _jump = 0;
+        events |= ACTIVITY_TICK;
+
+        uint32_t threshold = (_running) ? Threshold(_stop, kRunningSum) : Threshold(_start, kRunningSum);
+        bool still = _still && _deltas.sum() * Config::kAverage <= threshold;
+
+        uint32_t activity = _deltas.sum();
+        uint32_t average = _activities.push(activity);
+
+        for (; _stale; _stale--)
+          average = _activities.push(activity);
+        if (average > threshold && !still) {
+          if (!_running)
+            events |= ACTIVITY_STARTED;
+          _running = true;
+          _loaded = true;
+          _opened = _closed = false;
+        }
+        else {
+          if (_running)
+            events |= ACTIVITY_STOPPED;
+          _running = false;
+        }
+      }
+
+      if (kDoorClosing)
+        events |= (kDoorOpening) ? door() : bump();
+
+      return events;
+    }
+
+    /*
+       replace the thresholds of the configuration -- NULL restores them
+    */
+    void setThresholds(const ACTIVITY_THRESHOLDS_T *thresholds)
+    {
+      ACTIVITY_THRESHOLDS_T none = {};
+
+      if (!thresholds)
+        thresholds = &none;
+      _start = thresholds->running * Config::kAverage;
+      _stop = thresholds->stopped * Config::kAverage;
+      if (_stop > Threshold(_start, kRunningSum))
+        _stop = Threshold(_start, kRunningSum);
+      _opening = thresholds->opening;
+      _closing = thresholds->closing;
+    }
+
+    /*
+       the thresholds in use
+    */
+    void thresholds(ACTIVITY_THRESHOLDS_T *thresholds) const
+    {
+      thresholds->running = Threshold(_start, kRunningSum) / Config::kAverage;
+      thresholds->stopped = Threshold(_stop, Threshold(_start, kRunningSum)) / Config::kAverage;
+      thresholds->opening = (kDoorOpening) ? Threshold(_opening, kDoorOpening) : 0;
+      thresholds->closing = (kDoorClosing) ? Threshold(_closing, kDoorClosing) : 0;
+    }
+
+    /*
+       the machine is still -- detected outside of the detector
+    */
+    void setStill(bool still)
+    {
+      _still = still;
+    }
+
+    /*
+       the machine was emptied -- detected outside of the detector
+    */
+    void setEmpty(void)
+    {
+      _loaded = false;
+    }
+
+    bool running(void) const
+    {
+      return _running;
+    }
+
+    bool empty(void) const
+    {
+      return !_loaded;
+    }
+
+    /*
+       the samples the door is open
+    */
+    unsigned quiet(void) const
+    {
+      return _quiet;
+    }
+
+    /*
+       the last magnitude and the windows in g
+    */
+    float magnitude(void) const
+    {
+      return (float) _magnitudes.ago(0) / ACTIVITY_UNITS_PER_G;
+    }
+
+    float activity(void) const
+    {
+      return (float) _deltas.sum() / ACTIVITY_UNITS_PER_G;
+    }
+
+    float average(void) const
+    {
+      return (float) _activities.sum() / (Config::kAverage * (float) ACTIVITY_UNITS_PER_G);
+    }
+
+    float small(void) const
+    {
+      return (float) _small.sum() / ACTIVITY_UNITS_PER_G;
+    }
+
+    /*
+       the activity and the peak jump of the small activity of the last window in the fixed point
+    */
+    uint32_t activityUnits(void) const
+    {
+      return _activities.ago(0);
+    }
+
+    uint32_t jump(void) const
+    {
+      return _jumpPeak;
+    }
+
+  private:
+    static uint32_t Threshold(uint32_t value, uint32_t configured)
+    {
+      return (value) ? value : configured;
+    }
+
+    /*
+       the small activity jumped by more than change
+    */
+    bool jumped(uint32_t change) const
+    {
+      return _history.ago(0) > _history.ago(Config::kLag) + change;
+    }
+
+    /*
+       the door is opened, stays open for the quiet time and is closed
+    */
+    unsigned door(void)
+    {
+      unsigned events = 0;
+
+      if (!_running && _loaded && !_opened && !_cooldown) {
+        if (jumped(Threshold(_opening, kDoorOpening))) {
+          _opened = true;
+          events |= ACTIVITY_DOOR_OPENED;
+        }
+        _quiet = 0;
+      }
+      if (!_running && _loaded && _opened && !_closed) {
+        if (jumped(Threshold(_closing, kDoorClosing)) && _quiet > Config::kQuietMin) {
+          _closed = true;
+          events |= ACTIVITY_DOOR_CLOSED;
+        }
+        _quiet++;
+        if (_quiet > Config::kQuietOpen) {
+          _loaded = false;
+          events |= ACTIVITY_EMPTIED;
+        }
+      }
+      if (_opened && _closed) {
+        if (_quiet > Config::kQuietEmpty) {
+          if (_loaded)
+            events |= ACTIVITY_EMPTIED;
+          _loaded = false;
+        }
+        else {
+          _opened = _closed = false;
+          _cooldown = Config::kCooldown;
+          events |= ACTIVITY_CHECKED;
+        }
+      }
+      if (_cooldown)
+        _cooldown--;
+      return events;
+    }
+
+    /*
+       any jump of the small activity empties a stopped machine
+    */
+    unsigned bump(void)
+    {
+      if (_running || !_loaded || !jumped(Threshold(_closing, kDoorClosing)))
+        return 0;
+      _loaded = false;
+      return ACTIVITY_EMPTIED;
+    }
+
+    RollingWindow<uint32_t, Config::kWindow> _deltas;
+    RollingWindow<uint32_t, Config::kAverage> _activities;
+    RollingWindow<uint32_t, Config::kSmall> _small;
+    RollingWindow<uint32_t, Config::kLag + 1> _history;
+    RollingWindow<uint32_t, Config::kDecimate> _magnitudes;
+    uint32_t _block;
+    uint32_t _peak;
+    uint32_t _jump;
+    uint32_t _jumpPeak;
+    uint32_t _start;              // the thresholds, 0 is the configured
+    uint32_t _stop;
+    uint32_t _opening;
+    uint32_t _closing;
+    unsigned _phase;
+    unsigned _sample;
+    unsigned _quiet;
+    unsigned _cooldown;
+    unsigned _stale;              // windows slept through, replaced by the next one
+    bool _still;
+    bool _running;
+    bool _loaded;
+    bool _opened;
+    bool _closed;
+};
+
+#endif
+
+/**/
@@ -0,0 +1,430 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  phase of the cycle and the minutes remaining
+
+  A machine runs a few programmes, each with its profile: the activity
+  of the filling, the washing, the rinses and the spin, or of the heating
+  and the cooling of a dryer. The tracker learns them as templates, the
+  mean activity of every minute of a cycle, and matches the cycle that is
+  running against them:
+
+    minute    the activities of the windows of the detector (1 s) are
+              summed up, once a minute their mean is a byte of the
+              profile of the cycle
+    match     per template a column of an open ended dynamic time
+              warping (DTW) of the profile against the template is
+              advanced by the minute -- the cost to be at a minute of the
+              template now. The cheapest minute of the cheapest template
+              is the position, the rest of the template is the estimate
+              of the minutes remaining, its fraction the phase
+    learn     kGap minutes after the machine stopped the cycle is over,
+              its profile is merged into the template it matches (kMatch
+              per minute, the length within 1/kStretch) or replaces the
+              one of the fewest cycles
+
+  A stop shorter than kGap minutes (a pause of the washing, a spin that
+  is balanced out) is part of the cycle. A cycle is at most CYCLE_MINUTES
+  long, one shorter than kMinCycle minutes isn't learned.
+
+  The work of a window is a sum, the one of a minute is bounded by
+  CYCLE_TEMPLATES x CYCLE_MINUTES steps of the DTW, the learning at the
+  end of a cycle runs the DTW of the whole cycle once per template. The
+  templates are a few hundred bytes (CYCLE_TEMPLATES_T), the sketch keeps
+  them in the NVS and restores them after a boot. A new tracker is zero,
+  like the detector, it has no templates and learns from scratch.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __CYCLETRACKER_H__
+#define __CYCLETRACKER_H__ 1
+
+#include <stdint.h>
+#include <string.h>
+#include "ActivityDetector.h"
+
+/*
+   the version of the saved templates -- others are not restored
+*/
+#define CYCLE_VERSION           1
+
+/*
+   the templates and their max. length in minutes
+*/
+#define CYCLE_TEMPLATES         4
+#define CYCLE_MINUTES           180
+
+/*
+   the mean activity of a minute in a byte, in 1/8 g
+*/
+#define CYCLE_BYTE_PER_G        8
+
+/*
+   the phases of a cycle, the minutes remaining without an estimate
+*/
+#define CYCLE_PHASES            16
+#define CYCLE_UNKNOWN           0xFFFF
+
+/*
+   the events of an update
+*/
+#define CYCLE_MINUTE            0x01    // the estimate was updated
+#define CYCLE_LEARNED           0x02    // a cycle was learned into the templates
+
+/*
+   a template -- the profile of a programme
+*/
+typedef struct _cycle_template {
+  uint16_t minutes;             // the length, 0 if unused
+  uint16_t cycles;              // the cycles learned into it
+  uint8_t profile[CYCLE_MINUTES];
+} CYCLE_TEMPLATE_T;
+
+/*
+   the saved templates
+*/
+typedef struct _cycle_templates {
+  uint32_t version;
+  CYCLE_TEMPLATE_T templates[CYCLE_TEMPLATES];
+} CYCLE_TEMPLATES_T;
+
+/*
+   the minutes remaining in 5 bits of the advertisement of a sensor -- 0 without an estimate, 1 to 30 at most 5 x n
+   minutes, CYCLE_REMAINING_OVER more than 150 minutes
+*/
+#define CYCLE_REMAINING_OVER    31
+
+static inline uint8_t CycleRemainingBits(unsigned minutes)
+{
+  if (minutes == CYCLE_UNKNOWN)
+    return 0;
+
+  unsigned steps = (minutes + 4) / 5;
+
+  return (steps < 1) ? 1 : (steps >= CYCLE_REMAINING_OVER) ? CYCLE_REMAINING_OVER : steps;
+}
+
+/*
+   the configuration -- derive from it and override what differs
+*/
+struct CycleConfig {
+  static constexpr unsigned kTicks = 60;          // windows of the detector per minute
+  static constexpr unsigned kGap = 5;             // minutes stopped within a cycle
+  static constexpr unsigned kMinCycle = 10;       // minutes of a cycle to learn it
+  static constexpr unsigned kSettle = 3;          // minutes of a cycle before an estimate
+  static constexpr unsigned kWarp = 8;            // cost of a minute stretched or skipped, in 1/8 g
+  static constexpr unsigned kMatch = 12;          // mean cost per minute of a match, in 1/8 g
+  static constexpr unsigned kStretch = 4;         // the lengths of a match differ by 1/kStretch at most
+  static constexpr unsigned kWeight = 8;          // the cycles a template is the mean of, at most
+};
+
+template <class Config = CycleConfig>
+class CycleTracker {
+  public:
+    /*
+       forget the templates and the cycle
+    */
+    void clear(void)
+    {
+      _state = CYCLE_TEMPLATES_T();
+      _tracking = false;
+      _now = false;
+    }
+
+    /*
+       pass the last window of the detector -- called on every ACTIVITY_TICK, returns the events
+    */
+    template <class Detector>
+    unsigned update(const Detector &detector)
+    {
+      unsigned events = 0;
+
+      _now = detector.running();
+      if (!_tracking) {
+        if (!_now)
+          return 0;
+        start();
+      }
+      _sum += detector.activityUnits();
+      _moving |= _now;
+      if (++_ticks < Config::kTicks)
+        return 0;
+
+      uint64_t mean = (uint64_t) _sum * CYCLE_BYTE_PER_G / ((uint64_t) Config::kTicks * ACTIVITY_UNITS_PER_G);
+      uint8_t value = (mean > 255) ? 255 : mean;
+
+      if (_moving) {
+        _gap = 0;
+        _last = _elapsed + 1;
+      }
+      else
+        _gap++;
+      if (_elapsed < CYCLE_MINUTES) {
+        _profile[_elapsed] = value;
+        locate(value);
+      }
+      _elapsed++;
+      _sum = 0;
+      _ticks = 0;
+      _moving = false;
+      events |= CYCLE_MINUTE;
+
+      if (_gap >= Config::kGap) {
+        _tracking = false;
+        if (learn())
+          events |= CYCLE_LEARNED;
+      }
+      return events;
+    }
+
+    /*
+       a cycle is tracked, the machine running or within kGap minutes of a stop
+    */
+    bool tracking(void) const
+    {
+      return _tracking;
+    }
+
+    /*
+       the minutes since the start, the template matched (-1 if none)
+    */
+    unsigned elapsed(void) const
+    {
+      return _elapsed;
+    }
+
+    int match(void) const
+    {
+      return (estimated()) ? _match : -1;
+    }
+
+    /*
+       the minutes remaining and the phase 0 to CYCLE_PHASES - 1 -- CYCLE_UNKNOWN/0 without an estimate
+    */
+    unsigned remaining(void) const
+    {
+      if (!estimated())
+        return CYCLE_UNKNOWN;
+      return _state.templates[_match].minutes - 1 - _position;
+    }
+
+    unsigned phase(void) const
+    {
+      if (!estimated())
+        return 0;
+      return _position * CYCLE_PHASES / _state.templates[_match].minutes;
+    }
+
+    /*
+       the templates learned
+    */
+    unsigned templates(void) const
+    {
+      unsigned count = 0;
+
+      for (unsigned k = 0; k < CYCLE_TEMPLATES; k++)
+        if (_state.templates[k].minutes)
+          count++;
+      return count;
+    }
+
+    /*
+       save/restore the templates -- restoring fails if they are of another version
+    */
+    void save(CYCLE_TEMPLATES_T *state) const
+    {
+      *state = _state;
+      state->version = CYCLE_VERSION;
+    }
+
+    bool restore(const CYCLE_TEMPLATES_T *state)
+    {
+      if (state->version != CYCLE_VERSION)
+        return false;
+      for (unsigned k = 0; k < CYCLE_TEMPLATES; k++)
+        if (state->templates[k].minutes > CYCLE_MINUTES)
+          return false;
+      _state = *state;
+      _tracking = false;
+      return true;
+    }
+
+  private:
+    static constexpr uint16_t kInfinite = 0xFFFF;
+
+    /*
+       the estimate is valid -- running, settled and matched
+    */
+    bool estimated(void) const
+    {
+      return _tracking && _now && _match >= 0 && _elapsed >= Config::kSettle &&
+             _cost <= (uint32_t) Config::kMatch * ((_elapsed < CYCLE_MINUTES) ? _elapsed : CYCLE_MINUTES);
+    }
+
+    void start(void)
+    {
+      for (unsigned k = 0; k < CYCLE_TEMPLATES; k++)
+        for (unsigned j = 0; j < CYCLE_MINUTES; j++)
+          _costs[k][j] = kInfinite;
+      _tracking = true;
+      _elapsed = 0;
+      _last = 0;
+      _gap = 0;
+      _sum = 0;
+      _ticks = 0;
+      _moving = false;
+      _match = -1;
+      _position = 0;
+      _cost = 0;
+    }
+
+    /*
+       advance the column of the DTW of a template by a minute of the cycle -- first is the first minute
+    */
+    static void Step(uint16_t *costs, const CYCLE_TEMPLATE_T &pattern, uint8_t value, bool first)
+    {
+      uint32_t diagonal = (first) ? 0 : kInfinite, below = kInfinite;
+
+      for (unsigned j = 0; j < pattern.minutes; j++) {
+        uint32_t previous = costs[j];
+        uint32_t best = diagonal;
+
+        if (previous + Config::kWarp < best)
+          best = previous + Config::kWarp;
+        if (below + Config::kWarp < best)
+          best = below + Config::kWarp;
+        best += (value > pattern.profile[j]) ? value - pattern.profile[j] : pattern.profile[j] - value;
+        costs[j] = (best < kInfinite) ? best : kInfinite;
+        diagonal = previous;
+        below = costs[j];
+      }
+    }
+
+    /*
+       the position of the cycle in the templates
+    */
+    void locate(uint8_t value)
+    {
+      _match = -1;
+      for (unsigned k = 0; k < CYCLE_TEMPLATES; k++) {
+        const CYCLE_TEMPLATE_T &pattern = _state.templates[k];
+
+        if (!pattern.minutes)
+          continue;
+        Step(_costs[k], pattern, value, !_elapsed);
+        for (unsigned j = 0; j < pattern.minutes; j++)
+          if (_match < 0 || _costs[k][j] < _cost) {
+            _match = k;
+            _position = j;
+            _cost = _costs[k][j];
+          }
+      }
+    }
+
+    /*
+       the profile of b minutes resampled to a of them, the mean of a weighted by weight
+    */
+    static void Merge(uint8_t *a, unsigned minutes, const uint8_t *b, unsigned length, unsigned weight,
+                      unsigned merged)
+    {
+      uint8_t result[CYCLE_MINUTES];
+
+      for (unsigned i = 0; i < merged; i++) {
+        unsigned ia = (2 * i * minutes + merged) / (2 * merged), ib = (2 * i * length + merged) / (2 * merged);
+
+        if (ia >= minutes)
+          ia = minutes - 1;
+        if (ib >= length)
+          ib = length - 1;
+        result[i] = (a[ia] * weight + b[ib] + (weight + 1) / 2) / (weight + 1);
+      }
+      memcpy(a, result, merged);
+    }
+
+    /*
+       learn the cycle that ended -- returns true if it was
+    */
+    bool learn(void)
+    {
+      unsigned length = (_last < CYCLE_MINUTES) ? _last : CYCLE_MINUTES;
+      int best = -1, fewest = -1;
+      uint32_t bestCost = 0;
+
+      if (length < Config::kMinCycle)
+        return false;
+
+      /*
+         the DTW of the whole cycle against every template, anchored at both ends
+      */
+      for (unsigned k = 0; k < CYCLE_TEMPLATES; k++) {
+        CYCLE_TEMPLATE_T &pattern = _state.templates[k];
+
+        if (!pattern.minutes) {
+          if (fewest < 0 || _state.templates[fewest].minutes)
+            fewest = k;
+          continue;
+        }
+        if (fewest < 0 || (_state.templates[fewest].minutes && pattern.cycles < _state.templates[fewest].cycles))
+          fewest = k;
+        for (unsigned j = 0; j < pattern.minutes; j++)
+          _costs[k][j] = kInfinite;
+        for (unsigned i = 0; i < length; i++)
+          Step(_costs[k], pattern, _profile[i], !i);
+
+        uint32_t cost = _costs[k][pattern.minutes - 1];
+        unsigned longer = (length > pattern.minutes) ? length : pattern.minutes;
+        unsigned stretch = (length > pattern.minutes) ? length - pattern.minutes : pattern.minutes - length;
+
+        if (cost <= (uint32_t) Config::kMatch * longer && stretch * Config::kStretch <= pattern.minutes &&
+            (best < 0 || cost < bestCost)) {
+          best = k;
+          bestCost = cost;
+        }
+      }
+
+      if (best >= 0) {
+        CYCLE_TEMPLATE_T &pattern = _state.templates[best];
+        unsigned weight = (pattern.cycles < Config::kWeight) ? pattern.cycles : Config::kWeight;
+        unsigned merged = (pattern.minutes * weight + length + weight / 2) / (weight + 1);
+
+        Merge(pattern.profile, pattern.minutes, _profile, length, weight, merged);
+        pattern.minutes = merged;
+        if (pattern.cycles < UINT16_MAX)
+          pattern.cycles++;
+      }
+      else {
+        CYCLE_TEMPLATE_T &pattern = _state.templates[fewest];
+
+        memcpy(pattern.profile, _profile, length);
+        pattern.minutes = length;
+        pattern.cycles = 1;
+      }
+      return true;
+    }
+
+    CYCLE_TEMPLATES_T _state;
+    uint16_t _costs[CYCLE_TEMPLATES][CYCLE_MINUTES];
+    uint8_t _profile[CYCLE_MINUTES];
+    uint32_t _sum;
+    uint32_t _cost;
+    unsigned _ticks;
+    unsigned _elapsed;
+    unsigned _last;
+    unsigned _gap;
+    unsigned _position;
+    int _match;
+    bool _tracking;
+    bool _moving;
+    bool _now;
+};
+
+#endif
+
+/**/
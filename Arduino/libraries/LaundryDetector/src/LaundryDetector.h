@@ -0,0 +1,32 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  the detector of the laundry machine sensors
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __LAUNDRYDETECTOR_H__
+#define __LAUNDRYDETECTOR_H__ 1
+
+#include "RollingWindow.h"
+#include "ActivityDetector.h"
+#include "ActivityCalibration.h"
+#include "VibrationBands.h"
+#include "CycleTracker.h"
+#include "MpuFifo.h"
+#include "SampleClock.h"
+#include "SleepPolicy.h"
+#include "RtcSnapshot.h"
+#include "SketchConfig.h"
+#include "SensorTrace.h"
+
+#endif
+
+/**/
@@ -0,0 +1,204 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  burst acquisition of the acceleration through the FIFO of the MPU-6050
+
+  The MPU samples the acceleration at its own rate (MPU_FIFO_RATE) into
+  its FIFO of 1024 bytes, a frame of 6 bytes per sample (x, y, z big
+  endian). The FIFO is drained every few hundred milliseconds in bursts
+  of up to MPU_FIFO_BURST bytes, one I2C transaction each, and the
+  samples are passed in a batch. So the CPU wakes up a few times per
+  second instead of once per sample, and the samples have the period of
+  the clock of the MPU instead of the jitter of the loop.
+
+  If the FIFO is full -- it was not drained within 1024 / 6 samples,
+  850 ms at 200 Hz -- the oldest frames are overwritten and the frames
+  are no longer aligned, so the FIFO is reset. Every frame since the
+  last drain is lost then: drain() takes the time of the drain and
+  lost() returns the frames the time since the last one stands for, so
+  the sketch holds its last sample over them in the detector like the
+  periods of SampleClock, and the windows stay a second of time.
+
+  The registers are accessed through the functions passed to begin(),
+  so the FIFO can be simulated on the host.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __MPUFIFO_H__
+#define __MPUFIFO_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+   the registers
+*/
+#define MPU_REG_SMPLRT_DIV      0x19
+#define MPU_REG_CONFIG          0x1a
+#define MPU_REG_FIFO_EN         0x23
+#define MPU_REG_USER_CTRL       0x6a
+#define MPU_REG_FIFO_COUNTH     0x72
+#define MPU_REG_FIFO_R_W        0x74
+
+#define MPU_FIFO_EN_ACCEL       0x08
+#define MPU_USER_CTRL_FIFO_EN   0x40
+#define MPU_USER_CTRL_FIFO_RST  0x04
+
+/*
+   the low pass filter of 94 Hz (DLPF_CFG 2), the internal rate is 1 kHz with it
+*/
+#define MPU_DLPF_94HZ           2
+#define MPU_INTERNAL_RATE       1000
+
+/*
+   the FIFO and its frames
+*/
+#define MPU_FIFO_SIZE           1024
+#define MPU_FIFO_FRAME          6
+
+/*
+   the sample rate in Hz
+*/
+#ifndef MPU_FIFO_RATE
+#define MPU_FIFO_RATE           200
+#endif
+
+/*
+   max. bytes of a burst -- the buffer of Wire has to be set to this size
+*/
+#ifndef MPU_FIFO_BURST
+#define MPU_FIFO_BURST          (84 * MPU_FIFO_FRAME)
+#endif
+
+/*
+   access to the registers, return false on an error of the bus
+*/
+typedef bool (*MpuRead)(uint8_t reg, uint8_t *data, size_t length);
+typedef bool (*MpuWrite)(uint8_t reg, uint8_t value);
+
+/*
+   statistics
+*/
+typedef struct _mpu_fifo_stats {
+  unsigned long frames;         // passed
+  unsigned long bursts;         // I2C transactions of frames
+  unsigned long drains;
+  unsigned long overflows;      // the FIFO was reset, the frames were lost
+  unsigned long lost;           // frames, by the overflows
+  unsigned long errors;         // of the bus
+} MPU_FIFO_STATS_T;
+
+class MpuFifo {
+  public:
+    /*
+       configure the rate and the filter and start the FIFO -- the range is set by the sketch
+    */
+    bool begin(MpuRead read, MpuWrite write)
+    {
+      _read = read;
+      _write = write;
+      _stats = MPU_FIFO_STATS_T();
+      _last = 0;
+      _lost = 0;
+      return _write(MPU_REG_CONFIG, MPU_DLPF_94HZ) &&
+             _write(MPU_REG_SMPLRT_DIV, MPU_INTERNAL_RATE / MPU_FIFO_RATE - 1) &&
+             _write(MPU_REG_FIFO_EN, MPU_FIFO_EN_ACCEL) &&
+             reset();
+    }
+
+    /*
+       drain the FIFO at us (esp_timer_get_time(), 0 if unknown) -- sample(x, y, z) is called for every frame
+       with the raw values, returns the frames
+    */
+    template <typename F>
+    size_t drain(F sample, uint64_t us = 0)
+    {
+      uint8_t count[2];
+      size_t length, frames = 0;
+
+      _stats.drains++;
+      _lost = 0;
+      if (!_read(MPU_REG_FIFO_COUNTH, count, sizeof(count))) {
+        _stats.errors++;
+        return 0;
+      }
+      length = (count[0] << 8) | count[1];
+      if (length > MPU_FIFO_SIZE - MPU_FIFO_FRAME) {
+        /*
+           the frames since the last drain -- a full FIFO at least
+        */
+        uint64_t elapsed = (us > _last && _last) ? (us - _last) * MPU_FIFO_RATE / 1000000 : 0;
+
+        _lost = (elapsed > MPU_FIFO_SIZE / MPU_FIFO_FRAME) ? (unsigned) elapsed : MPU_FIFO_SIZE / MPU_FIFO_FRAME;
+        _last = us;
+        _stats.overflows++;
+        _stats.lost += _lost;
+        if (!reset())
+          _stats.errors++;
+        return 0;
+      }
+      _last = us;
+
+      while (length >= MPU_FIFO_FRAME) {
+        size_t burst = (length < MPU_FIFO_BURST) ? length - length % MPU_FIFO_FRAME : MPU_FIFO_BURST;
+
+        if (!_read(MPU_REG_FIFO_R_W, _buffer, burst)) {
+          _stats.errors++;
+          break;
+        }
+        _stats.bursts++;
+        for (size_t n = 0; n < burst; n += MPU_FIFO_FRAME)
+          sample((int16_t) ((_buffer[n + 0] << 8) | _buffer[n + 1]),
+                 (int16_t) ((_buffer[n + 2] << 8) | _buffer[n + 3]),
+                 (int16_t) ((_buffer[n + 4] << 8) | _buffer[n + 5]));
+        frames += burst / MPU_FIFO_FRAME;
+        length -= burst;
+      }
+      _stats.frames += frames;
+      return frames;
+    }
+
+    /*
+       the frames lost by an overflow at the last drain, 0 if none
+    */
+    unsigned lost(void) const
+    {
+      return _lost;
+    }
+
+    /*
+       get the statistics
+    */
+    void stats(MPU_FIFO_STATS_T *stats) const
+    {
+      *stats = _stats;
+    }
+
+  private:
+    /*
+       empty the FIFO and restart it
+    */
+    bool reset(void)
+    {
+      return _write(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_RST) &&
+             _write(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_EN);
+    }
+
+    MpuRead _read;
+    MpuWrite _write;
+    MPU_FIFO_STATS_T _stats;
+    uint64_t _last;             // us of the last drain
+    unsigned _lost;
+    uint8_t _buffer[MPU_FIFO_BURST];
+};
+
+#endif
+
+/**/
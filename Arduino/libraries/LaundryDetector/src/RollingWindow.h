@@ -0,0 +1,108 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  rolling window with a running sum
+
+  The window keeps the last N values and their sum. The sum is updated
+  with every value -- the value N pushes ago is subtracted, the new one
+  added -- so it costs the same for every size of the window. The values
+  are integers (fixed point), so the sum is exact: it never drifts away
+  from the sum of the values, however long the window runs.
+
+  The values are stored in a ring of the next power of two >= N, so the
+  index is masked instead of taken modulo N. The head is free running,
+  the values of the last kSize pushes can be read back with ago().
+
+  The window has no constructor: a static window is zero, ie. empty, and
+  a window in the RTC memory (RTC_DATA_ATTR) keeps its values over the
+  deep sleep. Call clear() to empty it.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __ROLLINGWINDOW_H__
+#define __ROLLINGWINDOW_H__ 1
+
+#include <stdint.h>
+#include <type_traits>
+
+/*
+   the size of the ring -- the next power of two >= n
+*/
+constexpr unsigned RollingWindowSize(unsigned n, unsigned size = 1)
+{
+  return (size >= n) ? size : RollingWindowSize(n, size << 1);
+}
+
+template <typename T, unsigned N, typename S = T>
+class RollingWindow {
+  static_assert(std::is_integral<T>::value && std::is_integral<S>::value,
+                "the values of a rolling window are fixed point, a float sum drifts");
+  static_assert(N > 0, "a rolling window holds at least one value");
+
+  public:
+    static constexpr unsigned kLength = N;
+    static constexpr unsigned kSize = RollingWindowSize(N);
+    static constexpr unsigned kMask = kSize - 1;
+
+    /*
+       empty the window
+    */
+    void clear(void)
+    {
+      for (unsigned n = 0; n < kSize; n++)
+        _values[n] = 0;
+      _sum = 0;
+      _head = 0;
+    }
+
+    /*
+       push a value -- the value N pushes ago drops out, returns the new sum
+    */
+    S push(T value)
+    {
+      _sum -= _values[(_head - N) & kMask];
+      _sum += value;
+      _values[_head++ & kMask] = value;
+      return _sum;
+    }
+
+    /*
+       the sum of the last N values
+    */
+    S sum(void) const
+    {
+      return _sum;
+    }
+
+    /*
+       the value pushed n pushes ago, 0 is the last one -- n < kSize
+    */
+    T ago(unsigned n) const
+    {
+      return _values[(_head - 1 - n) & kMask];
+    }
+
+    /*
+       the number of pushes since clear(), wraps
+    */
+    unsigned pushes(void) const
+    {
+      return _head;
+    }
+
+  private:
+    T _values[kSize];
+    S _sum;
+    unsigned _head;
+};
+
+#endif
+
+/**/
@@ -0,0 +1,138 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  versioned snapshot of the state of a sensor over the deep sleep
+
+  A sensor on battery keeps its state in the RTC memory over the deep
+  sleep -- the detector with its windows, the calibration, the flags of
+  the door. As separate RTC_DATA_ATTR variables nothing tells a state of
+  the last wake up from memory that lost its content (a brown out) or
+  that has the layout of another build, and a broken state is resumed as
+  it is.
+
+  The snapshot keeps the whole state in one block, after a header with
+  the CRC-32 of the rest, a magic, the version of the state and its
+  size:
+
+    save()        the state is copied into the snapshot and the CRC is
+                  computed -- right before esp_deep_sleep_start()
+    restore()     the state is copied out only if the magic, the version,
+                  the size and the CRC match -- after the wake up; else
+                  the sketch starts over from the NVS
+
+  A state restored resumes at once: aged by the time slept (age()), the
+  detector decides at its first window instead of after kAverage windows. The
+  state is copied as it is, bytes and padding, so it has to be trivially
+  copyable -- the detector and the calibration have no constructor.
+
+  The snapshot is zeroed before it is saved, so the CRC covers every
+  byte of it, the padding too. The CRC is the one of zlib and of
+  esp_rom_crc32_le() (reflected 0xedb88320), by a table of 16 entries.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __RTCSNAPSHOT_H__
+#define __RTCSNAPSHOT_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+/*
+   the magic of a snapshot, "LDSN"
+*/
+#define SNAPSHOT_MAGIC          0x4e53444c
+
+/*
+   the CRC-32 of length bytes, continued from crc -- 0 to start
+*/
+static inline uint32_t SnapshotCrc32(uint32_t crc, const void *data, size_t length)
+{
+  static const uint32_t table[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+  };
+  const uint8_t *bytes = (const uint8_t *) data;
+
+  crc = ~crc;
+  while (length--) {
+    crc ^= *bytes++;
+    crc = (crc >> 4) ^ table[crc & 0x0f];
+    crc = (crc >> 4) ^ table[crc & 0x0f];
+  }
+  return ~crc;
+}
+
+template <class State, uint16_t Version>
+class RtcSnapshot {
+  static_assert(std::is_trivially_copyable<State>::value, "the state is copied as bytes");
+  static_assert(sizeof(State) <= 0xffff, "the size of the state is 16 bit");
+
+  public:
+    /*
+       copy the state into the snapshot
+    */
+    void save(const State &state)
+    {
+      memset((void *) this, 0, sizeof(*this));
+      _magic = SNAPSHOT_MAGIC;
+      _version = Version;
+      _size = sizeof(State);
+      memcpy(_state, &state, sizeof(State));
+      _crc = crc();
+    }
+
+    /*
+       copy the state out of the snapshot -- fails if it isn't valid, the state is left alone then
+    */
+    bool restore(State *state) const
+    {
+      if (!valid())
+        return false;
+      memcpy(state, _state, sizeof(State));
+      return true;
+    }
+
+    /*
+       the snapshot is of this version and size and its CRC matches
+    */
+    bool valid(void) const
+    {
+      return _magic == SNAPSHOT_MAGIC && _version == Version && _size == sizeof(State) && _crc == crc();
+    }
+
+    /*
+       the next restore() fails -- a new state isn't resumed from the old one
+    */
+    void invalidate(void)
+    {
+      _magic = 0;
+    }
+
+  private:
+    /*
+       the CRC of everything behind it
+    */
+    uint32_t crc(void) const
+    {
+      return SnapshotCrc32(0, (const uint8_t *) this + sizeof(_crc), sizeof(*this) - sizeof(_crc));
+    }
+
+    uint32_t _crc;              // first
+    uint32_t _magic;
+    uint16_t _version;
+    uint16_t _size;
+    alignas(State) uint8_t _state[sizeof(State)];
+};
+
+#endif
+
+/**/
@@ -0,0 +1,145 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  accounting of the samples of a periodic timer
+
+  A sketch that reads the MPU once per loop and then waits with delay()
+  samples at the period of the wait plus the work of the loop -- the I2C
+  transaction, the Serial output, an update of the advertisement -- and
+  the windows of the detector, a fixed number of samples, get longer
+  than the second they stand for. With a periodic timer (esp_timer) that
+  notifies a sampling task, and the samples passed to the loop through a
+  queue, the samples keep the period of the timer, whatever the loop
+  does in between.
+
+  The clock accounts for the samples taken by the task against the ideal
+  schedule, the start of the timer plus n periods:
+
+    jitter    the distance of a sample to its slot in the schedule, in us
+    missed    the slots without a sample -- the task was late by more
+              than half a period, or the timer skipped
+    dropped   the samples taken but lost as the queue was full
+
+  tick() returns the periods the sample stands for, 1 on time, more after
+  missed slots and after the samples dropped before it, 0 for a second
+  sample in a slot. The sketch passes it on with the sample and the loop
+  holds the sample for that many periods, so the windows of the detector
+  stay a whole second of time.
+
+  The clock is plain integer arithmetic on the timestamps passed, it is
+  checked on the host. It is owned by the sampling task, the stats are
+  only read for a report.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __SAMPLECLOCK_H__
+#define __SAMPLECLOCK_H__ 1
+
+#include <stdint.h>
+
+/*
+   statistics
+*/
+typedef struct _sample_clock_stats {
+  unsigned long samples;        // taken
+  unsigned long missed;         // slots of the schedule without a sample
+  unsigned long dropped;        // samples lost in a full queue
+  uint32_t jitterMax;           // in us
+  uint64_t jitterSum;           // in us, of all samples
+} SAMPLE_CLOCK_STATS_T;
+
+class SampleClock {
+  public:
+    /*
+       start over with the period in us and the start of the timer -- its first slot is a period later
+    */
+    void begin(uint32_t period, uint64_t start)
+    {
+      _period = period;
+      _start = start;
+      _stats = SAMPLE_CLOCK_STATS_T();
+      _slot = 0;
+      _owed = 0;
+    }
+
+    /*
+       a sample was taken at us (esp_timer_get_time()) -- returns the periods it stands for
+    */
+    unsigned tick(uint64_t us)
+    {
+      /*
+         the nearest slot of the schedule -- a sample in the slot of the one
+         before (that one was more than half a period late) stands for no period
+      */
+      uint64_t elapsed = (us > _start) ? us - _start : 0;
+      uint64_t slot = (elapsed + _period / 2) / _period;
+      int64_t distance = (int64_t) elapsed - (int64_t) (slot * _period);
+      uint32_t jitter = (uint32_t) ((distance < 0) ? -distance : distance);
+      unsigned periods = 0;
+
+      _stats.samples++;
+      _stats.jitterSum += jitter;
+      if (jitter > _stats.jitterMax)
+        _stats.jitterMax = jitter;
+      if (slot > _slot) {
+        periods = (unsigned) (slot - _slot);
+        _stats.missed += periods - 1;
+        _slot = slot;
+      }
+      return periods + take();
+    }
+
+    /*
+       the sample of tick() was lost -- its periods are passed on with the next one
+    */
+    void drop(unsigned periods)
+    {
+      _stats.dropped++;
+      _owed += periods;
+    }
+
+    /*
+       the mean jitter in us
+    */
+    uint32_t jitter(void) const
+    {
+      return (_stats.samples) ? (uint32_t) (_stats.jitterSum / _stats.samples) : 0;
+    }
+
+    /*
+       get the statistics
+    */
+    void stats(SAMPLE_CLOCK_STATS_T *stats) const
+    {
+      *stats = _stats;
+    }
+
+  private:
+    /*
+       the periods of the dropped samples, once
+    */
+    unsigned take(void)
+    {
+      unsigned owed = _owed;
+
+      _owed = 0;
+      return owed;
+    }
+
+    uint32_t _period;
+    uint64_t _start;
+    uint64_t _slot;             // of the last sample, 0 is the start
+    unsigned _owed;
+    SAMPLE_CLOCK_STATS_T _stats;
+};
+
+#endif
+
+/**/
@@ -0,0 +1,318 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  recording of the raw samples of a sensor
+
+  The samples of a sensor (the raw x, y, z of the MPU, or the band
+  energies of the microphone) are recorded as they are passed to the
+  detector, so they can be replayed on the host through the same detector
+  (extras/host/tracereplay.cpp) -- after every change of a threshold.
+
+  format (all values little endian)
+
+    header    "LDTRAC" version(1) channels(1) rate(2) scale(2) reserved(4)
+    block     index(varint) frames(1) frame...
+    frame     delta(varint) per channel
+
+  rate is the samples per second, scale the LSB per g (or 1). A block has
+  up to TRACE_BLOCK_FRAMES frames, index is the number of its first frame
+  since the header. The first frame of a block is the change to 0, the
+  others the change to the previous frame, zigzag encoded, as LEB128
+  varint -- the noise of a sensor at rest fits into a byte per channel.
+  Every block starts over, so a lost block costs its frames and no more,
+  and the gap is seen in the index.
+
+  The header and the blocks are passed to the write function given to
+  begin(). A sketch writes them into a file in the flash as they are, or
+  to Serial as lines, "TRCH:<hex>" the header and "TRC:<hex>" a block --
+  the last byte of a line is the sum of the other bytes -- which are
+  picked out of the rest of the output of the sketch on the host.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __SENSORTRACE_H__
+#define __SENSORTRACE_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+   the modes of a sketch
+*/
+#define TRACE_OFF               0
+#define TRACE_SERIAL            1
+#define TRACE_FLASH             2
+
+/*
+   format
+*/
+#define TRACE_MAGIC             "LDTRAC"
+#define TRACE_VERSION           1
+#define TRACE_HEADER_SIZE       16
+#define TRACE_CHANNELS_MAX      4
+#define TRACE_SERIAL_HEADER     "TRCH:"
+#define TRACE_SERIAL_BLOCK      "TRC:"
+
+#ifndef TRACE_BLOCK_FRAMES
+#define TRACE_BLOCK_FRAMES      20
+#endif
+
+#define TRACE_BLOCK_MAX         (5 + 1 + TRACE_BLOCK_FRAMES * TRACE_CHANNELS_MAX * 5)
+#define TRACE_LINE_MAX          (sizeof(TRACE_SERIAL_HEADER) + 2 * (TRACE_BLOCK_MAX + 1) + 1)
+
+/*
+   the file in the flash -- the recording stops when it is full
+*/
+#define TRACE_FILE              "/trace.bin"
+#ifndef TRACE_FILE_MAX
+#define TRACE_FILE_MAX          (1024 * 1024)
+#endif
+
+/*
+   write the header or a block, return false if it was lost
+*/
+typedef bool (*TraceWrite)(const uint8_t *data, size_t length, bool header);
+
+typedef struct _trace_header {
+  unsigned channels;
+  unsigned rate;
+  unsigned scale;
+} TRACE_HEADER_T;
+
+/*
+   statistics
+*/
+typedef struct _trace_stats {
+  unsigned long frames;
+  unsigned long blocks;
+  unsigned long bytes;
+  unsigned long lost;           // frames of the blocks which couldn't be written
+} TRACE_STATS_T;
+
+/*
+   encode/decode the header, decoding fails if it is not a trace
+*/
+static inline size_t TraceEncodeHeader(uint8_t *buffer, const TRACE_HEADER_T *header)
+{
+  memcpy(buffer, TRACE_MAGIC, 6);
+  buffer[6] = TRACE_VERSION;
+  buffer[7] = header->channels;
+  buffer[8] = header->rate & 0xff;
+  buffer[9] = header->rate >> 8;
+  buffer[10] = header->scale & 0xff;
+  buffer[11] = header->scale >> 8;
+  memset(&buffer[12], 0, 4);
+  return TRACE_HEADER_SIZE;
+}
+
+static inline bool TraceDecodeHeader(const uint8_t *buffer, size_t length, TRACE_HEADER_T *header)
+{
+  if (length < TRACE_HEADER_SIZE || memcmp(buffer, TRACE_MAGIC, 6) || buffer[6] != TRACE_VERSION ||
+      !buffer[7] || buffer[7] > TRACE_CHANNELS_MAX)
+    return false;
+  header->channels = buffer[7];
+  header->rate = buffer[8] | (buffer[9] << 8);
+  header->scale = buffer[10] | (buffer[11] << 8);
+  return true;
+}
+
+/*
+   LEB128 varint -- getting it returns 0 if the buffer is too short
+*/
+static inline size_t TracePutVarint(uint8_t *buffer, uint32_t value)
+{
+  size_t n = 0;
+
+  do {
+    buffer[n++] = (value & 0x7f) | ((value >> 7) ? 0x80 : 0);
+    value >>= 7;
+  } while (value);
+  return n;
+}
+
+static inline size_t TraceGetVarint(const uint8_t *buffer, size_t length, uint32_t *value)
+{
+  uint32_t result = 0;
+
+  for (size_t n = 0; n < 5; n++) {
+    if (n >= length)
+      return 0;
+    result |= (uint32_t) (buffer[n] & 0x7f) << (7 * n);
+    if (!(buffer[n] & 0x80)) {
+      *value = result;
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+/*
+   decode a block -- frame(index, values) is called for every frame, returns the bytes
+   of the block or 0 if it is too short or invalid
+*/
+template <typename F>
+static inline size_t TraceDecodeBlock(const uint8_t *buffer, size_t length, unsigned channels, F frame)
+{
+  int32_t values[TRACE_CHANNELS_MAX] = {};
+  uint32_t index, delta = 0;
+  size_t n, used;
+
+  if (!(n = TraceGetVarint(buffer, length, &index)) || n >= length)
+    return 0;
+
+  unsigned frames = buffer[n++];
+
+  if (!frames || frames > TRACE_BLOCK_FRAMES)
+    return 0;
+
+  /*
+     check the whole block before the first frame is passed
+  */
+  size_t start = n;
+
+  for (unsigned i = 0; i < frames * channels; i++, n += used)
+    if (!(used = TraceGetVarint(&buffer[n], length - n, &delta)))
+      return 0;
+
+  n = start;
+  for (unsigned i = 0; i < frames; i++) {
+    for (unsigned c = 0; c < channels; c++) {
+      n += TraceGetVarint(&buffer[n], length - n, &delta);
+      values[c] = (int32_t) ((uint32_t) values[c] + ((delta >> 1) ^ -(delta & 1)));
+    }
+    frame(index + i, (const int32_t *) values);
+  }
+  return n;
+}
+
+/*
+   a Serial line of the header or a block -- returns its length without the '\0'
+*/
+static inline size_t TraceLine(char *line, const uint8_t *data, size_t length, bool header)
+{
+  static const char hex[] = "0123456789abcdef";
+  const char *tag = (header) ? TRACE_SERIAL_HEADER : TRACE_SERIAL_BLOCK;
+  size_t n = strlen(tag);
+  uint8_t sum = 0;
+
+  memcpy(line, tag, n);
+  for (size_t i = 0; i <= length; i++) {
+    uint8_t b = (i < length) ? data[i] : sum;
+
+    sum += b;
+    line[n++] = hex[b >> 4];
+    line[n++] = hex[b & 0x0f];
+  }
+  line[n] = '\0';
+  return n;
+}
+
+class TraceRecorder {
+  public:
+    /*
+       start the recording -- writes the header
+    */
+    bool begin(TraceWrite write, unsigned channels, unsigned rate, unsigned scale)
+    {
+      TRACE_HEADER_T header = { channels, rate, scale };
+      uint8_t buffer[TRACE_HEADER_SIZE];
+
+      _write = NULL;
+      _stats = TRACE_STATS_T();
+      _index = 0;
+      _frames = 0;
+      if (!channels || channels > TRACE_CHANNELS_MAX || !write(buffer, TraceEncodeHeader(buffer, &header), true))
+        return false;
+      _channels = channels;
+      _stats.bytes = TRACE_HEADER_SIZE;
+      _write = write;
+      return true;
+    }
+
+    /*
+       stop the recording -- writes the last block
+    */
+    void end(void)
+    {
+      flush();
+      _write = NULL;
+    }
+
+    /*
+       add a frame, the channels after the ones of begin() are ignored -- nothing if not recording
+    */
+    void add(int32_t a, int32_t b = 0, int32_t c = 0, int32_t d = 0)
+    {
+      const int32_t values[TRACE_CHANNELS_MAX] = { a, b, c, d };
+
+      if (!_write)
+        return;
+      if (!_frames) {
+        _count = TracePutVarint(_buffer, _index);
+        _length = _count + 1;
+        memset(_previous, 0, sizeof(_previous));
+      }
+      for (unsigned n = 0; n < _channels; n++) {
+        uint32_t delta = (uint32_t) values[n] - (uint32_t) _previous[n];
+
+        _length += TracePutVarint(&_buffer[_length], (delta << 1) ^ -(delta >> 31));
+        _previous[n] = values[n];
+      }
+      _index++;
+      _frames++;
+      if (_frames == TRACE_BLOCK_FRAMES)
+        flush();
+    }
+
+    /*
+       write the block, also if it isn't full
+    */
+    void flush(void)
+    {
+      if (!_write || !_frames)
+        return;
+
+      _buffer[_count] = _frames;
+      if (_write(_buffer, _length, false)) {
+        _stats.blocks++;
+        _stats.bytes += _length;
+        _stats.frames += _frames;
+      }
+      else
+        _stats.lost += _frames;
+      _frames = 0;
+    }
+
+    bool recording(void) const
+    {
+      return _write;
+    }
+
+    void stats(TRACE_STATS_T *stats) const
+    {
+      *stats = _stats;
+    }
+
+  private:
+    TraceWrite _write;
+    TRACE_STATS_T _stats;
+    unsigned _channels;
+    uint32_t _index;
+    unsigned _frames;
+    size_t _count;                // the offset of the frames of the block
+    size_t _length;
+    int32_t _previous[TRACE_CHANNELS_MAX];
+    uint8_t _buffer[TRACE_BLOCK_MAX];
+};
+
+#endif
+
+/**/
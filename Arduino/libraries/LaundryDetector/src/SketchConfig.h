@@ -0,0 +1,88 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  the configurations of the detector in the sketches
+
+  The thresholds and the windows of every sketch are kept here, so the
+  sketch and the benches and trace-replay on the host, which check the
+  sketches, build the same detector. The rate and the range are the
+  ones of the sensor of the sketch -- SensorConfig and SensorBandConfig
+  add them:
+
+    ActivityDetector<SensorConfig<DryerConfig, MPU_FIFO_RATE / 20, 2048>> detector;
+    VibrationBands<SensorBandConfig<MPU_FIFO_RATE, 2048>> bands;
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __SKETCHCONFIG_H__
+#define __SKETCHCONFIG_H__ 1
+
+#include "ActivityDetector.h"
+#include "VibrationBands.h"
+
+/*
+   machineESP -- the defaults: 1 s of activity averaged over 15 s for running (> 3 g),
+   0.2 s of small activity for the door latch (0.45/0.9 g)
+*/
+struct MachineEspConfig : ActivityConfig {
+};
+
+/*
+   1MPUaccelerometercode -- the clothes were removed if the door was open for more than 90 samples (4.5 s)
+*/
+struct AccelerometerConfig : ActivityConfig {
+  static constexpr unsigned kQuietEmpty = 90;
+};
+
+/*
+   Dryer_Code_Bluer_No_power_opt -- a dryer: 10 s of activity for running, the small activity is
+   compared with the one 0.1 s ago, the opening isn't detected, any door event while stopped means empty
+*/
+struct DryerConfig : ActivityConfig {
+  static constexpr unsigned kAverage = 10;
+  static constexpr unsigned kLag = 2;
+  static constexpr float kRunning = 2.5;
+  static constexpr float kDoorOpening = 0;
+  static constexpr float kDoorClosing = 0.55;
+};
+
+/*
+   DryerLaunDryerCode -- awake for 10 s to decide, 10 s of activity for running, no door
+*/
+struct WakeConfig : ActivityConfig {
+  static constexpr unsigned kAverage = 10;
+  static constexpr float kRunning = 4.0;
+  static constexpr float kDoorOpening = 0;
+  static constexpr float kDoorClosing = 0;
+};
+
+/*
+   a configuration at the rate (D magnitudes per sample of 50 ms) and the range (L LSB/g) of a sensor
+*/
+template <class Base, unsigned D = Base::kDecimate, unsigned L = Base::kLsbPerG>
+struct SensorConfig : Base {
+  static constexpr unsigned kDecimate = D;
+  static constexpr unsigned kLsbPerG = L;
+};
+
+/*
+   the bands of blocks of 1 s at the rate (R Hz) and the range (L LSB/g) of a sensor -- the bins up to 5 Hz below 40 Hz
+*/
+template <unsigned R, unsigned L = BandConfig::kLsbPerG>
+struct SensorBandConfig : BandConfig {
+  static constexpr unsigned kLsbPerG = L;
+  static constexpr unsigned kRate = R;
+  static constexpr unsigned kBlock = R;
+  static constexpr unsigned kBands = (R >= 40) ? BandConfig::kBands : 4;
+};
+
+#endif
+
+/**/
@@ -0,0 +1,173 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  the deep sleep schedule of a sensor which sleeps between its samples
+
+  A sensor on battery (DryerLaunDryerCode) is awake for a few seconds
+  to decide whether the machine runs, then it sleeps. While the machine
+  is stopped, it sleeps until the MPU sees motion (the door or the start
+  of the machine). While the machine runs there is no motion to wait
+  for -- the stop is quiet -- so it wakes up on the timer, and the time
+  it sleeps is the delay of the stop it could miss.
+
+  The policy decides the next wake up out of the state of the sensor and
+  the lengths of the last cycles:
+
+    StagedSleepPolicy    a sleep of kFirst, kStages sleeps of kStage, then
+                         awake until the machine stops -- kFirst 0 is
+                         always awake while running
+    AdaptiveSleepPolicy  sleeps of up to kLong until kMargin before the
+                         end of the shortest of the last cycles, then
+                         sleeps of kStage -- staged without a history
+
+  While the door is left open the sensor wakes up after kDoorWait or on
+  motion. The policies have no state of their own; the state and the
+  history are kept by the sketch, in the RTC memory over the deep sleep.
+  All times are in seconds.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __SLEEPPOLICY_H__
+#define __SLEEPPOLICY_H__ 1
+
+#include <stdint.h>
+#include "RollingWindow.h"
+
+/*
+   the sources of the wake up, none is to stay awake
+*/
+#define SLEEP_WAKE_TIMER        0x01
+#define SLEEP_WAKE_MOTION       0x02
+
+/*
+   the cycles of the history
+*/
+#ifndef SLEEP_HISTORY
+#define SLEEP_HISTORY           8
+#endif
+
+/*
+   the next wake up -- after seconds (SLEEP_WAKE_TIMER) and/or on motion
+*/
+typedef struct _sleep_wake {
+  uint32_t seconds;
+  unsigned sources;
+} SLEEP_WAKE_T;
+
+/*
+   the state of the sensor
+*/
+typedef struct _sleep_state {
+  bool running;
+  bool door;                    // left open, the clothes are being removed
+  uint32_t elapsed;             // since the start of the cycle
+  unsigned stage;               // sleeps since the start of the cycle
+} SLEEP_STATE_T;
+
+/*
+   the configuration -- derive from it and override what differs
+*/
+struct SleepConfig {
+  static constexpr uint32_t kFirst = 12;          // the first sleep of a cycle, 0 is awake
+  static constexpr uint32_t kStage = 15;          // the following sleeps
+  static constexpr unsigned kStages = 4;          // following sleeps, then awake until stopped
+  static constexpr uint32_t kLong = 600;          // max. sleep of the adaptive policy
+  static constexpr uint32_t kMargin = 300;        // before the end of the shortest cycle
+  static constexpr uint32_t kDoorWait = 30;       // the door left open
+};
+
+/*
+   the lengths of the last SLEEP_HISTORY cycles -- no constructor, so it can be kept in the RTC memory
+*/
+class SleepHistory {
+  public:
+    void clear(void)
+    {
+      _cycles.clear();
+    }
+
+    void add(uint32_t seconds)
+    {
+      _cycles.push(seconds);
+    }
+
+    unsigned count(void) const
+    {
+      return (_cycles.pushes() < SLEEP_HISTORY) ? _cycles.pushes() : SLEEP_HISTORY;
+    }
+
+    uint32_t mean(void) const
+    {
+      return (count()) ? _cycles.sum() / count() : 0;
+    }
+
+    uint32_t shortest(void) const
+    {
+      uint32_t shortest = UINT32_MAX;
+
+      for (unsigned n = 0; n < count(); n++)
+        if (_cycles.ago(n) < shortest)
+          shortest = _cycles.ago(n);
+      return (count()) ? shortest : 0;
+    }
+
+  private:
+    RollingWindow<uint32_t, SLEEP_HISTORY, uint64_t> _cycles;
+};
+
+/*
+   the machine is stopped -- until motion, or the door left open is checked again
+*/
+template <class Config>
+static inline SLEEP_WAKE_T SleepStopped(const SLEEP_STATE_T &state)
+{
+  if (state.door)
+    return { Config::kDoorWait, SLEEP_WAKE_TIMER | SLEEP_WAKE_MOTION };
+  return { 0, SLEEP_WAKE_MOTION };
+}
+
+template <class Config = SleepConfig>
+class StagedSleepPolicy {
+  public:
+    static SLEEP_WAKE_T next(const SLEEP_STATE_T &state, const SleepHistory &history)
+    {
+      (void) history;
+      if (!state.running)
+        return SleepStopped<Config>(state);
+      if (!Config::kFirst || state.stage > Config::kStages)
+        return { 0, 0 };
+      return { (state.stage) ? Config::kStage : Config::kFirst, SLEEP_WAKE_TIMER };
+    }
+};
+
+template <class Config = SleepConfig>
+class AdaptiveSleepPolicy {
+  public:
+    static SLEEP_WAKE_T next(const SLEEP_STATE_T &state, const SleepHistory &history)
+    {
+      if (!state.running)
+        return SleepStopped<Config>(state);
+      if (!history.count())
+        return StagedSleepPolicy<Config>::next(state, history);
+
+      uint32_t end = history.shortest();
+
+      if (state.elapsed + Config::kMargin + Config::kStage < end) {
+        uint32_t seconds = end - Config::kMargin - state.elapsed;
+
+        return { (seconds < Config::kLong) ? seconds : Config::kLong, SLEEP_WAKE_TIMER };
+      }
+      return { Config::kStage, SLEEP_WAKE_TIMER };
+    }
+};
+
+#endif
+
+/**/
@@ -0,0 +1,229 @@
+/*
+  LaundryDetector - Laundry Machine Monitor
+
+  band amplitudes of the vibration
+
+  The activity of the detector is one sum of the changes of the
+  magnitude, it doesn't tell the tumbling of the drum from the spin or
+  from a slam of the door, and the average over 10 to 15 s it decides on
+  keeps the machine running for as long after it stopped. A machine
+  vibrates at the rotation of its drum and its harmonics, which stop with
+  it. The bands are a bank of Goertzel filters on the raw x, y, z, one per
+  bin of a block of kBlock samples (1 s), updated every sample in fixed
+  point:
+
+    s = x + 2 cos(w) s1 - s2          every sample, w = 2 pi bin / kBlock
+    X = s1 - cos(w) s2 + i sin(w) s2  at the end of the block
+
+  the amplitude of a band is 2 |X| / kBlock of the three axes. The bins
+  are whole (Bin() of the configuration, in kRate / kBlock Hz), so the
+  gravity on the axes falls out of the block. Once the sum of the
+  amplitudes stays below kStill for kHold blocks, the machine is still --
+  the sketch passes it to the detector (setStill()), which stops it at
+  the next window below its threshold instead of waiting for the average.
+  A door slam is over within a block, it is left to the small activity of
+  the detector.
+
+  The state is 2 x 3 values per band and the coefficients of the block,
+  O(1) in the samples. The bands have no constructor, like the detector;
+  the coefficients are computed at the start of every block.
+
+  This file is part of LaundryDetector.
+
+  LaundryDetector is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __VIBRATIONBANDS_H__
+#define __VIBRATIONBANDS_H__ 1
+
+#include <math.h>
+#include <stdint.h>
+#include "ActivityDetector.h"
+
+/*
+   the max. bands of a bank
+*/
+#define BANDS_MAX               8
+
+/*
+   the events of an update
+*/
+#define BANDS_BLOCK             0x01    // the amplitudes were updated
+#define BANDS_STILL             0x02    // the bands got still
+#define BANDS_MOVING            0x04    // the bands aren't still anymore
+
+/*
+   the integer square root of 64 bit -- the top 32 bits are exact
+*/
+static inline uint32_t BandsSqrt(uint64_t n)
+{
+  unsigned shift = 0;
+
+  while (n >> 32) {
+    n >>= 2;
+    shift++;
+  }
+  return ActivitySqrt((uint32_t) n) << shift;
+}
+
+/*
+   the configuration -- derive from it and override what differs
+*/
+struct BandConfig {
+  static constexpr unsigned kLsbPerG = 2048;      // of the raw values, +-16g
+  static constexpr unsigned kRate = 200;          // samples per second
+  static constexpr unsigned kBlock = 200;         // samples of a block, the bins are kRate / kBlock Hz apart
+  static constexpr unsigned kBands = 6;
+  static constexpr float kStill = 0.02;           // the sum of the amplitudes in g is still below
+  static constexpr unsigned kHold = 3;            // blocks below kStill until still
+
+  /*
+     the bin of a band -- the drum and its harmonics, the spin
+  */
+  static constexpr unsigned Bin(unsigned band)
+  {
+    return (band == 0) ? 1 : (band == 1) ? 2 : (band == 2) ? 3 : (band == 3) ? 5 : (band == 4) ? 12 : 16;
+  }
+};
+
+template <class Config = BandConfig>
+class VibrationBands {
+  static_assert(Config::kBands <= BANDS_MAX, "too many bands");
+  static_assert(ACTIVITY_UNITS_PER_G % Config::kLsbPerG == 0, "the raw values are scaled to the fixed point by an integer");
+
+  public:
+    static constexpr uint32_t kStill = ActivityUnits(Config::kStill);
+
+    /*
+       reset to moving bands -- still after kHold blocks
+    */
+    void clear(void)
+    {
+      for (unsigned band = 0; band < Config::kBands; band++)
+        _amplitudes[band] = 0;
+      _level = 0;
+      _count = 0;
+      _below = 0;
+    }
+
+    /*
+       pass the next raw values -- returns the events
+    */
+    unsigned update(int16_t x, int16_t y, int16_t z)
+    {
+      const int32_t values[3] = { x, y, z };
+
+      if (!_count)
+        start();
+      for (unsigned band = 0; band < Config::kBands; band++)
+        for (unsigned axis = 0; axis < 3; axis++) {
+          int32_t s = values[axis] + (int32_t) (((int64_t) _cos[band] * _s1[band][axis] + (1L << 28)) >> 29) -
+                      _s2[band][axis];
+
+          _s2[band][axis] = _s1[band][axis];
+          _s1[band][axis] = s;
+        }
+      if (++_count < Config::kBlock)
+        return 0;
+      _count = 0;
+      return finish();
+    }
+
+    /*
+       the amplitude of a band and the sum of all in the fixed point, of the last block
+    */
+    uint32_t amplitudeUnits(unsigned band) const
+    {
+      return _amplitudes[band];
+    }
+
+    uint32_t levelUnits(void) const
+    {
+      return _level;
+    }
+
+    /*
+       the same in g
+    */
+    float amplitude(unsigned band) const
+    {
+      return (float) _amplitudes[band] / ACTIVITY_UNITS_PER_G;
+    }
+
+    float level(void) const
+    {
+      return (float) _level / ACTIVITY_UNITS_PER_G;
+    }
+
+    /*
+       the bands were still for kHold blocks
+    */
+    bool still(void) const
+    {
+      return _below >= Config::kHold;
+    }
+
+  private:
+    /*
+       the coefficients of the bins in Q30, cleared filters
+    */
+    void start(void)
+    {
+      for (unsigned band = 0; band < Config::kBands; band++) {
+        double w = 2 * M_PI * Config::Bin(band) / Config::kBlock;
+
+        _cos[band] = (int32_t) lround(cos(w) * (1L << 30));
+        _sin[band] = (int32_t) lround(sin(w) * (1L << 30));
+        for (unsigned axis = 0; axis < 3; axis++)
+          _s1[band][axis] = _s2[band][axis] = 0;
+      }
+    }
+
+    /*
+       the amplitudes of the block
+    */
+    unsigned finish(void)
+    {
+      bool still = this->still();
+
+      _level = 0;
+      for (unsigned band = 0; band < Config::kBands; band++) {
+        uint64_t power = 0;
+
+        for (unsigned axis = 0; axis < 3; axis++) {
+          int64_t s2 = _s2[band][axis];
+          int64_t real = _s1[band][axis] - ((_cos[band] * s2 + (1L << 29)) >> 30);
+          int64_t imaginary = (_sin[band] * s2 + (1L << 29)) >> 30;
+
+          power += real * real + imaginary * imaginary;
+        }
+        _amplitudes[band] = (uint32_t) ((2ULL * BandsSqrt(power) * (ACTIVITY_UNITS_PER_G / Config::kLsbPerG) +
+                                         Config::kBlock / 2) / Config::kBlock);
+        _level += _amplitudes[band];
+      }
+      if (_level < kStill) {
+        if (_below < Config::kHold)
+          _below++;
+      }
+      else
+        _below = 0;
+      return BANDS_BLOCK | ((this->still() && !still) ? BANDS_STILL : 0) | ((!this->still() && still) ? BANDS_MOVING : 0);
+    }
+
+    int32_t _s1[Config::kBands][3];
+    int32_t _s2[Config::kBands][3];
+    int32_t _cos[Config::kBands];
+    int32_t _sin[Config::kBands];
+    uint32_t _amplitudes[Config::kBands];
+    uint32_t _level;
+    unsigned _count;
+    unsigned _below;
+};
+
+#endif
+
+/**/
@@ -40,6 +40,39 @@ const HEARTBEAT_INTERVAL_MS = 5 * 60 * 1000;
 const MISSED_HEARTBEATS_BEFORE_OFFLINE = 3;
 const OFFLINE_TIMEOUT_MS = HEARTBEAT_INTERVAL_MS * MISSED_HEARTBEATS_BEFORE_OFFLINE;
 
+/**
+ * Current epoch time in microseconds
+ */
+function nowUs() {
+  return Math.round((performance.timeOrigin + performance.now()) * 1000);
+}
+
+/**
+ * Accept a hop timestamp (epoch microseconds) only if it is plausible.
+ * Gateways send 0 until their clock is synchronized; sensors posting
+ * directly don't send any.
+ */
+function validUs(value) {
+  const us = Number(value);
+  if (!Number.isFinite(us) || us <= 0) return null;
+  // after 2020-01-01 and not more than 5 minutes in the future
+  if (us < 1577836800e6 || us > nowUs() + 5 * 60e6) return null;
+  return us;
+}
+
+/**
+ * Per-hop latencies in ms, null where a timestamp is missing
+ */
+function hopLatencies({ observedUs, publishedUs, bridgeUs, storedUs }) {
+  const hop = (from, to) => (from !== null && to !== null ? (to - from) / 1000 : null);
+  return {
+    radioToPublishMs: hop(observedUs, publishedUs),
+    publishToBridgeMs: hop(publishedUs, bridgeUs),
+    bridgeToDbMs: hop(bridgeUs, storedUs),
+    totalMs: hop(observedUs, storedUs),
+  };
+}
+
 export default async function handler(req, res) {
   // Enable CORS
   res.setHeader('Access-Control-Allow-Credentials', true);
@@ -73,6 +106,14 @@ export default async function handler(req, res) {
       const history = await getCollection('machineHistory');
       const now = new Date();
 
+      // Hop timestamps from the gateway and bridge (epoch microseconds)
+      const observedUs = validUs(req.body.observedUs);
+      const publishedUs = validUs(req.body.publishedUs);
+      const bridgeUs = validUs(req.body.bridgeUs);
+
+      // When the change was observed at the radio -- falls back to the time we got it
+      const observedAt = observedUs !== null ? new Date(observedUs / 1000) : now;
+
       // Get current state to detect changes
       const currentMachine = await machines.findOne({ machineId });
 
@@ -99,6 +140,7 @@ export default async function handler(req, res) {
         empty,
         available: true,
         lastUpdate: now,
+        observedAt,
         updatedAt: now
       };
       
@@ -117,26 +159,38 @@ export default async function handler(req, res) {
       );
 
       // Record state change in history if state actually changed
+      let storedUs = nowUs();
+      let latency = hopLatencies({ observedUs, publishedUs, bridgeUs, storedUs });
       if (stateChanged) {
         await history.insertOne({
           machineId,
           running,
           empty,
           available: true,
-          timestamp: now,
+          timestamp: observedAt,
+          receivedAt: now,
+          latency,
           changeType: currentMachine ? 'update' : 'initial'
         });
+        storedUs = nowUs();
 
         console.log(`📊 [${machineId}] STATE CHANGE - Running: ${running}, Empty: ${empty}`);
       } else {
         console.log(`📊 [${machineId}] Heartbeat - No state change`);
       }
 
+      latency = hopLatencies({ observedUs, publishedUs, bridgeUs, storedUs });
+      if (latency.totalMs !== null) {
+        console.log(`⏱️ [${machineId}] radio->publish ${latency.radioToPublishMs}ms, publish->bridge ${latency.publishToBridgeMs}ms, bridge->DB ${latency.bridgeToDbMs}ms`);
+      }
+
       return res.status(200).json({
         success: true,
         machineId,
         received: { running, empty },
-        stateChanged
+        stateChanged,
+        storedUs,
+        latency
       });
     }
 
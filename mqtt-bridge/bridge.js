@@ -46,10 +46,60 @@ let mqttClient = null;
 let messageCount = 0;
 let errorCount = 0;
 
+// Per-hop latency samples in ms (radio -> publish -> bridge -> DB)
+const LATENCY_SAMPLES = 500;
+const latency = {
+  radioToPublish: [],
+  publishToBridge: [],
+  bridgeToDb: [],
+  endToEnd: [],
+};
+
+/**
+ * Current epoch time in microseconds
+ */
+function nowUs() {
+  return Math.round((performance.timeOrigin + performance.now()) * 1000);
+}
+
+/**
+ * Accept a gateway timestamp only if it is a plausible epoch time in us
+ * (the gateway sends 0 as long as its clock is not synchronized)
+ */
+function validUs(value) {
+  const us = Number(value);
+  if (!Number.isFinite(us) || us <= 0) return null;
+  // after 2020-01-01 and not more than 5 minutes in the future
+  if (us < 1577836800e6 || us > nowUs() + 5 * 60e6) return null;
+  return us;
+}
+
+/**
+ * Record a latency sample for a hop
+ */
+function recordLatency(hop, fromUs, toUs) {
+  if (fromUs === null || toUs === null) return;
+  const samples = latency[hop];
+  samples.push((toUs - fromUs) / 1000);
+  if (samples.length > LATENCY_SAMPLES) samples.shift();
+}
+
+/**
+ * Summarize the latency samples of a hop
+ */
+function latencySummary(samples) {
+  if (samples.length === 0) return 'n/a';
+  const sorted = [...samples].sort((a, b) => a - b);
+  const pick = (p) => sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))];
+  return `p50=${pick(0.5).toFixed(1)}ms p95=${pick(0.95).toFixed(1)}ms max=${sorted[sorted.length - 1].toFixed(1)}ms (n=${sorted.length})`;
+}
+
 /**
  * Post machine status to Vercel API
+ *
+ * timestamps holds the epoch times in us of each hop (observedUs, publishedUs, bridgeUs)
  */
-async function postToApi(machineId, room, running, empty) {
+async function postToApi(machineId, room, running, empty, timestamps = {}) {
   const payload = {
     machineId,
     running,
@@ -61,6 +111,13 @@ async function postToApi(machineId, room, running, empty) {
     payload.room = room;
   }
 
+  // Add the hop timestamps we know of
+  for (const key of ['observedUs', 'publishedUs', 'bridgeUs']) {
+    if (timestamps[key] !== null && timestamps[key] !== undefined) {
+      payload[key] = timestamps[key];
+    }
+  }
+
   console.log(`[API] Posting: ${JSON.stringify(payload)}`);
 
   for (let attempt = 1; attempt <= config.retryAttempts; attempt++) {
@@ -76,6 +133,8 @@ async function postToApi(machineId, room, running, empty) {
       if (response.ok) {
         const data = await response.json();
         console.log(`[API] Success: ${JSON.stringify(data)}`);
+        recordLatency('bridgeToDb', payload.bridgeUs ?? null, validUs(data.storedUs));
+        recordLatency('endToEnd', payload.observedUs ?? null, validUs(data.storedUs));
         return true;
       } else {
         const errorText = await response.text();
@@ -98,6 +157,7 @@ async function postToApi(machineId, room, running, empty) {
  * Handle incoming MQTT message
  */
 async function handleMessage(topic, message) {
+  const bridgeUs = nowUs();
   messageCount++;
   console.log(`\n[MQTT] #${messageCount} Message on topic: ${topic}`);
   
@@ -122,8 +182,14 @@ async function handleMessage(topic, message) {
     const empty = Boolean(payload.empty);
     const room = payload.room || null; // Room name from BLE advertisement
 
+    // Hop timestamps: radio receipt and publish on the gateway, receipt here
+    const observedUs = validUs(payload.observedUs);
+    const publishedUs = validUs(payload.publishedUs);
+    recordLatency('radioToPublish', observedUs, publishedUs);
+    recordLatency('publishToBridge', publishedUs, bridgeUs);
+
     // Forward to Vercel API
-    await postToApi(machineId, room, running, empty);
+    await postToApi(machineId, room, running, empty, { observedUs, publishedUs, bridgeUs });
     
   } catch (error) {
     console.error(`[MQTT] Failed to parse message: ${error.message}`);
@@ -191,6 +257,10 @@ function connectMqtt() {
  */
 function printStatus() {
   console.log(`\n[STATUS] Messages received: ${messageCount}, Errors: ${errorCount}`);
+  console.log(`[LATENCY] radio -> publish:  ${latencySummary(latency.radioToPublish)}`);
+  console.log(`[LATENCY] publish -> bridge: ${latencySummary(latency.publishToBridge)}`);
+  console.log(`[LATENCY] bridge -> DB:      ${latencySummary(latency.bridgeToDb)}`);
+  console.log(`[LATENCY] radio -> DB:       ${latencySummary(latency.endToEnd)}`);
 }
 
 /**
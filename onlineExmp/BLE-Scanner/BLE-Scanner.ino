@@ -24,7 +24,11 @@
 #include "state.h"
 #include "util.h"
 #include "bluetooth.h"
+#include "capture.h"
+#include "memstat.h"
+#include "ota.h"
 #include "scandev.h"
+#include "history.h"
 #include "watchdog.h"
 #if defined(ESP32)
 #include "soc/soc.h"
@@ -46,6 +50,8 @@ void setup()
   Serial.begin(115200);
   Serial.println();
   Serial.println();
+  LogSetup();
+  MemStatSetup();
   LogMsg("**********************************************");
   LogMsg("*  Laundry Machine Scanner                   *");
   LogMsg("*  Version " GIT_VERSION "                          *");
@@ -57,6 +63,7 @@ void setup()
 #if UNIT_TEST
   WatchdogUnitTest();
   LogMsg("End of UnitTest -- restarting");
+  LogFlush();
   ESP.restart();
 #endif
 
@@ -66,6 +73,7 @@ void setup()
   WatchdogSetup(0);
   LedSetup(LED_MODE_ON);
   StateSetup(STATE_SCANNING);
+  OtaSetup();
 
   // Initialize config with hardcoded values
   ConfigSetup();
@@ -79,17 +87,20 @@ void setup()
     while (!WifiSetup()) {
       delay(5000);
       WatchdogUpdate();
+      OtaUpdate();
     }
   }
 
   /*
      setup the other sub-systems
   */
-  HttpSetup();
   ScanDevSetup();
+  HistorySetup();
   NtpSetup();
   MqttSetup();
+  CaptureSetup();
   BluetoothSetup();
+  HttpSetup();      // last, its task reads the tables and the config of the others
   WatchdogSetup(_config.bluetooth.scan_time);
   
   LogMsg("SETUP: All systems ready - starting BLE scanning");
@@ -102,6 +113,8 @@ void loop()
   */
   WatchdogUpdate();
   ConfigUpdate();
+  MemStatUpdate();
+  OtaUpdate();
   LedUpdate();
   WifiUpdate();
   
@@ -113,7 +126,9 @@ void loop()
     NtpUpdate();
     MqttUpdate();
     BluetoothUpdate();
+    CaptureUpdate();
     ScanDevUpdate();
+    HistoryUpdate();
   }
 
   /*
@@ -143,6 +158,7 @@ void loop()
       */
       LogMsg("SCANNER: Restarting the device");
       LedSetup(LED_MODE_OFF);
+      LogFlush();
       ESP.restart();
       break;
   }
@@ -23,32 +23,68 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_BT
+
 #include "config.h"
 #include "state.h"
 #include "bluetooth.h"
 #include "scandev.h"
+#include "capture.h"
+#include "ntp.h"
+#include "memstat.h"
 #include "util.h"
 
 static NimBLEScan *_scan = NULL;
 static time_t _last_scan = 0;
 static time_t _last_activescan = 0;
 
+/*
+   find an AD structure in the payload -- returns its data or NULL
+*/
+static const uint8_t *BluetoothFindField(const std::vector<uint8_t> &payload, uint8_t type, size_t *length)
+{
+  for (size_t n = 0; n + 1 < payload.size() && payload[n]; n += payload[n] + 1) {
+    if (n + payload[n] >= payload.size())
+      break;
+    if (payload[n + 1] == type) {
+      *length = payload[n] - 1;
+      return &payload[n + 2];
+    }
+  }
+  return NULL;
+}
+
 class BLEScannerScanCallbacks : public NimBLEScanCallbacks
 {
     void onResult(const BLEAdvertisedDevice* advertisedDevice)
     {
-      // Get device name
-      std::string deviceName = advertisedDevice->getName();
-      
+      MEMSTAT_SCOPE(MEMSTAT_BT);
+
+      // Timestamp of the receipt -- taken first, before any filtering
+      uint64_t seen_us = NtpGetTimeUs();
+      const std::vector<uint8_t> &payload = advertisedDevice->getPayload();
+
+      // Record the raw advertisement
+      if (CaptureMode() != CAPTURE_OFF)
+        CaptureAdvertisement(advertisedDevice->getAddress().getVal(), advertisedDevice->getAddressType(),
+                             advertisedDevice->getRSSI(), payload.data(), payload.size(), seen_us);
+
+      // Get device name -- taken from the payload, getName() would allocate a string
+      size_t nameLen;
+      const uint8_t *name = BluetoothFindField(payload, BLE_HS_ADV_TYPE_COMP_NAME, &nameLen);
+
 #if DBG_BT
+      char deviceName[32];
+
+      snprintf(deviceName, sizeof(deviceName), "%.*s", (name) ? (int) nameLen : 0, (name) ? (const char *) name : "");
       DbgMsg("BLE: found device: %s name: '%s' address type: 0x%02x", 
              advertisedDevice->getAddress().toString().c_str(), 
-             deviceName.c_str(),
+             deviceName,
              advertisedDevice->getAddressType());
 #endif
 
       // Filter 1: Check if device name matches TARGET_DEVICE_NAME
-      if (deviceName != TARGET_DEVICE_NAME) {
+      if (!name || nameLen != strlen(TARGET_DEVICE_NAME) || memcmp(name, TARGET_DEVICE_NAME, nameLen)) {
 #if DBG_BT
         DbgMsg("BLE: Skipping - name doesn't match '%s'", TARGET_DEVICE_NAME);
 #endif
@@ -56,27 +92,30 @@ class BLEScannerScanCallbacks : public NimBLEScanCallbacks
       }
 
       // Filter 2: Check for manufacturer data
-      if (!advertisedDevice->haveManufacturerData()) {
+      size_t manufLen;
+      const uint8_t *manufData = BluetoothFindField(payload, BLE_HS_ADV_TYPE_MFG_DATA, &manufLen);
+
+      if (!manufData) {
 #if DBG_BT
         DbgMsg("BLE: Skipping - no manufacturer data");
 #endif
         return;
       }
 
-      // Get manufacturer data
-      std::string manufData = advertisedDevice->getManufacturerData();
-      
       // Need at least: 2 (company ID) + 1 (machineId) + 1 (status) = 4 bytes minimum
-      // Format: 2 + MACHINE_ID_MAX_LEN + 1 = 19 bytes
-      if (manufData.length() < 4) {
+      // Format: 2 + MACHINE_ID_MAX_LEN + 1 = 19 bytes, or 2 + MACHINE_ID_MAX_LEN + 3 + 1 = 22 bytes with the thresholds
+      // of the detector of the sensor before the status byte. Bits 3-7 of the status are the minutes remaining of the
+      // cycle in steps of 5 min, 0 without an estimate (and from older sensors), 1-30 at most 5 x n min, 31 is
+      // saturated: more than 150 min
+      if (manufLen < 4) {
 #if DBG_BT
-        DbgMsg("BLE: Skipping - manufacturer data too short (%d bytes)", manufData.length());
+        DbgMsg("BLE: Skipping - manufacturer data too short (%d bytes)", (int) manufLen);
 #endif
         return;
       }
 
       // Filter 3: Check manufacturer ID (0xFFFF)
-      uint16_t manufacturer_id = (uint8_t)manufData[0] | ((uint8_t)manufData[1] << 8);
+      uint16_t manufacturer_id = manufData[0] | (manufData[1] << 8);
       if (manufacturer_id != TARGET_MANUFACTURER_ID) {
 #if DBG_BT
         DbgMsg("BLE: Skipping - manufacturer ID 0x%04X doesn't match 0x%04X", 
@@ -89,7 +128,7 @@ class BLEScannerScanCallbacks : public NimBLEScanCallbacks
       char machineId[MACHINE_ID_MAX_LEN + 1];
       memset(machineId, 0, sizeof(machineId));
       
-      int idLen = manufData.length() - 3; // -2 for company ID, -1 for status byte
+      int idLen = manufLen - 3; // -2 for company ID, -1 for status byte
       if (idLen > MACHINE_ID_MAX_LEN) idLen = MACHINE_ID_MAX_LEN;
       
       for (int i = 0; i < idLen && manufData[2 + i] != '\0'; i++) {
@@ -97,9 +136,11 @@ class BLEScannerScanCallbacks : public NimBLEScanCallbacks
       }
 
       // Parse status byte (last byte)
-      uint8_t statusByte = (uint8_t)manufData[manufData.length() - 1];
+      uint8_t statusByte = manufData[manufLen - 1];
       bool running = (statusByte & 0x01) != 0;
       bool empty = (statusByte & 0x02) != 0;
+      int steps = statusByte >> 3;
+      int remaining = (steps == 31) ? SCANDEV_REMAINING_OVER : (steps) ? steps * 5 : -1;
 
       LogMsg("BLE: Found LaundryMachine! ID: %s, Running: %s, Empty: %s, RSSI: %d",
              machineId,
@@ -107,6 +148,19 @@ class BLEScannerScanCallbacks : public NimBLEScanCallbacks
              empty ? "YES" : "NO",
              advertisedDevice->getRSSI());
 
+      // Thresholds of the detector (running and stopped in 1/16 g, the door in 1/64 g), bit 2 of the status: calibrated
+      if (manufLen == 2 + MACHINE_ID_MAX_LEN + 3 + 1) {
+        const uint8_t *thresholds = &manufData[2 + MACHINE_ID_MAX_LEN];
+
+        LogMsg("BLE: %s thresholds running %.2f g, stopped %.2f g, door %.2f g%s", machineId,
+               thresholds[0] / 16.0, thresholds[1] / 16.0, thresholds[2] / 64.0,
+               (statusByte & 0x04) ? " (calibrated)" : "");
+      }
+      if (remaining == SCANDEV_REMAINING_OVER)
+        LogMsg("BLE: %s more than %d min remaining", machineId, SCANDEV_REMAINING_MAX);
+      else if (remaining >= 0)
+        LogMsg("BLE: %s at most %d min remaining", machineId, remaining);
+
       // Add to device list for tracking and API posting
       // Room mapping is done on backend based on machineId prefix
       ScanDevAddMachine(advertisedDevice->getAddress(),
@@ -114,7 +168,9 @@ class BLEScannerScanCallbacks : public NimBLEScanCallbacks
                         NULL, // No room in BLE - backend will map it
                         running,
                         empty,
-                        advertisedDevice->getRSSI());
+                        advertisedDevice->getRSSI(),
+                        seen_us);
+      ScanDevSetRemaining(machineId, remaining);
     }
 };
 
@@ -175,6 +231,8 @@ void BluetoothUpdate(void)
 */
 bool BluetoothScanStart(void)
 {
+  MEMSTAT_SCOPE(MEMSTAT_BT);
+
 #if DBG_BT
   DbgMsg("BLE: BluetoothScanStart");
 #endif
@@ -190,6 +248,11 @@ bool BluetoothScanStart(void)
   }
   _scan->setActiveScan(active);
 
+  /*
+     a capture wants every advertisement, not only the first one of a device
+  */
+  _scan->setDuplicateFilter(CaptureMode() == CAPTURE_OFF);
+
   int scan_interval = 3000; // ms
   _scan->setInterval(scan_interval);
   _scan->setWindow(scan_interval - 1);
@@ -211,6 +274,8 @@ bool BluetoothScanStart(void)
 */
 bool BluetoothScanStop(void)
 {
+  MEMSTAT_SCOPE(MEMSTAT_BT);
+
 #if DBG_BT
   DbgMsg("BLE: BluetoothScanStop");
 #endif
@@ -0,0 +1,364 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module to capture the raw advertisements
+
+  The scan callback runs in the BLE task, so the records are passed to the
+  loop in a single producer/single consumer ring and only written there.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_BT
+
+#include <atomic>
+#include <mutex>
+#include <LittleFS.h>
+#include "config.h"
+#include "capture.h"
+#include "ntp.h"
+#include "util.h"
+
+static std::atomic<int> _capture_mode(CAPTURE_OFF);
+static std::atomic<int> _capture_request(-1);
+
+/*
+   held while the file is read by the web server -- a start is deferred meanwhile, it would truncate the file
+*/
+static std::mutex _capture_file_mutex;
+
+/*
+   the ring
+*/
+static CAPTURE_RECORD_T _capture_ring[CAPTURE_RING_SIZE];
+static std::atomic<uint32_t> _capture_head(0);
+static std::atomic<uint32_t> _capture_tail(0);
+
+/*
+   the output
+*/
+static File _capture_file;
+static uint64_t _capture_last_us = 0;
+static unsigned long _capture_last_flush = 0;
+
+/*
+   statistics
+*/
+static std::atomic<unsigned long> _capture_captured(0);
+static std::atomic<unsigned long> _capture_dropped(0);
+static std::atomic<unsigned long> _capture_bytes(0);
+
+/*
+   little endian helpers
+*/
+static void CapturePut64(uint8_t *buffer, uint64_t value)
+{
+  for (int n = 0; n < 8; n++)
+    buffer[n] = value >> (8 * n);
+}
+
+static uint64_t CaptureGet64(const uint8_t *buffer)
+{
+  uint64_t value = 0;
+
+  for (int n = 7; n >= 0; n--)
+    value = (value << 8) | buffer[n];
+  return value;
+}
+
+/*
+   encode/decode the header
+*/
+size_t CaptureEncodeHeader(uint8_t *buffer, uint64_t start_us)
+{
+  memcpy(buffer, CAPTURE_MAGIC, 6);
+  buffer[6] = CAPTURE_VERSION;
+  buffer[7] = 0;
+  CapturePut64(&buffer[8], start_us);
+  return CAPTURE_HEADER_SIZE;
+}
+
+bool CaptureDecodeHeader(const uint8_t *buffer, size_t length, uint64_t *start_us)
+{
+  if (length < CAPTURE_HEADER_SIZE || memcmp(buffer, CAPTURE_MAGIC, 6) || buffer[6] != CAPTURE_VERSION)
+    return false;
+  if (start_us)
+    *start_us = CaptureGet64(&buffer[8]);
+  return true;
+}
+
+/*
+   encode a record
+*/
+size_t CaptureEncode(uint8_t *buffer, size_t size, const CAPTURE_RECORD_T *record, uint64_t *last_us)
+{
+  uint64_t delta = (record->time_us > *last_us) ? record->time_us - *last_us : 0;
+  size_t n = 0;
+
+  if (record->length > CAPTURE_PAYLOAD_MAX || size < CAPTURE_RECORD_MAX)
+    return 0;
+
+  do {
+    buffer[n++] = (delta & 0x7f) | ((delta >> 7) ? 0x80 : 0);
+    delta >>= 7;
+  } while (delta);
+
+  memcpy(&buffer[n], record->addr, 6);
+  n += 6;
+  buffer[n++] = record->type;
+  buffer[n++] = (uint8_t) record->rssi;
+  buffer[n++] = record->length;
+  memcpy(&buffer[n], record->payload, record->length);
+  n += record->length;
+
+  if (record->time_us > *last_us)
+    *last_us = record->time_us;
+  return n;
+}
+
+/*
+   decode a record
+*/
+size_t CaptureDecode(const uint8_t *buffer, size_t length, CAPTURE_RECORD_T *record, uint64_t *last_us)
+{
+  uint64_t delta = 0;
+  size_t n = 0;
+
+  for (int shift = 0; ; shift += 7) {
+    if (n >= length || shift > 63)
+      return 0;
+    delta |= (uint64_t) (buffer[n] & 0x7f) << shift;
+    if (!(buffer[n++] & 0x80))
+      break;
+  }
+
+  if (n + 9 > length || buffer[n + 8] > CAPTURE_PAYLOAD_MAX || n + 9 + buffer[n + 8] > length)
+    return 0;
+
+  record->time_us = *last_us + delta;
+  memcpy(record->addr, &buffer[n], 6);
+  n += 6;
+  record->type = buffer[n++];
+  record->rssi = (int8_t) buffer[n++];
+  record->length = buffer[n++];
+  memcpy(record->payload, &buffer[n], record->length);
+  n += record->length;
+
+  *last_us = record->time_us;
+  return n;
+}
+
+/*
+   write the encoded bytes
+*/
+static void CaptureOutput(const char *tag, const uint8_t *buffer, size_t length)
+{
+  if (_capture_mode == CAPTURE_FLASH) {
+    if (_capture_bytes + length > CAPTURE_FILE_MAX) {
+      LogWarn("CAPTURE: file is full after %lu bytes -- stopped", _capture_bytes.load());
+      CaptureStop();
+      return;
+    }
+    _capture_file.write(buffer, length);
+  }
+  else {
+    /*
+       one line per write, so the log messages don't tear it
+    */
+    static const char hex[] = "0123456789abcdef";
+    char line[sizeof(CAPTURE_SERIAL_HEADER) + 2 * (CAPTURE_RECORD_MAX + 1) + 2];
+    size_t n = strlen(tag);
+    uint8_t sum = 0;
+
+    memcpy(line, tag, n);
+    for (size_t i = 0; i <= length; i++) {
+      uint8_t b = (i < length) ? buffer[i] : sum;
+
+      sum += b;
+      line[n++] = hex[b >> 4];
+      line[n++] = hex[b & 0x0f];
+    }
+    line[n++] = '\n';
+    Serial.write((const uint8_t *) line, n);
+  }
+  _capture_bytes += length;
+}
+
+/*
+   start the capture
+*/
+bool CaptureStart(int mode)
+{
+  if (_capture_mode != CAPTURE_OFF)
+    CaptureStop();
+  if (mode == CAPTURE_OFF)
+    return true;
+
+  if (mode == CAPTURE_FLASH) {
+    if (!LittleFS.begin(true)) {
+      LogErr("CAPTURE: couldn't mount the flash file system");
+      return false;
+    }
+    if (!(_capture_file = LittleFS.open(CAPTURE_FILE, "w"))) {
+      LogErr("CAPTURE: couldn't create %s", CAPTURE_FILE);
+      return false;
+    }
+  }
+
+  /*
+     drop what is left from a previous capture
+  */
+  _capture_tail.store(_capture_head.load());
+  _capture_bytes = 0;
+  _capture_last_us = NtpGetTimeUs();
+  _capture_last_flush = millis();
+
+  uint8_t header[CAPTURE_HEADER_SIZE];
+  CaptureEncodeHeader(header, _capture_last_us);
+  _capture_mode = mode;
+  CaptureOutput(CAPTURE_SERIAL_HEADER, header, sizeof(header));
+
+  LogMsg("CAPTURE: started to %s", (mode == CAPTURE_FLASH) ? CAPTURE_FILE : "Serial");
+  return true;
+}
+
+/*
+   stop the capture
+*/
+void CaptureStop(void)
+{
+  int mode = _capture_mode.exchange(CAPTURE_OFF);
+
+  if (mode == CAPTURE_FLASH)
+    _capture_file.close();
+  if (mode != CAPTURE_OFF)
+    LogMsg("CAPTURE: stopped after %lu bytes", _capture_bytes.load());
+}
+
+/*
+   request a start/stop from another task
+*/
+void CaptureRequest(int mode)
+{
+  _capture_request = mode;
+}
+
+/*
+   pass the capture file to send -- from another task, while the capture isn't written to the flash
+*/
+bool CaptureDownload(void (*send)(File &file))
+{
+  std::lock_guard<std::mutex> lock(_capture_file_mutex);
+
+  if (_capture_mode == CAPTURE_FLASH || !LittleFS.begin(false) || !LittleFS.exists(CAPTURE_FILE))
+    return false;
+
+  File file = LittleFS.open(CAPTURE_FILE, "r");
+
+  if (!file)
+    return false;
+  send(file);
+  file.close();
+  return true;
+}
+
+/*
+   get the current mode
+*/
+int CaptureMode(void)
+{
+  return _capture_mode;
+}
+
+/*
+   record an advertisement
+*/
+void CaptureAdvertisement(const uint8_t addr[6], uint8_t type, int rssi, const uint8_t *payload, size_t length, uint64_t time_us)
+{
+  if (_capture_mode == CAPTURE_OFF)
+    return;
+
+  uint32_t head = _capture_head.load(std::memory_order_relaxed);
+
+  if (head - _capture_tail.load(std::memory_order_acquire) >= CAPTURE_RING_SIZE) {
+    _capture_dropped++;
+    return;
+  }
+
+  CAPTURE_RECORD_T *record = &_capture_ring[head % CAPTURE_RING_SIZE];
+
+  record->time_us = time_us;
+  memcpy(record->addr, addr, 6);
+  record->type = type;
+  record->rssi = constrain(rssi, -128, 127);
+  record->length = MIN(length, (size_t) CAPTURE_PAYLOAD_MAX);
+  memcpy(record->payload, payload, record->length);
+
+  _capture_head.store(head + 1, std::memory_order_release);
+  _capture_captured++;
+}
+
+/*
+   setup
+*/
+void CaptureSetup(void)
+{
+  if (BT_CAPTURE != CAPTURE_OFF)
+    CaptureStart(BT_CAPTURE);
+}
+
+/*
+   write the captured records
+*/
+void CaptureUpdate(void)
+{
+  std::unique_lock<std::mutex> lock(_capture_file_mutex, std::try_to_lock);
+
+  if (lock.owns_lock()) {
+    int request = _capture_request.exchange(-1);
+
+    if (request >= 0)
+      CaptureStart(request);
+    lock.unlock();
+  }
+
+  uint32_t tail = _capture_tail.load(std::memory_order_relaxed);
+
+  while (_capture_mode != CAPTURE_OFF && tail != _capture_head.load(std::memory_order_acquire)) {
+    uint8_t buffer[CAPTURE_RECORD_MAX];
+    size_t length = CaptureEncode(buffer, sizeof(buffer), &_capture_ring[tail % CAPTURE_RING_SIZE], &_capture_last_us);
+
+    _capture_tail.store(++tail, std::memory_order_release);
+    if (length)
+      CaptureOutput(CAPTURE_SERIAL_RECORD, buffer, length);
+  }
+
+  /*
+     the file is flushed once per second, so a reset doesn't lose much
+  */
+  if (_capture_mode == CAPTURE_FLASH && millis() - _capture_last_flush >= 1000) {
+    _capture_file.flush();
+    _capture_last_flush = millis();
+  }
+}
+
+/*
+   get the statistics
+*/
+void CaptureStats(unsigned long *captured, unsigned long *dropped, unsigned long *bytes)
+{
+  if (captured)
+    *captured = _capture_captured.load();
+  if (dropped)
+    *dropped = _capture_dropped.load();
+  if (bytes)
+    *bytes = _capture_bytes.load();
+}
+
+/**/
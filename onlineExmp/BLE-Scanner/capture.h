@@ -0,0 +1,141 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module to capture the raw advertisements
+
+  Every advertisement reported by the scan is recorded with its address,
+  address type, RSSI, payload and the time of receipt in micro seconds.
+  The records are written to a file in the flash (download with /capture)
+  or as text lines to Serial, and can be replayed on the host with
+  host/replay.cpp.
+
+  file format (all values little endian)
+
+    header    "BLECAP" version(1) reserved(1) start_us(8)
+    record    delta_us(varint) addr(6) type(1) rssi(1) length(1) payload(length)
+
+  delta_us is the time since the previous record (the start for the first
+  one), the varint is LEB128. On Serial, the header is sent as a line
+  "CAPH:<hex>", every record as "CAP:<hex>", the last byte of a line is
+  the sum of the other bytes.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <LittleFS.h>
+#include "config.h"
+
+/*
+   capture modes
+*/
+#define CAPTURE_OFF             0
+#define CAPTURE_SERIAL          1
+#define CAPTURE_FLASH           2
+
+/*
+   format
+*/
+#define CAPTURE_MAGIC           "BLECAP"
+#define CAPTURE_VERSION         1
+#define CAPTURE_HEADER_SIZE     16
+#define CAPTURE_PAYLOAD_MAX     62      // advertisement and scan response
+#define CAPTURE_RECORD_MAX      (10 + 6 + 1 + 1 + 1 + CAPTURE_PAYLOAD_MAX)
+#define CAPTURE_SERIAL_HEADER   "CAPH:"
+#define CAPTURE_SERIAL_RECORD   "CAP:"
+
+/*
+   the capture file in the flash -- the capture stops when it is full
+*/
+#define CAPTURE_FILE            "/capture.bin"
+#ifndef CAPTURE_FILE_MAX
+#define CAPTURE_FILE_MAX        (512 * 1024)
+#endif
+
+/*
+   records passed from the BLE task to the loop
+*/
+#ifndef CAPTURE_RING_SIZE
+#define CAPTURE_RING_SIZE       64
+#endif
+
+/*
+   a captured advertisement
+*/
+typedef struct _capture_record {
+  uint64_t time_us;
+  uint8_t addr[6];
+  uint8_t type;
+  int8_t rssi;
+  uint8_t length;
+  uint8_t payload[CAPTURE_PAYLOAD_MAX];
+} CAPTURE_RECORD_T;
+
+/*
+   encode/decode the header, decoding fails if it is not a capture
+*/
+size_t CaptureEncodeHeader(uint8_t *buffer, uint64_t start_us);
+bool CaptureDecodeHeader(const uint8_t *buffer, size_t length, uint64_t *start_us);
+
+/*
+   encode/decode a record -- last_us is the time of the previous record and is updated,
+   both return the number of bytes or 0 if the buffer is too short or the record invalid
+*/
+size_t CaptureEncode(uint8_t *buffer, size_t size, const CAPTURE_RECORD_T *record, uint64_t *last_us);
+size_t CaptureDecode(const uint8_t *buffer, size_t length, CAPTURE_RECORD_T *record, uint64_t *last_us);
+
+/*
+   setup the capture -- starts with the mode BT_CAPTURE of the config
+*/
+void CaptureSetup(void);
+
+/*
+   write the captured records
+*/
+void CaptureUpdate(void);
+
+/*
+   start/stop the capture, starting in the flash truncates the file
+*/
+bool CaptureStart(int mode);
+void CaptureStop(void);
+
+/*
+   request a start/stop from another task -- it is done by the next CaptureUpdate()
+*/
+void CaptureRequest(int mode);
+
+/*
+   pass the capture file to send -- fails while the capture is written to the flash or without a file;
+   a start requested meanwhile waits until the file is sent
+*/
+bool CaptureDownload(void (*send)(File &file));
+
+/*
+   get the current mode
+*/
+int CaptureMode(void);
+
+/*
+   record an advertisement -- called from the scan callback
+*/
+void CaptureAdvertisement(const uint8_t addr[6], uint8_t type, int rssi, const uint8_t *payload, size_t length, uint64_t time_us);
+
+/*
+   get the number of captured and dropped records and of written bytes
+*/
+void CaptureStats(unsigned long *captured, unsigned long *dropped, unsigned long *bytes);
+
+#endif
+
+/**/
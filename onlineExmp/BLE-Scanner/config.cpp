@@ -23,6 +23,8 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_CFG
+
 #include <Arduino.h>
 #include <stdio.h>
 #include <string.h>
@@ -48,8 +50,8 @@ void ConfigInitHardcoded(void)
   // Device
   strncpy(_config.device.name, DEVICE_NAME, sizeof(_config.device.name) - 1);
   
-  // NTP (optional, for logging)
-  strncpy(_config.ntp.server, "pool.ntp.org", sizeof(_config.ntp.server) - 1);
+  // NTP (optional, for logging) -- the servers are queried in parallel
+  strncpy(_config.ntp.server, "0.pool.ntp.org 1.pool.ntp.org 2.pool.ntp.org", sizeof(_config.ntp.server) - 1);
   _config.ntp.timezone = 0;
   
   // Bluetooth
@@ -49,6 +49,23 @@
 #define DBG_WIFI          (DBG && 0)
 #define DBG_MQTT          (DBG && 1)
 
+/*
+   control the log messages at compile time -- see logger.h
+*/
+#ifndef LOG_LEVEL
+#define LOG_LEVEL         ((DBG) ? LOG_LEVEL_DEBUG : LOG_LEVEL_INFO)
+#endif
+#ifndef LOG_MODULES
+#define LOG_MODULES       LOG_MODULE_ALL
+#endif
+
+/*
+   capture the raw advertisements: 0 = off, 1 = Serial, 2 = flash -- see capture.h
+*/
+#ifndef BT_CAPTURE
+#define BT_CAPTURE        0
+#endif
+
 
 /*
   tags to mark the configuration in the EEPROM
@@ -0,0 +1,671 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module to keep the history of the machine transitions
+
+  The transitions are recorded by the scan callback (BLE task) and the
+  loop, the blocks are written by the loop and read by the web server,
+  so the state in RAM is guarded by a mutex. Nothing in the recording
+  path allocates or touches the flash.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_HISTORY
+
+#include <mutex>
+#include <LittleFS.h>
+#include "config.h"
+#include "history.h"
+#include "ntp.h"
+#include "util.h"
+
+/*
+   a block -- data holds the header and the records as in the flash
+*/
+typedef struct _history_block {
+  uint32_t seq;
+  uint32_t base;
+  uint32_t last;
+  size_t length;            // including the header
+  uint8_t data[HISTORY_BLOCK_SIZE];
+} HISTORY_BLOCK_T;
+
+/*
+   the time range of a block in the flash
+*/
+typedef struct _history_index {
+  uint32_t seq;             // 0 if the slot is empty
+  uint32_t base;
+  uint32_t last;
+} HISTORY_INDEX_T;
+
+static std::mutex _history_mutex;
+
+/*
+   the newest block and the time of the last record of every machine in it
+*/
+static HISTORY_BLOCK_T _history_current;
+static uint32_t _history_times[HISTORY_MACHINES];
+static bool _history_dirty = false;
+
+/*
+   the full block which waits to be written
+*/
+static HISTORY_BLOCK_T _history_full;
+static bool _history_full_pending = false;
+
+/*
+   the blocks in the flash
+*/
+static HISTORY_INDEX_T _history_index[HISTORY_BLOCKS];
+static bool _history_ready = false;
+static unsigned long _history_last_flush = 0;
+
+/*
+   the IDs of the machines -- the index is the machine in the records; a slot is
+   taken over by a new machine once the last block with a record of its machine
+   has left the ring, so no record in the log refers to the old one any more
+*/
+static char _history_ids[HISTORY_MACHINES][MACHINE_ID_MAX_LEN + 1];
+static uint32_t _history_seqs[HISTORY_MACHINES];    // the block with the last record of the machine
+static int _history_id_count = 0;
+static bool _history_ids_dirty = false;
+static bool _history_ids_warned = false;
+
+static HISTORY_STATS_T _history_stats;
+
+/*
+   the block being written -- only used by the loop
+*/
+static HISTORY_BLOCK_T _history_write;
+
+/*
+   the query -- only used by the web server
+*/
+static HISTORY_BLOCK_T _history_read;
+static uint32_t _history_busy[HISTORY_BUCKETS_MAX];
+static uint16_t _history_changes[HISTORY_BUCKETS_MAX];
+
+/*
+   little endian helpers
+*/
+static void HistoryPut32(uint8_t *buffer, uint32_t value)
+{
+  for (int n = 0; n < 4; n++)
+    buffer[n] = value >> (8 * n);
+}
+
+static uint32_t HistoryGet32(const uint8_t *buffer)
+{
+  return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t) buffer[3] << 24);
+}
+
+/*
+   LEB128
+*/
+static size_t HistoryPutVarint(uint8_t *buffer, size_t size, uint32_t value)
+{
+  size_t n = 0;
+
+  do {
+    if (n >= size)
+      return 0;
+    buffer[n++] = (value & 0x7f) | ((value > 0x7f) ? 0x80 : 0);
+    value >>= 7;
+  } while (value);
+  return n;
+}
+
+static size_t HistoryGetVarint(const uint8_t *buffer, size_t length, uint32_t *value)
+{
+  *value = 0;
+  for (size_t n = 0; n < length && n < 5; n++) {
+    *value |= (uint32_t) (buffer[n] & 0x7f) << (7 * n);
+    if (!(buffer[n] & 0x80))
+      return n + 1;
+  }
+  return 0;
+}
+
+/*
+   encode/decode a record
+*/
+size_t HistoryEncode(uint8_t *buffer, size_t size, int machine, uint8_t state, uint32_t delta)
+{
+  size_t n = HistoryPutVarint(buffer, size, ((uint32_t) machine << HISTORY_STATE_BITS) | state);
+  size_t m = (n) ? HistoryPutVarint(&buffer[n], size - n, delta) : 0;
+
+  return (m) ? n + m : 0;
+}
+
+size_t HistoryDecode(const uint8_t *buffer, size_t length, int *machine, uint8_t *state, uint32_t *delta)
+{
+  uint32_t key;
+  size_t n = HistoryGetVarint(buffer, length, &key);
+  size_t m = (n) ? HistoryGetVarint(&buffer[n], length - n, delta) : 0;
+
+  if (!m)
+    return 0;
+  *machine = key >> HISTORY_STATE_BITS;
+  *state = key & ((1 << HISTORY_STATE_BITS) - 1);
+  return n + m;
+}
+
+/*
+   start an empty block
+*/
+static void HistoryBlockStart(HISTORY_BLOCK_T *block, uint32_t seq)
+{
+  block->seq = seq;
+  block->base = 0;
+  block->last = 0;
+  block->length = HISTORY_HEADER_SIZE;
+}
+
+/*
+   write/parse the header of a block
+*/
+static void HistoryBlockHeader(HISTORY_BLOCK_T *block)
+{
+  memcpy(block->data, HISTORY_MAGIC, 2);
+  block->data[2] = HISTORY_VERSION;
+  block->data[3] = 0;
+  HistoryPut32(&block->data[4], block->seq);
+  HistoryPut32(&block->data[8], block->base);
+  HistoryPut32(&block->data[12], block->last);
+  block->data[16] = block->length;
+  block->data[17] = block->length >> 8;
+  block->data[18] = block->data[19] = 0;
+}
+
+static bool HistoryBlockParse(HISTORY_BLOCK_T *block, size_t size)
+{
+  if (size < HISTORY_HEADER_SIZE || memcmp(block->data, HISTORY_MAGIC, 2) || block->data[2] != HISTORY_VERSION)
+    return false;
+  block->seq = HistoryGet32(&block->data[4]);
+  block->base = HistoryGet32(&block->data[8]);
+  block->last = HistoryGet32(&block->data[12]);
+  block->length = block->data[16] | (block->data[17] << 8);
+  return block->seq && block->length >= HISTORY_HEADER_SIZE && block->length <= size;
+}
+
+/*
+   read a block from the flash
+*/
+static bool HistoryBlockRead(File &file, uint32_t seq, HISTORY_BLOCK_T *block)
+{
+  if (!file.seek((seq % HISTORY_BLOCKS) * HISTORY_BLOCK_SIZE))
+    return false;
+  return HistoryBlockParse(block, file.read(block->data, HISTORY_BLOCK_SIZE)) && block->seq == seq;
+}
+
+/*
+   write a block to the flash
+*/
+static bool HistoryBlockWrite(const HISTORY_BLOCK_T *block)
+{
+  File file = LittleFS.open(HISTORY_FILE, "r+");
+
+  if (!file)
+    return false;
+
+  bool ok = file.seek((block->seq % HISTORY_BLOCKS) * HISTORY_BLOCK_SIZE) &&
+            file.write(block->data, block->length) == block->length;
+
+  file.close();
+  return ok;
+}
+
+/*
+   find a machine, add it if it is new -- returns -1 if the table is full and every
+   machine in it still has records in the ring
+*/
+static int HistoryMachine(const char *machineId, bool add)
+{
+  for (int n = 0; n < _history_id_count; n++)
+    if (!strcmp(_history_ids[n], machineId))
+      return n;
+
+  if (!add)
+    return -1;
+
+  int machine = _history_id_count;
+
+  if (machine >= HISTORY_MACHINES) {
+    uint32_t oldest = (_history_current.seq > HISTORY_BLOCKS) ? _history_current.seq - HISTORY_BLOCKS + 1 : 1;
+
+    machine = -1;
+    for (int n = 0; n < HISTORY_MACHINES; n++)
+      if (_history_seqs[n] < oldest && (machine < 0 || _history_seqs[n] < _history_seqs[machine]))
+        machine = n;
+    if (machine < 0) {
+      if (!_history_ids_warned)
+        LogWarn("HISTORY: no slot for machine %s -- all %d machines have records in the log, "
+                "the transitions of new machines are dropped", machineId, HISTORY_MACHINES);
+      _history_ids_warned = true;
+      return -1;
+    }
+    LogMsg("HISTORY: machine %s takes the slot of %s", machineId, _history_ids[machine]);
+    _history_ids_warned = false;
+  }
+  else
+    _history_id_count++;
+
+  memset(_history_ids[machine], 0, sizeof(_history_ids[machine]));
+  strncpy(_history_ids[machine], machineId, MACHINE_ID_MAX_LEN);
+  _history_seqs[machine] = 0;
+  _history_times[machine] = 0;
+  _history_ids_dirty = true;
+  return machine;
+}
+
+/*
+   setup
+*/
+void HistorySetup(void)
+{
+  std::lock_guard<std::mutex> lock(_history_mutex);
+
+  HistoryBlockStart(&_history_current, 1);
+  if (!LittleFS.begin(true)) {
+    LogMsg("HISTORY: couldn't mount the flash -- the history is not stored");
+    return;
+  }
+
+  /*
+     the IDs of the machines
+  */
+  File file = LittleFS.open(HISTORY_IDS_FILE, "r");
+
+  if (file) {
+    while (_history_id_count < HISTORY_MACHINES &&
+           file.read((uint8_t *) _history_ids[_history_id_count], sizeof(_history_ids[0])) == sizeof(_history_ids[0]))
+      _history_ids[_history_id_count++][MACHINE_ID_MAX_LEN] = '\0';
+    file.close();
+  }
+
+  /*
+     the index of the blocks
+  */
+  if (!LittleFS.exists(HISTORY_FILE) && (file = LittleFS.open(HISTORY_FILE, "w")))
+    file.close();
+  if (!(file = LittleFS.open(HISTORY_FILE, "r"))) {
+    LogMsg("HISTORY: couldn't open %s -- the history is not stored", HISTORY_FILE);
+    return;
+  }
+
+  uint32_t newest = 0;
+
+  for (uint32_t slot = 0; slot < HISTORY_BLOCKS; slot++) {
+    if (file.seek(slot * HISTORY_BLOCK_SIZE) &&
+        HistoryBlockParse(&_history_read, file.read(_history_read.data, HISTORY_BLOCK_SIZE)) &&
+        _history_read.seq % HISTORY_BLOCKS == slot) {
+      _history_index[slot].seq = _history_read.seq;
+      _history_index[slot].base = _history_read.base;
+      _history_index[slot].last = _history_read.last;
+      newest = MAX(newest, _history_read.seq);
+
+      /*
+         the last block of every machine -- its slot can't be taken over before that block is gone
+      */
+      size_t offset = HISTORY_HEADER_SIZE;
+      int machine;
+      uint8_t state;
+      uint32_t delta;
+      size_t n;
+
+      while ((n = HistoryDecode(&_history_read.data[offset], _history_read.length - offset, &machine, &state, &delta)) &&
+             machine < HISTORY_MACHINES) {
+        _history_seqs[machine] = MAX(_history_seqs[machine], _history_read.seq);
+        offset += n;
+      }
+    }
+  }
+
+  /*
+     continue with the newest block
+  */
+  if (newest && HistoryBlockRead(file, newest, &_history_current)) {
+    size_t offset = HISTORY_HEADER_SIZE;
+    int machine;
+    uint8_t state;
+    uint32_t delta;
+    size_t n;
+
+    while ((n = HistoryDecode(&_history_current.data[offset], _history_current.length - offset, &machine, &state, &delta)) &&
+           machine < HISTORY_MACHINES) {
+      _history_times[machine] = ((_history_times[machine]) ? _history_times[machine] : _history_current.base) + delta;
+      offset += n;
+    }
+    _history_current.length = offset;
+  }
+  file.close();
+
+  _history_ready = true;
+  _history_last_flush = millis();
+  LogMsg("HISTORY: %d machines, newest block %lu", _history_id_count, (unsigned long) newest);
+}
+
+/*
+   write the blocks to the flash
+*/
+void HistoryUpdate(void)
+{
+  if (!_history_ready)
+    return;
+
+  bool full = false;
+  bool write = false;
+  int ids = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(_history_mutex);
+
+    if ((full = _history_full_pending)) {
+      _history_write = _history_full;
+      write = true;
+    }
+    else if (_history_dirty && millis() - _history_last_flush >= HISTORY_FLUSH_INTERVAL) {
+      HistoryBlockHeader(&_history_current);
+      _history_write = _history_current;
+      _history_dirty = false;
+      _history_last_flush = millis();
+      write = true;
+    }
+    if (_history_ids_dirty) {
+      ids = _history_id_count;
+      _history_ids_dirty = false;
+    }
+  }
+
+  /*
+     the IDs are copied in chunks under the lock -- a slot may be taken over meanwhile
+  */
+  if (ids) {
+    File file = LittleFS.open(HISTORY_IDS_FILE, "w");
+    bool ok = file;
+
+    for (int n = 0; ok && n < ids; n += HISTORY_IDS_CHUNK) {
+      char chunk[HISTORY_IDS_CHUNK][MACHINE_ID_MAX_LEN + 1];
+      int count = MIN(HISTORY_IDS_CHUNK, ids - n);
+
+      {
+        std::lock_guard<std::mutex> lock(_history_mutex);
+
+        memcpy(chunk, _history_ids[n], count * sizeof(chunk[0]));
+      }
+      ok = file.write((const uint8_t *) chunk, count * sizeof(chunk[0])) == count * sizeof(chunk[0]);
+    }
+    if (!ok)
+      LogMsg("HISTORY: couldn't write %s", HISTORY_IDS_FILE);
+    file.close();
+  }
+
+  if (!write)
+    return;
+  if (!HistoryBlockWrite(&_history_write))
+    LogMsg("HISTORY: couldn't write block %lu", (unsigned long) _history_write.seq);
+
+  std::lock_guard<std::mutex> lock(_history_mutex);
+  HISTORY_INDEX_T *index = &_history_index[_history_write.seq % HISTORY_BLOCKS];
+
+  index->seq = _history_write.seq;
+  index->base = _history_write.base;
+  index->last = _history_write.last;
+  if (full)
+    _history_full_pending = false;
+  _history_stats.blocks++;
+}
+
+/*
+   record a transition
+*/
+void HistoryRecord(const char *machineId, uint32_t time, uint8_t state)
+{
+  std::lock_guard<std::mutex> lock(_history_mutex);
+  int machine = (time) ? HistoryMachine(machineId, true) : -1;
+
+  if (machine < 0) {
+    _history_stats.dropped++;
+    return;
+  }
+  if (!_history_current.seq)
+    HistoryBlockStart(&_history_current, 1);
+
+  for (;;) {
+    bool first = _history_current.length == HISTORY_HEADER_SIZE;
+    uint32_t ref = (first) ? time : (_history_times[machine]) ? _history_times[machine] : _history_current.base;
+
+    /*
+       the time doesn't go back in the log
+    */
+    time = MAX(time, ref);
+
+    size_t n = HistoryEncode(&_history_current.data[_history_current.length], HISTORY_BLOCK_SIZE - _history_current.length,
+                             machine, state, time - ref);
+
+    if (n) {
+      if (first)
+        _history_current.base = time;
+      _history_current.length += n;
+      _history_current.last = MAX(_history_current.last, time);
+      _history_times[machine] = time;
+      _history_seqs[machine] = _history_current.seq;
+      _history_dirty = true;
+      _history_stats.transitions++;
+      _history_stats.bytes += n;
+      return;
+    }
+
+    /*
+       the block is full -- the loop writes it, a new one starts
+    */
+    if (_history_full_pending) {
+      _history_stats.dropped++;
+      return;
+    }
+    HistoryBlockHeader(&_history_current);
+    _history_full = _history_current;
+    _history_full_pending = true;
+    HistoryBlockStart(&_history_current, _history_current.seq + 1);
+    memset(_history_times, 0, sizeof(_history_times));
+  }
+}
+
+/*
+   get a block -- from RAM if it is not yet written
+*/
+static bool HistoryLoad(File &file, uint32_t seq, HISTORY_BLOCK_T *block)
+{
+  {
+    std::lock_guard<std::mutex> lock(_history_mutex);
+
+    if (seq == _history_current.seq) {
+      *block = _history_current;
+      return true;
+    }
+    if (_history_full_pending && seq == _history_full.seq) {
+      *block = _history_full;
+      return true;
+    }
+    if (_history_index[seq % HISTORY_BLOCKS].seq != seq)
+      return false;
+  }
+  return file && HistoryBlockRead(file, seq, block);
+}
+
+/*
+   the state of the machine while the blocks are scanned
+*/
+typedef struct _history_scan {
+  int machine;
+  bool known;               // a record of the machine was found
+  uint8_t state;
+  uint32_t time;
+  uint32_t from;            // the buckets
+  uint32_t step;
+  uint32_t end;             // the end of the elapsed time
+} HISTORY_SCAN_T;
+
+/*
+   add the time of a state to the buckets
+*/
+static void HistoryAccount(const HISTORY_SCAN_T *scan, uint32_t to)
+{
+  if ((scan->state & (HISTORY_RUNNING | HISTORY_PRESENT)) != (HISTORY_RUNNING | HISTORY_PRESENT))
+    return;
+
+  uint32_t from = MAX(scan->time, scan->from);
+
+  to = MIN(to, scan->end);
+  while (from < to) {
+    uint32_t bucket = (from - scan->from) / scan->step;
+    uint32_t next = MIN(to, scan->from + (bucket + 1) * scan->step);
+
+    _history_busy[bucket] += next - from;
+    from = next;
+  }
+}
+
+/*
+   go through the records of the machine in a block
+*/
+static void HistoryScan(HISTORY_SCAN_T *scan, const HISTORY_BLOCK_T *block)
+{
+  size_t offset = HISTORY_HEADER_SIZE;
+  uint32_t last = 0;
+  int machine;
+  uint8_t state;
+  uint32_t delta;
+  size_t n;
+
+  while ((n = HistoryDecode(&block->data[offset], block->length - offset, &machine, &state, &delta))) {
+    offset += n;
+    if (machine != scan->machine)
+      continue;
+
+    uint32_t time = ((last) ? last : block->base) + delta;
+
+    if (scan->known)
+      HistoryAccount(scan, time);
+    if (time >= scan->from && time < scan->end)
+      _history_changes[(time - scan->from) / scan->step]++;
+    scan->known = true;
+    scan->state = state;
+    scan->time = last = time;
+  }
+}
+
+/*
+   write the utilization of a machine as JSON
+*/
+bool HistoryJSON(JSON_WRITER_T *json, const char *machineId, uint32_t from, uint32_t step, int count)
+{
+  HISTORY_SCAN_T scan;
+  uint32_t newest;
+
+  {
+    std::lock_guard<std::mutex> lock(_history_mutex);
+
+    scan.machine = HistoryMachine(machineId, false);
+    newest = _history_current.seq;
+  }
+  if (scan.machine < 0)
+    return false;
+
+  step = MAX(HISTORY_STEP_MIN, MIN(step, HISTORY_STEP_MAX));
+  count = MAX(1, MIN(count, HISTORY_BUCKETS_MAX));
+
+  uint32_t to = from + step * count;
+  uint32_t now = NtpGetTime();
+
+  scan.known = false;
+  scan.state = 0;
+  scan.time = 0;
+  scan.from = from;
+  scan.step = step;
+  scan.end = (now) ? MAX(from, MIN(to, now)) : to;
+  memset(_history_busy, 0, sizeof(_history_busy));
+  memset(_history_changes, 0, sizeof(_history_changes));
+
+  /*
+     the blocks which end before the range are skipped
+  */
+  uint32_t oldest = (newest > HISTORY_BLOCKS) ? newest - HISTORY_BLOCKS + 1 : 1;
+  uint32_t before = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(_history_mutex);
+
+    for (uint32_t seq = oldest; seq < newest; seq++) {
+      const HISTORY_INDEX_T *index = &_history_index[seq % HISTORY_BLOCKS];
+
+      if (index->seq == seq && index->last < from)
+        before = seq;
+    }
+  }
+
+  File file = LittleFS.open(HISTORY_FILE, "r");
+
+  /*
+     the state at the start of the range is the last record of the machine before it
+  */
+  for (uint32_t seq = before; seq >= oldest && seq && !scan.known; seq--)
+    if (HistoryLoad(file, seq, &_history_read))
+      HistoryScan(&scan, &_history_read);
+
+  for (uint32_t seq = (before) ? before + 1 : oldest; seq <= newest; seq++) {
+    if (!HistoryLoad(file, seq, &_history_read))
+      continue;
+    if (_history_read.base >= scan.end && _history_read.length > HISTORY_HEADER_SIZE)
+      break;
+    HistoryScan(&scan, &_history_read);
+  }
+  if (scan.known)
+    HistoryAccount(&scan, scan.end);
+  file.close();
+
+  /*
+     the utilization in % of the elapsed time of the bucket, null for the future
+  */
+  JsonObjectBegin(json, NULL);
+  JsonString(json, "machineId", machineId);
+  JsonUInt(json, "from", from);
+  JsonUInt(json, "step", step);
+  JsonArrayBegin(json, "utilization");
+  for (int n = 0; n < count; n++) {
+    uint32_t start = from + n * step;
+
+    if (start >= scan.end)
+      JsonNull(json, NULL);
+    else
+      JsonUInt(json, NULL, _history_busy[n] * 100 / (MIN(start + step, scan.end) - start));
+  }
+  JsonArrayEnd(json);
+  JsonArrayBegin(json, "transitions");
+  for (int n = 0; n < count; n++)
+    JsonUInt(json, NULL, _history_changes[n]);
+  JsonArrayEnd(json);
+  JsonObjectEnd(json);
+  return true;
+}
+
+/*
+   get the statistics
+*/
+void HistoryStats(HISTORY_STATS_T *stats)
+{
+  std::lock_guard<std::mutex> lock(_history_mutex);
+
+  *stats = _history_stats;
+  stats->machines = _history_id_count;
+}
+
+/**/
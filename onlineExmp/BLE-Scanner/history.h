@@ -0,0 +1,141 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module to keep the history of the machine transitions
+
+  Every transition of a machine -- new, state change, absent, returned --
+  is appended to a log in the flash, so the utilization of the last weeks
+  can be queried on the gateway itself (/history), also while the cloud
+  is not reachable.
+
+  The log is a ring of HISTORY_BLOCKS blocks in HISTORY_FILE, the newest
+  block is kept in RAM and written every HISTORY_FLUSH_INTERVAL and when
+  it is full. The time range of every block is kept in RAM, so a query
+  reads only the blocks of its range.
+
+  block format (all values little endian)
+
+    header    "HS" version(1) reserved(1) seq(4) base(4) last(4) length(2) reserved(2)
+    record    key(varint) delta(varint)
+
+  seq counts the blocks from 1, the block is stored at seq % HISTORY_BLOCKS.
+  base and last are the times of the first and the last record in seconds
+  since Jan 1 1970, length is the size of the block including the header.
+  key is the index of the machine in HISTORY_IDS_FILE shifted left by 3 or
+  the state (HISTORY_RUNNING, ...), delta is the time since the previous
+  record of the machine in the block, or since base for the first one.
+  The varint is LEB128.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __HISTORY_H__
+#define __HISTORY_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "json.h"
+#include "scandev.h"
+
+/*
+   the files in the flash
+*/
+#define HISTORY_FILE            "/history.bin"
+#define HISTORY_IDS_FILE        "/history.ids"
+
+/*
+   the ring -- 128 kB, about a month with 50 machines
+*/
+#ifndef HISTORY_BLOCKS
+#define HISTORY_BLOCKS          256
+#endif
+#define HISTORY_BLOCK_SIZE      512
+
+/*
+   format
+*/
+#define HISTORY_MAGIC           "HS"
+#define HISTORY_VERSION         1
+#define HISTORY_HEADER_SIZE     20
+#define HISTORY_RECORD_MAX      (5 + 5)
+
+/*
+   max. number of machines in the log -- beyond that a new machine takes the slot of
+   one without records in the ring; the IDs are written in chunks of ...
+*/
+#define HISTORY_MACHINES        SCANDEV_MAX_MACHINES
+#define HISTORY_IDS_CHUNK       16
+
+/*
+   the state of a machine in a record
+*/
+#define HISTORY_RUNNING         0x01
+#define HISTORY_EMPTY           0x02
+#define HISTORY_PRESENT         0x04
+#define HISTORY_STATE_BITS      3
+
+/*
+   the block in RAM is written every ... ms, if it changed
+*/
+#define HISTORY_FLUSH_INTERVAL  (5 * 60 * 1000)
+
+/*
+   limits of a query: number of buckets and min./max. size of a bucket in seconds
+*/
+#define HISTORY_BUCKETS_MAX     336
+#define HISTORY_STEP_MIN        60
+#define HISTORY_STEP_MAX        (7 * 24 * 3600)
+
+/*
+   statistics
+*/
+typedef struct _history_stats {
+  unsigned long transitions;    // recorded
+  unsigned long dropped;        // not recorded: no time, no free slot for the machine or the flash was too slow
+  unsigned long bytes;          // of the records
+  unsigned long blocks;         // written to the flash
+  int machines;
+} HISTORY_STATS_T;
+
+/*
+   encode/decode a record -- return the size, 0 if the buffer is too small resp. the record is incomplete
+*/
+size_t HistoryEncode(uint8_t *buffer, size_t size, int machine, uint8_t state, uint32_t delta);
+size_t HistoryDecode(const uint8_t *buffer, size_t length, int *machine, uint8_t *state, uint32_t *delta);
+
+/*
+   setup -- load the index of the blocks and the newest block
+*/
+void HistorySetup(void);
+
+/*
+   write the blocks to the flash
+*/
+void HistoryUpdate(void);
+
+/*
+   record a transition -- time in seconds since Jan 1 1970, 0 if unknown
+*/
+void HistoryRecord(const char *machineId, uint32_t time, uint8_t state);
+
+/*
+   write the utilization of a machine as JSON -- count buckets of step
+   seconds starting at from, returns false if the machine is unknown
+*/
+bool HistoryJSON(JSON_WRITER_T *json, const char *machineId, uint32_t from, uint32_t step, int count);
+
+/*
+   get the statistics
+*/
+void HistoryStats(HISTORY_STATS_T *stats);
+
+#endif
+
+/**/
@@ -0,0 +1,204 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  check of the zero allocation steady state
+
+  The gateway runs on the virtual clock with SCANDEV_MAX_MACHINES machines,
+  every machine advertises a new status per round, so every round goes
+  through the scan callback, the machine table, the MQTT publishing and
+  the JSON of the machine table.
+  After the warm-up rounds (the table is filled, the buffers have their
+  size) the allocation counters are reset -- the steady state rounds must
+  not allocate in the hot path subsystems (see memstat.h), otherwise the
+  check fails.
+
+  The advertisements are passed like a replay, so every one of them
+  reaches the scan callback (see HostBleReplay()).
+
+  usage: scanner-alloccheck-<machines> [-w <warm-up rounds>] [-r <rounds>]
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <unistd.h>
+#include "config.h"
+#include "scandev.h"
+#include "json.h"
+#include "memstat.h"
+#include "util.h"
+#include "host.h"
+
+/*
+   start of the virtual clock: Nov 14 2023
+*/
+#define ALLOCCHECK_EPOCH_US     1700000000000000ULL
+
+/*
+   the loop of the sketch runs every ...
+*/
+#define ALLOCCHECK_LOOP_US      (10 * 1000)
+
+/*
+   a round lasts longer than the min. interval between two publishes of a machine
+*/
+#define ALLOCCHECK_ROUND_US     (20 * 1000 * 1000)
+
+/*
+   the subsystems which must not allocate in steady state
+*/
+static const int _hot[] = { MEMSTAT_BT, MEMSTAT_SCANDEV, MEMSTAT_MQTT };
+
+static int _warmup = 2;
+static int _rounds = 3;
+
+static unsigned long _publishes = 0;
+
+static void AllocCheckJSON(const char *data, size_t length)
+{
+}
+
+static void AllocCheckPublished(const char *topic, const char *payload, unsigned int length)
+{
+  _publishes++;
+}
+
+/*
+   one round: every machine advertises its new status, then the loop runs
+*/
+static void AllocCheckRound(int round)
+{
+  for (int n = 0; n < SCANDEV_MAX_MACHINES; n++) {
+    uint8_t addr[6] = { 0x02, 0x00, 0x00, (uint8_t) (n >> 16), (uint8_t) (n >> 8), (uint8_t) n };
+    uint8_t payload[31 + 16];
+    size_t length = 0;
+
+    payload[length++] = 2;
+    payload[length++] = 0x01;     // flags
+    payload[length++] = 0x06;
+    payload[length++] = 2 + MACHINE_ID_MAX_LEN + 1 + 1;
+    payload[length++] = 0xff;     // manufacturer data
+    payload[length++] = TARGET_MANUFACTURER_ID & 0xff;
+    payload[length++] = TARGET_MANUFACTURER_ID >> 8;
+    memset(&payload[length], 0, MACHINE_ID_MAX_LEN);
+    snprintf((char *) &payload[length], MACHINE_ID_MAX_LEN, "M%05d", n);
+    length += MACHINE_ID_MAX_LEN;
+    payload[length++] = (round + n) & 0x03;
+    payload[length++] = 1 + strlen(TARGET_DEVICE_NAME);
+    payload[length++] = 0x09;     // name, from the scan response
+    memcpy(&payload[length], TARGET_DEVICE_NAME, strlen(TARGET_DEVICE_NAME));
+    length += strlen(TARGET_DEVICE_NAME);
+
+    HostClockAdvance(1);
+    HostBleReplay(addr, BLE_ADDR_PUBLIC, -60 - n % 30, payload, length);
+  }
+
+  for (uint64_t t = 0; t < ALLOCCHECK_ROUND_US; t += ALLOCCHECK_LOOP_US) {
+    HostClockAdvance(ALLOCCHECK_LOOP_US);
+    HostSketchLoop();
+  }
+
+  /*
+     /api/machines
+  */
+  MEMSTAT_SCOPE(MEMSTAT_SCANDEV);
+  JSON_WRITER_T json;
+
+  JsonBegin(&json, AllocCheckJSON);
+  ScanDevListJSON(&json);
+  JsonEnd(&json);
+}
+
+/*
+   the counters see malloc() and the buffer of a String longer than its
+   small string optimization -- otherwise the check would miss them
+*/
+static bool AllocCheckSeen(void)
+{
+  MEMSTAT_ALLOCS_T allocs;
+
+  MemStatReset();
+  {
+    MEMSTAT_SCOPE(MEMSTAT_HTTP);
+    String small("0123456789");
+    String large("longer than the small string optimization");
+
+    void *volatile buffer = malloc(16);    // volatile, the pair isn't optimized away
+
+    free(buffer);
+  }
+  MemStatAllocs(MEMSTAT_HTTP, &allocs);
+
+  bool ok = allocs.allocs == 2 && allocs.frees == 2;
+
+  printf("ALLOCCHECK: malloc() and String counted, %lu allocs %lu frees %s\n", allocs.allocs, allocs.frees,
+         (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "w:r:")) != -1) {
+    switch (opt) {
+      case 'w': _warmup = MAX(1, atoi(optarg)); break;
+      case 'r': _rounds = MAX(1, atoi(optarg)); break;
+      default:
+        fprintf(stderr, "usage: %s [-w <warm-up rounds>] [-r <rounds>]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  HostSerialMute(true);
+  HostClockVirtual(ALLOCCHECK_EPOCH_US);
+  HostWifiSet(true);
+  HostNtpSet(true);
+  HostMqttSet(true, AllocCheckPublished);
+  HostSketchSetup();
+
+  bool seen = AllocCheckSeen();
+  int round = 0;
+
+  while (round < _warmup)
+    AllocCheckRound(round++);
+
+  unsigned long publishes = _publishes;
+
+  MemStatReset();
+  while (round < _warmup + _rounds)
+    AllocCheckRound(round++);
+
+  printf("ALLOCCHECK: %d machines, %d warm-up and %d steady state rounds, %lu publishes\n",
+         ScanDevGetCount(), _warmup, _rounds, _publishes - publishes);
+
+  bool failed = !seen;
+
+  for (int n = 0; n < MEMSTAT_SUBSYSTEMS; n++) {
+    MEMSTAT_ALLOCS_T allocs;
+    bool hot = false;
+
+    for (size_t h = 0; h < sizeof(_hot) / sizeof(_hot[0]); h++)
+      hot |= _hot[h] == n;
+
+    MemStatAllocs(n, &allocs);
+    printf("  %-8s %10lu allocs %10lu frees %12lu bytes%s\n", MemStatName(n),
+           allocs.allocs, allocs.frees, allocs.bytes,
+           (!hot) ? "" : (allocs.allocs) ? "  FAILED" : "  ok");
+    failed |= hot && allocs.allocs;
+  }
+
+  if (ScanDevGetCount() != SCANDEV_MAX_MACHINES || _publishes == publishes) {
+    printf("ALLOCCHECK: the hot paths were not exercised\n");
+    failed = true;
+  }
+  printf("ALLOCCHECK: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
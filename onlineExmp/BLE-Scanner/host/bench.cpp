@@ -0,0 +1,232 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  benchmark of the scanner core on the host
+
+  measures
+    - adverts/s through ScanDevAddMachine()
+    - messages/s through the MQTT payload builder and the publish path
+    - cost of one ScanDevUpdate() loop with SCANDEV_MAX_MACHINES machines
+    - cost of the JSON of the machine table (/api/machines)
+
+  The scanner runs on the virtual clock, the measurements use the real
+  clock of the host.
+
+  usage: scanner-bench-<machines> [-t <ms per measurement>]
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <chrono>
+#include <unistd.h>
+#include "config.h"
+#include "state.h"
+#include "scandev.h"
+#include "json.h"
+#include "mqtt.h"
+#include "ntp.h"
+#include "util.h"
+#include "host.h"
+
+/*
+   default time per measurement in milli seconds
+*/
+#define BENCH_TIME_MS         500
+
+/*
+   start of the virtual clock: Nov 14 2023
+*/
+#define BENCH_EPOCH_US        1700000000000000ULL
+
+/*
+   the scanner doesn't publish a machine more often than this (see scandev.cpp)
+*/
+#define BENCH_POST_INTERVAL   5
+
+static char _machine_ids[SCANDEV_MAX_MACHINES][MACHINE_ID_MAX_LEN + 1];
+static BLEAddress _machine_addrs[SCANDEV_MAX_MACHINES];
+static bool _machine_running[SCANDEV_MAX_MACHINES];
+
+static unsigned long _bench_time_ms = BENCH_TIME_MS;
+
+/*
+   get the real time in seconds
+*/
+static double BenchTime(void)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+   print a result
+*/
+static void BenchReport(const char *name, unsigned long ops, double seconds, const char *unit)
+{
+  printf("%-40s %12.0f %s/s %10.1f ns/%s\n", name, ops / seconds, unit, seconds * 1e9 / ops, unit);
+}
+
+/*
+   run the function in batches until the measurement time is over
+*/
+template<typename F>
+static void BenchRun(const char *name, const char *unit, F fn)
+{
+  unsigned long ops = 0;
+  double start = BenchTime();
+  double elapsed;
+
+  do {
+    for (int n = 0; n < 1024; n++)
+      fn(ops++);
+  } while ((elapsed = BenchTime() - start) * 1000 < _bench_time_ms);
+
+  BenchReport(name, ops, elapsed, unit);
+}
+
+/*
+   run the function once per loop, but only measure the time of ScanDevUpdate()
+*/
+template<typename F>
+static void BenchUpdate(const char *name, F prepare)
+{
+  unsigned long loops = 0;
+  double total = 0;
+  double start = BenchTime();
+
+  do {
+    prepare(loops);
+
+    double t = BenchTime();
+    ScanDevUpdate();
+    total += BenchTime() - t;
+    loops++;
+  } while ((BenchTime() - start) * 1000 < _bench_time_ms);
+
+  printf("%-40s %12.0f loops/s %9.2f us/loop\n", name, loops / total, total * 1e6 / loops);
+}
+
+/*
+   setup the scanner core
+*/
+static void BenchSetup(void)
+{
+  HostSerialMute(true);
+  HostClockVirtual(BENCH_EPOCH_US);
+  HostWifiSet(true);
+  HostNtpSet(true);
+  HostMqttSet(true, NULL);
+
+  ConfigSetup();
+  StateSetup(STATE_SCANNING);
+  StateUpdate();
+  ScanDevSetup();
+  MqttSetup();
+
+  for (int n = 0; n < SCANDEV_MAX_MACHINES; n++) {
+    uint8_t addr[6] = { (uint8_t) n, (uint8_t) (n >> 8), 0x00, 0xde, 0xad, 0xbe };
+
+    snprintf(_machine_ids[n], sizeof(_machine_ids[n]), "MACHINE-%05d", n);
+    _machine_addrs[n] = BLEAddress(addr, BLE_ADDR_RANDOM);
+    ScanDevAddMachine(_machine_addrs[n], _machine_ids[n], "", false, true, -60, NtpGetTimeUs());
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:")) != -1) {
+    switch (opt) {
+      case 't':
+        _bench_time_ms = strtoul(optarg, NULL, 10);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-t <ms per measurement>]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  BenchSetup();
+  printf("BENCH: %d machines, log level %d, %lu ms per measurement\n",
+         SCANDEV_MAX_MACHINES, LOG_LEVEL, _bench_time_ms);
+
+  /*
+     the advertisement path -- the machines are updated round robin
+  */
+  BenchRun("ScanDevAddMachine (unchanged)", "advert", [](unsigned long n) {
+    int m = n % SCANDEV_MAX_MACHINES;
+
+    HostClockAdvance(100);
+    ScanDevAddMachine(_machine_addrs[m], _machine_ids[m], "", _machine_running[m], true, -60, NtpGetTimeUs());
+  });
+
+  BenchRun("ScanDevAddMachine (state change)", "advert", [](unsigned long n) {
+    int m = n % SCANDEV_MAX_MACHINES;
+
+    HostClockAdvance(100);
+    _machine_running[m] = !_machine_running[m];
+    ScanDevAddMachine(_machine_addrs[m], _machine_ids[m], "", _machine_running[m], true, -60, NtpGetTimeUs());
+  });
+
+  /*
+     the publish path
+  */
+  BenchRun("MqttBuildMachineStatus", "msg", [](unsigned long n) {
+    char topic[MQTT_TOPIC_SIZE];
+    char payload[MQTT_PAYLOAD_SIZE];
+
+    MqttBuildMachineStatus(topic, sizeof(topic), payload, sizeof(payload),
+                           _machine_ids[n % SCANDEV_MAX_MACHINES], n & 1, n & 2, BENCH_EPOCH_US + n, BENCH_EPOCH_US + n);
+  });
+
+  BenchRun("MqttPublishMachineStatus", "msg", [](unsigned long n) {
+    MqttPublishMachineStatus(_machine_ids[n % SCANDEV_MAX_MACHINES], "", n & 1, n & 2, BENCH_EPOCH_US + n);
+  });
+
+  /*
+     the cyclic update
+  */
+  ScanDevUpdate();
+  BenchUpdate("ScanDevUpdate (idle)", [](unsigned long n) {
+    HostClockAdvance(1000);
+  });
+
+  unsigned long publishes_before;
+  HostMqttStats(NULL, &publishes_before);
+  BenchUpdate("ScanDevUpdate (all machines publish)", [](unsigned long n) {
+    HostClockAdvance(BENCH_POST_INTERVAL * 1000000ULL);
+    for (int m = 0; m < SCANDEV_MAX_MACHINES; m++) {
+      _machine_running[m] = !_machine_running[m];
+      ScanDevAddMachine(_machine_addrs[m], _machine_ids[m], "", _machine_running[m], true, -60, NtpGetTimeUs());
+    }
+  });
+
+  unsigned long publishes;
+  HostMqttStats(NULL, &publishes);
+  printf("BENCH: %lu messages published by ScanDevUpdate\n", publishes - publishes_before);
+
+  /*
+     the JSON API -- the chunks are dropped
+  */
+  static unsigned long json_bytes = 0;
+
+  BenchRun("ScanDevListJSON", "table", [](unsigned long n) {
+    JSON_WRITER_T json;
+
+    JsonBegin(&json, NULL);
+    ScanDevListJSON(&json);
+    JsonEnd(&json);
+    json_bytes = json.written;
+  });
+  printf("BENCH: %lu bytes of JSON per table\n", json_bytes);
+
+  return 0;
+}
+
+/**/
@@ -0,0 +1,319 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  minimal MQTT broker for the host
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "broker.h"
+#include "host.h"
+
+/*
+   a connected client
+*/
+typedef struct _broker_client {
+  int fd;
+  std::vector<uint8_t> in;
+  double tokens;
+  uint64_t tokens_us;
+} BROKER_CLIENT_T;
+
+static std::thread _broker_thread;
+static std::atomic<bool> _broker_running(false);
+static int _broker_fd = -1;
+static uint16_t _broker_port = 0;
+static BROKER_PUBLISH_CB _broker_callback = NULL;
+
+static std::atomic<unsigned long> _broker_rate(0);
+static std::atomic<int> _broker_limit_mode(BROKER_LIMIT_THROTTLE);
+
+static std::mutex _broker_stats_mutex;
+static BROKER_STATS_T _broker_stats;
+
+static uint64_t BrokerNowUs(void)
+{
+  return HostEpochUs();
+}
+
+/*
+   send a packet to a client -- the broker only sends short ones
+*/
+static void BrokerSend(BROKER_CLIENT_T *client, uint8_t header, const uint8_t *body, size_t length)
+{
+  uint8_t packet[2];
+
+  packet[0] = header;
+  packet[1] = length;
+  send(client->fd, packet, 2, MSG_NOSIGNAL);
+  if (length)
+    send(client->fd, body, length, MSG_NOSIGNAL);
+}
+
+/*
+   handle a complete packet -- false closes the connection
+*/
+static bool BrokerPacket(BROKER_CLIENT_T *client, uint8_t header, const uint8_t *body, size_t length, uint64_t now)
+{
+  std::lock_guard<std::mutex> lock(_broker_stats_mutex);
+
+  switch (header & 0xf0) {
+    case 0x10: {
+      /*
+         CONNECT -- accepted
+      */
+      static const uint8_t connack[] = { 0, 0 };
+
+      _broker_stats.connects++;
+      BrokerSend(client, 0x20, connack, sizeof(connack));
+      return true;
+    }
+    case 0x30: {
+      /*
+         PUBLISH
+      */
+      int qos = (header >> 1) & 0x03;
+      size_t topic_len;
+
+      if (length < 2 || (topic_len = (body[0] << 8) | body[1]) + 2 + ((qos) ? 2 : 0) > length)
+        return false;
+
+      std::string topic((const char *) &body[2], topic_len);
+      size_t offset = 2 + topic_len;
+
+      if (qos) {
+        uint8_t puback[] = { body[offset], body[offset + 1] };
+
+        BrokerSend(client, 0x40, puback, sizeof(puback));
+        offset += 2;
+      }
+      _broker_stats.publishes++;
+      if (_broker_callback)
+        (*_broker_callback)(topic.c_str(), &body[offset], length - offset, now);
+      return true;
+    }
+    case 0x80: {
+      /*
+         SUBSCRIBE -- every topic is granted with QoS 0, nothing is forwarded
+      */
+      uint8_t suback[2 + 16] = { body[0], body[1] };
+      size_t n = 2;
+
+      for (size_t pos = 2; pos + 2 < length && n < sizeof(suback); n++)
+        pos += 2 + ((body[pos] << 8) | body[pos + 1]) + 1;
+      memset(&suback[2], 0, n - 2);
+      BrokerSend(client, 0x90, suback, n);
+      return true;
+    }
+    case 0xc0:
+      /*
+         PINGREQ
+      */
+      _broker_stats.pings++;
+      BrokerSend(client, 0xd0, NULL, 0);
+      return true;
+    case 0xe0:
+      /*
+         DISCONNECT
+      */
+      return false;
+  }
+  return true;
+}
+
+/*
+   refill the tokens of the rate limit -- false if the client is above the limit
+*/
+static bool BrokerTokens(BROKER_CLIENT_T *client, uint64_t now)
+{
+  unsigned long rate = _broker_rate;
+
+  if (!rate)
+    return true;
+  client->tokens = std::min((double) rate, client->tokens + (now - client->tokens_us) * rate / 1e6);
+  client->tokens_us = now;
+  return client->tokens >= 1;
+}
+
+/*
+   handle the data of a client -- false closes the connection
+*/
+static bool BrokerInput(BROKER_CLIENT_T *client)
+{
+  uint8_t buffer[4096];
+  ssize_t n = recv(client->fd, buffer, sizeof(buffer), 0);
+
+  if (n <= 0)
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+  client->in.insert(client->in.end(), buffer, buffer + n);
+
+  uint64_t now = BrokerNowUs();
+
+  for (;;) {
+    size_t length = 0, pos = 1;
+    int shift = 0;
+    bool complete = false;
+
+    while (pos < client->in.size() && pos < 5) {
+      length |= (size_t) (client->in[pos] & 0x7f) << shift;
+      shift += 7;
+      if (!(client->in[pos++] & 0x80)) {
+        complete = client->in.size() >= pos + length;
+        break;
+      }
+    }
+    if (!complete)
+      return true;
+
+    uint8_t header = client->in[0];
+
+    if ((header & 0xf0) == 0x30 && _broker_rate) {
+      BrokerTokens(client, now);
+      if (client->tokens < 1 && _broker_limit_mode == BROKER_LIMIT_DISCONNECT) {
+        std::lock_guard<std::mutex> lock(_broker_stats_mutex);
+        _broker_stats.limit_disconnects++;
+        return false;
+      }
+      client->tokens -= 1;
+    }
+    if (!BrokerPacket(client, header, &client->in[pos], length, now))
+      return false;
+    client->in.erase(client->in.begin(), client->in.begin() + pos + length);
+  }
+}
+
+/*
+   the thread of the broker
+*/
+static void BrokerThread(void)
+{
+  std::vector<BROKER_CLIENT_T> clients;
+
+  while (_broker_running) {
+    std::vector<struct pollfd> pfds;
+    uint64_t now = BrokerNowUs();
+
+    pfds.push_back({ _broker_fd, POLLIN, 0 });
+    for (auto &client : clients) {
+      /*
+         a throttled client is not read until it has a token again
+      */
+      bool throttled = _broker_limit_mode == BROKER_LIMIT_THROTTLE && !BrokerTokens(&client, now);
+
+      if (throttled) {
+        std::lock_guard<std::mutex> lock(_broker_stats_mutex);
+        _broker_stats.limit_throttles++;
+      }
+      pfds.push_back({ client.fd, (short) ((throttled) ? 0 : POLLIN), 0 });
+    }
+
+    if (poll(pfds.data(), pfds.size(), 1) <= 0)
+      continue;
+
+    for (size_t n = clients.size(); n > 0; n--) {
+      BROKER_CLIENT_T *client = &clients[n - 1];
+      short revents = pfds[n].revents;
+
+      if ((revents & (POLLIN | POLLERR | POLLHUP)) && !BrokerInput(client)) {
+        close(client->fd);
+        clients.erase(clients.begin() + n - 1);
+      }
+    }
+
+    if (pfds[0].revents & POLLIN) {
+      int fd = accept4(_broker_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+      if (fd >= 0)
+        clients.push_back({ fd, {}, (double) _broker_rate, BrokerNowUs() });
+    }
+  }
+
+  for (auto &client : clients)
+    close(client.fd);
+}
+
+/*
+   start the broker
+*/
+bool BrokerStart(uint16_t port, BROKER_PUBLISH_CB callback)
+{
+  struct sockaddr_in addr = {};
+  socklen_t len = sizeof(addr);
+  int on = 1;
+
+  BrokerStop();
+  if (!port)
+    port = _broker_port;
+
+  if ((_broker_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0)
+    return false;
+  setsockopt(_broker_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (bind(_broker_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(_broker_fd, 16) < 0 ||
+      getsockname(_broker_fd, (struct sockaddr *) &addr, &len) < 0) {
+    close(_broker_fd);
+    _broker_fd = -1;
+    return false;
+  }
+
+  _broker_port = ntohs(addr.sin_port);
+  _broker_callback = callback;
+  _broker_running = true;
+  _broker_thread = std::thread(BrokerThread);
+  return true;
+}
+
+/*
+   stop the broker
+*/
+void BrokerStop(void)
+{
+  if (!_broker_running)
+    return;
+
+  _broker_running = false;
+  _broker_thread.join();
+  close(_broker_fd);
+  _broker_fd = -1;
+}
+
+uint16_t BrokerPort(void)
+{
+  return _broker_port;
+}
+
+void BrokerLimit(unsigned long rate, int mode)
+{
+  _broker_rate = rate;
+  _broker_limit_mode = mode;
+}
+
+void BrokerStats(BROKER_STATS_T *stats)
+{
+  std::lock_guard<std::mutex> lock(_broker_stats_mutex);
+
+  *stats = _broker_stats;
+}
+
+/**/
@@ -0,0 +1,77 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  minimal MQTT broker for the host
+
+  An MQTT 3.1.1 broker in a thread of the process, so the integration
+  benchmark runs without mosquitto and fully offline. It accepts any
+  client, acknowledges CONNECT, PUBLISH (QoS 0/1), SUBSCRIBE and PINGREQ,
+  but doesn't forward anything -- every PUBLISH is passed to a callback
+  with the time of receipt instead.
+
+  It can be stopped and started again (on the same port) to simulate a
+  broker restart, and can limit the publish rate per client: throttled
+  clients are not read (TCP backpressure), or disconnected.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __BROKER_H__
+#define __BROKER_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+   what to do with a client above the rate limit
+*/
+#define BROKER_LIMIT_THROTTLE     0
+#define BROKER_LIMIT_DISCONNECT   1
+
+/*
+   called in the thread of the broker for every PUBLISH
+*/
+typedef void (*BROKER_PUBLISH_CB)(const char *topic, const uint8_t *payload, size_t length, uint64_t received_us);
+
+typedef struct _broker_stats {
+  unsigned long connects;
+  unsigned long publishes;
+  unsigned long pings;
+  unsigned long limit_disconnects;    // clients disconnected by the rate limit
+  unsigned long limit_throttles;      // poll rounds a client wasn't read because of the rate limit
+} BROKER_STATS_T;
+
+/*
+   start the broker on 127.0.0.1 -- port 0 takes a free one, which is kept for the next start
+*/
+bool BrokerStart(uint16_t port, BROKER_PUBLISH_CB callback);
+
+/*
+   stop the broker -- all connections are closed
+*/
+void BrokerStop(void);
+
+/*
+   get the port
+*/
+uint16_t BrokerPort(void);
+
+/*
+   limit the publishes per second and client, 0 is no limit
+*/
+void BrokerLimit(unsigned long rate, int mode);
+
+/*
+   get the statistics
+*/
+void BrokerStats(BROKER_STATS_T *stats);
+
+#endif
+
+/**/
@@ -0,0 +1,300 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  check of the JSON of the machine table and of its ETag
+
+  /api/machines and /api/machines/{id} answer 304 while the If-None-Match
+  of the client holds the ETag of the version of the table resp. of the
+  machine. The body has the RSSI, the last seen times and the time of the
+  server, which change beside the version -- so the ETag has to be a
+  weak one.
+
+  checks
+    - the ETag of a version is weak, the If-None-Match header is matched
+      by the weak comparison (a list, "*", with and without W/)
+    - the JSON of the table and of a machine is valid
+    - an advertisement with a new RSSI changes the body but not the
+      version: 304, and only with a weak ETag
+    - a new state changes the version: 200 with a new ETag
+
+  usage: scanner-etag
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <string>
+#include "config.h"
+#include "state.h"
+#include "scandev.h"
+#include "json.h"
+#include "ntp.h"
+#include "util.h"
+#include "host.h"
+
+/*
+   start of the virtual clock: Nov 14 2023
+*/
+#define ETAGCHECK_EPOCH_US      1700000000000000ULL
+
+#define ETAGCHECK_BOOT_ID       0x1234abcd
+#define ETAGCHECK_MACHINES      3
+
+static std::string _json;
+
+static void EtagCheckJSON(const char *data, size_t length)
+{
+  _json.append(data, length);
+}
+
+/*
+   a minimal JSON parser -- returns the position after the value, NULL if it isn't valid
+*/
+static const char *EtagCheckSpace(const char *p)
+{
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+    p++;
+  return p;
+}
+
+static const char *EtagCheckString(const char *p)
+{
+  if (*p++ != '"')
+    return NULL;
+  while (*p != '"') {
+    if ((unsigned char) *p < 0x20)
+      return NULL;
+    if (*p == '\\') {
+      p++;
+      if (*p == 'u') {
+        for (int n = 1; n <= 4; n++)
+          if (!isxdigit((unsigned char) p[n]))
+            return NULL;
+        p += 4;
+      }
+      else if (!strchr("\"\\/bfnrt", *p))
+        return NULL;
+    }
+    p++;
+  }
+  return p + 1;
+}
+
+static const char *EtagCheckValue(const char *p)
+{
+  p = EtagCheckSpace(p);
+  if (*p == '{' || *p == '[') {
+    char close = (*p == '{') ? '}' : ']';
+    bool object = *p == '{';
+
+    p = EtagCheckSpace(p + 1);
+    if (*p == close)
+      return p + 1;
+    for (;;) {
+      if (object) {
+        if (!(p = EtagCheckString(EtagCheckSpace(p))))
+          return NULL;
+        p = EtagCheckSpace(p);
+        if (*p++ != ':')
+          return NULL;
+      }
+      if (!(p = EtagCheckValue(p)))
+        return NULL;
+      p = EtagCheckSpace(p);
+      if (*p == close)
+        return p + 1;
+      if (*p++ != ',')
+        return NULL;
+    }
+  }
+  if (*p == '"')
+    return EtagCheckString(p);
+  if (!strncmp(p, "true", 4) || !strncmp(p, "null", 4))
+    return p + 4;
+  if (!strncmp(p, "false", 5))
+    return p + 5;
+
+  const char *start = p;
+
+  if (*p == '-')
+    p++;
+  while (isdigit((unsigned char) *p) || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-')
+    p++;
+  return (p > start && isdigit((unsigned char) p[-1])) ? p : NULL;
+}
+
+static bool EtagCheckValid(const std::string &json)
+{
+  const char *end = EtagCheckValue(json.c_str());
+
+  return end && !*EtagCheckSpace(end);
+}
+
+/*
+   the JSON of the table and of a machine
+*/
+static std::string EtagCheckTable(void)
+{
+  JSON_WRITER_T json;
+
+  _json.clear();
+  JsonBegin(&json, EtagCheckJSON);
+  ScanDevListJSON(&json);
+  JsonEnd(&json);
+  return _json;
+}
+
+static std::string EtagCheckMachine(const SCANDEV_MACHINE_T *machine)
+{
+  JSON_WRITER_T json;
+
+  _json.clear();
+  JsonBegin(&json, EtagCheckJSON);
+  ScanDevMachineJSON(&json, NULL, machine);
+  JsonEnd(&json);
+  return _json;
+}
+
+/*
+   the answer of the server to a request with the If-None-Match header -- 304 or 200
+*/
+static int EtagCheckRequest(const char *if_none_match, uint32_t version, char *etag, int size)
+{
+  EtagOfVersion(etag, size, ETAGCHECK_BOOT_ID, version);
+  return (EtagMatch(if_none_match, etag)) ? 304 : 200;
+}
+
+/*
+   advertise the machines, with a state and an RSSI
+*/
+static void EtagCheckAdvertise(bool running, int rssi)
+{
+  for (int n = 0; n < ETAGCHECK_MACHINES; n++) {
+    uint8_t addr[6] = { (uint8_t) n, 0x00, 0x00, 0xde, 0xad, 0xbe };
+    char id[MACHINE_ID_MAX_LEN];
+
+    snprintf(id, sizeof(id), "MACHINE-%d", n);
+    ScanDevAddMachine(BLEAddress(addr, BLE_ADDR_RANDOM), id, (n) ? "Room \"B\"" : "", running, false, rssi - n,
+                      NtpGetTimeUs());
+  }
+}
+
+static bool EtagCheckMatch(void)
+{
+  static const struct {
+    const char *header;
+    const char *etag;
+    bool match;
+  } cases[] = {
+    { "W/\"1234abcd-7\"", "W/\"1234abcd-7\"", true },
+    { "\"1234abcd-7\"", "W/\"1234abcd-7\"", true },
+    { "W/\"1234abcd-7\"", "\"1234abcd-7\"", true },
+    { "\"x\", W/\"1234abcd-7\" ,\"y\"", "W/\"1234abcd-7\"", true },
+    { "*", "W/\"1234abcd-7\"", true },
+    { "W/\"1234abcd-70\"", "W/\"1234abcd-7\"", false },
+    { "W/\"1234abcd-7", "W/\"1234abcd-7\"", false },
+    { "\"00000000-7\"", "W/\"1234abcd-7\"", false },
+    { "", "W/\"1234abcd-7\"", false },
+  };
+  char etag[28];
+  bool ok = !strcmp(EtagOfVersion(etag, sizeof(etag), ETAGCHECK_BOOT_ID, 7), "W/\"1234abcd-7\"");
+
+  for (const auto &c : cases)
+    if (EtagMatch(c.header, c.etag) != c.match) {
+      printf("ETAG: If-None-Match: %s against %s FAILED\n", c.header, c.etag);
+      ok = false;
+    }
+  printf("ETAG: %s, %d headers matched %s\n", etag, (int) (sizeof(cases) / sizeof(cases[0])), (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   the conditional requests of a client that polls the table and a machine
+*/
+static bool EtagCheckConditional(void)
+{
+  char etag[28], table_etag[28], machine_etag[28];
+
+  EtagCheckAdvertise(false, -60);
+
+  /*
+     the first requests, without an ETag
+  */
+  uint32_t version = ScanDevGetVersion();
+  std::string table = EtagCheckTable();
+  SCANDEV_MACHINE_T machine;
+  bool found = ScanDevGetMachine("MACHINE-1", &machine);
+  std::string body = (found) ? EtagCheckMachine(&machine) : "";
+  int first = EtagCheckRequest("", version, table_etag, sizeof(table_etag));
+
+  if (found)
+    EtagCheckRequest("", machine.version, machine_etag, sizeof(machine_etag));
+  bool valid = found && EtagCheckValid(table) && EtagCheckValid(body) &&
+               table.find("\"count\":3") != std::string::npos;
+
+  /*
+     a new RSSI a second later -- the bodies change, the versions don't
+  */
+  HostClockAdvance(1000000);
+  EtagCheckAdvertise(false, -70);
+
+  std::string rssi_table = EtagCheckTable();
+  ScanDevGetMachine("MACHINE-1", &machine);
+
+  std::string rssi_body = EtagCheckMachine(&machine);
+  int rssi = EtagCheckRequest(table_etag, ScanDevGetVersion(), etag, sizeof(etag));
+  int rssi_machine = EtagCheckRequest(machine_etag, machine.version, etag, sizeof(etag));
+  bool weak = rssi_table != table && rssi_body != body && !strncmp(table_etag, "W/", 2) &&
+              !strncmp(machine_etag, "W/", 2);
+
+  /*
+     a new state
+  */
+  HostClockAdvance(1000000);
+  EtagCheckAdvertise(true, -70);
+
+  ScanDevGetMachine("MACHINE-1", &machine);
+
+  int state = EtagCheckRequest(table_etag, ScanDevGetVersion(), etag, sizeof(etag));
+  int state_machine = EtagCheckRequest(machine_etag, machine.version, etag, sizeof(etag));
+
+  valid = valid && EtagCheckValid(EtagCheckTable()) && EtagCheckValid(EtagCheckMachine(&machine));
+
+  bool ok = valid && weak && first == 200 && rssi == 304 && rssi_machine == 304 && state == 200 && state_machine == 200;
+
+  printf("ETAG: %zu bytes of JSON %s, new RSSI %d/%d (%s), new state %d/%d %s\n", table.length(),
+         (valid) ? "valid" : "INVALID", rssi, rssi_machine, (weak) ? "the body changed, weak ETag" : "NOT WEAK",
+         state, state_machine, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc > 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 1;
+  }
+
+  HostSerialMute(true);
+  HostClockVirtual(ETAGCHECK_EPOCH_US);
+  HostWifiSet(true);
+  HostNtpSet(true);
+
+  ConfigSetup();
+  StateSetup(STATE_SCANNING);
+  StateUpdate();
+  ScanDevSetup();
+
+  bool failed = !EtagCheckMatch();
+
+  failed = !EtagCheckConditional() || failed;
+  printf("ETAG: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
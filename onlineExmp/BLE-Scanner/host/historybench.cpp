@@ -0,0 +1,379 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  benchmark and check of the history of the machine transitions
+
+  The machines run through laundry cycles -- idle, running, done, emptied,
+  sometimes absent -- for some days on the virtual clock, every transition
+  is recorded in the history, which is stored in a temporary directory.
+
+  measures
+    - bytes per transition of the records and in the flash
+    - cost of recording a transition
+    - cost of a query of the utilization of a machine (/history)
+
+  checks
+    - every record decodes to what was encoded
+    - the utilization and the transitions per bucket of every machine
+      match the simulation, as long as the ring didn't wrap
+    - a new machine beyond HISTORY_MACHINES is dropped while every machine
+      has records in the ring, and takes the slot of one whose records
+      left the ring
+
+  usage: scanner-history-<machines> [-d <days>] [-q <hours>] [-s <seed>]
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "history.h"
+#include "json.h"
+#include "ntp.h"
+#include "util.h"
+#include "host.h"
+
+/*
+   start of the virtual clock: Nov 14 2023
+*/
+#define HISTORYBENCH_EPOCH      1700000000UL
+
+/*
+   the query is done in buckets of an hour
+*/
+#define HISTORYBENCH_STEP       3600
+
+typedef struct _historybench_event {
+  uint32_t time;
+  int machine;
+  uint8_t state;
+} HISTORYBENCH_EVENT_T;
+
+static int _days = 2;
+static int _hours = 24;
+static unsigned _seed = 1;
+
+static std::mt19937 _rng;
+static std::vector<HISTORYBENCH_EVENT_T> _events;
+static char _machine_ids[HISTORY_MACHINES][MACHINE_ID_MAX_LEN + 1];
+static std::string _json;
+
+/*
+   get the real time in seconds
+*/
+static double HistoryBenchTime(void)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t HistoryBenchRandom(uint32_t min, uint32_t max)
+{
+  return std::uniform_int_distribution<uint32_t>(min, max)(_rng);
+}
+
+/*
+   the records of the encoder
+*/
+static bool HistoryBenchEncoder(void)
+{
+  static const uint32_t deltas[] = { 0, 1, 127, 128, 16383, 16384, 2097151, 2097152, 268435455, 268435456, 0xffffffff };
+  static const int machines[] = { 0, 1, 15, 16, HISTORY_MACHINES - 1 };
+  uint8_t buffer[HISTORY_RECORD_MAX];
+  unsigned long failed = 0;
+
+  for (int machine : machines)
+    for (uint8_t state = 0; state < (1 << HISTORY_STATE_BITS); state++)
+      for (uint32_t delta : deltas) {
+        size_t n = HistoryEncode(buffer, sizeof(buffer), machine, state, delta);
+        int m;
+        uint8_t s;
+        uint32_t d;
+
+        if (!n || HistoryDecode(buffer, n, &m, &s, &d) != n || m != machine || s != state || d != delta ||
+            HistoryDecode(buffer, n - 1, &m, &s, &d) || HistoryEncode(buffer, n - 1, machine, state, delta))
+          failed++;
+      }
+
+  printf("HISTORY: encoder round trip %s\n", (failed) ? "FAILED" : "ok");
+  return !failed;
+}
+
+/*
+   the laundry cycles of the machines
+*/
+static void HistoryBenchSimulate(int machines, uint32_t start, uint32_t end)
+{
+  for (int machine = 0; machine < machines; machine++) {
+    uint32_t t = start + HistoryBenchRandom(0, 4 * 3600);
+
+    snprintf(_machine_ids[machine], sizeof(_machine_ids[machine]), "M%05d", machine);
+    _events.push_back({ start, machine, HISTORY_PRESENT | HISTORY_EMPTY });
+    while (t < end) {
+      _events.push_back({ t, machine, HISTORY_PRESENT | HISTORY_RUNNING });
+      t += HistoryBenchRandom(30 * 60, 70 * 60);
+      _events.push_back({ t, machine, HISTORY_PRESENT });
+      t += HistoryBenchRandom(2 * 60, 60 * 60);
+      _events.push_back({ t, machine, HISTORY_PRESENT | HISTORY_EMPTY });
+      if (HistoryBenchRandom(0, 19) == 0) {
+        t += 10 * 60;
+        _events.push_back({ t, machine, HISTORY_EMPTY });
+        t += HistoryBenchRandom(10 * 60, 120 * 60);
+        _events.push_back({ t, machine, HISTORY_PRESENT | HISTORY_EMPTY });
+      }
+      t += HistoryBenchRandom(20 * 60, 6 * 3600);
+    }
+  }
+
+  std::stable_sort(_events.begin(), _events.end(), [](const HISTORYBENCH_EVENT_T &a, const HISTORYBENCH_EVENT_T &b) {
+    return a.time < b.time;
+  });
+  while (!_events.empty() && _events.back().time > end)
+    _events.pop_back();
+}
+
+static void HistoryBenchJSON(const char *data, size_t length)
+{
+  _json.append(data, length);
+}
+
+/*
+   the expected answer of a query, computed from the simulation
+*/
+static std::string HistoryBenchExpected(int machine, uint32_t from, uint32_t step, int count, uint32_t end)
+{
+  std::vector<uint32_t> busy(count, 0);
+  std::vector<uint32_t> changes(count, 0);
+  bool known = false;
+  uint8_t state = 0;
+  uint32_t time = 0;
+
+  auto account = [&](uint32_t to) {
+    if (!known || (state & (HISTORY_RUNNING | HISTORY_PRESENT)) != (HISTORY_RUNNING | HISTORY_PRESENT))
+      return;
+    for (uint32_t t = MAX(time, from); t < MIN(to, end); t++)
+      busy[(t - from) / step]++;
+  };
+
+  for (const HISTORYBENCH_EVENT_T &event : _events) {
+    if (event.machine != machine)
+      continue;
+    account(event.time);
+    if (event.time >= from && event.time < end)
+      changes[(event.time - from) / step]++;
+    known = true;
+    state = event.state;
+    time = event.time;
+  }
+  account(end);
+
+  JSON_WRITER_T json;
+
+  _json.clear();
+  JsonBegin(&json, HistoryBenchJSON);
+  JsonObjectBegin(&json, NULL);
+  JsonString(&json, "machineId", _machine_ids[machine]);
+  JsonUInt(&json, "from", from);
+  JsonUInt(&json, "step", step);
+  JsonArrayBegin(&json, "utilization");
+  for (int n = 0; n < count; n++) {
+    uint32_t start = from + n * step;
+
+    if (start >= end)
+      JsonNull(&json, NULL);
+    else
+      JsonUInt(&json, NULL, busy[n] * 100 / (MIN(start + step, end) - start));
+  }
+  JsonArrayEnd(&json);
+  JsonArrayBegin(&json, "transitions");
+  for (int n = 0; n < count; n++)
+    JsonUInt(&json, NULL, changes[n]);
+  JsonArrayEnd(&json);
+  JsonObjectEnd(&json);
+  JsonEnd(&json);
+  return _json;
+}
+
+/*
+   the answer of the history
+*/
+static std::string HistoryBenchQuery(int machine, uint32_t from, uint32_t step, int count)
+{
+  JSON_WRITER_T json;
+
+  _json.clear();
+  JsonBegin(&json, HistoryBenchJSON);
+  HistoryJSON(&json, (machine < 0) ? "NEW-MACHINE" : _machine_ids[machine], from, step, count);
+  JsonEnd(&json);
+  return _json;
+}
+
+/*
+   a new machine with the table of the IDs full -- the ring is filled by one machine
+   until the records of the others are gone
+*/
+static bool HistoryBenchReuse(uint32_t *now, bool wrapped)
+{
+  HISTORY_STATS_T before, stats;
+  const char *id = "NEW-MACHINE";
+
+  HistoryStats(&before);
+  HistoryRecord(id, *now, HISTORY_PRESENT | HISTORY_EMPTY);
+  HistoryStats(&stats);
+
+  bool dropped = wrapped || stats.dropped == before.dropped + 1;
+  uint8_t state = HISTORY_PRESENT;
+
+  while (stats.bytes < before.bytes + HISTORY_BLOCKS * HISTORY_BLOCK_SIZE) {
+    HostClockAdvance(60 * 1000000ULL);
+    *now += 60;
+    state ^= HISTORY_RUNNING;
+    HistoryRecord(_machine_ids[0], *now, state);
+    HistoryUpdate();
+    HistoryStats(&stats);
+  }
+
+  HistoryStats(&before);
+  HistoryRecord(id, *now, HISTORY_PRESENT | HISTORY_EMPTY);
+  HistoryStats(&stats);
+  HostClockAdvance(3600 * 1000000ULL);
+  *now += 3600;
+
+  std::string answer = HistoryBenchQuery(-1, *now - 2 * 3600, 3600, 2);
+  bool reused = stats.dropped == before.dropped && stats.machines == before.machines &&
+                answer.find("\"transitions\":[0,1]") != std::string::npos;
+  bool evicted = false;
+
+  for (int machine = 1; machine < SCANDEV_MAX_MACHINES && !evicted; machine++)
+    evicted = HistoryBenchQuery(machine, *now - 3600, 3600, 1).empty();
+
+  bool ok = dropped && reused && evicted;
+
+  printf("HISTORY: a new machine with %d machines in the table %s, %s, %s %s\n", SCANDEV_MAX_MACHINES,
+         (wrapped) ? "not checked" : (dropped) ? "dropped" : "NOT DROPPED", (reused) ? "reused a slot later" : "NO SLOT",
+         (evicted) ? "the old machine is gone" : "NO MACHINE EVICTED", (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "d:q:s:")) != -1) {
+    switch (opt) {
+      case 'd': _days = MAX(1, atoi(optarg)); break;
+      case 'q': _hours = MAX(1, MIN(HISTORY_BUCKETS_MAX, atoi(optarg))); break;
+      case 's': _seed = atoi(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-d <days>] [-q <hours>] [-s <seed>]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  char dir[] = "/tmp/scanner-history-XXXXXX";
+
+  if (!mkdtemp(dir)) {
+    perror(dir);
+    return 1;
+  }
+
+  bool failed = !HistoryBenchEncoder();
+
+  /*
+     the simulation
+  */
+  uint32_t start = HISTORYBENCH_EPOCH;
+  uint32_t end = start + _days * 24 * 3600;
+
+  _rng.seed(_seed);
+  HistoryBenchSimulate(SCANDEV_MAX_MACHINES, start, end);
+
+  HostSerialMute(true);
+  HostClockVirtual((uint64_t) start * 1000000);
+  HostNtpSet(true);
+  HostFsSetRoot(dir);
+  HistorySetup();
+
+  /*
+     record the transitions on the virtual clock, the real time is measured
+  */
+  double record = 0;
+  uint32_t now = start;
+
+  for (const HISTORYBENCH_EVENT_T &event : _events) {
+    if (event.time > now) {
+      HostClockAdvance((uint64_t) (event.time - now) * 1000000);
+      now = event.time;
+    }
+
+    double t = HistoryBenchTime();
+
+    HistoryRecord(_machine_ids[event.machine], event.time, event.state);
+    record += HistoryBenchTime() - t;
+    HistoryUpdate();
+  }
+  HostClockAdvance((uint64_t) (end - now) * 1000000);
+
+  HISTORY_STATS_T stats;
+
+  HistoryStats(&stats);
+
+  size_t payload = HISTORY_BLOCK_SIZE - HISTORY_HEADER_SIZE;
+  unsigned long blocks = (stats.bytes + payload - HISTORY_RECORD_MAX - 1) / (payload - HISTORY_RECORD_MAX) + 1;
+  bool wrapped = blocks >= HISTORY_BLOCKS;
+
+  printf("HISTORY: %d machines, %d days, %lu transitions, %lu dropped, %lu block writes\n",
+         SCANDEV_MAX_MACHINES, _days, stats.transitions, stats.dropped, stats.blocks);
+  printf("%-40s %12.2f B/transition\n", "records", (double) stats.bytes / MAX(1, stats.transitions));
+  printf("%-40s %12.2f B/transition\n", "flash (with the headers)",
+         (double) (stats.bytes + MIN(blocks, HISTORY_BLOCKS) * HISTORY_HEADER_SIZE) / MAX(1, stats.transitions));
+  printf("%-40s %12.1f ns/transition\n", "HistoryRecord", record * 1e9 / MAX(1, stats.transitions));
+
+  /*
+     query every machine for the last hours
+  */
+  uint32_t from = (end / HISTORYBENCH_STEP - _hours) * HISTORYBENCH_STEP;
+  int count = _hours + 1;
+  unsigned long mismatches = 0;
+  double query = 0;
+
+  for (int machine = 0; machine < SCANDEV_MAX_MACHINES; machine++) {
+    double t = HistoryBenchTime();
+    std::string answer = HistoryBenchQuery(machine, from, HISTORYBENCH_STEP, count);
+
+    query += HistoryBenchTime() - t;
+    if (!wrapped && answer != HistoryBenchExpected(machine, from, HISTORYBENCH_STEP, count, end)) {
+      if (!mismatches)
+        printf("HISTORY: %s\n  got      %s\n  expected %s\n", _machine_ids[machine], answer.c_str(), _json.c_str());
+      mismatches++;
+    }
+  }
+  printf("%-40s %12.1f us/query (%d buckets)\n", "HistoryJSON", query * 1e6 / SCANDEV_MAX_MACHINES, count);
+
+  if (wrapped)
+    printf("HISTORY: the ring wrapped -- the queries are not checked, use less days (-d)\n");
+  else
+    printf("HISTORY: queries of %d machines %s\n", SCANDEV_MAX_MACHINES, (mismatches) ? "FAILED" : "ok");
+  failed |= mismatches || stats.dropped;
+  failed = !HistoryBenchReuse(&end, wrapped) || failed;
+
+  LittleFS.remove(HISTORY_FILE);
+  LittleFS.remove(HISTORY_IDS_FILE);
+  rmdir(dir);
+
+  printf("HISTORY: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
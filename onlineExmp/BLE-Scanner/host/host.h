@@ -0,0 +1,114 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  control of the host environment
+
+  The host build runs the scanner modules natively on Linux. The Arduino,
+  WiFi, NimBLE and MQTT APIs are replaced by the shims in host/shims, the
+  WiFi and NTP modules by the stubs in host/. The functions below let a
+  driver (eg. the benchmark) control this environment.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __HOST_H__
+#define __HOST_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+   the clock
+
+   by default millis(), micros() and now() follow the real clock, after
+   HostClockVirtual() the time only moves by HostClockAdvance() or delay()
+*/
+void HostClockVirtual(uint64_t epoch_us);
+void HostClockAdvance(uint64_t us);
+bool HostClockIsVirtual(void);
+
+/*
+   get the local time in micro seconds since start and the epoch time in micro seconds
+*/
+uint64_t HostLocalUs(void);
+uint64_t HostEpochUs(void);
+
+/*
+   set the epoch time in micro seconds -- the local time is not affected
+*/
+void HostEpochSet(uint64_t epoch_us);
+
+/*
+   mute the output of Serial
+*/
+void HostSerialMute(bool mute);
+
+/*
+   control the WiFi and NTP stubs
+*/
+void HostWifiSet(bool connected);
+void HostNtpSet(bool synced);
+
+/*
+   control the MQTT client
+
+   while the simulated broker is not reachable connect() fails, every
+   successful publish is passed to the callback (if set)
+*/
+typedef void (*HOST_MQTT_PUBLISH_CB)(const char *topic, const char *payload, unsigned int length);
+
+void HostMqttSet(bool reachable, HOST_MQTT_PUBLISH_CB callback);
+void HostMqttStats(unsigned long *connects, unsigned long *publishes);
+
+/*
+   connect the MQTT client to a real broker instead of the configured one
+   and the simulated one -- NULL switches back to the simulated broker
+*/
+void HostMqttBroker(const char *host, uint16_t port);
+
+/*
+   the radio
+
+   advertisements are passed with the raw payload (AD structures), they
+   reach the scan callbacks only while a scan is running and if they pass
+   the duplicate filter -- the scan response (may be NULL) is only added
+   during an active scan
+*/
+typedef struct _host_ble_stats {
+  unsigned long received;       // advertisements passed to HostBleAdvertise()
+  unsigned long missed;         // received while not scanning
+  unsigned long filtered;       // dropped by the duplicate filter
+  unsigned long reported;       // passed to the scan callbacks
+  unsigned long results_max;    // max. number of devices in the scan results
+} HOST_BLE_STATS_T;
+
+void HostBleAdvertise(const uint8_t addr[6], uint8_t type, int rssi, const uint8_t *payload, size_t length,
+                      const uint8_t *scan_rsp = NULL, size_t scan_rsp_length = 0);
+void HostBleStats(HOST_BLE_STATS_T *stats);
+
+/*
+   replay a captured advertisement (see capture.h) -- it was recorded in the scan callback,
+   so it is passed there directly, regardless of the scan state and the duplicate filter
+*/
+void HostBleReplay(const uint8_t addr[6], uint8_t type, int rssi, const uint8_t *payload, size_t length);
+
+/*
+   the flash file system -- the files are stored in this directory of the host (default: the current one)
+*/
+void HostFsSetRoot(const char *dir);
+
+/*
+   the sketch -- setup() and loop() of BLE-Scanner.ino without HTTP, LED and watchdog
+*/
+void HostSketchSetup(void);
+void HostSketchLoop(void);
+
+#endif
+
+/**/
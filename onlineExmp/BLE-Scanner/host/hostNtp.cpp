@@ -0,0 +1,108 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  replacement of the NTP module for the host build
+
+  The NTP time is the epoch time of the host clock, once it is marked as
+  synced by HostNtpSet() in host.h.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_NTP
+
+#include "config.h"
+#include "ntp.h"
+#include "memstat.h"
+#include "host.h"
+
+static bool _ntp_synced = false;
+static time_t _ntp_first_sync = 0;
+
+/*
+   control the simulated sync
+*/
+void HostNtpSet(bool synced)
+{
+  _ntp_synced = synced;
+  if (synced && !_ntp_first_sync)
+    _ntp_first_sync = HostEpochUs() / 1000000;
+}
+
+void NtpSetup(void)
+{
+}
+
+void NtpUpdate(void)
+{
+  MEMSTAT_SCOPE(MEMSTAT_NTP);
+
+}
+
+time_t NtpGetTime(void)
+{
+  return NtpGetTimeUs() / 1000000;
+}
+
+uint64_t NtpGetTimeUs(void)
+{
+  return (_ntp_synced) ? HostEpochUs() : 0;
+}
+
+int64_t NtpLocalUs(void)
+{
+  return HostLocalUs();
+}
+
+uint64_t NtpLocalToTimeUs(int64_t local)
+{
+  return (_ntp_synced) ? HostEpochUs() - HostLocalUs() + local : 0;
+}
+
+unsigned long NtpUptime(void)
+{
+  return (_ntp_first_sync) ? NtpGetTime() - _ntp_first_sync : 0;
+}
+
+time_t NtpFirstSync(void)
+{
+  return _ntp_first_sync;
+}
+
+time_t NtpLastSync(void)
+{
+  return NtpGetTime();
+}
+
+long NtpLastCorrection(void)
+{
+  return 0;
+}
+
+int64_t NtpLastOffsetUs(void)
+{
+  return 0;
+}
+
+int64_t NtpLastDelayUs(void)
+{
+  return 0;
+}
+
+const char *NtpLastServer(void)
+{
+  return "host";
+}
+
+void NtpStats(int *requests,int *replies_total,int *replies_good)
+{
+  *requests = *replies_total = *replies_good = 0;
+}
+
+/**/
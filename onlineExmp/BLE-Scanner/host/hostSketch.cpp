@@ -0,0 +1,80 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  setup() and loop() of the sketch for the host build
+
+  This follows BLE-Scanner.ino -- HTTP, LED and watchdog are not part of
+  the host build.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_MAIN
+
+#include "config.h"
+#include "state.h"
+#include "wifiHandler.h"
+#include "bluetooth.h"
+#include "capture.h"
+#include "memstat.h"
+#include "scandev.h"
+#include "mqtt.h"
+#include "ntp.h"
+#include "util.h"
+#include "host.h"
+
+void HostSketchSetup(void)
+{
+  LogSetup();
+  MemStatSetup();
+  StateSetup(STATE_SCANNING);
+  ConfigSetup();
+  WifiSetup();
+  ScanDevSetup();
+  NtpSetup();
+  MqttSetup();
+  CaptureSetup();
+  BluetoothSetup();
+
+  LogMsg("SETUP: All systems ready - starting BLE scanning");
+}
+
+void HostSketchLoop(void)
+{
+  ConfigUpdate();
+  MemStatUpdate();
+  WifiUpdate();
+
+  if (StateCheck(STATE_SCANNING) || StateCheck(STATE_PAUSING)) {
+    NtpUpdate();
+    MqttUpdate();
+    BluetoothUpdate();
+    CaptureUpdate();
+    ScanDevUpdate();
+  }
+
+  switch (StateUpdate()) {
+    case STATE_SCANNING:
+      LogMsg("SCANNER: Starting BLE scan for %d seconds...", _config.bluetooth.scan_time);
+      BluetoothScanStart();
+      break;
+    case STATE_PAUSING:
+      LogMsg("SCANNER: Pausing for %d seconds (machines tracked: %d)",
+             _config.bluetooth.pause_time, ScanDevGetCount());
+      BluetoothScanStop();
+      break;
+    case STATE_REBOOT:
+      LogMsg("SCANNER: Restarting the device");
+      LogFlush();
+      ESP.restart();
+      break;
+  }
+}
+
+/**/
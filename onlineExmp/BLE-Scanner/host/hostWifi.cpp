@@ -0,0 +1,100 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  replacement of the WiFi module for the host build
+
+  The link is simulated, see HostWifiSet() in host.h.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_WIFI
+
+#include "config.h"
+#include "wifiHandler.h"
+#include "memstat.h"
+#include "util.h"
+#include "host.h"
+
+WiFiClient _wifiClient;
+
+static bool _wifi_connected = true;
+static WIFI_STATS_T _wifi_stats;
+
+/*
+   control the simulated link
+*/
+void HostWifiSet(bool connected)
+{
+  if (connected && !_wifi_connected)
+    _wifi_stats.connects++;
+  if (!connected && _wifi_connected)
+    _wifi_stats.disconnects++;
+  _wifi_connected = connected;
+}
+
+bool WifiSetup(void)
+{
+  LogMsg("WIFI: host build -- link is simulated");
+  return _wifi_connected;
+}
+
+bool WifiUpdate(void)
+{
+  MEMSTAT_SCOPE(MEMSTAT_WIFI);
+
+  return _wifi_connected;
+}
+
+bool WifiIsConnected(void)
+{
+  return _wifi_connected;
+}
+
+const char *WifiGetStateString(void)
+{
+  return (_wifi_connected) ? "Connected" : "Idle";
+}
+
+void WifiStats(WIFI_STATS_T *stats)
+{
+  *stats = _wifi_stats;
+}
+
+String WifiGetSSID(void)
+{
+  return String("host");
+}
+
+int WifiGetChannel(void)
+{
+  return 0;
+}
+
+int WifiGetRSSI(void)
+{
+  return 0;
+}
+
+String WifiGetIpAddr(void)
+{
+  return String("127.0.0.1");
+}
+
+String WifiGetMacAddr(void)
+{
+  return String("A1:B2:C3:D4:E5:F6");
+}
+
+WiFiClient *WifiGetClient(void)
+{
+  return &_wifiClient;
+}
+
+/**/
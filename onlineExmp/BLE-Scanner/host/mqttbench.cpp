@@ -0,0 +1,359 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  integration benchmark of the MQTT layer against a local broker
+
+  The gateway's MQTT layer (mqtt.cpp with the PubSubClient shim on a real
+  TCP connection) publishes to the embedded broker (broker.cpp) on
+  127.0.0.1, everything runs on the real clock and offline.
+
+  scenarios
+    - throughput: publish as fast as possible
+    - latency: publish at a fixed rate
+    - restart: the broker is stopped and started again while publishing,
+      measures the time to the first publish after the restart
+    - throttle/disconnect: the broker limits the publishes per second,
+      by not reading the client or by disconnecting it
+
+  usage: scanner-mqtt-<machines> [options], see Usage()
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "config.h"
+#include "state.h"
+#include "mqtt.h"
+#include "ntp.h"
+#include "util.h"
+#include "host.h"
+#include "broker.h"
+
+/*
+   the loop of the sketch runs MqttUpdate() every ...
+*/
+#define MQTTBENCH_LOOP_MS       10
+
+/*
+   after a scenario, wait for the last messages until none arrived for ...
+*/
+#define MQTTBENCH_DRAIN_MS      1000
+
+/*
+   the options
+*/
+static double _time = 5;
+static double _rate = 100;
+static double _down = 3;
+static unsigned long _limit = 50;
+static uint16_t _port = 0;
+
+/*
+   the messages -- the machine id carries a sequence number
+*/
+static std::mutex _mutex;
+static std::vector<uint8_t> _sent;          // publish() succeeded
+static std::vector<uint8_t> _received;
+static std::vector<double> _latency;        // publishedUs -> receipt at the broker
+static uint64_t _last_received_us = 0;
+static uint64_t _first_received_us = 0;     // first receipt after _mark_us
+static uint64_t _mark_us = 0;
+
+/*
+   the result of a scenario
+*/
+typedef struct _mqttbench_result {
+  unsigned long first;        // first sequence number
+  unsigned long sent;
+  unsigned long failed;
+  uint64_t start_us;
+  double seconds;
+  std::vector<double> calls;  // duration of the publish calls
+} MQTTBENCH_RESULT_T;
+
+static unsigned long _seq = 0;
+
+static double BenchTime(void)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+   a message arrived at the broker
+*/
+static void BenchReceived(const char *topic, const uint8_t *payload, size_t length, uint64_t received_us)
+{
+  unsigned long seq;
+  std::string json((const char *) payload, length);
+  size_t pos = json.find("\"publishedUs\":");
+
+  if (sscanf(topic, MQTT_TOPIC_PREFIX "bench-%lu", &seq) != 1)
+    return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (seq >= _received.size())
+    _received.resize(seq + 1);
+  _received[seq] = 1;
+  _last_received_us = received_us;
+  if (pos != std::string::npos)
+    _latency.push_back((received_us - strtoull(&json[pos + 14], NULL, 10)) / 1e6);
+  if (_mark_us && received_us >= _mark_us && !_first_received_us)
+    _first_received_us = received_us;
+}
+
+/*
+   publish the next message
+*/
+static void BenchPublish(MQTTBENCH_RESULT_T *result)
+{
+  char machineId[MACHINE_ID_MAX_LEN + 1];
+  unsigned long seq = _seq++;
+
+  snprintf(machineId, sizeof(machineId), "bench-%lu", seq);
+
+  double t = BenchTime();
+  bool ok = MqttPublishMachineStatus(machineId, "", seq & 1, seq & 2, NtpGetTimeUs());
+  result->calls.push_back(BenchTime() - t);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (seq >= _sent.size())
+    _sent.resize(seq + 1);
+  _sent[seq] = ok;
+  if (ok)
+    result->sent++;
+  else
+    result->failed++;
+}
+
+/*
+   run the loop for the given time, publishing at the rate (0: as fast as possible)
+   -- event is called every round with the elapsed time
+*/
+static void BenchRun(MQTTBENCH_RESULT_T *result, double seconds, double rate, std::function<void(double)> event = nullptr)
+{
+  double start = BenchTime();
+  double next_loop = start;
+  double next_publish = start;
+  double now;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _latency.clear();
+  }
+  *result = MQTTBENCH_RESULT_T();
+  result->first = _seq;
+  result->start_us = HostEpochUs();
+
+  while ((now = BenchTime()) - start < seconds) {
+    if (event)
+      event(now - start);
+    if (now >= next_loop) {
+      MqttUpdate();
+      next_loop += MQTTBENCH_LOOP_MS / 1000.0;
+    }
+    if (rate <= 0 || now >= next_publish) {
+      BenchPublish(result);
+      next_publish += (rate > 0) ? 1 / rate : 0;
+    }
+    if (rate > 0) {
+      double wait = std::min(next_loop, next_publish) - BenchTime();
+
+      if (wait > 0)
+        std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+    }
+  }
+  result->seconds = BenchTime() - start;
+
+  /*
+     let the last messages arrive -- a throttled backlog takes a while
+  */
+  size_t received = 0;
+
+  for (double drain = BenchTime(); BenchTime() - drain < MQTTBENCH_DRAIN_MS / 1000.0; ) {
+    MqttUpdate();
+    std::this_thread::sleep_for(std::chrono::milliseconds(MQTTBENCH_LOOP_MS));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_latency.size() != received) {
+      received = _latency.size();
+      drain = BenchTime();
+    }
+  }
+}
+
+/*
+   print a distribution
+*/
+static void BenchPercentiles(const char *name, std::vector<double> v, double scale, const char *unit)
+{
+  if (v.empty()) {
+    printf("  %-22s no samples\n", name);
+    return;
+  }
+  std::sort(v.begin(), v.end());
+  auto p = [&](double q) { return v[std::min(v.size() - 1, (size_t) (q * v.size()))] * scale; };
+  printf("  %-22s p50 %9.3f %s  p90 %9.3f %s  p99 %9.3f %s  max %9.3f %s\n",
+         name, p(0.50), unit, p(0.90), unit, p(0.99), unit, v.back() * scale, unit);
+}
+
+/*
+   print the result of a scenario
+*/
+static void BenchReport(const char *name, const MQTTBENCH_RESULT_T *result)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  unsigned long received = 0, lost = 0;
+
+  for (unsigned long seq = result->first; seq < _seq; seq++) {
+    bool r = seq < _received.size() && _received[seq];
+
+    received += r;
+    lost += _sent[seq] && !r;
+  }
+
+  /*
+     the received rate is taken until the last message arrived
+  */
+  double seconds = std::max(result->seconds, (_last_received_us - result->start_us) / 1e6);
+
+  printf("%s: %lu published (%.0f msg/s), %lu failed, %lu received (%.0f msg/s), %lu lost\n",
+         name, result->sent, result->sent / result->seconds, result->failed,
+         received, received / seconds, lost);
+  BenchPercentiles("latency", _latency, 1e3, "ms");
+  BenchPercentiles("publish call", result->calls, 1e6, "us");
+}
+
+static void Usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [options]\n"
+          "  -t <seconds>      duration of a scenario (%.0f)\n"
+          "  -r <msg/s>        publish rate of the latency scenario (%.0f)\n"
+          "  -k <seconds>      the broker is down in the restart scenario (%.0f)\n"
+          "  -l <msg/s>        rate limit of the broker (%lu)\n"
+          "  -p <port>         port of the broker (a free one)\n",
+          name, _time, _rate, _down, _limit);
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:r:k:l:p:")) != -1) {
+    switch (opt) {
+      case 't': _time = atof(optarg); break;
+      case 'r': _rate = atof(optarg); break;
+      case 'k': _down = atof(optarg); break;
+      case 'l': _limit = strtoul(optarg, NULL, 10); break;
+      case 'p': _port = atoi(optarg); break;
+      default:
+        Usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if (!BrokerStart(_port, BenchReceived)) {
+    perror("broker");
+    return 1;
+  }
+
+  /*
+     the gateway on the real clock, connected to the broker
+  */
+  HostSerialMute(true);
+  HostWifiSet(true);
+  HostNtpSet(true);
+  HostMqttBroker("127.0.0.1", BrokerPort());
+
+  ConfigSetup();
+  StateSetup(STATE_SCANNING);
+  StateUpdate();
+  MqttSetup();
+  if (!MqttIsConnected()) {
+    fprintf(stderr, "couldn't connect to the broker on port %u\n", BrokerPort());
+    return 1;
+  }
+  printf("MQTT: broker on 127.0.0.1:%u, %.0f s per scenario\n", BrokerPort(), _time);
+
+  MQTTBENCH_RESULT_T result;
+
+  /*
+     throughput and latency
+  */
+  BenchRun(&result, _time, 0);
+  BenchReport("THROUGHPUT", &result);
+
+  BenchRun(&result, _time, _rate);
+  char name[64];
+  snprintf(name, sizeof(name), "LATENCY at %.0f msg/s", _rate);
+  BenchReport(name, &result);
+
+  /*
+     restart of the broker
+  */
+  double stopped = 0, started = 0, lost_at = 0, back_at = 0;
+  unsigned long connects_before, connects;
+
+  HostMqttStats(&connects_before, NULL);
+  BenchRun(&result, 2 + _down + 2 * MQTT_RECONNECT_INTERVAL / 1000.0, 20, [&](double t) {
+    if (!stopped && t >= 2) {
+      BrokerStop();
+      stopped = t;
+    }
+    if (stopped && !lost_at && !MqttIsConnected())
+      lost_at = t;
+    if (!started && t >= 2 + _down) {
+      BrokerStart(0, BenchReceived);
+      started = t;
+      _mark_us = HostEpochUs();
+    }
+    if (started && !back_at && MqttIsConnected())
+      back_at = t;
+  });
+  HostMqttStats(&connects, NULL);
+  BenchReport("RESTART", &result);
+  printf("  broker down for %.1f s, loss detected after %.3f s, reconnected %.3f s and first publish received %.3f s after the restart (%lu connects)\n",
+         started - stopped, (lost_at) ? lost_at - stopped : -1, (back_at) ? back_at - started : -1,
+         (_first_received_us) ? (_first_received_us - _mark_us) / 1e6 : -1, connects - connects_before);
+
+  /*
+     rate limit of the broker
+  */
+  BROKER_STATS_T before, after;
+
+  BrokerLimit(_limit, BROKER_LIMIT_THROTTLE);
+  BrokerStats(&before);
+  BenchRun(&result, _time, 4 * _limit);
+  BrokerStats(&after);
+  snprintf(name, sizeof(name), "THROTTLE to %lu msg/s", _limit);
+  BenchReport(name, &result);
+  printf("  %lu poll rounds throttled\n", after.limit_throttles - before.limit_throttles);
+
+  BrokerLimit(_limit, BROKER_LIMIT_DISCONNECT);
+  BrokerStats(&before);
+  HostMqttStats(&connects_before, NULL);
+  BenchRun(&result, _time, 4 * _limit);
+  BrokerStats(&after);
+  HostMqttStats(&connects, NULL);
+  snprintf(name, sizeof(name), "DISCONNECT above %lu msg/s", _limit);
+  BenchReport(name, &result);
+  printf("  %lu disconnects by the broker, %lu reconnects\n",
+         after.limit_disconnects - before.limit_disconnects, connects - connects_before);
+
+  BrokerStop();
+  return 0;
+}
+
+/**/
@@ -0,0 +1,449 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  check of the NTP module against stand-in servers
+
+  The real ntp.cpp runs on the virtual clock and talks through the UDP
+  shim to three stand-in servers on the loopback interface (127.0.0.1-3).
+  Each server has its own offset to the clock of the host and its own
+  delay up and down, the reply is sent when the virtual clock reached
+  the time it arrives at the client -- so the four timestamps of the
+  exchange are those of a link with these delays.
+
+    127.0.0.1   4 ms up, 2 ms down -- the one to select
+    127.0.0.2   40 ms up, 10 ms down
+    127.0.0.3   echoes a wrong origin, later a kiss of death
+
+  checks
+    - exchange  the first round steps the clock to the server, off by
+                half the asymmetry of the delays, the reply with the
+                lowest delay is selected and the bad one is dropped
+    - slew      an offset of 60 ms is slewed at NTP_SLEW_RATE_PPM, the
+                clock neither jumps nor goes backwards
+    - step      an offset of 2 s is stepped
+    - sign      an offset between -1 ms and 0 keeps its sign
+    - late      polled every 10 ms, the replies may have waited longer
+                than NTP_MAX_POLL_LATENCY and are dropped, the clock
+                is left alone until it is polled in time again
+
+  usage: scanner-ntp
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <fcntl.h>
+#include <math.h>
+#include <functional>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "config.h"
+#include "state.h"
+#include "ntp.h"
+#include "util.h"
+#include "host.h"
+
+/*
+   start of the virtual clock: Nov 14 2023
+*/
+#define NTPCHECK_EPOCH_US       1700000000000000ULL
+
+/*
+   the steps of the virtual clock, around a round and in between
+*/
+#define NTPCHECK_STEP_FINE_US   100
+#define NTPCHECK_STEP_LATE_US   (10 * 1000)
+#define NTPCHECK_STEP_US        (50 * 1000)
+
+/*
+   the precision of the checks of the clock in us
+*/
+#define NTPCHECK_TOLERANCE_US   300
+
+#define NTPCHECK_PACKET_SIZE    48
+#define NTPCHECK_UNIX_OFFSET    2208988800ULL
+
+typedef enum {
+  NTPCHECK_GOOD = 0,
+  NTPCHECK_SPOOF,               // the origin doesn't match the request
+  NTPCHECK_KOD,                 // stratum 0
+} NTPCHECK_MODE_T;
+
+typedef struct _ntpcheck_server {
+  const char *ip;
+  int64_t up;                   // delay of the request in us
+  int64_t down;                 // delay of the reply in us
+  NTPCHECK_MODE_T mode;
+  int fd;
+  bool queued;                  // a reply waits for its time
+  uint64_t at;                  // local time to send it
+  uint8_t reply[NTPCHECK_PACKET_SIZE];
+  struct sockaddr_in to;
+} NTPCHECK_SERVER_T;
+
+static NTPCHECK_SERVER_T _servers[] = {
+  { "127.0.0.1", 4000, 2000, NTPCHECK_GOOD },
+  { "127.0.0.2", 40000, 10000, NTPCHECK_GOOD },
+  { "127.0.0.3", 1000, 1000, NTPCHECK_SPOOF },
+};
+#define NTPCHECK_SERVERS        (sizeof(_servers) / sizeof(_servers[0]))
+
+/*
+   the offset of all servers to the clock of the host in us
+*/
+static int64_t _offset = 0;
+
+/*
+   the last request seen by a server, the fine steps last until the round timed out
+*/
+static uint64_t _last_request = 0;
+
+/*
+   the step of the virtual clock around a round -- the time between two polls of the client
+*/
+static uint64_t _step_fine = NTPCHECK_STEP_FINE_US;
+
+/*
+   the clock of the client against the one of the servers
+*/
+typedef struct _ntpcheck_track {
+  uint64_t client;              // the last NtpGetTimeUs()
+  uint64_t host;                // the true time then
+  unsigned long jumps;          // changes beyond the slew rate
+  unsigned long backwards;
+} NTPCHECK_TRACK_T;
+
+static NTPCHECK_TRACK_T _track;
+
+static uint64_t NtpCheckToNtp(uint64_t us)
+{
+  return ((us / 1000000 + NTPCHECK_UNIX_OFFSET) << 32) | (((us % 1000000) << 32) / 1000000);
+}
+
+static void NtpCheckSetField(uint8_t *packet, int offset, uint64_t value)
+{
+  for (int n = 7; n >= 0; n--, value >>= 8)
+    packet[offset + n] = value & 0xff;
+}
+
+/*
+   the true time in us -- not HostEpochUs(), which is set by setTime() of the NTP module
+*/
+static uint64_t _truth_local = 0;
+
+static uint64_t NtpCheckTruth(void)
+{
+  return NTPCHECK_EPOCH_US + HostLocalUs() - _truth_local;
+}
+
+/*
+   the error of the client to the servers in us
+*/
+static int64_t NtpCheckError(void)
+{
+  return (int64_t) NtpGetTimeUs() - (int64_t) (NtpCheckTruth() + _offset);
+}
+
+static bool NtpCheckServerSetup(NTPCHECK_SERVER_T *server)
+{
+  struct sockaddr_in addr = {};
+  int on = 1;
+
+  if ((server->fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+    return false;
+  setsockopt(server->fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  fcntl(server->fd, F_SETFL, fcntl(server->fd, F_GETFL) | O_NONBLOCK);
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(NTP_UDP_PORT);
+  inet_pton(AF_INET, server->ip, &addr.sin_addr);
+  return bind(server->fd, (struct sockaddr *) &addr, sizeof(addr)) == 0;
+}
+
+/*
+   take the requests and send the replies which are due
+*/
+static void NtpCheckServerPoll(NTPCHECK_SERVER_T *server)
+{
+  uint8_t request[NTPCHECK_PACKET_SIZE];
+  struct sockaddr_in from;
+  socklen_t fromlen = sizeof(from);
+
+  while (recvfrom(server->fd, request, sizeof(request), 0, (struct sockaddr *) &from, &fromlen) == NTPCHECK_PACKET_SIZE) {
+    /*
+       the request arrives after the delay up, the reply leaves at once
+    */
+    uint64_t time = NtpCheckToNtp(NtpCheckTruth() + server->up + _offset);
+
+    memset(server->reply, 0, sizeof(server->reply));
+    server->reply[0] = (0 << 6) | (4 << 3) | 4;   // LI=0, Version=4, Mode=4 (=server)
+    server->reply[1] = (server->mode == NTPCHECK_KOD) ? 0 : 2;
+    memcpy(server->reply + 24, request + 40, 8);    // origin = the transmit timestamp of the request
+    if (server->mode == NTPCHECK_SPOOF)
+      server->reply[31] ^= 0x01;
+    NtpCheckSetField(server->reply, 32, time);
+    NtpCheckSetField(server->reply, 40, time);
+    server->to = from;
+    server->at = HostLocalUs() + server->up + server->down;
+    server->queued = true;
+    _last_request = HostLocalUs();
+  }
+  if (server->queued && HostLocalUs() >= server->at) {
+    sendto(server->fd, server->reply, sizeof(server->reply), 0, (struct sockaddr *) &server->to, sizeof(server->to));
+    server->queued = false;
+  }
+}
+
+/*
+   run the NTP module until the condition holds, max. for the given time -- returns the condition
+*/
+static bool NtpCheckRun(uint64_t max_us, std::function<bool(void)> until = NULL)
+{
+  uint64_t end = HostLocalUs() + max_us;
+
+  while (HostLocalUs() < end) {
+    bool fine = HostLocalUs() - _last_request < 2 * NTP_REPLY_TIMEOUT * 1000;
+
+    /*
+       the replies due are sent before and the requests are taken right after the update
+    */
+    for (size_t n = 0; n < NTPCHECK_SERVERS; n++)
+      NtpCheckServerPoll(&_servers[n]);
+    NtpUpdate();
+    for (size_t n = 0; n < NTPCHECK_SERVERS; n++) {
+      NtpCheckServerPoll(&_servers[n]);
+      fine |= _servers[n].queued;
+    }
+
+    /*
+       the clock of the client runs at the rate of the host, plus the slew
+    */
+    uint64_t client = NtpGetTimeUs();
+    uint64_t host = NtpCheckTruth();
+
+    if (_track.client && client && host > _track.host) {
+      int64_t drift = (int64_t) (client - _track.client) - (int64_t) (host - _track.host);
+
+      if (client < _track.client)
+        _track.backwards++;
+      if (llabs(drift) > (int64_t) ((host - _track.host) * NTP_SLEW_RATE_PPM / 1000000) + 1)
+        _track.jumps++;
+    }
+    _track.client = client;
+    _track.host = host;
+
+    if (until && until())
+      return true;
+    HostClockAdvance((fine) ? _step_fine : NTPCHECK_STEP_US);
+  }
+  return !until;
+}
+
+/*
+   run until the next round is done
+*/
+static bool NtpCheckSync(void)
+{
+  time_t last = NtpLastSync();
+  int requests;
+
+  NtpStats(&requests, NULL, NULL);
+  return NtpCheckRun((NTP_SYNC_INTERVAL + 10) * 1000000ULL, [&]() {
+    int now;
+
+    NtpStats(&now, NULL, NULL);
+    return now > requests && NtpLastSync() != last;
+  });
+}
+
+static bool NtpCheckNear(int64_t value, int64_t expected)
+{
+  return llabs(value - expected) <= NTPCHECK_TOLERANCE_US;
+}
+
+/*
+   the first round steps the clock
+*/
+static bool NtpCheckExchange(void)
+{
+  int requests, replies, good;
+
+  bool synced = NtpCheckRun(10 * 1000000ULL, []() { return NtpFirstSync() != 0; });
+
+  NtpStats(&requests, &replies, &good);
+
+  /*
+     the offset is off by half the asymmetry of the delays of the selected server
+  */
+  int64_t error = NtpCheckError();
+  bool ok = synced && !strcmp(NtpLastServer(), _servers[0].ip) &&
+            NtpCheckNear(NtpLastDelayUs(), _servers[0].up + _servers[0].down) &&
+            NtpCheckNear(error, (_servers[0].up - _servers[0].down) / 2) &&
+            requests == 3 && replies == 3 && good == 2;
+
+  printf("NTP: exchange with %s: offset %lld us, delay %lld us, error %lld us, %d requests %d replies %d good %s\n",
+         NtpLastServer(), (long long) NtpLastOffsetUs(), (long long) NtpLastDelayUs(), (long long) error,
+         requests, replies, good, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   an offset below the step threshold is slewed
+*/
+static bool NtpCheckSlew(void)
+{
+  int64_t asym = (_servers[0].up - _servers[0].down) / 2;
+  int64_t shift = 60000;
+  bool ok = true;
+
+  _servers[2].mode = NTPCHECK_KOD;
+  _offset += shift;
+  _track = NTPCHECK_TRACK_T();
+  ok = NtpCheckSync() && NtpCheckNear(NtpLastOffsetUs(), shift);
+
+  int64_t start = NtpCheckError();
+  uint64_t client = NtpGetTimeUs(), truth = NtpCheckTruth();
+
+  /*
+     half way through the slew and done
+  */
+  uint64_t half = (uint64_t) shift / 2 * 1000000 / NTP_SLEW_RATE_PPM;
+
+  NtpCheckRun(half);
+
+  int64_t middle = NtpCheckError();
+  double rate = (double) (NtpGetTimeUs() - client) / (double) (NtpCheckTruth() - truth);
+
+  NtpCheckRun(half + 10 * 1000000ULL);
+
+  int64_t end = NtpCheckError();
+
+  ok = ok && NtpCheckNear(start, asym - shift) && NtpCheckNear(middle, asym - shift / 2) && NtpCheckNear(end, asym) &&
+       fabs(rate - (1 + NTP_SLEW_RATE_PPM / 1e6)) < 1e-6 && !_track.jumps && !_track.backwards;
+  printf("NTP: slew of %lld us: error %lld -> %lld -> %lld us, rate %.6f, %lu jumps, %lu backwards %s\n",
+         (long long) NtpLastOffsetUs(), (long long) start, (long long) middle, (long long) end, rate,
+         _track.jumps, _track.backwards, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   an offset above the step threshold is stepped
+*/
+static bool NtpCheckStep(void)
+{
+  int64_t asym = (_servers[0].up - _servers[0].down) / 2;
+
+  _offset -= 2000000;
+  _track = NTPCHECK_TRACK_T();
+
+  bool synced = NtpCheckSync();
+  int64_t error = NtpCheckError();
+  bool ok = synced && NtpCheckNear(NtpLastOffsetUs(), -2000000) && NtpCheckNear(error, asym) && _track.jumps == 1;
+
+  printf("NTP: step of %lld us: error %lld us, %lu jumps %s\n", (long long) NtpLastOffsetUs(), (long long) error,
+         _track.jumps, (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   an offset between -1 ms and 0
+*/
+static bool NtpCheckSign(void)
+{
+  _offset -= 600;
+  _track = NTPCHECK_TRACK_T();
+
+  bool synced = NtpCheckSync();
+  bool ok = synced && NtpLastOffsetUs() < 0 && NtpLastOffsetUs() > -1000 && !_track.jumps;
+
+  printf("NTP: offset of %lld us slewed %s\n", (long long) NtpLastOffsetUs(), (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+/*
+   the replies of a round polled late are dropped
+*/
+static bool NtpCheckLate(void)
+{
+  time_t last = NtpLastSync();
+  int requests, replies, good, now_requests, now_replies, now_good;
+
+  NtpStats(&requests, &replies, &good);
+  _step_fine = NTPCHECK_STEP_LATE_US;
+  _offset += 5000;
+
+  /*
+     until the round is done -- all replies are in, none of the servers is waited for
+  */
+  bool done = NtpCheckRun((NTP_SYNC_INTERVAL + 10) * 1000000ULL, [&]() {
+    int n;
+
+    NtpStats(&n, &now_replies, NULL);
+    return n > requests && now_replies >= replies + (int) NTPCHECK_SERVERS;
+  });
+
+  NtpCheckRun(2 * NTP_REPLY_TIMEOUT * 1000ULL);
+  NtpStats(&now_requests, &now_replies, &now_good);
+
+  bool dropped = done && now_good == good && NtpLastSync() == last;
+
+  _step_fine = NTPCHECK_STEP_FINE_US;
+
+  bool synced = NtpCheckSync() && NtpCheckNear(NtpLastOffsetUs(), 5000);
+  bool ok = dropped && synced;
+
+  printf("NTP: polled every %d ms: %d replies, %d good, the clock %s, in time again %s %s\n",
+         NTPCHECK_STEP_LATE_US / 1000, now_replies - replies, now_good - good, (dropped) ? "left alone" : "ADJUSTED",
+         (synced) ? "synced" : "NOT SYNCED", (ok) ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc > 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 1;
+  }
+
+  for (size_t n = 0; n < NTPCHECK_SERVERS; n++)
+    if (!NtpCheckServerSetup(&_servers[n])) {
+      printf("NTP: can't listen on %s:%d -- FAILED\n", _servers[n].ip, NTP_UDP_PORT);
+      return 1;
+    }
+
+  HostSerialMute(true);
+  HostClockVirtual(NTPCHECK_EPOCH_US);
+  _truth_local = HostLocalUs();
+  HostWifiSet(true);
+
+  CONFIG_NTP_T ntp = {};
+
+  ConfigSetup();
+  snprintf(ntp.server, sizeof(ntp.server), "%s %s %s", _servers[0].ip, _servers[1].ip, _servers[2].ip);
+  CONFIG_SET(CONFIG_NTP_T, ntp, &ntp);
+  StateSetup(STATE_SCANNING);
+  StateUpdate();
+  NtpSetup();
+
+  /*
+     the sketch syncs after the WiFi is connected, a few seconds after the boot
+  */
+  HostClockAdvance(5 * 1000000ULL);
+
+  bool failed = !NtpCheckExchange();
+
+  failed = !NtpCheckSlew() || failed;
+  failed = !NtpCheckStep() || failed;
+  failed = !NtpCheckSign() || failed;
+  failed = !NtpCheckLate() || failed;
+  printf("NTP: %s\n", (failed) ? "FAILED" : "passed");
+  return (failed) ? 1 : 0;
+}
+
+/**/
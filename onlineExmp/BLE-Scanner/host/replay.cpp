@@ -0,0 +1,256 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  replay of captured advertisements
+
+  reads a capture (see capture.h) -- either the binary file downloaded with
+  /capture or a Serial log with the CAPH:/CAP: lines -- and passes the
+  advertisements to the scan callback of the gateway at their recorded
+  time on the virtual clock, while the loop of the sketch runs every 10 ms.
+
+  The replay is paced in real time (-x 1), accelerated (-x <factor>) or as
+  fast as possible (-x 0), the latter measures the ingest path.
+
+  usage: scanner-replay-<machines> [-x <speed>] [-r <repeat>] <capture>
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "config.h"
+#include "scandev.h"
+#include "capture.h"
+#include "util.h"
+#include "host.h"
+
+/*
+   the loop of the sketch runs every ...
+*/
+#define REPLAY_LOOP_US          (10 * 1000)
+
+static double _speed = 1;
+static int _repeat = 1;
+
+static std::vector<CAPTURE_RECORD_T> _records;
+static uint64_t _start_us = 0;
+static unsigned long _bad_lines = 0;
+
+static unsigned long _publishes = 0;
+
+static double ReplayTime(void)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+   read a binary capture
+*/
+static bool ReplayReadBinary(const std::vector<uint8_t> &data)
+{
+  uint64_t last_us;
+  size_t n = CAPTURE_HEADER_SIZE;
+
+  if (!CaptureDecodeHeader(data.data(), data.size(), &_start_us))
+    return false;
+
+  last_us = _start_us;
+  while (n < data.size()) {
+    CAPTURE_RECORD_T record;
+    size_t length = CaptureDecode(&data[n], data.size() - n, &record, &last_us);
+
+    if (!length) {
+      fprintf(stderr, "REPLAY: capture is truncated at offset %zu\n", n);
+      break;
+    }
+    _records.push_back(record);
+    n += length;
+  }
+  return true;
+}
+
+/*
+   decode the hex of a Serial line and check its sum
+*/
+static size_t ReplayDecodeLine(const char *hex, uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  uint8_t sum = 0;
+  unsigned int b;
+
+  while (n < size && sscanf(hex, "%2x", &b) == 1 && isxdigit(hex[1])) {
+    buffer[n++] = b;
+    hex += 2;
+  }
+  if (n < 2)
+    return 0;
+  for (size_t i = 0; i < n - 1; i++)
+    sum += buffer[i];
+  return (sum == buffer[n - 1]) ? n - 1 : 0;
+}
+
+/*
+   read a Serial log with the capture lines
+*/
+static bool ReplayReadSerial(const std::vector<uint8_t> &data)
+{
+  std::string text(data.begin(), data.end());
+  bool header = false;
+  uint64_t last_us = 0;
+  size_t pos = 0;
+
+  while (pos < text.size()) {
+    size_t end = text.find('\n', pos);
+    std::string line = text.substr(pos, (end == std::string::npos) ? std::string::npos : end - pos);
+    uint8_t buffer[CAPTURE_RECORD_MAX + 1];
+    size_t tag, length;
+
+    pos = (end == std::string::npos) ? text.size() : end + 1;
+
+    if ((tag = line.find(CAPTURE_SERIAL_HEADER)) != std::string::npos) {
+      length = ReplayDecodeLine(&line[tag + strlen(CAPTURE_SERIAL_HEADER)], buffer, sizeof(buffer));
+      if (!CaptureDecodeHeader(buffer, length, &last_us)) {
+        _bad_lines++;
+        continue;
+      }
+      if (!header)
+        _start_us = last_us;
+      header = true;
+    }
+    else if ((tag = line.find(CAPTURE_SERIAL_RECORD)) != std::string::npos && header) {
+      CAPTURE_RECORD_T record;
+
+      length = ReplayDecodeLine(&line[tag + strlen(CAPTURE_SERIAL_RECORD)], buffer, sizeof(buffer));
+      if (!length || CaptureDecode(buffer, length, &record, &last_us) != length) {
+        _bad_lines++;
+        continue;
+      }
+      _records.push_back(record);
+    }
+  }
+  return header;
+}
+
+static void ReplayPublished(const char *topic, const char *payload, unsigned int length)
+{
+  _publishes++;
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "x:r:")) != -1) {
+    switch (opt) {
+      case 'x': _speed = atof(optarg); break;
+      case 'r': _repeat = MAX(1, atoi(optarg)); break;
+      default:
+        optind = argc + 1;
+        break;
+    }
+  }
+  if (optind != argc - 1) {
+    fprintf(stderr, "usage: %s [-x <speed, 0 = max>] [-r <repeat>] <capture>\n", argv[0]);
+    return 1;
+  }
+
+  /*
+     read the capture
+  */
+  FILE *fp = fopen(argv[optind], "rb");
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t n;
+
+  if (!fp) {
+    perror(argv[optind]);
+    return 1;
+  }
+  while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    data.insert(data.end(), buffer, buffer + n);
+  fclose(fp);
+
+  if (!ReplayReadBinary(data) && !ReplayReadSerial(data)) {
+    fprintf(stderr, "%s: not a capture\n", argv[optind]);
+    return 1;
+  }
+  if (_records.empty()) {
+    fprintf(stderr, "%s: capture is empty\n", argv[optind]);
+    return 1;
+  }
+
+  uint64_t span = _records.back().time_us - _start_us;
+
+  /*
+     run the gateway on the clock of the capture
+  */
+  HostSerialMute(true);
+  HostClockVirtual(_start_us);
+  HostWifiSet(true);
+  HostNtpSet(true);
+  HostMqttSet(true, ReplayPublished);
+  HostSketchSetup();
+
+  double wall = ReplayTime();
+  double ingest = 0;
+  uint64_t next_loop = _start_us;
+
+  for (int round = 0; round < _repeat; round++) {
+    uint64_t offset = round * (span + REPLAY_LOOP_US);
+
+    for (auto &record : _records) {
+      uint64_t t = record.time_us + offset;
+
+      while (next_loop <= t) {
+        HostClockAdvance(next_loop - HostEpochUs());
+        HostSketchLoop();
+        next_loop += REPLAY_LOOP_US;
+      }
+      if (t > HostEpochUs())
+        HostClockAdvance(t - HostEpochUs());
+
+      if (_speed > 0) {
+        double due = wall + (t - _start_us) / 1e6 / _speed;
+        double now = ReplayTime();
+
+        if (due > now)
+          std::this_thread::sleep_for(std::chrono::duration<double>(due - now));
+      }
+
+      double s = ReplayTime();
+      HostBleReplay(record.addr, record.type, record.rssi, record.payload, record.length);
+      ingest += ReplayTime() - s;
+    }
+  }
+
+  /*
+     let the last publishes go out
+  */
+  for (int n = 0; n < 10 * 1000000 / REPLAY_LOOP_US; n++) {
+    HostClockAdvance(REPLAY_LOOP_US);
+    HostSketchLoop();
+  }
+  wall = ReplayTime() - wall;
+
+  unsigned long adverts = _records.size() * _repeat;
+
+  printf("REPLAY: %s, %zu records over %.1f s, %lu bad lines, %d round(s) at %s%.1fx in %.1f s\n",
+         argv[optind], _records.size(), span / 1e6, _bad_lines, _repeat,
+         (_speed > 0) ? "" : "max ", (_speed > 0) ? _speed : (span * _repeat / 1e6) / wall, wall);
+  printf("INGEST: %lu adverts, %.0f ns/advert, %.0f adverts/s through the scan callback\n",
+         adverts, ingest * 1e9 / adverts, adverts / ingest);
+  printf("GATEWAY: %d machines tracked, %lu publishes\n", ScanDevGetCount(), _publishes);
+
+  return 0;
+}
+
+/**/
@@ -0,0 +1,213 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the Arduino core and the Time library
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "Arduino.h"
+#include "TimeLib.h"
+#include "host.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+/*
+   the clock -- the epoch time is the local time plus an offset
+*/
+static std::atomic<bool> _clock_virtual(false);
+static std::atomic<uint64_t> _clock_local_us(0);
+static std::atomic<int64_t> _clock_epoch_offset(0);
+static std::atomic<bool> _clock_epoch_set(false);
+static const std::chrono::steady_clock::time_point _clock_start = std::chrono::steady_clock::now();
+
+static bool _serial_mute = false;
+
+/*
+   get the local time in micro seconds since start
+*/
+uint64_t HostLocalUs(void)
+{
+  if (_clock_virtual)
+    return _clock_local_us;
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _clock_start).count();
+}
+
+/*
+   get the epoch time in micro seconds
+*/
+uint64_t HostEpochUs(void)
+{
+  if (!_clock_epoch_set) {
+    /*
+       start with the time of the host
+    */
+    uint64_t epoch_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    HostEpochSet(epoch_us);
+  }
+  return HostLocalUs() + _clock_epoch_offset;
+}
+
+/*
+   set the epoch time in micro seconds
+*/
+void HostEpochSet(uint64_t epoch_us)
+{
+  _clock_epoch_offset = (int64_t) epoch_us - (int64_t) HostLocalUs();
+  _clock_epoch_set = true;
+}
+
+/*
+   switch to the virtual clock
+*/
+void HostClockVirtual(uint64_t epoch_us)
+{
+  _clock_local_us = HostLocalUs();
+  _clock_virtual = true;
+  HostEpochSet(epoch_us);
+}
+
+/*
+   advance the virtual clock
+*/
+void HostClockAdvance(uint64_t us)
+{
+  if (_clock_virtual)
+    _clock_local_us += us;
+}
+
+/*
+   check for the virtual clock
+*/
+bool HostClockIsVirtual(void)
+{
+  return _clock_virtual;
+}
+
+/*
+   timing
+*/
+unsigned long millis(void)
+{
+  return HostLocalUs() / 1000;
+}
+
+unsigned long micros(void)
+{
+  return HostLocalUs();
+}
+
+void delay(unsigned long ms)
+{
+  if (_clock_virtual)
+    HostClockAdvance((uint64_t) ms * 1000);
+  else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  if (_clock_virtual)
+    HostClockAdvance(us);
+  else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield(void)
+{
+  if (!_clock_virtual)
+    std::this_thread::yield();
+}
+
+/*
+   the Time library
+*/
+time_t now(void)
+{
+  return HostEpochUs() / 1000000;
+}
+
+void setTime(time_t t)
+{
+  HostEpochSet((uint64_t) t * 1000000);
+}
+
+timeStatus_t timeStatus(void)
+{
+  return timeSet;
+}
+
+void setSyncProvider(getExternalTime getTimeFunction)
+{
+}
+
+void setSyncInterval(time_t interval)
+{
+}
+
+/*
+   the serial console
+*/
+void HostSerialMute(bool mute)
+{
+  _serial_mute = mute;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  if (_serial_mute)
+    return 1;
+  return fputc(c, stderr) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  if (_serial_mute)
+    return size;
+  return fwrite(buffer, 1, size, stderr);
+}
+
+size_t HardwareSerial::print(const char *str)
+{
+  return write((const uint8_t *) str, strlen(str));
+}
+
+size_t HardwareSerial::printf(const char *fmt, ...)
+{
+  va_list args;
+  char buffer[256];
+
+  va_start(args, fmt);
+  int len = vsnprintf(buffer, sizeof(buffer), fmt, args);
+  va_end(args);
+  return (len > 0) ? print(buffer) : 0;
+}
+
+void HardwareSerial::flush(void)
+{
+  if (!_serial_mute)
+    fflush(stderr);
+}
+
+/*
+   the chip
+*/
+void EspClass::restart(void)
+{
+  Serial.println("ESP: restart requested -- exiting");
+  Serial.flush();
+  exit(0);
+}
+
+/**/
@@ -0,0 +1,95 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the Arduino core
+
+  Only the parts used by the scanner modules are provided.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __ARDUINO_H__
+#define __ARDUINO_H__ 1
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include "WString.h"
+#include "IPAddress.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+
+#define constrain(value,low,high) ((value) < (low) ? (low) : ((value) > (high) ? (high) : (value)))
+
+/*
+   timing -- see host.h for the virtual clock
+*/
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+/*
+   the serial console -- writes to stderr
+*/
+class HardwareSerial {
+  public:
+    void begin(unsigned long baud) {}
+    void end(void) {}
+    void flush(void);
+    int available(void) { return 0; }
+    int read(void) { return -1; }
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    size_t print(const char *str);
+    size_t print(const String &str) { return print(str.c_str()); }
+    size_t print(char c) { return write((uint8_t) c); }
+    template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    size_t print(T value, int base = DEC) { return print(String(value, base)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, (unsigned int) decimals)); }
+    size_t print(float value, int decimals = 2) { return print(String(value, (unsigned int) decimals)); }
+    size_t println(void) { return print("\r\n"); }
+    template<typename T>
+    size_t println(const T &value) { size_t n = print(value); return n + println(); }
+    size_t printf(const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+/*
+   the chip
+*/
+class EspClass {
+  public:
+    uint64_t getEfuseMac(void) { return 0x0000a1b2c3d4e5f6ULL; }
+    uint32_t getHeapSize(void) { return 0; }
+    uint32_t getFreeHeap(void) { return 0; }
+    uint32_t getMinFreeHeap(void) { return 0; }
+    uint32_t getMaxAllocHeap(void) { return 0; }
+    const char *getSdkVersion(void) { return "host"; }
+    void restart(void);
+};
+
+extern EspClass ESP;
+
+#endif
+
+/**/
@@ -0,0 +1,29 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the DNS server
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __DNSSERVER_H__
+#define __DNSSERVER_H__ 1
+
+#include "Arduino.h"
+
+class DNSServer {
+  public:
+    bool start(uint16_t port, const char *domain, IPAddress ip) { return true; }
+    void stop(void) {}
+    void processNextRequest(void) {}
+};
+
+#endif
+
+/**/
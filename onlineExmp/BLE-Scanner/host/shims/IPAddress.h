@@ -0,0 +1,64 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the Arduino IPAddress class
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __IPADDRESS_H__
+#define __IPADDRESS_H__ 1
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "WString.h"
+
+class IPAddress {
+  public:
+    IPAddress() { memset(_bytes, 0, sizeof(_bytes)); }
+    IPAddress(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) { _bytes[0] = b0; _bytes[1] = b1; _bytes[2] = b2; _bytes[3] = b3; }
+    IPAddress(uint32_t addr) { memcpy(_bytes, &addr, sizeof(_bytes)); }
+    IPAddress(const uint8_t *addr) { memcpy(_bytes, addr, sizeof(_bytes)); }
+
+    operator uint32_t() const { uint32_t addr; memcpy(&addr, _bytes, sizeof(addr)); return addr; }
+    bool operator==(const IPAddress &addr) const { return memcmp(_bytes, addr._bytes, sizeof(_bytes)) == 0; }
+    bool operator!=(const IPAddress &addr) const { return !(*this == addr); }
+    uint8_t operator[](int index) const { return _bytes[index]; }
+    uint8_t &operator[](int index) { return _bytes[index]; }
+
+    bool fromString(const char *str)
+    {
+      unsigned int b[4];
+      char tail;
+
+      if (sscanf(str, "%u.%u.%u.%u%c", &b[0], &b[1], &b[2], &b[3], &tail) != 4)
+        return false;
+      for (int n = 0; n < 4; n++) {
+        if (b[n] > 255)
+          return false;
+        _bytes[n] = b[n];
+      }
+      return true;
+    }
+
+    String toString(void) const
+    {
+      char buffer[16];
+      snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+      return String(buffer);
+    }
+
+  private:
+    uint8_t _bytes[4];
+};
+
+#endif
+
+/**/
@@ -0,0 +1,67 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the LittleFS file system
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "LittleFS.h"
+#include "host.h"
+
+LittleFSClass LittleFS;
+
+static std::string _fs_root = ".";
+
+/*
+   set the directory of the files
+*/
+void HostFsSetRoot(const char *dir)
+{
+  _fs_root = dir;
+}
+
+/*
+   map the path of the file system to the host
+*/
+static std::string HostFsPath(const char *path)
+{
+  return _fs_root + ((*path == '/') ? "" : "/") + path;
+}
+
+size_t File::size(void)
+{
+  struct stat st;
+
+  return (_fp && fstat(fileno(_fp.get()), &st) == 0) ? st.st_size : 0;
+}
+
+File LittleFSClass::open(const char *path, const char *mode)
+{
+  std::string m = mode;
+
+  if (m.find('b') == std::string::npos)
+    m += "b";
+  return File(fopen(HostFsPath(path).c_str(), m.c_str()));
+}
+
+bool LittleFSClass::exists(const char *path)
+{
+  return access(HostFsPath(path).c_str(), F_OK) == 0;
+}
+
+bool LittleFSClass::remove(const char *path)
+{
+  return unlink(HostFsPath(path).c_str()) == 0;
+}
+
+/**/
@@ -0,0 +1,54 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the LittleFS file system
+
+  The files are stored in a directory of the host, see HostFsSetRoot() in
+  host.h -- the default is the current directory.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __LITTLEFS_H__
+#define __LITTLEFS_H__ 1
+
+#include <memory>
+#include "Arduino.h"
+
+class File {
+  public:
+    File() {}
+    File(FILE *fp) { if (fp) _fp.reset(fp, fclose); }
+
+    size_t write(const uint8_t *buffer, size_t size) { return (_fp) ? fwrite(buffer, 1, size, _fp.get()) : 0; }
+    size_t read(uint8_t *buffer, size_t size) { return (_fp) ? fread(buffer, 1, size, _fp.get()) : 0; }
+    bool seek(uint32_t pos) { return _fp && fseek(_fp.get(), pos, SEEK_SET) == 0; }
+    size_t size(void);
+    void flush(void) { if (_fp) fflush(_fp.get()); }
+    void close(void) { _fp.reset(); }
+    operator bool() const { return (bool) _fp; }
+
+  private:
+    std::shared_ptr<FILE> _fp;
+};
+
+class LittleFSClass {
+  public:
+    bool begin(bool formatOnFail = false) { return true; }
+    void end(void) {}
+    File open(const char *path, const char *mode = "r");
+    bool exists(const char *path);
+    bool remove(const char *path);
+};
+
+extern LittleFSClass LittleFS;
+
+#endif
+
+/**/
@@ -0,0 +1,232 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host mock of the NimBLE library
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include "NimBLEDevice.h"
+#include "host.h"
+
+/*
+   the device
+*/
+static bool _ble_initialized = false;
+static NimBLEScan *_ble_scan = NULL;
+static uint8_t _ble_filter_mode = CONFIG_BTDM_SCAN_DUPL_TYPE_DEVICE;
+static uint16_t _ble_dupl_cache_size = 20;
+
+/*
+   the radio
+*/
+static HOST_BLE_STATS_T _ble_stats;
+
+bool NimBLEDevice::init(const std::string &deviceName)
+{
+  _ble_initialized = true;
+  return true;
+}
+
+bool NimBLEDevice::isInitialized(void)
+{
+  return _ble_initialized;
+}
+
+NimBLEScan *NimBLEDevice::getScan(void)
+{
+  if (!_ble_scan)
+    _ble_scan = new NimBLEScan();
+  return _ble_scan;
+}
+
+NimBLEClient *NimBLEDevice::createClient(void)
+{
+  return new NimBLEClient();
+}
+
+void NimBLEDevice::setScanFilterMode(uint8_t type)
+{
+  _ble_filter_mode = type;
+}
+
+void NimBLEDevice::setScanDuplicateCacheSize(uint16_t size)
+{
+  _ble_dupl_cache_size = size;
+}
+
+uint8_t NimBLEDevice::getScanFilterMode(void)
+{
+  return _ble_filter_mode;
+}
+
+uint16_t NimBLEDevice::getScanDuplicateCacheSize(void)
+{
+  return _ble_dupl_cache_size;
+}
+
+/*
+   start a scan -- the duration is in milli seconds, 0 scans forever
+*/
+bool NimBLEScan::start(uint32_t duration, bool isContinue, bool restart)
+{
+  if (!isContinue)
+    clearResults();
+
+  /*
+     the controller starts with an empty duplicate list on every scan
+  */
+  _dupl_cache.assign(NimBLEDevice::getScanDuplicateCacheSize(), 0);
+  _dupl_next = 0;
+
+  _scanning = true;
+  _end_us = (duration) ? HostLocalUs() + (uint64_t) duration * 1000 : 0;
+  return true;
+}
+
+bool NimBLEScan::stop(void)
+{
+  _scanning = false;
+  return true;
+}
+
+bool NimBLEScan::isScanning(void)
+{
+  if (_scanning && _end_us && HostLocalUs() >= _end_us) {
+    /*
+       the scan duration is over
+    */
+    _scanning = false;
+    if (_callbacks)
+      _callbacks->onScanEnd(_results, 0);
+  }
+  return _scanning;
+}
+
+void NimBLEScan::clearResults(void)
+{
+  for (auto device : _results._devices)
+    delete device;
+  _results._devices.clear();
+}
+
+/*
+   check the duplicate list of the controller, the oldest entry is replaced when it is full
+*/
+bool NimBLEScan::isDuplicate(const NimBLEAddress &address, const uint8_t *payload, size_t length)
+{
+  uint64_t key = 0;
+  uint8_t mode = NimBLEDevice::getScanFilterMode();
+
+  if (mode != CONFIG_BTDM_SCAN_DUPL_TYPE_DATA) {
+    for (int n = 0; n < 6; n++)
+      key = (key << 8) | address.getVal()[n];
+    key = (key << 8) | address.getType();
+  }
+  if (mode != CONFIG_BTDM_SCAN_DUPL_TYPE_DEVICE) {
+    // FNV-1a over the payload
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t n = 0; n < length; n++)
+      hash = (hash ^ payload[n]) * 0x100000001b3ULL;
+    key ^= hash;
+  }
+  key |= 1;   // 0 marks a free entry
+
+  if (_dupl_cache.empty())
+    return false;
+  for (auto entry : _dupl_cache)
+    if (entry == key)
+      return true;
+
+  _dupl_cache[_dupl_next] = key;
+  _dupl_next = (_dupl_next + 1) % _dupl_cache.size();
+  return false;
+}
+
+/*
+   pass a received advertisement to the scan
+*/
+void NimBLEScan::receive(const NimBLEAddress &address, int rssi, const uint8_t *payload, size_t length,
+                         const uint8_t *scan_rsp, size_t scan_rsp_length, bool replay)
+{
+  _ble_stats.received++;
+  if (replay) {
+    /*
+       a replayed advertisement already passed the scan and the filter
+    */
+  }
+  else if (!isScanning()) {
+    _ble_stats.missed++;
+    return;
+  }
+  else if (_filter_duplicates && !_want_duplicates && isDuplicate(address, payload, length)) {
+    _ble_stats.filtered++;
+    return;
+  }
+
+  /*
+     update the device in the results or add a new one
+  */
+  NimBLEAdvertisedDevice *device = NULL;
+  bool stored = true;
+
+  for (auto d : _results._devices) {
+    if (d->getAddress() == address) {
+      device = d;
+      break;
+    }
+  }
+  if (device)
+    device->update(rssi, payload, length);
+  else {
+    device = new NimBLEAdvertisedDevice(address, rssi, payload, length);
+    if (_max_results == 0xff || _results._devices.size() < _max_results)
+      _results._devices.push_back(device);
+    else
+      stored = false;
+  }
+  if (_active && scan_rsp)
+    device->append(scan_rsp, scan_rsp_length);
+  _ble_stats.results_max = max(_ble_stats.results_max, (unsigned long) _results._devices.size());
+
+  _ble_stats.reported++;
+  if (_callbacks) {
+    _callbacks->onDiscovered(device);
+    _callbacks->onResult(device);
+  }
+  if (!stored)
+    delete device;
+}
+
+/*
+   pass a received advertisement to the scan of the device
+*/
+void HostBleAdvertise(const uint8_t addr[6], uint8_t type, int rssi, const uint8_t *payload, size_t length,
+                      const uint8_t *scan_rsp, size_t scan_rsp_length)
+{
+  NimBLEDevice::getScan()->receive(NimBLEAddress(addr, type), rssi, payload, length, scan_rsp, scan_rsp_length, false);
+}
+
+/*
+   pass a captured advertisement directly to the scan callbacks
+*/
+void HostBleReplay(const uint8_t addr[6], uint8_t type, int rssi, const uint8_t *payload, size_t length)
+{
+  NimBLEDevice::getScan()->receive(NimBLEAddress(addr, type), rssi, payload, length, NULL, 0, true);
+}
+
+/*
+   get the stats of the radio
+*/
+void HostBleStats(HOST_BLE_STATS_T *stats)
+{
+  *stats = _ble_stats;
+}
+
+/**/
@@ -0,0 +1,250 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host mock of the NimBLE library
+
+  The radio is simulated: a driver passes raw advertisements to
+  HostBleAdvertise() or HostBleReplay() (see host.h). While a scan is running, they pass the
+  duplicate filter of the controller and are reported to the scan
+  callbacks like on the ESP32. Connections to devices always fail.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __NIMBLEDEVICE_H__
+#define __NIMBLEDEVICE_H__ 1
+
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+#define BLE_ADDR_PUBLIC     0
+#define BLE_ADDR_RANDOM     1
+
+/*
+   duplicate filter modes of the controller
+*/
+#define CONFIG_BTDM_SCAN_DUPL_TYPE_DEVICE       0
+#define CONFIG_BTDM_SCAN_DUPL_TYPE_DATA         1
+#define CONFIG_BTDM_SCAN_DUPL_TYPE_DATA_DEVICE  2
+
+/*
+   types of the advertisement data fields
+*/
+#define BLE_HS_ADV_TYPE_INCOMP_NAME     0x08
+#define BLE_HS_ADV_TYPE_COMP_NAME       0x09
+#define BLE_HS_ADV_TYPE_MFG_DATA        0xff
+
+class NimBLEAddress {
+  public:
+    NimBLEAddress() : _type(BLE_ADDR_PUBLIC) { memset(_val, 0, sizeof(_val)); }
+    NimBLEAddress(const uint8_t address[6], uint8_t type = BLE_ADDR_PUBLIC) : _type(type) { memcpy(_val, address, sizeof(_val)); }
+    NimBLEAddress(const std::string &address, uint8_t type = BLE_ADDR_PUBLIC) : _type(type)
+    {
+      unsigned int b[6];
+
+      memset(_val, 0, sizeof(_val));
+      if (sscanf(address.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) == 6) {
+        // the address is stored in reverse (little endian) byte order
+        for (int n = 0; n < 6; n++)
+          _val[n] = b[5 - n];
+      }
+    }
+
+    const uint8_t *getVal(void) const { return _val; }
+    uint8_t getType(void) const { return _type; }
+    bool isNull(void) const { static const uint8_t null[6] = {}; return memcmp(_val, null, sizeof(_val)) == 0; }
+
+    bool operator==(const NimBLEAddress &addr) const { return memcmp(_val, addr._val, sizeof(_val)) == 0 && _type == addr._type; }
+    bool operator!=(const NimBLEAddress &addr) const { return !(*this == addr); }
+
+    std::string toString(void) const
+    {
+      char buffer[18];
+      snprintf(buffer, sizeof(buffer), "%02x:%02x:%02x:%02x:%02x:%02x",
+               _val[5], _val[4], _val[3], _val[2], _val[1], _val[0]);
+      return buffer;
+    }
+
+  private:
+    uint8_t _val[6];
+    uint8_t _type;
+};
+
+class NimBLEUUID {
+  public:
+    NimBLEUUID(uint16_t uuid) : _uuid(uuid) {}
+    bool operator==(const NimBLEUUID &uuid) const { return _uuid == uuid._uuid; }
+
+  private:
+    uint16_t _uuid;
+};
+
+/*
+   a received advertisement -- the fields are parsed out of the raw payload on every call
+*/
+class NimBLEAdvertisedDevice {
+  public:
+    NimBLEAdvertisedDevice(const NimBLEAddress &address, int rssi, const uint8_t *payload, size_t length)
+      : _address(address), _rssi(rssi), _payload(payload, payload + length) {}
+
+    void update(int rssi, const uint8_t *payload, size_t length) { _rssi = rssi; _payload.assign(payload, payload + length); }
+    void append(const uint8_t *payload, size_t length) { _payload.insert(_payload.end(), payload, payload + length); }
+
+    NimBLEAddress getAddress(void) const { return _address; }
+    uint8_t getAddressType(void) const { return _address.getType(); }
+    int getRSSI(void) const { return _rssi; }
+    const std::vector<uint8_t> &getPayload(void) const { return _payload; }
+
+    std::string getName(void) const
+    {
+      std::string name = getField(BLE_HS_ADV_TYPE_COMP_NAME);
+      return (name.empty()) ? getField(BLE_HS_ADV_TYPE_INCOMP_NAME) : name;
+    }
+    bool haveName(void) const { return !getName().empty(); }
+    std::string getManufacturerData(void) const { return getField(BLE_HS_ADV_TYPE_MFG_DATA); }
+    bool haveManufacturerData(void) const { return findField(BLE_HS_ADV_TYPE_MFG_DATA, NULL) >= 0; }
+
+  private:
+    NimBLEAddress _address;
+    int _rssi;
+    std::vector<uint8_t> _payload;
+
+    int findField(uint8_t type, size_t *length) const
+    {
+      for (size_t n = 0; n + 1 < _payload.size() && _payload[n]; n += _payload[n] + 1) {
+        if (n + _payload[n] >= _payload.size())
+          break;
+        if (_payload[n + 1] == type) {
+          if (length)
+            *length = _payload[n] - 1;
+          return n + 2;
+        }
+      }
+      return -1;
+    }
+    std::string getField(uint8_t type) const
+    {
+      size_t length;
+      int offset = findField(type, &length);
+      return (offset < 0) ? std::string() : std::string((const char *) &_payload[offset], length);
+    }
+};
+
+class NimBLEScan;
+
+class NimBLEScanResults {
+  public:
+    int getCount(void) const { return _devices.size(); }
+    const NimBLEAdvertisedDevice *getDevice(uint32_t index) const { return _devices[index]; }
+
+  private:
+    friend class NimBLEScan;
+    std::vector<NimBLEAdvertisedDevice *> _devices;
+};
+
+class NimBLEScanCallbacks {
+  public:
+    virtual ~NimBLEScanCallbacks() {}
+    virtual void onDiscovered(const NimBLEAdvertisedDevice *advertisedDevice) {}
+    virtual void onResult(const NimBLEAdvertisedDevice *advertisedDevice) {}
+    virtual void onScanEnd(const NimBLEScanResults &scanResults, int reason) {}
+};
+
+class NimBLEScan {
+  public:
+    void setScanCallbacks(NimBLEScanCallbacks *callbacks, bool wantDuplicates = false) { _callbacks = callbacks; _want_duplicates = wantDuplicates; }
+    void setActiveScan(bool active) { _active = active; }
+    void setInterval(uint16_t interval) {}
+    void setWindow(uint16_t window) {}
+    void setDuplicateFilter(uint8_t enabled) { _filter_duplicates = enabled; }
+    void setMaxResults(uint8_t maxResults) { _max_results = maxResults; }
+    bool start(uint32_t duration, bool isContinue = false, bool restart = true);
+    bool stop(void);
+    bool isScanning(void);
+    bool isActiveScan(void) const { return _active; }
+    NimBLEScanResults getResults(void) { return _results; }
+    void clearResults(void);
+
+    /*
+       host only: pass a received advertisement, a replayed one bypasses the scan state and the filter
+    */
+    void receive(const NimBLEAddress &address, int rssi, const uint8_t *payload, size_t length,
+                 const uint8_t *scan_rsp, size_t scan_rsp_length, bool replay);
+
+  private:
+    NimBLEScanCallbacks *_callbacks = NULL;
+    bool _want_duplicates = false;
+    bool _active = false;
+    bool _scanning = false;
+    uint8_t _filter_duplicates = 1;
+    uint8_t _max_results = 0xff;
+    uint64_t _end_us = 0;
+    NimBLEScanResults _results;
+    std::vector<uint64_t> _dupl_cache;
+    size_t _dupl_next = 0;
+
+    bool isDuplicate(const NimBLEAddress &address, const uint8_t *payload, size_t length);
+};
+
+class NimBLEClient;
+
+class NimBLEClientCallbacks {
+  public:
+    virtual ~NimBLEClientCallbacks() {}
+    virtual void onConnect(NimBLEClient *client) {}
+    virtual void onDisconnect(NimBLEClient *client, int reason) {}
+};
+
+class NimBLERemoteCharacteristic {
+  public:
+    bool canRead(void) { return false; }
+    template<typename T>
+    T readValue(void) { return T(); }
+};
+
+class NimBLERemoteService {
+  public:
+    NimBLERemoteCharacteristic *getCharacteristic(const NimBLEUUID &uuid) { return NULL; }
+};
+
+class NimBLEClient {
+  public:
+    void setClientCallbacks(NimBLEClientCallbacks *callbacks, bool deleteCallbacks = true) { _callbacks = callbacks; }
+    bool connect(const NimBLEAddress &address) { return false; }
+    NimBLERemoteService *getService(const NimBLEUUID &uuid) { return NULL; }
+    int disconnect(void) { return 0; }
+
+  private:
+    NimBLEClientCallbacks *_callbacks = NULL;
+};
+
+class NimBLEDevice {
+  public:
+    static bool init(const std::string &deviceName);
+    static bool isInitialized(void);
+    static NimBLEScan *getScan(void);
+    static NimBLEClient *createClient(void);
+    static void setScanFilterMode(uint8_t type);
+    static void setScanDuplicateCacheSize(uint16_t size);
+
+    /*
+       host only: settings of the duplicate filter
+    */
+    static uint8_t getScanFilterMode(void);
+    static uint16_t getScanDuplicateCacheSize(void);
+};
+
+typedef NimBLEAddress BLEAddress;
+typedef NimBLEUUID BLEUUID;
+typedef NimBLEAdvertisedDevice BLEAdvertisedDevice;
+
+#endif
+
+/**/
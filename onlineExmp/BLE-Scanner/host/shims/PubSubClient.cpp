@@ -0,0 +1,323 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the PubSubClient library
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include "PubSubClient.h"
+#include "host.h"
+
+/*
+   MQTT packet types
+*/
+#define MQTTCONNECT       (1 << 4)
+#define MQTTCONNACK       (2 << 4)
+#define MQTTPUBLISH       (3 << 4)
+#define MQTTPINGREQ       (12 << 4)
+#define MQTTPINGRESP      (13 << 4)
+#define MQTTDISCONNECT    (14 << 4)
+
+/*
+   the simulated broker
+*/
+static bool _broker_reachable = true;
+static HOST_MQTT_PUBLISH_CB _broker_callback = NULL;
+static unsigned long _broker_connects = 0;
+static unsigned long _broker_publishes = 0;
+
+/*
+   the real broker, if set
+*/
+static std::string _broker_host;
+static uint16_t _broker_port = 0;
+
+/*
+   control the simulated broker
+*/
+void HostMqttSet(bool reachable, HOST_MQTT_PUBLISH_CB callback)
+{
+  _broker_reachable = reachable;
+  _broker_callback = callback;
+}
+
+/*
+   use a real broker
+*/
+void HostMqttBroker(const char *host, uint16_t port)
+{
+  _broker_host = (host) ? host : "";
+  _broker_port = port;
+}
+
+/*
+   get the stats of the client
+*/
+void HostMqttStats(unsigned long *connects, unsigned long *publishes)
+{
+  if (connects)
+    *connects = _broker_connects;
+  if (publishes)
+    *publishes = _broker_publishes;
+}
+
+PubSubClient &PubSubClient::setServer(IPAddress ip, uint16_t port)
+{
+  char domain[16];
+
+  snprintf(domain, sizeof(domain), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  return setServer(domain, port);
+}
+
+/*
+   write a packet
+*/
+bool PubSubClient::send(uint8_t header, const std::vector<uint8_t> &body)
+{
+  std::vector<uint8_t> buffer;
+  size_t length = body.size();
+
+  buffer.push_back(header);
+  do {
+    buffer.push_back((length & 0x7f) | ((length >> 7) ? 0x80 : 0));
+    length >>= 7;
+  } while (length);
+  if (buffer.size() + body.size() > _buffer_size)
+    return false;
+  buffer.insert(buffer.end(), body.begin(), body.end());
+
+  /*
+     the library writes the whole packet at once
+  */
+  if (_client->write(buffer.data(), buffer.size()) != buffer.size())
+    return false;
+  _last_out = millis();
+  return true;
+}
+
+/*
+   read a packet -- 1 if one is complete, 0 if not (yet), -1 if the timeout is over
+*/
+int PubSubClient::receive(uint8_t *header, std::vector<uint8_t> *body, unsigned long timeout)
+{
+  unsigned long start = millis();
+
+  for (;;) {
+    uint8_t buffer[256];
+    int n;
+
+    while (_client->available() > 0 && (n = _client->read(buffer, sizeof(buffer))) > 0)
+      _in.insert(_in.end(), buffer, buffer + n);
+
+    /*
+       complete packet in the input?
+    */
+    size_t length = 0, pos = 1;
+    int shift = 0;
+
+    while (pos < _in.size() && pos < 5) {
+      length |= (size_t) (_in[pos] & 0x7f) << shift;
+      shift += 7;
+      if (!(_in[pos++] & 0x80)) {
+        if (_in.size() >= pos + length) {
+          *header = _in[0];
+          body->assign(_in.begin() + pos, _in.begin() + pos + length);
+          _in.erase(_in.begin(), _in.begin() + pos + length);
+          _last_in = millis();
+          return 1;
+        }
+        break;
+      }
+    }
+
+    if (!timeout)
+      return 0;
+    if (millis() - start >= timeout || !_client->connected())
+      return -1;
+    delay(1);
+  }
+}
+
+bool PubSubClient::connect(const char *id, const char *user, const char *pass)
+{
+  if (connected())
+    return true;
+
+  if (_broker_host.empty()) {
+    /*
+       the simulated broker
+    */
+    if (!_broker_reachable) {
+      _state = MQTT_CONNECT_FAILED;
+      return false;
+    }
+    _broker_connects++;
+    _state = MQTT_CONNECTED;
+    return true;
+  }
+
+  _in.clear();
+  if (!_client->connect(_broker_host.c_str(), _broker_port)) {
+    _state = MQTT_CONNECT_FAILED;
+    return false;
+  }
+
+  /*
+     CONNECT with a clean session
+  */
+  std::vector<uint8_t> body = { 0, 4, 'M', 'Q', 'T', 'T', 4, 0x02, (uint8_t) (_keepalive >> 8), (uint8_t) _keepalive };
+  auto string = [&body](const char *s) {
+    size_t len = strlen(s);
+    body.push_back(len >> 8);
+    body.push_back(len);
+    body.insert(body.end(), s, s + len);
+  };
+
+  string(id);
+  if (user) {
+    body[7] |= 0x80;
+    string(user);
+    if (pass) {
+      body[7] |= 0x40;
+      string(pass);
+    }
+  }
+
+  uint8_t header;
+  std::vector<uint8_t> connack;
+
+  if (!send(MQTTCONNECT, body) || receive(&header, &connack, _socket_timeout * 1000UL) != 1) {
+    _state = MQTT_CONNECTION_TIMEOUT;
+    _client->stop();
+    return false;
+  }
+  if ((header & 0xf0) != MQTTCONNACK || connack.size() < 2 || connack[1] != 0) {
+    _state = (connack.size() >= 2) ? connack[1] : MQTT_CONNECT_FAILED;
+    _client->stop();
+    return false;
+  }
+
+  _broker_connects++;
+  _ping_outstanding = false;
+  _last_in = _last_out = millis();
+  _state = MQTT_CONNECTED;
+  return true;
+}
+
+void PubSubClient::disconnect(void)
+{
+  if (!_broker_host.empty() && _state == MQTT_CONNECTED) {
+    send(MQTTDISCONNECT, {});
+    _client->stop();
+  }
+  _state = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::connected(void)
+{
+  if (_broker_host.empty()) {
+    if (_state == MQTT_CONNECTED && !_broker_reachable)
+      _state = MQTT_CONNECTION_LOST;
+    return _state == MQTT_CONNECTED;
+  }
+
+  if (_state == MQTT_CONNECTED && !_client->connected()) {
+    _client->stop();
+    _state = MQTT_CONNECTION_LOST;
+  }
+  return _state == MQTT_CONNECTED;
+}
+
+bool PubSubClient::loop(void)
+{
+  if (!connected())
+    return false;
+  if (_broker_host.empty())
+    return true;
+
+  /*
+     keep alive
+  */
+  unsigned long now = millis();
+  unsigned long keepalive = _keepalive * 1000UL;
+
+  if (keepalive && (now - _last_in > keepalive || now - _last_out > keepalive)) {
+    if (_ping_outstanding) {
+      _state = MQTT_CONNECTION_TIMEOUT;
+      _client->stop();
+      return false;
+    }
+    if (!send(MQTTPINGREQ, {})) {
+      _state = MQTT_CONNECTION_LOST;
+      _client->stop();
+      return false;
+    }
+    _last_in = now;
+    _ping_outstanding = true;
+  }
+
+  /*
+     incoming packets
+  */
+  uint8_t header;
+  std::vector<uint8_t> body;
+
+  while (receive(&header, &body, 0) == 1) {
+    if ((header & 0xf0) == MQTTPINGRESP)
+      _ping_outstanding = false;
+    else if ((header & 0xf0) == MQTTPUBLISH && _callback && body.size() >= 2) {
+      size_t len = (body[0] << 8) | body[1];
+
+      if (2 + len <= body.size()) {
+        std::string topic((const char *) &body[2], len);
+        (*_callback)((char *) topic.c_str(), &body[2 + len], body.size() - 2 - len);
+      }
+    }
+  }
+  return true;
+}
+
+bool PubSubClient::publish(const char *topic, const char *payload, bool retained)
+{
+  return publish(topic, (const uint8_t *) payload, strlen(payload), retained);
+}
+
+bool PubSubClient::publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+{
+  if (!connected())
+    return false;
+
+  if (_broker_host.empty()) {
+    _broker_publishes++;
+    if (_broker_callback)
+      (*_broker_callback)(topic, (const char *) payload, length);
+    return true;
+  }
+
+  /*
+     QoS 0
+  */
+  std::vector<uint8_t> body;
+  size_t len = strlen(topic);
+
+  body.push_back(len >> 8);
+  body.push_back(len);
+  body.insert(body.end(), topic, topic + len);
+  body.insert(body.end(), payload, payload + length);
+  if (!send(MQTTPUBLISH | ((retained) ? 1 : 0), body)) {
+    if (!_client->connected())
+      _state = MQTT_CONNECTION_LOST;
+    return false;
+  }
+  _broker_publishes++;
+  return true;
+}
+
+/**/
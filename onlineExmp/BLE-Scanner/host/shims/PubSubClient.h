@@ -0,0 +1,91 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the PubSubClient library
+
+  By default no connection is opened and the broker is simulated, see
+  HostMqttSet() in host.h. After HostMqttBroker() the client speaks
+  MQTT 3.1.1 (QoS 0) through its Client to a real broker, like the
+  library does on the ESP32.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __PUBSUBCLIENT_H__
+#define __PUBSUBCLIENT_H__ 1
+
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "Client.h"
+
+#define MQTT_CONNECTION_TIMEOUT       -4
+#define MQTT_CONNECTION_LOST          -3
+#define MQTT_CONNECT_FAILED           -2
+#define MQTT_DISCONNECTED             -1
+#define MQTT_CONNECTED                0
+#define MQTT_CONNECT_BAD_PROTOCOL     1
+#define MQTT_CONNECT_BAD_CLIENT_ID    2
+#define MQTT_CONNECT_UNAVAILABLE      3
+#define MQTT_CONNECT_BAD_CREDENTIALS  4
+#define MQTT_CONNECT_UNAUTHORIZED     5
+
+#define MQTT_MAX_PACKET_SIZE          256
+#define MQTT_KEEPALIVE                15
+#define MQTT_SOCKET_TIMEOUT           15
+
+#define MQTT_CALLBACK_SIGNATURE void (*callback)(char *, uint8_t *, unsigned int)
+
+class PubSubClient {
+  public:
+    PubSubClient(Client &client) : _client(&client) {}
+
+    PubSubClient &setServer(const char *domain, uint16_t port) { _domain = domain; _port = port; return *this; }
+    PubSubClient &setServer(IPAddress ip, uint16_t port);
+    PubSubClient &setCallback(MQTT_CALLBACK_SIGNATURE) { _callback = callback; return *this; }
+    PubSubClient &setClient(Client &client) { _client = &client; return *this; }
+    PubSubClient &setKeepAlive(uint16_t keepAlive) { _keepalive = keepAlive; return *this; }
+    PubSubClient &setSocketTimeout(uint16_t timeout) { _socket_timeout = timeout; return *this; }
+    bool setBufferSize(uint16_t size) { _buffer_size = size; return true; }
+
+    bool connect(const char *id) { return connect(id, NULL, NULL); }
+    bool connect(const char *id, const char *user, const char *pass);
+    void disconnect(void);
+    bool connected(void);
+    int state(void) { return _state; }
+    bool loop(void);
+
+    bool publish(const char *topic, const char *payload, bool retained = false);
+    bool publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained = false);
+
+  private:
+    Client *_client;
+    int _state = MQTT_DISCONNECTED;
+    std::string _domain;
+    uint16_t _port = 1883;
+    void (*_callback)(char *, uint8_t *, unsigned int) = NULL;
+    uint16_t _keepalive = MQTT_KEEPALIVE;
+    uint16_t _socket_timeout = MQTT_SOCKET_TIMEOUT;
+    uint16_t _buffer_size = MQTT_MAX_PACKET_SIZE;
+
+    /*
+       the protocol
+    */
+    unsigned long _last_out = 0;
+    unsigned long _last_in = 0;
+    bool _ping_outstanding = false;
+    std::vector<uint8_t> _in;
+
+    bool send(uint8_t header, const std::vector<uint8_t> &body);
+    int receive(uint8_t *header, std::vector<uint8_t> *body, unsigned long timeout);
+};
+
+#endif
+
+/**/
@@ -0,0 +1,39 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the Time library
+
+  The system time follows the epoch time of the host clock (see host.h).
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __TIMELIB_H__
+#define __TIMELIB_H__ 1
+
+#include <time.h>
+#include "Arduino.h"
+
+#define SECS_PER_MIN    ((time_t)(60UL))
+#define SECS_PER_HOUR   ((time_t)(3600UL))
+#define SECS_PER_DAY    ((time_t)(SECS_PER_HOUR * 24UL))
+
+typedef enum { timeNotSet, timeNeedsSync, timeSet } timeStatus_t;
+
+typedef time_t (*getExternalTime)();
+
+time_t now(void);
+void setTime(time_t t);
+timeStatus_t timeStatus(void);
+void setSyncProvider(getExternalTime getTimeFunction);
+void setSyncInterval(time_t interval);
+
+#endif
+
+/**/
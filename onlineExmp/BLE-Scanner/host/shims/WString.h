@@ -0,0 +1,258 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the Arduino String class
+
+  The characters are kept like in the String of the ESP32 core: up to
+  WSTRING_SSO_SIZE - 1 in the object itself, longer ones in a buffer of
+  exactly their size from realloc() -- so the host sees the allocations
+  of a String where the ESP32 has them, and memstat.cpp counts them.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __WSTRING_H__
+#define __WSTRING_H__ 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <type_traits>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+/*
+   the characters kept in the object, with the terminating 0 -- as on the 32 bit ESP32
+*/
+#define WSTRING_SSO_SIZE    11
+
+class String {
+  public:
+    String(const char *cstr = "") { if (cstr) copy(cstr, strlen(cstr)); }
+    String(const std::string &str) { copy(str.data(), str.length()); }
+    String(const String &str) { copy(str.buffer(), str._len); }
+    String(String &&str) { move(str); }
+    explicit String(char c) { copy(&c, 1); }
+    explicit String(unsigned char value, unsigned char base = DEC) { fromUnsigned(value, base); }
+    explicit String(int value, unsigned char base = DEC) { fromSigned(value, base); }
+    explicit String(unsigned int value, unsigned char base = DEC) { fromUnsigned(value, base); }
+    explicit String(long value, unsigned char base = DEC) { fromSigned(value, base); }
+    explicit String(unsigned long value, unsigned char base = DEC) { fromUnsigned(value, base); }
+    explicit String(long long value, unsigned char base = DEC) { fromSigned(value, base); }
+    explicit String(unsigned long long value, unsigned char base = DEC) { fromUnsigned(value, base); }
+    explicit String(float value, unsigned int decimals = 2) { fromDouble(value, decimals); }
+    explicit String(double value, unsigned int decimals = 2) { fromDouble(value, decimals); }
+    ~String() { free(_heap); }
+
+    String &operator=(const String &str) { if (this != &str) copy(str.buffer(), str._len); return *this; }
+    String &operator=(String &&str) { if (this != &str) { free(_heap); _heap = NULL; move(str); } return *this; }
+    String &operator=(const char *cstr) { copy((cstr) ? cstr : "", (cstr) ? strlen(cstr) : 0); return *this; }
+
+    const char *c_str(void) const { return buffer(); }
+    unsigned int length(void) const { return _len; }
+    bool isEmpty(void) const { return !_len; }
+    bool reserve(unsigned int size) { return grow(size); }
+
+    bool concat(const String &str) { return append(str.buffer(), str._len); }
+    bool concat(const char *cstr) { return !cstr || append(cstr, strlen(cstr)); }
+    bool concat(char c) { return append(&c, 1); }
+    template<typename T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value, int>::type = 0>
+    bool concat(T value) { return concat(String(value)); }
+
+    template<typename T>
+    String &operator+=(const T &value) { concat(value); return *this; }
+
+    char charAt(unsigned int index) const { return (index < _len) ? buffer()[index] : '\0'; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char &operator[](unsigned int index) { static char dummy; return (index < _len) ? buffer()[index] : (dummy = '\0'); }
+
+    bool equals(const String &str) const { return _len == str._len && !memcmp(buffer(), str.buffer(), _len); }
+    bool equals(const char *cstr) const { return !strcmp(buffer(), (cstr) ? cstr : ""); }
+    bool operator==(const String &str) const { return equals(str); }
+    bool operator==(const char *cstr) const { return equals(cstr); }
+    bool operator!=(const String &str) const { return !equals(str); }
+    bool operator!=(const char *cstr) const { return !equals(cstr); }
+    bool operator<(const String &str) const { return strcmp(buffer(), str.buffer()) < 0; }
+
+    bool startsWith(const String &str) const { return _len >= str._len && !memcmp(buffer(), str.buffer(), str._len); }
+    bool endsWith(const String &str) const { return _len >= str._len && !memcmp(buffer() + _len - str._len, str.buffer(), str._len); }
+    int indexOf(char c, unsigned int from = 0) const
+    {
+      const char *p = (from < _len) ? (const char *) memchr(buffer() + from, c, _len - from) : NULL;
+      return (p) ? (int) (p - buffer()) : -1;
+    }
+    int indexOf(const String &str, unsigned int from = 0) const
+    {
+      const char *p = (from <= _len) ? strstr(buffer() + from, str.buffer()) : NULL;
+      return (p) ? (int) (p - buffer()) : -1;
+    }
+    String substring(unsigned int from) const { return substring(from, _len); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+      String str;
+
+      if (to > _len)
+        to = _len;
+      if (from < to)
+        str.copy(buffer() + from, to - from);
+      return str;
+    }
+
+    void replace(const String &find, const String &replace)
+    {
+      if (!find._len || indexOf(find) < 0)
+        return;
+
+      String str;
+
+      for (unsigned int pos = 0; pos < _len; ) {
+        int next = indexOf(find, pos);
+
+        if (next < 0)
+          next = _len;
+        str.append(buffer() + pos, next - pos);
+        if ((unsigned int) next < _len)
+          str.append(replace.buffer(), replace._len);
+        pos = next + find._len;
+      }
+      *this = static_cast<String &&>(str);
+    }
+    void trim(void)
+    {
+      unsigned int begin = 0, end = _len;
+
+      while (begin < end && strchr(" \t\r\n", buffer()[begin]))
+        begin++;
+      while (end > begin && strchr(" \t\r\n", buffer()[end - 1]))
+        end--;
+      memmove(buffer(), buffer() + begin, end - begin);
+      _len = end - begin;
+      buffer()[_len] = '\0';
+    }
+    void toLowerCase(void) { for (unsigned int n = 0; n < _len; n++) buffer()[n] = tolower(buffer()[n]); }
+    void toUpperCase(void) { for (unsigned int n = 0; n < _len; n++) buffer()[n] = toupper(buffer()[n]); }
+    long toInt(void) const { return strtol(buffer(), NULL, 10); }
+    float toFloat(void) const { return strtof(buffer(), NULL); }
+    double toDouble(void) const { return strtod(buffer(), NULL); }
+
+  private:
+    char *_heap = NULL;
+    unsigned int _len = 0;
+    unsigned int _capacity = WSTRING_SSO_SIZE - 1;
+    char _sso[WSTRING_SSO_SIZE] = { 0 };
+
+    char *buffer(void) { return (_heap) ? _heap : _sso; }
+    const char *buffer(void) const { return (_heap) ? _heap : _sso; }
+
+    /*
+       make room for size characters -- a buffer of exactly this size, as the ESP32 core does
+    */
+    bool grow(unsigned int size)
+    {
+      if (size <= _capacity)
+        return true;
+
+      char *heap = (char *) realloc(_heap, size + 1);
+
+      if (!heap)
+        return false;
+      if (!_heap)
+        memcpy(heap, _sso, _len + 1);
+      _heap = heap;
+      _capacity = size;
+      return true;
+    }
+    void copy(const char *str, unsigned int length)
+    {
+      if (!grow(length))
+        return;
+      memmove(buffer(), str, length);
+      _len = length;
+      buffer()[_len] = '\0';
+    }
+    bool append(const char *str, unsigned int length)
+    {
+      /*
+         the characters may be our own, which move with the buffer
+      */
+      size_t own = (str >= buffer() && str < buffer() + _len + 1) ? str - buffer() : (size_t) -1;
+
+      if (!grow(_len + length))
+        return false;
+      memmove(buffer() + _len, (own != (size_t) -1) ? buffer() + own : str, length);
+      _len += length;
+      buffer()[_len] = '\0';
+      return true;
+    }
+    void move(String &str)
+    {
+      _heap = str._heap;
+      _len = str._len;
+      _capacity = str._capacity;
+      memcpy(_sso, str._sso, sizeof(_sso));
+      str._heap = NULL;
+      str._len = 0;
+      str._capacity = WSTRING_SSO_SIZE - 1;
+      str._sso[0] = '\0';
+    }
+
+    void fromUnsigned(unsigned long long value, unsigned char base, bool negative = false)
+    {
+      char buffer[8 * sizeof(value) + 2];
+      char *p = &buffer[sizeof(buffer) - 1];
+
+      *p = '\0';
+      if (base < 2)
+        base = 10;
+      do {
+        int digit = value % base;
+        *--p = (digit < 10) ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+      } while (value);
+      if (negative)
+        *--p = '-';
+      copy(p, &buffer[sizeof(buffer) - 1] - p);
+    }
+    template<typename T>
+    void fromSigned(T value, unsigned char base)
+    {
+      typedef typename std::make_unsigned<T>::type U;
+
+      if (base == DEC && value < 0)
+        fromUnsigned(-(unsigned long long) value, base, true);
+      else
+        fromUnsigned((U) value, base);
+    }
+    void fromDouble(double value, unsigned int decimals)
+    {
+      char buffer[64];
+
+      snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+      copy(buffer, strlen(buffer));
+    }
+};
+
+/*
+   concatenation
+*/
+inline String operator+(const String &lhs, const String &rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const String &lhs, const char *rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const char *lhs, const String &rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const String &lhs, char rhs) { String s(lhs); s.concat(rhs); return s; }
+template<typename T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value, int>::type = 0>
+inline String operator+(const String &lhs, T rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+
+#endif
+
+/**/
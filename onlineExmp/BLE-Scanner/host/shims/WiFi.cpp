@@ -0,0 +1,38 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the WiFi library
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "WiFi.h"
+
+WiFiClass WiFi;
+
+/*
+   look up the IPv4 address of a host -- returns 1 on success
+*/
+int WiFiClass::hostByName(const char *name, IPAddress &ip)
+{
+  struct addrinfo hints = {}, *ai;
+
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  if (getaddrinfo(name, NULL, &hints, &ai) != 0)
+    return 0;
+  ip = IPAddress((uint32_t) ((struct sockaddr_in *) ai->ai_addr)->sin_addr.s_addr);
+  freeaddrinfo(ai);
+  return 1;
+}
+
+/**/
@@ -0,0 +1,36 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the WiFi library
+
+  The WiFi module itself is replaced by host/hostWifi.cpp, so only the
+  types are needed here -- and the lookup of a host name, by the
+  resolver of the host.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __WIFI_H__
+#define __WIFI_H__ 1
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFiClient.h"
+#include "WiFiUdp.h"
+
+class WiFiClass {
+  public:
+    int hostByName(const char *name, IPAddress &ip);
+};
+
+extern WiFiClass WiFi;
+
+#endif
+
+/**/
@@ -0,0 +1,162 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the WiFi client
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include "WiFiClient.h"
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+  char host[16];
+
+  snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  return connect(host, port);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+  struct addrinfo hints = {}, *ai;
+  char service[8];
+
+  stop();
+
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  snprintf(service, sizeof(service), "%u", port);
+  if (getaddrinfo(host, service, &hints, &ai) != 0)
+    return 0;
+
+  if ((_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0) {
+    freeaddrinfo(ai);
+    return 0;
+  }
+
+  int sndbuf = WIFI_CLIENT_SND_BUF;
+  setsockopt(_fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+  /*
+     wait for the connection
+  */
+  int rc = ::connect(_fd, ai->ai_addr, ai->ai_addrlen);
+  freeaddrinfo(ai);
+  if (rc < 0 && errno == EINPROGRESS) {
+    struct pollfd pfd = { _fd, POLLOUT, 0 };
+    int err = 0;
+    socklen_t len = sizeof(err);
+
+    if (poll(&pfd, 1, WIFI_CLIENT_CONNECT_TIMEOUT) == 1 &&
+        getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0)
+      rc = 0;
+  }
+  if (rc < 0) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+  size_t written = 0;
+
+  while (_fd >= 0 && written < size) {
+    ssize_t n = send(_fd, buffer + written, size - written, MSG_NOSIGNAL);
+
+    if (n > 0) {
+      written += n;
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      /*
+         the send buffer is full
+      */
+      struct pollfd pfd = { _fd, POLLOUT, 0 };
+
+      if (poll(&pfd, 1, WIFI_CLIENT_WRITE_TIMEOUT) == 1 && !(pfd.revents & (POLLERR | POLLHUP)))
+        continue;
+    }
+    stop();
+  }
+  return written;
+}
+
+int WiFiClient::available(void)
+{
+  int n = 0;
+
+  if (_fd < 0 || ioctl(_fd, FIONREAD, &n) < 0)
+    return 0;
+  return n;
+}
+
+int WiFiClient::read(void)
+{
+  uint8_t c;
+
+  return (read(&c, 1) == 1) ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+  if (_fd < 0)
+    return -1;
+
+  ssize_t n = recv(_fd, buffer, size, 0);
+
+  if (n == 0)
+    stop();
+  return (n > 0) ? n : -1;
+}
+
+void WiFiClient::stop(void)
+{
+  if (_fd >= 0)
+    close(_fd);
+  _fd = -1;
+}
+
+uint8_t WiFiClient::connected(void)
+{
+  uint8_t c;
+
+  if (_fd < 0)
+    return 0;
+
+  /*
+     the peer closed the connection, if it is readable without data
+  */
+  ssize_t n = recv(_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+int WiFiClient::setNoDelay(bool nodelay)
+{
+  int flag = nodelay;
+
+  return (_fd >= 0) ? setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) : -1;
+}
+
+/**/
@@ -0,0 +1,54 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the WiFi client
+
+  A plain TCP socket. Like on the ESP32, the send buffer is small (the
+  default of lwIP), connect() waits up to 3 s and write() gives up after
+  10 s without progress and closes the connection.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __WIFICLIENT_H__
+#define __WIFICLIENT_H__ 1
+
+#include "Client.h"
+
+#define WIFI_CLIENT_CONNECT_TIMEOUT   3000      // ms
+#define WIFI_CLIENT_WRITE_TIMEOUT     10000     // ms
+#define WIFI_CLIENT_SND_BUF           5744      // CONFIG_LWIP_TCP_SND_BUF_DEFAULT
+
+class WiFiClient : public Client {
+  public:
+    WiFiClient() {}
+    WiFiClient(const WiFiClient &) = delete;
+    WiFiClient &operator=(const WiFiClient &) = delete;
+    ~WiFiClient() { stop(); }
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available(void) override;
+    int read(void) override;
+    int read(uint8_t *buffer, size_t size) override;
+    void flush(void) override {}
+    void stop(void) override;
+    uint8_t connected(void) override;
+    operator bool() override { return connected(); }
+    int setNoDelay(bool nodelay);
+
+  private:
+    int _fd = -1;
+};
+
+#endif
+
+/**/
@@ -0,0 +1,116 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the WiFi UDP class
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "WiFiUdp.h"
+
+/*
+   open a non-blocking socket on the port -- as on the ESP32 an open one is closed before
+*/
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+  struct sockaddr_in addr = {};
+  int on = 1;
+
+  stop();
+
+  if ((_fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+    return 0;
+  setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_NONBLOCK);
+
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+void WiFiUDP::stop(void)
+{
+  if (_fd >= 0)
+    close(_fd);
+  _fd = -1;
+  _receive_length = _receive_offset = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+  _send_ip = ip;
+  _send_port = port;
+  _send_length = 0;
+  return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size)
+{
+  size = std::min(size, sizeof(_send) - _send_length);
+  memcpy(_send + _send_length, buffer, size);
+  _send_length += size;
+  return size;
+}
+
+int WiFiUDP::endPacket(void)
+{
+  struct sockaddr_in addr = {};
+
+  if (_fd < 0)
+    return 0;
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = (uint32_t) _send_ip;
+  addr.sin_port = htons(_send_port);
+  return sendto(_fd, _send, _send_length, 0, (struct sockaddr *) &addr, sizeof(addr)) == (ssize_t) _send_length;
+}
+
+/*
+   get the next packet, the rest of the one before is dropped -- returns its size, 0 if there is none
+*/
+int WiFiUDP::parsePacket(void)
+{
+  struct sockaddr_in addr = {};
+  socklen_t addrlen = sizeof(addr);
+  ssize_t length;
+
+  _receive_length = _receive_offset = 0;
+  if (_fd < 0)
+    return 0;
+  while ((length = recvfrom(_fd, _receive, sizeof(_receive), 0, (struct sockaddr *) &addr, &addrlen)) < 0 && errno == EINTR)
+    ;
+  if (length <= 0)
+    return 0;
+  _remote_ip = IPAddress((uint32_t) addr.sin_addr.s_addr);
+  _remote_port = ntohs(addr.sin_port);
+  _receive_length = length;
+  return length;
+}
+
+int WiFiUDP::read(uint8_t *buffer, size_t len)
+{
+  if (_receive_offset >= _receive_length)
+    return -1;
+  len = std::min(len, _receive_length - _receive_offset);
+  memcpy(buffer, _receive + _receive_offset, len);
+  _receive_offset += len;
+  return len;
+}
+
+/**/
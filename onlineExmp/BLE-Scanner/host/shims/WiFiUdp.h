@@ -0,0 +1,59 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  host shim of the WiFi UDP class
+
+  The packets are sent and received through a UDP socket of the host,
+  bound to all its addresses -- the NTP check talks to stand-in servers
+  on the loopback interface. parsePacket() doesn't block.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __WIFIUDP_H__
+#define __WIFIUDP_H__ 1
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+#define WIFIUDP_PACKET_MAX  1472
+
+class WiFiUDP {
+  public:
+    WiFiUDP() {}
+    ~WiFiUDP() { stop(); }
+
+    uint8_t begin(uint16_t port);
+    void stop(void);
+    int beginPacket(IPAddress ip, uint16_t port);
+    int endPacket(void);
+    size_t write(const uint8_t *buffer, size_t size);
+    int parsePacket(void);
+    int read(uint8_t *buffer, size_t len);
+    IPAddress remoteIP(void) { return _remote_ip; }
+    uint16_t remotePort(void) { return _remote_port; }
+
+  private:
+    int _fd = -1;
+
+    IPAddress _send_ip;
+    uint16_t _send_port = 0;
+    uint8_t _send[WIFIUDP_PACKET_MAX];
+    size_t _send_length = 0;
+
+    IPAddress _remote_ip;
+    uint16_t _remote_port = 0;
+    uint8_t _receive[WIFIUDP_PACKET_MAX];
+    size_t _receive_length = 0;
+    size_t _receive_offset = 0;
+};
+
+#endif
+
+/**/
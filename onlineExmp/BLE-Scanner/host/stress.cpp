@@ -0,0 +1,588 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  dorm-scale load generator and stress harness for the gateway
+
+  simulates on the virtual clock
+    - N laundry nodes following machineESP.ino: the status flips between
+      idle/empty, running and stopped/full, the advertisement is sent every
+      20..40 ms, but its data is only updated every 10 s while running and
+      every 30 s while idle -- the name is in the scan response
+    - M background devices (phones, earbuds) with rotating random addresses
+
+  and drives them through the gateway: NimBLE scan (mock) -> onResult()
+  -> ScanDevAddMachine() -> ScanDevUpdate() -> MQTT publish, with the
+  scan/pause cycle of the sketch.
+
+  reported
+    - transitions of the nodes which were published, dropped (superseded
+      before being published), late or not published at all
+    - depth of the publish queue and of the scan results
+    - CPU time per advertisement and per loop
+    - latency percentiles: status change -> publish and
+      first reception (observedUs) -> publish (publishedUs)
+
+  usage: scanner-stress-<machines> [options], see Usage()
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#include <chrono>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+#include "config.h"
+#include "scandev.h"
+#include "capture.h"
+#include "mqtt.h"
+#include "util.h"
+#include "host.h"
+
+/*
+   start of the virtual clock: Nov 14 2023
+*/
+#define STRESS_EPOCH_US         1700000000000000ULL
+
+/*
+   the loop of the sketch runs every ...
+*/
+#define STRESS_LOOP_US          (10 * 1000)
+
+/*
+   the queue depths are sampled every ...
+*/
+#define STRESS_SAMPLE_US        (1000 * 1000)
+
+/*
+   timing of the laundry nodes (see machineESP.ino)
+*/
+#define NODE_ADV_MIN_US         (20 * 1000)       // advertising interval 0x20..0x40
+#define NODE_ADV_MAX_US         (40 * 1000)
+#define NODE_ADV_DELAY_US       (10 * 1000)       // random delay added by the controller
+#define NODE_UPDATE_RUNNING_US  (10 * 1000000ULL) // advertisement data update while running
+#define NODE_UPDATE_IDLE_US     (30 * 1000000ULL) // ... while idle
+
+/*
+   timing of the background devices
+*/
+#define BG_ADV_MIN_US           (100 * 1000)
+#define BG_ADV_MAX_US           (1000 * 1000)
+#define BG_ROTATE_US            (15 * 60 * 1000000ULL)
+
+/*
+   the status byte of the nodes
+*/
+#define STATUS_RUNNING          0x01
+#define STATUS_EMPTY            0x02
+
+/*
+   the options
+*/
+static int _nodes = 50;
+static int _background = 200;
+static unsigned long _duration = 60 * 60;
+static unsigned long _phase = 15 * 60;
+static double _loss = 0;
+static unsigned long _late = 60;
+static long _activescan = -1;
+static unsigned long _seed = 1;
+static const char *_capture = NULL;
+
+static std::mt19937_64 _rng;
+
+/*
+   the events on the virtual clock
+*/
+enum EVENT {
+  EVENT_NODE_ADV,
+  EVENT_NODE_PHASE,
+  EVENT_BG_ADV,
+  EVENT_BG_ROTATE,
+};
+
+typedef struct _event {
+  uint64_t time;
+  int type;
+  int index;
+  bool operator<(const struct _event &e) const { return time > e.time; }
+} EVENT_T;
+
+static std::priority_queue<EVENT_T> _events;
+
+/*
+   a laundry node
+*/
+typedef struct _transition {
+  uint64_t time;          // when the status changed on the node
+  uint8_t status;
+} TRANSITION_T;
+
+typedef struct _node {
+  char machineId[MACHINE_ID_MAX_LEN + 1];
+  uint8_t addr[6];
+  int rssi;
+  uint8_t status;                   // the status of the node
+  uint8_t adv_status;               // the status in the advertisement
+  uint64_t adv_update;              // time of the last update of the advertisement
+  std::vector<TRANSITION_T> transitions;
+  int matched;                      // last transition matched by a publish
+} NODE_T;
+
+static std::vector<NODE_T> _node;
+static std::unordered_map<std::string, int> _node_by_id;
+
+/*
+   a background device
+*/
+typedef struct _background {
+  uint8_t addr[6];
+  int rssi;
+  uint64_t interval;
+  uint8_t payload[31];
+  size_t length;
+} BACKGROUND_T;
+
+static std::vector<BACKGROUND_T> _bg;
+
+/*
+   the results
+*/
+static std::vector<double> _latency_transition;
+static std::vector<double> _latency_gateway;
+static unsigned long _published = 0;
+static unsigned long _redundant = 0;
+static unsigned long _dropped = 0;
+static unsigned long _late_count = 0;
+static unsigned long _unknown = 0;
+
+static unsigned long _adverts_node = 0;
+static unsigned long _adverts_bg = 0;
+static unsigned long _reported_node = 0;
+static unsigned long _reported_bg = 0;
+static double _cpu_node = 0;
+static double _cpu_bg = 0;
+static double _cpu_loop = 0;
+static unsigned long _loops = 0;
+
+static int _pending_max = 0;
+static double _pending_sum = 0;
+static unsigned long _samples = 0;
+
+/*
+   helpers
+*/
+static double StressTime(void)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t StressRandom(uint64_t min, uint64_t max)
+{
+  return std::uniform_int_distribution<uint64_t>(min, max)(_rng);
+}
+
+static bool StressLost(void)
+{
+  return _loss > 0 && std::uniform_real_distribution<double>(0, 100)(_rng) < _loss;
+}
+
+static void StressSchedule(uint64_t time, int type, int index)
+{
+  _events.push({ time, type, index });
+}
+
+static void StressRandomAddr(uint8_t addr[6])
+{
+  for (int n = 0; n < 6; n++)
+    addr[n] = StressRandom(0, 255);
+  addr[5] |= 0xc0;    // static random address
+}
+
+/*
+   the node changes its status: idle/empty -> running -> stopped/full -> idle/empty
+*/
+static void NodePhase(int n, uint64_t now)
+{
+  NODE_T *node = &_node[n];
+
+  if (node->status & STATUS_RUNNING)
+    node->status = 0;
+  else if (node->status & STATUS_EMPTY)
+    node->status = STATUS_RUNNING;
+  else
+    node->status = STATUS_EMPTY;
+
+  node->transitions.push_back({ now, node->status });
+  StressSchedule(now + StressRandom(_phase * 500000ULL, _phase * 1500000ULL), EVENT_NODE_PHASE, n);
+}
+
+/*
+   the node sends its advertisement
+*/
+static void NodeAdvertise(int n, uint64_t now)
+{
+  NODE_T *node = &_node[n];
+
+  /*
+     the advertisement data is only updated periodically
+  */
+  uint64_t update = (node->status & STATUS_RUNNING) ? NODE_UPDATE_RUNNING_US : NODE_UPDATE_IDLE_US;
+  if (now - node->adv_update >= update) {
+    node->adv_status = node->status;
+    node->adv_update = now;
+  }
+
+  if (!StressLost()) {
+    uint8_t payload[31];
+    size_t length = 0;
+
+    payload[length++] = 2;
+    payload[length++] = 0x01;     // flags
+    payload[length++] = 0x06;
+    payload[length++] = 2 + MACHINE_ID_MAX_LEN + 1 + 1;
+    payload[length++] = 0xff;     // manufacturer data
+    payload[length++] = TARGET_MANUFACTURER_ID & 0xff;
+    payload[length++] = TARGET_MANUFACTURER_ID >> 8;
+    memset(&payload[length], 0, MACHINE_ID_MAX_LEN);
+    memcpy(&payload[length], node->machineId, strlen(node->machineId));
+    length += MACHINE_ID_MAX_LEN;
+    payload[length++] = node->adv_status;
+
+    static const uint8_t scan_rsp[] = { 1 + sizeof(TARGET_DEVICE_NAME) - 1, 0x09,
+                                        'L', 'a', 'u', 'n', 'd', 'r', 'y', 'M', 'a', 'c', 'h', 'i', 'n', 'e' };
+    HOST_BLE_STATS_T before, after;
+
+    HostBleStats(&before);
+    double t = StressTime();
+    HostBleAdvertise(node->addr, BLE_ADDR_PUBLIC, node->rssi, payload, length, scan_rsp, sizeof(scan_rsp));
+    _cpu_node += StressTime() - t;
+    HostBleStats(&after);
+    _adverts_node++;
+    _reported_node += after.reported - before.reported;
+  }
+
+  StressSchedule(now + StressRandom(NODE_ADV_MIN_US, NODE_ADV_MAX_US) + StressRandom(0, NODE_ADV_DELAY_US), EVENT_NODE_ADV, n);
+}
+
+/*
+   a background device gets a new address and payload
+*/
+static void BackgroundRotate(int n, uint64_t now)
+{
+  BACKGROUND_T *bg = &_bg[n];
+  size_t length = 0;
+
+  StressRandomAddr(bg->addr);
+  bg->payload[length++] = 2;
+  bg->payload[length++] = 0x01;
+  bg->payload[length++] = 0x1a;
+  if (n % 4 == 0) {
+    /*
+       earbuds announce a name
+    */
+    const char *name = "Buds Pro";
+    bg->payload[length++] = 1 + strlen(name);
+    bg->payload[length++] = 0x09;
+    memcpy(&bg->payload[length], name, strlen(name));
+    length += strlen(name);
+  }
+  else {
+    /*
+       phones send apple/google manufacturer data
+    */
+    bg->payload[length++] = 1 + 2 + 11;
+    bg->payload[length++] = 0xff;
+    bg->payload[length++] = 0x4c;
+    bg->payload[length++] = 0x00;
+    for (int i = 0; i < 11; i++)
+      bg->payload[length++] = StressRandom(0, 255);
+  }
+  bg->length = length;
+
+  StressSchedule(now + StressRandom(BG_ROTATE_US / 2, BG_ROTATE_US * 3 / 2), EVENT_BG_ROTATE, n);
+}
+
+/*
+   a background device sends its advertisement
+*/
+static void BackgroundAdvertise(int n, uint64_t now)
+{
+  BACKGROUND_T *bg = &_bg[n];
+
+  if (!StressLost()) {
+    HOST_BLE_STATS_T before, after;
+
+    HostBleStats(&before);
+    double t = StressTime();
+    HostBleAdvertise(bg->addr, BLE_ADDR_RANDOM, bg->rssi, bg->payload, bg->length);
+    _cpu_bg += StressTime() - t;
+    HostBleStats(&after);
+    _adverts_bg++;
+    _reported_bg += after.reported - before.reported;
+  }
+
+  StressSchedule(now + bg->interval + StressRandom(0, NODE_ADV_DELAY_US), EVENT_BG_ADV, n);
+}
+
+/*
+   the gateway published a status -- match it with the transitions of the node
+*/
+static void StressPublished(const char *topic, const char *payload, unsigned int length)
+{
+  char machineId[MACHINE_ID_MAX_LEN + 1];
+
+  if (sscanf(topic, MQTT_TOPIC_PREFIX "%16[^/]", machineId) != 1 || !_node_by_id.count(machineId)) {
+    _unknown++;
+    return;
+  }
+
+  NODE_T *node = &_node[_node_by_id[machineId]];
+  uint8_t status = (strstr(payload, "\"running\":true") ? STATUS_RUNNING : 0) |
+                   (strstr(payload, "\"empty\":true") ? STATUS_EMPTY : 0);
+  uint64_t now = HostEpochUs();
+  const char *s;
+
+  _published++;
+  if ((s = strstr(payload, "\"observedUs\":"))) {
+    uint64_t observed = strtoull(s + 13, NULL, 10);
+    if (observed)
+      _latency_gateway.push_back((now - observed) / 1e6);
+  }
+
+  /*
+     the latest transition to this status, which is not yet matched
+  */
+  int k;
+  for (k = node->transitions.size() - 1; k > node->matched; k--)
+    if (node->transitions[k].status == status && node->transitions[k].time <= now)
+      break;
+  if (k <= node->matched) {
+    _redundant++;
+    return;
+  }
+
+  /*
+     transitions in between were never published, the first one is the initial status
+  */
+  _dropped += k - node->matched - 1;
+  if (k > 0) {
+    double latency = (now - node->transitions[k].time) / 1e6;
+
+    _latency_transition.push_back(latency);
+    if (latency > _late)
+      _late_count++;
+  }
+  node->matched = k;
+}
+
+/*
+   setup the nodes and the background devices
+*/
+static void StressSetup(void)
+{
+  uint64_t now = HostEpochUs();
+
+  _node.resize(_nodes);
+  for (int n = 0; n < _nodes; n++) {
+    NODE_T *node = &_node[n];
+
+    snprintf(node->machineId, sizeof(node->machineId), "d%d-m%d", n / 40 + 1, n % 40 + 1);
+    _node_by_id[node->machineId] = n;
+    StressRandomAddr(node->addr);
+    node->rssi = -50 - (int) StressRandom(0, 45);
+    node->status = (StressRandom(0, 1)) ? STATUS_EMPTY : STATUS_RUNNING;
+    node->adv_status = node->status;
+    node->adv_update = now;
+    node->transitions.push_back({ now, node->status });
+    node->matched = -1;
+
+    StressSchedule(now + StressRandom(0, NODE_ADV_MAX_US), EVENT_NODE_ADV, n);
+    StressSchedule(now + StressRandom(0, _phase * 1000000ULL), EVENT_NODE_PHASE, n);
+  }
+
+  _bg.resize(_background);
+  for (int n = 0; n < _background; n++) {
+    BACKGROUND_T *bg = &_bg[n];
+
+    bg->rssi = -40 - (int) StressRandom(0, 55);
+    bg->interval = StressRandom(BG_ADV_MIN_US, BG_ADV_MAX_US);
+    BackgroundRotate(n, now - StressRandom(0, BG_ROTATE_US));
+    StressSchedule(now + StressRandom(0, bg->interval), EVENT_BG_ADV, n);
+  }
+}
+
+/*
+   print a latency distribution
+*/
+static void StressPercentiles(const char *name, std::vector<double> &v)
+{
+  if (v.empty()) {
+    printf("%-34s no samples\n", name);
+    return;
+  }
+  std::sort(v.begin(), v.end());
+  auto p = [&](double q) { return v[std::min(v.size() - 1, (size_t) (q * v.size()))]; };
+  printf("%-34s p50 %8.3f s  p90 %8.3f s  p99 %8.3f s  max %8.3f s  (%zu samples)\n",
+         name, p(0.50), p(0.90), p(0.99), v.back(), v.size());
+}
+
+static void Usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [options]\n"
+          "  -n <nodes>        laundry nodes (%d)\n"
+          "  -m <devices>      background devices (%d)\n"
+          "  -d <seconds>      simulated duration (%lu)\n"
+          "  -p <seconds>      mean duration of a machine phase (%lu)\n"
+          "  -l <percent>      loss of advertisements (%.0f)\n"
+          "  -L <seconds>      a published transition is late after (%lu)\n"
+          "  -a <seconds>      override the active scan timeout of the config\n"
+          "  -s <seed>         seed of the random generator (%lu)\n"
+          "  -w <dir>          capture the advertisements to <dir>" CAPTURE_FILE " for scanner-replay\n",
+          name, _nodes, _background, _duration, _phase, _loss, _late, _seed);
+}
+
+int main(int argc, char *argv[])
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:m:d:p:l:L:a:s:w:")) != -1) {
+    switch (opt) {
+      case 'n': _nodes = atoi(optarg); break;
+      case 'm': _background = atoi(optarg); break;
+      case 'd': _duration = strtoul(optarg, NULL, 10); break;
+      case 'p': _phase = MAX(1UL, strtoul(optarg, NULL, 10)); break;
+      case 'l': _loss = atof(optarg); break;
+      case 'L': _late = strtoul(optarg, NULL, 10); break;
+      case 'a': _activescan = atol(optarg); break;
+      case 's': _seed = strtoul(optarg, NULL, 10); break;
+      case 'w': _capture = optarg; break;
+      default:
+        Usage(argv[0]);
+        return 1;
+    }
+  }
+
+  _rng.seed(_seed);
+  HostSerialMute(true);
+  HostClockVirtual(STRESS_EPOCH_US);
+  HostWifiSet(true);
+  HostNtpSet(true);
+  HostMqttSet(true, StressPublished);
+
+  HostSketchSetup();
+  if (_activescan >= 0)
+    _config.bluetooth.activescan_timeout = _activescan;
+  if (_capture) {
+    HostFsSetRoot(_capture);
+    if (!CaptureStart(CAPTURE_FLASH)) {
+      fprintf(stderr, "%s: couldn't create the capture\n", _capture);
+      return 1;
+    }
+  }
+  StressSetup();
+
+  /*
+     run the simulation
+  */
+  uint64_t start = HostEpochUs();
+  uint64_t end = start + _duration * 1000000ULL;
+  uint64_t next_loop = start;
+  uint64_t next_sample = start;
+  double wall = StressTime();
+
+  while (next_loop < end) {
+    /*
+       the radio until the next loop
+    */
+    while (!_events.empty() && _events.top().time < next_loop) {
+      EVENT_T e = _events.top();
+
+      _events.pop();
+      HostClockAdvance(e.time - HostEpochUs());
+      switch (e.type) {
+        case EVENT_NODE_ADV: NodeAdvertise(e.index, e.time); break;
+        case EVENT_NODE_PHASE: NodePhase(e.index, e.time); break;
+        case EVENT_BG_ADV: BackgroundAdvertise(e.index, e.time); break;
+        case EVENT_BG_ROTATE: BackgroundRotate(e.index, e.time); break;
+      }
+    }
+
+    /*
+       the loop of the sketch
+    */
+    HostClockAdvance(next_loop - HostEpochUs());
+    double t = StressTime();
+    HostSketchLoop();
+    _cpu_loop += StressTime() - t;
+    _loops++;
+
+    if (next_loop >= next_sample) {
+      int pending = ScanDevGetPendingCount();
+
+      _pending_max = MAX(_pending_max, pending);
+      _pending_sum += pending;
+      _samples++;
+      next_sample += STRESS_SAMPLE_US;
+    }
+    next_loop += STRESS_LOOP_US;
+  }
+  wall = StressTime() - wall;
+
+  unsigned long captured, capture_dropped, capture_bytes;
+  CaptureUpdate();
+  CaptureStats(&captured, &capture_dropped, &capture_bytes);
+  CaptureStop();
+
+  /*
+     transitions which are not published at the end
+  */
+  unsigned long transitions = 0;
+  unsigned long unpublished = 0;
+  unsigned long in_flight = 0;
+
+  for (auto &node : _node) {
+    transitions += node.transitions.size() - 1;
+    for (size_t k = node.matched + 1; k < node.transitions.size(); k++) {
+      if (k == 0)
+        continue;
+      if (node.transitions[k].time + _late * 1000000ULL < end)
+        unpublished++;
+      else
+        in_flight++;
+    }
+  }
+
+  HOST_BLE_STATS_T ble;
+  HostBleStats(&ble);
+
+  printf("STRESS: %d nodes, %d background devices, %lu s simulated in %.1f s, table size %d, seed %lu\n",
+         _nodes, _background, _duration, wall, SCANDEV_MAX_MACHINES, _seed);
+  printf("RADIO: %lu adverts (%lu nodes, %lu background), %lu while not scanning, %lu duplicates filtered, %lu reported\n",
+         ble.received, _adverts_node, _adverts_bg, ble.missed, ble.filtered, ble.reported);
+  printf("CPU: %.0f ns/advert node (%.0f ns/reported), %.0f ns/advert background (%.0f ns/reported), %.2f us/loop\n",
+         _cpu_node * 1e9 / MAX(1UL, _adverts_node), _cpu_node * 1e9 / MAX(1UL, _reported_node),
+         _cpu_bg * 1e9 / MAX(1UL, _adverts_bg), _cpu_bg * 1e9 / MAX(1UL, _reported_bg),
+         _cpu_loop * 1e6 / MAX(1UL, _loops));
+  printf("QUEUE: pending publishes max %d mean %.2f, scan results max %lu, machines tracked %d\n",
+         _pending_max, _pending_sum / MAX(1UL, _samples), ble.results_max, ScanDevGetCount());
+  printf("TRANSITIONS: %lu total, %lu published, %lu dropped, %lu late (> %lu s), %lu never published, %lu in flight\n",
+         transitions, (unsigned long) _latency_transition.size(), _dropped, _late_count, _late, unpublished, in_flight);
+  printf("PUBLISHES: %lu total, %lu redundant, %lu unknown\n", _published, _redundant, _unknown);
+  if (_capture)
+    printf("CAPTURE: %s" CAPTURE_FILE ", %lu records, %lu dropped, %lu bytes\n", _capture, captured, capture_dropped, capture_bytes);
+  StressPercentiles("LATENCY status change -> publish:", _latency_transition);
+  StressPercentiles("LATENCY observed -> publish:", _latency_gateway);
+
+  return 0;
+}
+
+/**/
@@ -23,16 +23,25 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_HTTP
+
 #include <WebServer.h>
-#include <Update.h>
+#include <uri/UriBraces.h>
+#include <LittleFS.h>
 #include "config.h"
 #include "http.h"
 #include "wifiHandler.h"
 #include "ntp.h"
 #include "bluetooth.h"
+#include "capture.h"
 #include "watchdog.h"
 #include "scandev.h"
 #include "mqtt.h"
+#include "memstat.h"
+#include "json.h"
+#include "webAssets.h"
+#include "ota.h"
+#include "history.h"
 
 /*
    the web server object
@@ -40,271 +49,568 @@
 static WebServer _WebServer(80);
 
 /*
-   this is a callback helper to push data to the web client in chunks
+   the copy of the config for the task of the server
 */
-static void HttpSendHelper(const String& content)
-{
-  _WebServer.sendContent(content);
-}
+static CONFIG_T _http_config;
 
 /*
   time of the last HTTP request
 */
 static unsigned long _last_http_request = 0;
 
+/*
+   part of the ETags, so a version of the machine table isn't valid after a restart
+*/
+static uint32_t _http_boot_id = 0;
+
+/*
+   pass the chunks of the JSON writer to the web client
+*/
+static void HttpSendJSON(const char *data, size_t length)
+{
+  _WebServer.sendContent(data, length);
+}
+
+/*
+   the clients of the event stream -- the WiFiClient is a copy of the one of
+   the web server, which keeps the socket open after the request was handled
+*/
+typedef struct _http_sse_client {
+  WiFiClient client;
+  bool in_use;
+  uint32_t version;             // last version sent to the client
+  unsigned long last_write;
+} HTTP_SSE_CLIENT_T;
+
+static HTTP_SSE_CLIENT_T _http_sse_clients[HTTP_SSE_CLIENTS_MAX];
+static HTTP_SSE_CLIENT_T *_http_sse_current = NULL;
+static bool _http_sse_failed = false;
+
+/*
+   write to the current client of the event stream
+*/
+static void HttpSseWrite(const char *data, size_t length)
+{
+  if (!_http_sse_failed && _http_sse_current->client.write((const uint8_t *) data, length) != length)
+    _http_sse_failed = true;
+}
+
+/*
+   send the machines changed since the version of the client -- only the last event of a batch
+   carries the ID, so a client which lost the connection within a batch gets all of it again
+*/
+static void HttpSseSend(HTTP_SSE_CLIENT_T *sse, uint32_t version)
+{
+  SCANDEV_MACHINE_T machine, next;
+  bool more;
+  int index = 0;
+  char line[40];
+
+  _http_sse_current = sse;
+  _http_sse_failed = false;
+
+  more = ScanDevGetChanged(sse->version, &index, &next);
+  while (more && !_http_sse_failed) {
+    JSON_WRITER_T json;
+
+    machine = next;
+    more = ScanDevGetChanged(sse->version, &index, &next);
+    HttpSseWrite("event: machine\ndata: ", 21);
+    JsonBegin(&json, HttpSseWrite);
+    ScanDevDeltaJSON(&json, &machine);
+    JsonEnd(&json);
+    if (more)
+      HttpSseWrite("\n\n", 2);
+    else
+      HttpSseWrite(line, snprintf(line, sizeof(line), "\nid: %08lx-%lu\n\n", (unsigned long) _http_boot_id, (unsigned long) version));
+  }
+  if (!_http_sse_failed) {
+    sse->version = version;
+    sse->last_write = millis();
+  }
+}
+
+/*
+   get the version from an event ID (or the since argument) -- 0 for the ID of a previous boot
+*/
+static uint32_t HttpSseCursor(const String &id)
+{
+  unsigned long boot, version;
+
+  if (sscanf(id.c_str(), "%lx-%lu", &boot, &version) == 2)
+    return (boot == _http_boot_id) ? version : 0;
+  return strtoul(id.c_str(), NULL, 10);
+}
+
+/*
+   a client subscribes to the event stream
+*/
+static void HttpSseSubscribe(void)
+{
+  HTTP_SSE_CLIENT_T *sse = NULL;
+
+  for (int n = 0; n < HTTP_SSE_CLIENTS_MAX; n++) {
+    if (!_http_sse_clients[n].in_use || !_http_sse_clients[n].client.connected()) {
+      sse = &_http_sse_clients[n];
+      break;
+    }
+  }
+  if (!sse) {
+    _WebServer.send(503, "text/plain", "too many event stream clients");
+    return;
+  }
+
+  /*
+     resume after the ID of the last event received -- without an ID the client gets all machines
+  */
+  String cursor = _WebServer.header("Last-Event-ID");
+
+  if (!cursor.length())
+    cursor = _WebServer.arg("since");
+
+  sse->client = _WebServer.client();
+  sse->in_use = true;
+  sse->version = HttpSseCursor(cursor);
+  sse->last_write = millis();
+
+  char header[160];
+  int length = snprintf(header, sizeof(header),
+                        "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/event-stream\r\n"
+                        "Cache-Control: no-cache\r\n"
+                        "Access-Control-Allow-Origin: *\r\n"
+                        "\r\n"
+                        "retry: %d\n\n", HTTP_SSE_RETRY);
+
+  sse->client.write((const uint8_t *) header, length);
+  LogMsg("HTTP: event stream client %s subscribed at version %lu", sse->client.remoteIP().toString().c_str(), (unsigned long) sse->version);
+  HttpSseSend(sse, ScanDevGetVersion());
+}
+
+/*
+   push the changes and the heartbeat to the clients of the event stream
+*/
+static void HttpSseUpdate(void)
+{
+  uint32_t version = ScanDevGetVersion();
+
+  for (int n = 0; n < HTTP_SSE_CLIENTS_MAX; n++) {
+    HTTP_SSE_CLIENT_T *sse = &_http_sse_clients[n];
+
+    if (!sse->in_use)
+      continue;
+    if (sse->version != version)
+      HttpSseSend(sse, version);
+    else if (millis() - sse->last_write >= HTTP_SSE_HEARTBEAT) {
+      _http_sse_current = sse;
+      _http_sse_failed = false;
+      HttpSseWrite(": heartbeat\n\n", 13);
+      sse->last_write = millis();
+    }
+
+    if (_http_sse_failed || !sse->client.connected()) {
+      LogMsg("HTTP: event stream client disconnected");
+      sse->client.stop();
+      sse->in_use = false;
+      _http_sse_failed = false;
+    }
+  }
+}
+
+/*
+   send the ETag and the cache headers -- answers 304 and returns true if the client has this version
+*/
+static bool HttpNotModified(const char *etag, const char *cache_control)
+{
+  _WebServer.sendHeader("ETag", etag);
+  _WebServer.sendHeader("Cache-Control", cache_control);
+  _WebServer.sendHeader("Access-Control-Allow-Origin", "*");
+
+  if (EtagMatch(_WebServer.header("If-None-Match").c_str(), etag)) {
+    _WebServer.send(304);
+    return true;
+  }
+  return false;
+}
+
+/*
+   the same for a version of the machine table -- the ETag is weak, the
+   RSSI and the last seen times in the body change beside the version
+*/
+static bool HttpVersionNotModified(uint32_t version)
+{
+  char etag[28];
+
+  return HttpNotModified(EtagOfVersion(etag, sizeof(etag), _http_boot_id, version), "no-cache");
+}
+
+/*
+   send a static asset -- it is sent compressed as it is in the flash, every browser accepts gzip
+*/
+static void HttpSendAsset(const WEB_ASSET_T *asset)
+{
+  if (HttpNotModified(asset->etag, asset->cache_control))
+    return;
+
+  _WebServer.sendHeader("Content-Encoding", "gzip");
+  _WebServer.send_P(200, asset->type, (PGM_P) asset->data, asset->length);
+}
+
+/*
+   the timing of the requests
+*/
+static HTTP_STATS_T _http_stats;
+
+/*
+   register a handler, the time spent in it is added to the statistics
+*/
+static void HttpOn(const Uri &uri, HTTPMethod method, std::function<void(void)> handler, std::function<void(void)> upload = nullptr)
+{
+  _WebServer.on(uri, method, [handler]() {
+    unsigned long start = micros();
+
+    handler();
+
+    unsigned long us = micros() - start;
+
+    _http_stats.requests++;
+    _http_stats.total_us += us;
+    _http_stats.last_us = us;
+    _http_stats.max_us = MAX(_http_stats.max_us, us);
+    if (us >= HTTP_SLOW_REQUEST * 1000UL) {
+      _http_stats.slow++;
+      LogWarn("HTTP: request %s took %lu ms", _WebServer.uri().c_str(), us / 1000);
+    }
+  }, upload);
+}
+
+static void HttpOn(const Uri &uri, std::function<void(void)> handler)
+{
+  HttpOn(uri, HTTP_ANY, handler);
+}
+
+/*
+   append a line to the metrics
+*/
+static void HttpMetric(char *buffer, size_t size, size_t *length, const char *format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  int n = vsnprintf(&buffer[*length], size - *length, format, args);
+  va_end(args);
+
+  if (n > 0)
+    *length = MIN(*length + n, size - 1);
+}
+
+/*
+   build the metrics in the Prometheus text format -- without String, so the
+   scrape doesn't allocate more than the web server itself
+*/
+static size_t HttpMetrics(char *buffer, size_t size)
+{
+  MEMSTAT_HEAP_T heap;
+  size_t length = 0;
+
+  MemStatHeap(&heap);
+  HttpMetric(buffer, size, &length,
+             "# TYPE scanner_heap_size_bytes gauge\nscanner_heap_size_bytes %lu\n"
+             "# TYPE scanner_heap_free_bytes gauge\nscanner_heap_free_bytes %lu\n"
+             "# TYPE scanner_heap_min_free_bytes gauge\nscanner_heap_min_free_bytes %lu\n"
+             "# TYPE scanner_heap_largest_free_block_bytes gauge\nscanner_heap_largest_free_block_bytes %lu\n"
+             "# TYPE scanner_heap_min_largest_free_block_bytes gauge\nscanner_heap_min_largest_free_block_bytes %lu\n"
+             "# TYPE scanner_heap_fragmentation_percent gauge\nscanner_heap_fragmentation_percent %d\n",
+             (unsigned long) heap.size, (unsigned long) heap.free, (unsigned long) heap.min_free,
+             (unsigned long) heap.largest, (unsigned long) heap.min_largest, heap.fragmentation);
+
+  static const char *counters[] = { "allocations", "frees", "allocated_bytes" };
+
+  for (int c = 0; c < 3; c++) {
+    HttpMetric(buffer, size, &length, "# TYPE scanner_%s_total counter\n", counters[c]);
+    for (int n = 0; n < MEMSTAT_SUBSYSTEMS; n++) {
+      MEMSTAT_ALLOCS_T allocs;
+
+      MemStatAllocs(n, &allocs);
+      HttpMetric(buffer, size, &length, "scanner_%s_total{subsystem=\"%s\"} %lu\n", counters[c], MemStatName(n),
+                 (c == 0) ? allocs.allocs : (c == 1) ? allocs.frees : allocs.bytes);
+    }
+  }
+
+  HttpMetric(buffer, size, &length,
+             "# TYPE scanner_http_requests_total counter\nscanner_http_requests_total %lu\n"
+             "# TYPE scanner_http_slow_requests_total counter\nscanner_http_slow_requests_total %lu\n"
+             "# TYPE scanner_http_handler_microseconds_total counter\nscanner_http_handler_microseconds_total %llu\n"
+             "# TYPE scanner_http_handler_max_microseconds gauge\nscanner_http_handler_max_microseconds %lu\n",
+             _http_stats.requests, _http_stats.slow, (unsigned long long) _http_stats.total_us, _http_stats.max_us);
+
+  HttpMetric(buffer, size, &length,
+             "# TYPE scanner_machines_tracked gauge\nscanner_machines_tracked %d\n"
+             "# TYPE scanner_uptime_seconds gauge\nscanner_uptime_seconds %lu\n",
+             ScanDevGetCount(), (unsigned long) NtpUptime());
+  return length;
+}
+
+/*
+   the system information as JSON
+*/
+static void HttpInfoJSON(JSON_WRITER_T *json)
+{
+  WIFI_STATS_T wifi_stats;
+  unsigned long log_written, log_dropped;
+  unsigned long capture_captured, capture_dropped, capture_bytes;
+  HTTP_STATS_T http_stats;
+  OTA_STATS_T ota_stats;
+  HISTORY_STATS_T history_stats;
+  MEMSTAT_HEAP_T heap;
+
+  WifiStats(&wifi_stats);
+  LogStats(&log_written, &log_dropped);
+  CaptureStats(&capture_captured, &capture_dropped, &capture_bytes);
+  HttpStats(&http_stats);
+  OtaStats(&ota_stats);
+  HistoryStats(&history_stats);
+  MemStatHeap(&heap);
+
+  JsonObjectBegin(json, NULL);
+
+  JsonObjectBegin(json, "device");
+  JsonString(json, "name", _http_config.device.name);
+  JsonString(json, "version", GIT_VERSION);
+  JsonString(json, "build", __DATE__ " " __TIME__);
+  JsonInt(json, "machines", ScanDevGetCount());
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "wifi");
+  JsonString(json, "ssid", WifiGetSSID().c_str());
+  JsonInt(json, "channel", WifiGetChannel());
+  JsonInt(json, "rssi", WifiGetRSSI());
+  JsonInt(json, "quality", WIFI_RSSI_TO_QUALITY(WifiGetRSSI()));
+  JsonString(json, "mac", WifiGetMacAddr().c_str());
+  JsonString(json, "ip", WifiGetIpAddr().c_str());
+  JsonString(json, "state", WifiGetStateString());
+  JsonUInt(json, "connects", wifi_stats.connects);
+  JsonUInt(json, "attempts", wifi_stats.attempts);
+  JsonUInt(json, "connectTime", wifi_stats.last_connect_time);
+  JsonBool(json, "pinned", wifi_stats.pinned);
+  JsonUInt(json, "disconnects", wifi_stats.disconnects);
+  JsonInt(json, "lastReason", wifi_stats.last_reason);
+  JsonUInt(json, "lastOutage", wifi_stats.last_outage);
+  JsonUInt(json, "maxOutage", wifi_stats.max_outage);
+  JsonUInt(json, "totalOutage", wifi_stats.total_outage);
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "mqtt");
+  JsonString(json, "broker", MQTT_BROKER);
+  JsonInt(json, "port", MQTT_PORT);
+  JsonString(json, "status", MqttGetStatusString());
+  JsonString(json, "topic", "laundry/machines/");
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "target");
+  JsonString(json, "name", TARGET_DEVICE_NAME);
+  JsonUInt(json, "manufacturer", TARGET_MANUFACTURER_ID);
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "time");
+  JsonString(json, "server", _http_config.ntp.server);
+  JsonInt(json, "offsetUs", NtpLastOffsetUs());
+  JsonInt(json, "delayUs", NtpLastDelayUs());
+  JsonString(json, "lastServer", NtpLastServer());
+  JsonString(json, "now", TimeToString(now()));
+  JsonString(json, "uptime", TimeToString(NtpUptime()));
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "bluetooth");
+  JsonUInt(json, "scanTime", _http_config.bluetooth.scan_time);
+  JsonUInt(json, "pauseTime", _http_config.bluetooth.pause_time);
+  JsonInt(json, "absenceCycles", _http_config.bluetooth.absence_cycles);
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "capture");
+  JsonString(json, "mode", (CaptureMode() == CAPTURE_FLASH) ? "Flash" : (CaptureMode() == CAPTURE_SERIAL) ? "Serial" : "Off");
+  JsonUInt(json, "captured", capture_captured);
+  JsonUInt(json, "dropped", capture_dropped);
+  JsonUInt(json, "bytes", capture_bytes);
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "history");
+  JsonUInt(json, "transitions", history_stats.transitions);
+  JsonUInt(json, "dropped", history_stats.dropped);
+  JsonInt(json, "machines", history_stats.machines);
+  JsonUInt(json, "blocks", history_stats.blocks);
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "firmware");
+  JsonBool(json, "pending", OtaPending());
+  JsonBool(json, "compressed", ota_stats.compressed);
+  JsonUInt(json, "received", ota_stats.received);
+  JsonUInt(json, "written", ota_stats.written);
+  JsonUInt(json, "time", ota_stats.time);
+  JsonUInt(json, "inflate", ota_stats.inflate);
+  JsonUInt(json, "flash", ota_stats.flash);
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "http");
+  JsonUInt(json, "requests", http_stats.requests);
+  JsonUInt(json, "slow", http_stats.slow);
+  JsonUInt(json, "avgUs", (http_stats.requests) ? http_stats.total_us / http_stats.requests : 0);
+  JsonUInt(json, "maxUs", http_stats.max_us);
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "memory");
+  JsonUInt(json, "free", heap.free);
+  JsonUInt(json, "size", heap.size);
+  JsonUInt(json, "minFree", heap.min_free);
+  JsonUInt(json, "largest", heap.largest);
+  JsonUInt(json, "minLargest", heap.min_largest);
+  JsonInt(json, "fragmentation", heap.fragmentation);
+  JsonArrayBegin(json, "allocs");
+  for (int n = 0; n < MEMSTAT_SUBSYSTEMS; n++) {
+    MEMSTAT_ALLOCS_T a;
+
+    MemStatAllocs(n, &a);
+    JsonObjectBegin(json, NULL);
+    JsonString(json, "name", MemStatName(n));
+    JsonUInt(json, "allocs", a.allocs);
+    JsonUInt(json, "frees", a.frees);
+    JsonUInt(json, "bytes", a.bytes);
+    JsonObjectEnd(json);
+  }
+  JsonArrayEnd(json);
+  JsonObjectEnd(json);
+
+  JsonObjectBegin(json, "log");
+  JsonUInt(json, "written", log_written);
+  JsonUInt(json, "dropped", log_dropped);
+  JsonObjectEnd(json);
+
+  JsonObjectEnd(json);
+}
+
+/*
+   the task of the web server
+*/
+static void HttpTask(void *parameter)
+{
+  MEMSTAT_SCOPE(MEMSTAT_HTTP);
+
+  for (;;) {
+    _WebServer.handleClient();
+    HttpSseUpdate();
+    vTaskDelay(pdMS_TO_TICKS(HTTP_TASK_DELAY));
+  }
+}
+
 /*
    setup the webserver
 */
 void HttpSetup(void)
 {
-  static String _html_header PROGMEM =
-    "<!DOCTYPE html>"
-    "<html>"
-    "<head>"
-    "<meta charset='utf-8'>"
-    "<meta name='viewport' content='width=device-width,initial-scale=1,user-scalable=no'>"
-    "<title>Laundry Scanner</title>"
-    "<link href='/styles.css' rel='stylesheet' type='text/css'>"
-    "</head>"
-    "<body>"
-    "<div class=content>"
-    "<div class=header>"
-    "<h3>Laundry Machine Scanner</h3>"
-    "<h2>" + String(_config.device.name) + "</h2>"
-    "</div>"
-    ;
-  static String _html_footer PROGMEM =
-    "<div class=footer>"
-    "<hr>"
-    "<a href='https://laun-dryer.vercel.app' target='_blank' style='color:#aaa;'>Laundry Scanner " GIT_VERSION "</a>"
-    "</div>"
-    "</div>"
-    "</body>"
-    "</html>"
-    ;
-
   LogMsg("HTTP: setting up HTTP server");
 
   /*
-     get the current config as a duplicate
+     get the current config as a duplicate -- the task of the server reads only this copy,
+     so it is taken after the other sub-systems have fixed their ranges
   */
-  ConfigGet(0, sizeof(CONFIG_T), &_config);
+  ConfigGet(0, sizeof(CONFIG_T), &_http_config);
 
-  _WebServer.onNotFound( []() {
-    _last_http_request = millis();
-    if (_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _config.device.password))
-      return _WebServer.requestAuthentication();
+  /*
+     the conditional requests of the API
+  */
+  static const char *headers[] = { "If-None-Match", "Last-Event-ID" };
 
-    _WebServer.send(200, "text/html",
-                    _html_header +
-                    "<form action='/machines' method='get'><button class='button greenbg'>Tracked Machines</button></form><p>"
-                    "<form action='/info' method='get'><button>System Information</button></form><p>"
-                    "<form action='/upgrade' method='get'><button>Firmware Upgrade</button></form><p>"
-                    "<form action='/restart' method='get' onsubmit=\"return confirm('Are you sure to restart the device?');\"><button class='button redbg'>Restart</button></form><p>"
-                    + _html_footer);
-  });
+  _WebServer.collectHeaders(headers, sizeof(headers) / sizeof(headers[0]));
+  _http_boot_id = esp_random();
 
-  _WebServer.on("/styles.css", []() {
-    _last_http_request = millis();
-    _WebServer.send(200, "text/css",
-                    "html, body { background:#ffffff; }"
-                    "body { margin:1rem; padding:0; font-familiy:'sans-serif'; color:#202020; text-align:center; font-size:1rem; }"
-                    "input { width:100%; font-size:1rem; box-sizing: border-box; -webkit-box-sizing: border-box; }"
-                    "input[type=radio] { width:2rem; }"
-                    "button { border: 0; border-radius: 0.3rem; background: #1881ba; color: #ffffff; line-height: 2.4rem; font-size: 1.2rem; width: 100%; -webkit-transition-duration: 0.5s; transition-duration: 0.5s; cursor: pointer; opacity:0.8; }"
-                    "button:hover { opacity: 1.0; }"
-                    ".header { text-align:center; }"
-                    ".content { text-align:left; display:inline-block; color:#000000; min-width:340px; }"
-                    ".msg { text-align:center; color:#be3731; font-weight:bold; padding:5rem 0; }"
-                    ".devinfo { padding:0; margin:0; border-spacing:0; width: 100%; }"
-                    ".devinfo tr th { background: #c0c0c0; font-weight:bold; }"
-                    ".devinfo tr td { font-familiy:'monospace'; }"
-                    ".devinfo tr td:first-child { font-weight:bold; }"
-                    ".devinfo tr td, .devinfo tr th { padding:4px; }"
-                    ".devinfo tr:nth-child(even) { background: #f0f0f0; }"
-                    ".devinfo tr:nth-child(odd) {background: #ffffff; }"
-                    ".btscanlist { padding:0; margin:0; border-spacing:0; width: 100%; }"
-                    ".btscanlist tr th { background: #c0c0c0; font-weight:bold; }"
-                    ".btscanlist tr td { font-familiy:'monospace'; }"
-                    ".btscanlist tr td, .btscanlist tr th { padding:4px; }"
-                    ".btscanlist tr:nth-child(even) { background: #f0f0f0; }"
-                    ".btscanlist tr:nth-child(odd) {background: #ffffff; }"
-                    ".footer { text-align:right; }"
-                    ".greenbg { background: #348f4b; }"
-                    ".redbg { background: #a12828; }"
-                   );
-  });
+  /*
+     the static assets -- the main page is the single page UI in web/index.html, the
+     other pages (/info, /machines, /config, /upgrade, /restart) are shells that load
+     their data from /api/info and /api/machines
+  */
+  for (size_t n = 0; n < sizeof(_web_assets) / sizeof(_web_assets[0]); n++) {
+    const WEB_ASSET_T *asset = &_web_assets[n];
 
-  _WebServer.on("/config", []() {
-    _last_http_request = millis();
-    if (_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _config.device.password))
-      return _WebServer.requestAuthentication();
+    HttpOn(asset->path, HTTP_GET, [asset]() {
+      if (!strcmp(asset->type, "text/html") &&
+          _http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
+        return _WebServer.requestAuthentication();
+
+      _last_http_request = millis();
+      HttpSendAsset(asset);
+    });
+  }
 
-    // Configuration is hardcoded - show info page
-    _WebServer.send(200, "text/html",
-                    _html_header +
-                    "<div class='msg'>"
-                    "<p><b>Configuration is hardcoded</b></p>"
-                    "<p>To change settings, edit the following in <code>config.h</code>:</p>"
-                    "<ul style='text-align:left;'>"
-                    "<li><b>WiFi:</b> WIFI_SSID, WIFI_PASSWORD</li>"
-                    "<li><b>MQTT:</b> MQTT_BROKER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD</li>"
-                    "<li><b>Scanning:</b> BT_SCAN_TIME, BT_PAUSE_TIME, BT_ABSENCE_CYCLES</li>"
-                    "<li><b>Target:</b> TARGET_DEVICE_NAME, TARGET_MANUFACTURER_ID</li>"
-                    "</ul>"
-                    "<p>Then recompile and upload the firmware.</p>"
-                    "</div>"
-                    "<p><form action='/' method='get'><button>Main Menu</button></form><p>"
-                    + _html_footer);
+  _WebServer.onNotFound( []() {
+    _WebServer.sendHeader("Location", "/", true);
+    _WebServer.send(302, "text/plain", "");
   });
 
   // Redirect old config sub-pages to main config page
-  _WebServer.on("/config/device", []() {
+  HttpOn("/config/device", []() {
     _WebServer.sendHeader("Location", "/config", true);
     _WebServer.send(302, "text/plain", "");
   });
-  _WebServer.on("/config/wifi", []() {
+  HttpOn("/config/wifi", []() {
     _WebServer.sendHeader("Location", "/config", true);
     _WebServer.send(302, "text/plain", "");
   });
-  _WebServer.on("/config/ntp", []() {
+  HttpOn("/config/ntp", []() {
     _WebServer.sendHeader("Location", "/config", true);
     _WebServer.send(302, "text/plain", "");
   });
-  _WebServer.on("/config/mqtt", []() {
+  HttpOn("/config/mqtt", []() {
     _WebServer.sendHeader("Location", "/config", true);
     _WebServer.send(302, "text/plain", "");
   });
-  _WebServer.on("/config/bluetooth", []() {
+  HttpOn("/config/bluetooth", []() {
     _WebServer.sendHeader("Location", "/config", true);
     _WebServer.send(302, "text/plain", "");
   });
-  _WebServer.on("/config/reset", []() {
+  HttpOn("/config/reset", []() {
     _WebServer.sendHeader("Location", "/config", true);
     _WebServer.send(302, "text/plain", "");
   });
 
-  _WebServer.on("/info", []() {
-    if (_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _config.device.password))
+  /*
+     the system information as JSON -- for the pages /info and /machines
+  */
+  HttpOn("/api/info", []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
       return _WebServer.requestAuthentication();
 
     _last_http_request = millis();
 
-    _WebServer.send(200, "text/html",
-                    _html_header +
-                    "<div class='info'>"
-                    "<table class='devinfo'>"
-
-                    "<tr><th colspan=2>Device</th></tr>"
-                    "<tr>"
-                    "<td>SW Version</td>"
-                    "<td>" GIT_VERSION "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>SW Build Date</td>"
-                    "<td>" __DATE__ " " __TIME__ "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Device Name</td>"
-                    "<td>" + String(_config.device.name) + "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Machines Tracked</td>"
-                    "<td>" + String(ScanDevGetCount()) + "</td>"
-                    "</tr>"
-
-                    "<tr><th colspan=2>WiFi</th></tr>"
-                    "<tr>"
-                    "<td>SSID</td>"
-                    "<td>" + WifiGetSSID() + "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Channel</td>"
-                    "<td>" + WifiGetChannel() + "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>RSSI</td>"
-                    "<td>" + String(WIFI_RSSI_TO_QUALITY(WifiGetRSSI())) + " % (" + WifiGetRSSI() + " dBm)</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>MAC</td>"
-                    "<td>" + WifiGetMacAddr() + "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>IP Address</td>"
-                    "<td>" + WifiGetIpAddr() + "</td>"
-                    "</tr>"
-
-                    "<tr><th colspan=2>MQTT</th></tr>"
-                    "<tr>"
-                    "<td>Broker</td>"
-                    "<td>" MQTT_BROKER ":" + String(MQTT_PORT) + "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Status</td>"
-                    "<td>" + String(MqttGetStatusString()) + "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Topic Prefix</td>"
-                    "<td>laundry/machines/</td>"
-                    "</tr>"
-
-                    "<tr><th colspan=2>Target Devices</th></tr>"
-                    "<tr>"
-                    "<td>Device Name</td>"
-                    "<td>" TARGET_DEVICE_NAME "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Manufacturer ID</td>"
-                    "<td>0x" + String(TARGET_MANUFACTURER_ID, HEX) + "</td>"
-                    "</tr>"
-
-                    "<tr><th colspan=2>Time</th></tr>"
-                    "<tr>"
-                    "<td>NTP Server</td>"
-                    "<td>" + _config.ntp.server + "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Current Time</td>"
-                    "<td>" + String(TimeToString(now())) + "</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Uptime</td>"
-                    "<td>" + String(TimeToString(NtpUptime())) + "</td>"
-                    "</tr>"
-
-                    "<tr><th colspan=2>Bluetooth Scanning</th></tr>"
-                    "<tr>"
-                    "<td>Scan Duration</td>"
-                    "<td>" + _config.bluetooth.scan_time + " s</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Pause Between Scans</td>"
-                    "<td>" + _config.bluetooth.pause_time + " s</td>"
-                    "</tr>"
-                    "<tr>"
-                    "<td>Absence Timeout Cycles</td>"
-                    "<td>" + _config.bluetooth.absence_cycles + "</td>"
-                    "</tr>"
-
-                    "</table>"
-                    "</div>"
-                    "<p><form action='/' method='get'><button>Main Menu</button></form><p>"
-                    + _html_footer);
+    JSON_WRITER_T json;
+
+    _WebServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _WebServer.send(200, "application/json", "");
+    JsonBegin(&json, HttpSendJSON);
+    HttpInfoJSON(&json);
+    JsonEnd(&json);
   });
 
-  _WebServer.on("/restart", []() {
-    if (_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _config.device.password))
+  HttpOn("/metrics", []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
       return _WebServer.requestAuthentication();
 
     _last_http_request = millis();
 
-    _WebServer.send(200, "text/html",
-                    _html_header +
-                    "<div class='msg'>"
-                    "Device will restart now."
-                    "</div>"
-                    + _html_footer);
+    static char buffer[HTTP_METRICS_SIZE];
+    size_t length = HttpMetrics(buffer, sizeof(buffer));
+
+    _WebServer.send_P(200, "text/plain; version=0.0.4", buffer, length);
+  });
+
+  /*
+     the restart -- the page /restart posts here
+  */
+  HttpOn("/api/restart", HTTP_POST, []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
+      return _WebServer.requestAuthentication();
+
+    _last_http_request = millis();
+    _WebServer.send(202, "application/json", "{\"restart\":true}");
 
     /*
         trigger reboot
@@ -313,61 +619,66 @@ void HttpSetup(void)
   });
 
   /*
-     firmware upgrade -- form
+     capture of the advertisements -- ?mode=0|1|2 stops/starts it, otherwise the capture file is downloaded
   */
-  _WebServer.on("/upgrade", HTTP_GET, []() {
-    if (_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _config.device.password))
+  HttpOn("/capture", []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
       return _WebServer.requestAuthentication();
 
     _last_http_request = millis();
 
-    _WebServer.send(200, "text/html",
-                    _html_header +
-
-                    "<fieldset>"
-                    "<legend>"
-                    "<b>&nbsp;Upgrade by file upload&nbsp;</b>"
-                    "</legend>"
-                    "<form method='post' action='/upgrade' enctype='multipart/form-data'>"
+    if (_WebServer.hasArg("mode")) {
+      int mode = _WebServer.arg("mode").toInt();
 
-                    "<p>"
-                    "<b>Firmware File</b>"
-                    "<br>"
-                    "<input name='fwfile' type='file' placeholder='Firmware File'>"
-                    "</p>"
-
-                    "<button name='upgrade' type='submit' class='button greenbg'>Start upgrade</button>"
-                    "</form>"
-                    "</fieldset>"
+      if (mode < CAPTURE_OFF || mode > CAPTURE_FLASH) {
+        _WebServer.send(400, "text/plain", "unknown mode");
+        return;
+      }
+      CaptureRequest(mode);
+      _WebServer.send(202, "text/plain", "requested");
+      return;
+    }
 
-                    "<p><form action='/' method='get'><button>Main Menu</button></form><p>"
-                    + _html_footer);
+    /*
+       the file can only be read while it is closed -- the capture module keeps it so until it is sent
+    */
+    if (!CaptureDownload([](File &file) {
+      _WebServer.sendHeader("Content-Disposition", "attachment; filename=capture.bin");
+      _WebServer.streamFile(file, "application/octet-stream");
+    }))
+      _WebServer.send(404, "text/plain", "no capture available");
   });
 
   /*
-     firmware upgrade -- flash
+     firmware upgrade -- flash; the page /upgrade posts the file here, the result is JSON
   */
-  _WebServer.on("/upgrade", HTTP_POST, []() {
-    if (_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _config.device.password))
+  HttpOn("/upgrade", HTTP_POST, []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
       return _WebServer.requestAuthentication();
 
     _last_http_request = millis();
 
-    _WebServer.send(200, "text/html",
-                    _html_header +
-                    "<div class='msg'>"
-                    "Upgrade " + ((Update.hasError()) ? "failed" : "succeeded") +
-                    "<p>"
-                    "Device will restart now."
-                    "</div>"
-                    + _html_footer);
+    JSON_WRITER_T json;
+
+    _WebServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _WebServer.send((OtaError()) ? 500 : 200, "application/json", "");
+    JsonBegin(&json, HttpSendJSON);
+    JsonObjectBegin(&json, NULL);
+    if (OtaError())
+      JsonString(&json, "error", OtaError());
+    else
+      JsonString(&json, "sha256", OtaHash());
+    JsonObjectEnd(&json);
+    JsonEnd(&json);
+    if (OtaError())
+      return;
 
     /*
         trigger reboot
     */
     StateChange(STATE_WAIT_BEFORE_REBOOTING);
   }, []() {
-    if (_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _config.device.password))
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
       return _WebServer.requestAuthentication();
 
     _last_http_request = millis();
@@ -379,71 +690,139 @@ void HttpSetup(void)
 
     if (upload.status == UPLOAD_FILE_START) {
       LogMsg("HTTP: Starting firmware upload: %s", upload.filename.c_str());
-      if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
-        LogMsg("HTTP: upgrade failure: %s", Update.errorString());
-      }
-    }
-    else if (upload.status == UPLOAD_FILE_WRITE) {
-      if (Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
-        LogMsg("HTTP: upload failure: %s", Update.errorString());
-      }
+      OtaBegin((_WebServer.hasArg("sha256")) ? _WebServer.arg("sha256").c_str() : NULL);
     }
+    else if (upload.status == UPLOAD_FILE_WRITE)
+      OtaWrite(upload.buf, upload.currentSize);
     else if (upload.status == UPLOAD_FILE_END) {
-      if (Update.end(true)) {
-        if (Update.isFinished()) {
-          LogMsg("HTTP: upgrade success: %u bytes -- rebooting...", upload.totalSize);
-        }
-        else {
-          LogMsg("HTTP: upgrade failure: %s", Update.errorString());
-        }
-      }
-      else {
-        LogMsg("HTTP: upgrade failure: %s", Update.errorString());
-      }
+      if (OtaEnd())
+        LogMsg("HTTP: upgrade success: %u bytes -- rebooting...", upload.totalSize);
     }
+    else if (upload.status == UPLOAD_FILE_ABORTED)
+      OtaAbort();
   });
 
 
-  _WebServer.on("/machines", []() {
-    if (_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _config.device.password))
+  /*
+     the machines as JSON -- the ETag is the version of the table resp. of the machine,
+     so it changes with the state and the presence, not with the RSSI or the last seen
+     time; it is a weak one, a 304 means the same state, not the same bytes
+  */
+  HttpOn("/api/machines", []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
+      return _WebServer.requestAuthentication();
+
+    _last_http_request = millis();
+
+    if (HttpVersionNotModified(ScanDevGetVersion()))
+      return;
+
+    JSON_WRITER_T json;
+
+    _WebServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _WebServer.send(200, "application/json", "");
+    JsonBegin(&json, HttpSendJSON);
+    ScanDevListJSON(&json);
+    JsonEnd(&json);
+  });
+
+  HttpOn(UriBraces("/api/machines/{}"), []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
       return _WebServer.requestAuthentication();
 
     _last_http_request = millis();
 
+    SCANDEV_MACHINE_T machine;
+
+    if (!ScanDevGetMachine(_WebServer.pathArg(0).c_str(), &machine)) {
+      _WebServer.send(404, "application/json", "{\"error\":\"unknown machine\"}");
+      return;
+    }
+    if (HttpVersionNotModified(machine.version))
+      return;
+
+    JSON_WRITER_T json;
+
     _WebServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
-    _WebServer.send(200, "text/html");
-    _WebServer.sendContent(
-      _html_header +
-      "<p><b>Scanning for:</b> " + String(TARGET_DEVICE_NAME) + " (0x" + String(TARGET_MANUFACTURER_ID, HEX) + ")</p>"
-      "<p><b>MQTT Broker:</b> " + String(MQTT_BROKER) + ":" + String(MQTT_PORT) + 
-      " (" + String(MqttGetStatusString()) + ")</p>"
-      "<p><form action='/machines' method='get'><button class='button greenbg'>Refresh</button></form><p>");
-
-    ScanDevListHTML(HttpSendHelper);
-
-    _WebServer.sendContent(
-      "<p><form action='/machines' method='get'><button class='button greenbg'>Refresh</button></form><p>"
-      "<p><form action='/' method='get'><button>Main Menu</button></form><p>"
-      + _html_footer);
+    _WebServer.send(200, "application/json", "");
+    JsonBegin(&json, HttpSendJSON);
+    ScanDevMachineJSON(&json, NULL, &machine);
+    JsonEnd(&json);
+  });
+
+  /*
+     the utilization of a machine from the history -- from and step in seconds,
+     default are the last 24 hours in steps of an hour
+  */
+  HttpOn("/history", []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
+      return _WebServer.requestAuthentication();
+
+    _last_http_request = millis();
+
+    if (!_WebServer.hasArg("machine")) {
+      _WebServer.send(400, "application/json", "{\"error\":\"missing machine\"}");
+      return;
+    }
+
+    uint32_t now = NtpGetTime();
+    uint32_t step = (_WebServer.hasArg("step")) ? _WebServer.arg("step").toInt() : 3600;
+
+    step = MAX(HISTORY_STEP_MIN, MIN(step, HISTORY_STEP_MAX));
+
+    uint32_t from = (_WebServer.hasArg("from")) ? _WebServer.arg("from").toInt() : (now / step - 23) * step;
+    int count = (_WebServer.hasArg("count")) ? _WebServer.arg("count").toInt() :
+                (now > from) ? (now - from + step - 1) / step : 1;
+
+    JSON_WRITER_T json;
+
+    _WebServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _WebServer.send(200, "application/json", "");
+    JsonBegin(&json, HttpSendJSON);
+    if (!HistoryJSON(&json, _WebServer.arg("machine").c_str(), from, step, count)) {
+      JsonObjectBegin(&json, NULL);
+      JsonString(&json, "error", "unknown machine");
+      JsonObjectEnd(&json);
+    }
+    JsonEnd(&json);
+  });
+
+  /*
+     the changes of the machines as Server-Sent Events
+  */
+  HttpOn("/api/events", []() {
+    if (_http_config.device.password[0] && !_WebServer.authenticate(HTTP_WEB_USER, _http_config.device.password))
+      return _WebServer.requestAuthentication();
+
+    _last_http_request = millis();
+    HttpSseSubscribe();
   });
 
   // Keep old endpoint for compatibility
-  _WebServer.on("/btlist", []() {
+  HttpOn("/btlist", []() {
     _WebServer.sendHeader("Location", "/machines", true);
     _WebServer.send(302, "text/plain", "");
   });
 
   _WebServer.begin();
   _last_http_request = millis();
+  xTaskCreatePinnedToCore(HttpTask, "http", HTTP_TASK_STACK, NULL, HTTP_TASK_PRIORITY, NULL, HTTP_TASK_CORE);
   LogMsg("HTTP: server started");
 }
 
 /*
-**	handle incoming HTTP requests
+**	handle incoming HTTP requests -- nothing to do, the server runs in its own task
 */
 void HttpUpdate(void)
 {
-  _WebServer.handleClient();
+}
+
+/*
+   get the timing of the requests
+*/
+void HttpStats(HTTP_STATS_T *stats)
+{
+  *stats = _http_stats;
 }
 
 /*
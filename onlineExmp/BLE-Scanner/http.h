@@ -34,16 +34,60 @@
 */
 #define HTTP_WEB_USER   "admin"
 
+/*
+   size of the buffer for /metrics
+*/
+#define HTTP_METRICS_SIZE   3072
+
+/*
+   the event stream /api/events: max. number of clients, heartbeat interval
+   in ms and the reconnect delay of the clients in ms
+*/
+#define HTTP_SSE_CLIENTS_MAX    4
+#define HTTP_SSE_HEARTBEAT      15000
+#define HTTP_SSE_RETRY          2000
+
+/*
+   the web server runs in its own task, so a slow client or an upgrade doesn't block the loop --
+   it is the synchronous WebServer, which serves one connection at a time: a slow client or an
+   upgrade still holds up the other clients and the event streams
+*/
+#define HTTP_TASK_STACK         8192
+#define HTTP_TASK_PRIORITY      1
+#define HTTP_TASK_CORE          1
+#define HTTP_TASK_DELAY         2       // ms between two rounds of the server
+
+/*
+   a request is counted as slow, if its handler takes longer than ... ms
+*/
+#define HTTP_SLOW_REQUEST       100
+
+/*
+   the timing of the requests -- the time spent in the handlers
+*/
+typedef struct _http_stats {
+  unsigned long requests;
+  unsigned long slow;
+  uint64_t total_us;
+  unsigned long max_us;
+  unsigned long last_us;
+} HTTP_STATS_T;
+
 /*
 **  setup the HTTP web server:w
 */
 void HttpSetup(void);
 
 /*
-**	handle incoming HTTP requests
+**	handle incoming HTTP requests -- nothing to do, the server runs in its own task
 */
 void HttpUpdate(void);
 
+/*
+   get the timing of the requests
+*/
+void HttpStats(HTTP_STATS_T *stats);
+
 /*
   return the time in seconds since the last HTTP request
 */
@@ -0,0 +1,196 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module to write JSON
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_UTIL
+
+#include "config.h"
+#include "json.h"
+#include "util.h"
+
+/*
+   pass the buffer to the callback
+*/
+static void JsonFlush(JSON_WRITER_T *json)
+{
+  if (json->length && json->flush)
+    (*json->flush)(json->buffer, json->length);
+  json->written += json->length;
+  json->length = 0;
+}
+
+/*
+   append to the buffer
+*/
+static void JsonWrite(JSON_WRITER_T *json, const char *data, size_t length)
+{
+  while (length) {
+    size_t n = MIN(length, sizeof(json->buffer) - json->length);
+
+    memcpy(&json->buffer[json->length], data, n);
+    json->length += n;
+    data += n;
+    length -= n;
+    if (json->length == sizeof(json->buffer))
+      JsonFlush(json);
+  }
+}
+
+static void JsonPutc(JSON_WRITER_T *json, char c)
+{
+  if (json->length == sizeof(json->buffer))
+    JsonFlush(json);
+  json->buffer[json->length++] = c;
+}
+
+/*
+   write a quoted string
+*/
+static void JsonQuote(JSON_WRITER_T *json, const char *s)
+{
+  static const char hex[] = "0123456789abcdef";
+
+  JsonPutc(json, '"');
+  for (; *s; s++) {
+    uint8_t c = *s;
+
+    if (c == '"' || c == '\\') {
+      JsonPutc(json, '\\');
+      JsonPutc(json, c);
+    }
+    else if (c < 0x20) {
+      char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0f] };
+
+      JsonWrite(json, escape, sizeof(escape));
+    }
+    else
+      JsonPutc(json, c);
+  }
+  JsonPutc(json, '"');
+}
+
+/*
+   start a member of the current level -- the separator and the key
+*/
+static void JsonMember(JSON_WRITER_T *json, const char *key)
+{
+  uint32_t bit = 1UL << (json->depth % JSON_DEPTH_MAX);
+
+  if (json->members & bit)
+    JsonPutc(json, ',');
+  json->members |= bit;
+
+  if (key) {
+    JsonQuote(json, key);
+    JsonPutc(json, ':');
+  }
+}
+
+/*
+   start/end the output
+*/
+void JsonBegin(JSON_WRITER_T *json, void (*flush)(const char *data, size_t length))
+{
+  json->length = 0;
+  json->depth = 0;
+  json->members = 0;
+  json->written = 0;
+  json->flush = flush;
+}
+
+void JsonEnd(JSON_WRITER_T *json)
+{
+  JsonFlush(json);
+}
+
+/*
+   objects and arrays
+*/
+static void JsonOpen(JSON_WRITER_T *json, const char *key, char c)
+{
+  JsonMember(json, key);
+  JsonPutc(json, c);
+  json->depth++;
+  json->members &= ~(1UL << (json->depth % JSON_DEPTH_MAX));
+}
+
+static void JsonClose(JSON_WRITER_T *json, char c)
+{
+  if (json->depth > 0)
+    json->depth--;
+  JsonPutc(json, c);
+}
+
+void JsonObjectBegin(JSON_WRITER_T *json, const char *key)
+{
+  JsonOpen(json, key, '{');
+}
+
+void JsonObjectEnd(JSON_WRITER_T *json)
+{
+  JsonClose(json, '}');
+}
+
+void JsonArrayBegin(JSON_WRITER_T *json, const char *key)
+{
+  JsonOpen(json, key, '[');
+}
+
+void JsonArrayEnd(JSON_WRITER_T *json)
+{
+  JsonClose(json, ']');
+}
+
+/*
+   values
+*/
+void JsonString(JSON_WRITER_T *json, const char *key, const char *value)
+{
+  if (!value)
+    return JsonNull(json, key);
+  JsonMember(json, key);
+  JsonQuote(json, value);
+}
+
+void JsonInt(JSON_WRITER_T *json, const char *key, long long value)
+{
+  char number[24];
+
+  JsonMember(json, key);
+  JsonWrite(json, number, snprintf(number, sizeof(number), "%lld", value));
+}
+
+void JsonUInt(JSON_WRITER_T *json, const char *key, unsigned long long value)
+{
+  char number[24];
+
+  JsonMember(json, key);
+  JsonWrite(json, number, snprintf(number, sizeof(number), "%llu", value));
+}
+
+void JsonBool(JSON_WRITER_T *json, const char *key, bool value)
+{
+  JsonMember(json, key);
+  if (value)
+    JsonWrite(json, "true", 4);
+  else
+    JsonWrite(json, "false", 5);
+}
+
+void JsonNull(JSON_WRITER_T *json, const char *key)
+{
+  JsonMember(json, key);
+  JsonWrite(json, "null", 4);
+}
+
+/**/
@@ -0,0 +1,87 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module to write JSON
+
+  The writer streams the JSON through a fixed buffer, which is passed to
+  the flush callback whenever it is full and at the end -- e.g. as the
+  chunks of an HTTP response. It doesn't allocate.
+
+    JSON_WRITER_T json;
+
+    JsonBegin(&json, callback);
+    JsonObjectBegin(&json, NULL);
+    JsonUInt(&json, "version", 17);
+    JsonArrayBegin(&json, "machines");
+    ...
+    JsonArrayEnd(&json);
+    JsonObjectEnd(&json);
+    JsonEnd(&json);
+
+  The key is NULL for the members of an array and the top level value.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __JSON_H__
+#define __JSON_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+   size of the buffer -- the size of the chunks
+*/
+#ifndef JSON_BUFFER_SIZE
+#define JSON_BUFFER_SIZE        512
+#endif
+
+/*
+   max. nesting of objects and arrays
+*/
+#define JSON_DEPTH_MAX          32
+
+/*
+   the writer
+*/
+typedef struct _json_writer {
+  char buffer[JSON_BUFFER_SIZE];
+  size_t length;
+  int depth;
+  uint32_t members;         // one bit per level: the level has a member
+  unsigned long written;    // bytes passed to the callback
+  void (*flush)(const char *data, size_t length);
+} JSON_WRITER_T;
+
+/*
+   start/end the output -- the end flushes the rest
+*/
+void JsonBegin(JSON_WRITER_T *json, void (*flush)(const char *data, size_t length));
+void JsonEnd(JSON_WRITER_T *json);
+
+/*
+   objects and arrays
+*/
+void JsonObjectBegin(JSON_WRITER_T *json, const char *key);
+void JsonObjectEnd(JSON_WRITER_T *json);
+void JsonArrayBegin(JSON_WRITER_T *json, const char *key);
+void JsonArrayEnd(JSON_WRITER_T *json);
+
+/*
+   values
+*/
+void JsonString(JSON_WRITER_T *json, const char *key, const char *value);
+void JsonInt(JSON_WRITER_T *json, const char *key, long long value);
+void JsonUInt(JSON_WRITER_T *json, const char *key, unsigned long long value);
+void JsonBool(JSON_WRITER_T *json, const char *key, bool value);
+void JsonNull(JSON_WRITER_T *json, const char *key);
+
+#endif
+
+/**/
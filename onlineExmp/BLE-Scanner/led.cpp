@@ -23,6 +23,8 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_LED
+
 #include <Arduino.h>
 #include "config.h"
 #include "led.h"
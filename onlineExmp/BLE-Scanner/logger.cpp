@@ -0,0 +1,310 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module to handle the log messages
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_UTIL
+
+#include <Arduino.h>
+#include <mutex>
+#include <stdio.h>
+#include <time.h>
+#include "config.h"
+#include "logger.h"
+#include "ntp.h"
+#include "util.h"
+
+/*
+   the ring -- multiple producers, one consumer
+
+   every entry carries the round of the position it was last used for: the
+   entry of position pos is free for the producer if seq == LogRound(pos),
+   ready for the consumer if seq == LogRound(pos) + 1, and freed for the
+   next round by LOG_RING_SIZE more -- so the ring of zeros is valid as it
+   is, there is nothing to initialize before the first message of any task
+*/
+static LOG_ENTRY_T _log_ring[LOG_RING_SIZE];
+static std::atomic<uint32_t> _log_head(0);
+static uint32_t _log_tail = 0;
+
+/*
+   the consumer -- the log task, or a caller of LogFlush() before a restart,
+   which waits for a drain in progress and drains what is left
+*/
+static std::mutex _log_drain_mutex;
+
+/*
+   some statistics
+*/
+static std::atomic<unsigned long> _log_written(0);
+static std::atomic<unsigned long> _log_dropped(0);
+static unsigned long _log_dropped_reported = 0;
+
+/*
+   the round of a position
+*/
+static inline uint32_t LogRound(uint32_t pos)
+{
+  return pos & ~(uint32_t) (LOG_RING_SIZE - 1);
+}
+
+/*
+   reserve an entry in the ring
+*/
+LOG_ENTRY_T *LogReserve(int level, int module, const char *fmt)
+{
+  uint32_t pos = _log_head.load(std::memory_order_relaxed);
+  LOG_ENTRY_T *entry;
+
+  for (;;) {
+    entry = &_log_ring[pos & (LOG_RING_SIZE - 1)];
+    int32_t diff = (int32_t) (entry->seq.load(std::memory_order_acquire) - LogRound(pos));
+
+    if (diff == 0) {
+      if (_log_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0) {
+      /*
+         the ring is full
+      */
+      _log_dropped++;
+      return NULL;
+    }
+    else
+      pos = _log_head.load(std::memory_order_relaxed);
+  }
+
+  entry->fmt = fmt;
+  entry->local_us = NtpLocalUs();
+  entry->level = level;
+  entry->nargs = 0;
+  entry->strings_used = 0;
+  return entry;
+}
+
+/*
+   hand over a reserved entry to the formatting task
+*/
+void LogCommit(LOG_ENTRY_T *entry)
+{
+  uint32_t pos = entry->seq.load(std::memory_order_relaxed);
+
+  entry->seq.store(pos + 1, std::memory_order_release);
+  _log_written++;
+
+#if !defined(ESP32)
+  /*
+     without a formatting task we print synchronously
+  */
+  LogFlush();
+#endif
+}
+
+/*
+   format one conversion of the entry into the buffer
+*/
+static int LogFormatArg(char *buf, int size, char *spec, int speclen, char conv, const LOG_ENTRY_T *entry, int n)
+{
+  int type = entry->types[n];
+  bool wide = type == LOG_ARG_INT64 || type == LOG_ARG_UINT64;
+
+  switch (conv) {
+    case 's':
+      if (type != LOG_ARG_STR)
+        return snprintf(buf, size, "?");
+      spec[speclen++] = 's';
+      spec[speclen] = '\0';
+      return snprintf(buf, size, spec, (entry->args[n].i < 0) ? "..." : &entry->strings[entry->args[n].i]);
+
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'c':
+      if (type == LOG_ARG_STR || type == LOG_ARG_PTR)
+        return snprintf(buf, size, "?");
+      if (wide && conv != 'c') {
+        spec[speclen++] = 'l';
+        spec[speclen++] = 'l';
+      }
+      spec[speclen++] = conv;
+      spec[speclen] = '\0';
+      if (type == LOG_ARG_DOUBLE)
+        return snprintf(buf, size, spec, (long long) entry->args[n].d);
+      if (wide && conv != 'c')
+        return snprintf(buf, size, spec, entry->args[n].i);
+      return snprintf(buf, size, spec, (int) entry->args[n].i);
+
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+      if (type == LOG_ARG_STR || type == LOG_ARG_PTR)
+        return snprintf(buf, size, "?");
+      spec[speclen++] = conv;
+      spec[speclen] = '\0';
+      if (type == LOG_ARG_DOUBLE)
+        return snprintf(buf, size, spec, entry->args[n].d);
+      if (type == LOG_ARG_UINT || type == LOG_ARG_UINT64)
+        return snprintf(buf, size, spec, (double) entry->args[n].u);
+      return snprintf(buf, size, spec, (double) entry->args[n].i);
+
+    case 'p':
+      return snprintf(buf, size, "%p", entry->args[n].p);
+  }
+  return snprintf(buf, size, "?");
+}
+
+/*
+   format an entry into the buffer
+
+   the format is parsed here, each conversion is formatted on its own with the
+   length modifier matching the stored type of the argument
+*/
+static int LogFormat(char *buf, int size, const LOG_ENTRY_T *entry)
+{
+  int len = 0;
+  int arg = 0;
+
+  for (const char *p = entry->fmt; *p && len < size - 1; p++) {
+    if (*p != '%') {
+      buf[len++] = *p;
+      continue;
+    }
+    if (p[1] == '%') {
+      buf[len++] = '%';
+      p++;
+      continue;
+    }
+
+    /*
+       copy flags, width and precision, skip the length modifiers
+    */
+    char spec[16];
+    int speclen = 0;
+    const char *q = p + 1;
+
+    spec[speclen++] = '%';
+    while (*q && strchr("-+ #0123456789.", *q) && speclen < (int) sizeof(spec) - 4)
+      spec[speclen++] = *q++;
+    while (*q && strchr("hlLzjt", *q))
+      q++;
+    if (!*q)
+      break;
+    p = q;
+
+    int written = (arg < entry->nargs) ?
+                  LogFormatArg(&buf[len], size - len, spec, speclen, *q, entry, arg++) :
+                  snprintf(&buf[len], size - len, "?");
+    if (written > 0)
+      len += MIN(written, size - len - 1);
+  }
+  buf[len] = '\0';
+  return len;
+}
+
+/*
+   format and print the timestamp of a local time -- the uptime until the NTP time is synchronized
+*/
+static void LogPrintTime(int64_t local_us)
+{
+  uint64_t time_us = NtpLocalToTimeUs(local_us);
+  char buffer[32];
+
+  if (!time_us)
+    time_us = local_us;
+  time_t t = time_us / 1000000 + (long) _config.ntp.timezone * SECS_PER_HOUR;
+  struct tm tm;
+
+  gmtime_r(&t, &tm);
+  int len = strftime(buffer, sizeof(buffer), "%H:%M:%S", &tm);
+  len += snprintf(&buffer[len], sizeof(buffer) - len, ".%03u", (unsigned) (time_us / 1000 % 1000));
+  strftime(&buffer[len], sizeof(buffer) - len, " %d.%m.%Y: ", &tm);
+  Serial.print(buffer);
+}
+
+/*
+   format and print all pending messages
+*/
+void LogFlush(void)
+{
+  static char line[LOG_LINE_SIZE];
+
+  std::lock_guard<std::mutex> lock(_log_drain_mutex);
+
+  for (;;) {
+    LOG_ENTRY_T *entry = &_log_ring[_log_tail & (LOG_RING_SIZE - 1)];
+
+    if (entry->seq.load(std::memory_order_acquire) != LogRound(_log_tail) + 1)
+      break;
+
+    LogFormat(line, sizeof(line), entry);
+    if (Serial) {
+      LogPrintTime(entry->local_us);
+      Serial.println(line);
+    }
+
+    /*
+       free the entry for the next round
+    */
+    entry->seq.store(LogRound(_log_tail) + LOG_RING_SIZE, std::memory_order_release);
+    _log_tail++;
+  }
+
+  unsigned long dropped = _log_dropped.load();
+  if (dropped != _log_dropped_reported && Serial) {
+    snprintf(line, sizeof(line), "LOG: %lu messages dropped", dropped - _log_dropped_reported);
+    Serial.println(line);
+    _log_dropped_reported = dropped;
+  }
+}
+
+#if defined(ESP32)
+/*
+   the formatting task
+*/
+static void LogTask(void *arg)
+{
+  for (;;) {
+    LogFlush();
+    vTaskDelay(pdMS_TO_TICKS(LOG_TASK_INTERVAL));
+  }
+}
+#endif
+
+/*
+   setup the logger
+*/
+void LogSetup(void)
+{
+#if defined(ESP32)
+  xTaskCreate(LogTask, "log", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY, NULL);
+#endif
+}
+
+/*
+   get the number of written and dropped messages
+*/
+void LogStats(unsigned long *written, unsigned long *dropped)
+{
+  if (written)
+    *written = _log_written.load();
+  if (dropped)
+    *dropped = _log_dropped.load();
+}
+
+/**/
@@ -0,0 +1,230 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module to handle the log messages
+
+  Messages are not formatted by the caller. The format pointer and the raw
+  arguments are stored in a lock-free ring and formatted later by a low
+  priority task, so logging from the BLE callback or the publish path
+  doesn't cost more than a few copies.
+
+  An entry is stamped with the local time (NtpLocalUs(), esp_timer), which
+  takes no lock -- the task formatting it converts it into the NTP time.
+
+  NOTE: the format must be a string literal, as only its pointer is stored.
+        Strings passed for %s are copied into the ring.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __LOGGER_H__
+#define __LOGGER_H__ 1
+
+#include <atomic>
+#include <type_traits>
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+
+/*
+   log levels
+*/
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+/*
+   log modules -- every source file defines LOG_MODULE before its includes
+*/
+#define LOG_MODULE_MAIN       (1 << 0)
+#define LOG_MODULE_BT         (1 << 1)
+#define LOG_MODULE_CFG        (1 << 2)
+#define LOG_MODULE_HTTP       (1 << 3)
+#define LOG_MODULE_LED        (1 << 4)
+#define LOG_MODULE_NTP        (1 << 5)
+#define LOG_MODULE_SCANDEV    (1 << 6)
+#define LOG_MODULE_STATE      (1 << 7)
+#define LOG_MODULE_UTIL       (1 << 8)
+#define LOG_MODULE_WIFI       (1 << 9)
+#define LOG_MODULE_MQTT       (1 << 10)
+#define LOG_MODULE_WATCHDOG   (1 << 11)
+#define LOG_MODULE_OTA        (1 << 12)
+#define LOG_MODULE_HISTORY    (1 << 13)
+#define LOG_MODULE_ALL        0xffff
+
+#ifndef LOG_MODULE
+#define LOG_MODULE          LOG_MODULE_MAIN
+#endif
+
+/*
+   compile time filter -- disabled calls are removed completely
+*/
+#define LOG_ENABLED(level,module)   ((level) <= LOG_LEVEL && ((LOG_MODULES) & (module)))
+#define LOG_AT(level,...)           do { if (LOG_ENABLED(level, LOG_MODULE)) LogWrite(level, LOG_MODULE, __VA_ARGS__); } while (0)
+
+#define LogErr(...)   LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LogWarn(...)  LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LogMsg(...)   LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define DbgMsg(...)   LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+/*
+   size of the ring and of its entries
+*/
+#define LOG_RING_SIZE       32      // must be a power of two
+#define LOG_ARGS_MAX        8
+#define LOG_STRINGS_SIZE    128
+#define LOG_LINE_SIZE       256
+
+/*
+   priority and stack size of the formatting task
+*/
+#define LOG_TASK_PRIORITY   1
+#define LOG_TASK_STACK      4096
+#define LOG_TASK_INTERVAL   10      // ms
+
+/*
+   types of the stored arguments
+*/
+enum LOG_ARG {
+  LOG_ARG_INT,
+  LOG_ARG_UINT,
+  LOG_ARG_INT64,
+  LOG_ARG_UINT64,
+  LOG_ARG_DOUBLE,
+  LOG_ARG_STR,
+  LOG_ARG_PTR,
+};
+
+/*
+   an entry in the ring
+*/
+typedef struct _log_entry {
+  std::atomic<uint32_t> seq;
+  const char *fmt;
+  int64_t local_us;             // NtpLocalUs() of the call
+  uint8_t level;
+  uint8_t nargs;
+  uint8_t strings_used;
+  uint8_t types[LOG_ARGS_MAX];
+  union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    const void *p;
+  } args[LOG_ARGS_MAX];
+  char strings[LOG_STRINGS_SIZE];
+} LOG_ENTRY_T;
+
+/*
+   reserve an entry in the ring, NULL if the ring is full (the message is counted as dropped)
+*/
+LOG_ENTRY_T *LogReserve(int level, int module, const char *fmt);
+
+/*
+   hand over a reserved entry to the formatting task
+*/
+void LogCommit(LOG_ENTRY_T *entry);
+
+/*
+   store the arguments
+*/
+static inline void LogArg(LOG_ENTRY_T *entry, const char *str)
+{
+  if (entry->nargs >= LOG_ARGS_MAX)
+    return;
+
+  int n = entry->nargs++;
+  int avail = LOG_STRINGS_SIZE - entry->strings_used;
+
+  entry->types[n] = LOG_ARG_STR;
+  entry->args[n].i = -1;
+  if (!str || avail <= 0)
+    return;
+
+  int len = strnlen(str, avail - 1);
+  memcpy(&entry->strings[entry->strings_used], str, len);
+  entry->strings[entry->strings_used + len] = '\0';
+  entry->args[n].i = entry->strings_used;
+  entry->strings_used += len + 1;
+}
+
+static inline void LogArg(LOG_ENTRY_T *entry, char *str)
+{
+  LogArg(entry, (const char *) str);
+}
+
+static inline void LogArg(LOG_ENTRY_T *entry, double value)
+{
+  if (entry->nargs >= LOG_ARGS_MAX)
+    return;
+  entry->types[entry->nargs] = LOG_ARG_DOUBLE;
+  entry->args[entry->nargs++].d = value;
+}
+
+template<typename T>
+static inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type LogArg(LOG_ENTRY_T *entry, T value)
+{
+  if (entry->nargs >= LOG_ARGS_MAX)
+    return;
+
+  bool wide = sizeof(T) > sizeof(int32_t);
+
+  if (std::is_signed<T>::value || std::is_enum<T>::value) {
+    entry->types[entry->nargs] = (wide) ? LOG_ARG_INT64 : LOG_ARG_INT;
+    entry->args[entry->nargs++].i = (int64_t) value;
+  }
+  else {
+    entry->types[entry->nargs] = (wide) ? LOG_ARG_UINT64 : LOG_ARG_UINT;
+    entry->args[entry->nargs++].u = (uint64_t) value;
+  }
+}
+
+template<typename T>
+static inline void LogArg(LOG_ENTRY_T *entry, T *ptr)
+{
+  if (entry->nargs >= LOG_ARGS_MAX)
+    return;
+  entry->types[entry->nargs] = LOG_ARG_PTR;
+  entry->args[entry->nargs++].p = (const void *) ptr;
+}
+
+/*
+   write a log message
+*/
+template<typename... Args>
+static inline void LogWrite(int level, int module, const char *fmt, Args... args)
+{
+  LOG_ENTRY_T *entry = LogReserve(level, module, fmt);
+
+  if (!entry)
+    return;
+  (LogArg(entry, args), ...);
+  LogCommit(entry);
+}
+
+/*
+   setup the logger -- starts the formatting task
+*/
+void LogSetup(void);
+
+/*
+   format and print all pending messages in the context of the caller -- a
+   drain in progress of the log task is waited for, so no message written
+   before is left behind (eg. before a restart)
+*/
+void LogFlush(void);
+
+/*
+   get the number of written and dropped messages
+*/
+void LogStats(unsigned long *written, unsigned long *dropped);
+
+#endif
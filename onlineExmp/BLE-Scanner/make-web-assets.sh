@@ -0,0 +1,103 @@
+#!/bin/bash
+#
+#	this script embeds the static assets of the web interface (web/*)
+#	gzip compressed as PROGMEM arrays into webAssets.h
+#
+#	Run it after a change in web/ and commit webAssets.h with it:
+#
+#	./make-web-assets.sh [<sketch directory>]
+#
+#	The ETag of an asset is a hash of its content. The HTML pages are
+#	revalidated on every request, they refer to the other assets with
+#	their hash (@<file name>@ in the HTML is replaced by it), so these
+#	are cached for a year.
+#
+#	index.html is the main page at /, the other pages are served
+#	without the extension (info.html at /info) -- they are shells which
+#	load their data from the JSON API.
+#
+
+DIR=${1:-$( dirname "$0" )}
+OUT=$DIR/webAssets.h
+TMP=$( mktemp -d )
+trap "rm -rf $TMP" EXIT
+
+declare -A HASH
+FILES="$( ls $DIR/web/* | grep -v '\.html$' ) $( ls $DIR/web/*.html )"
+
+# the referenced assets first, then the HTML with the references replaced
+for FILE in $FILES; do
+	NAME=$( basename $FILE )
+	cp $FILE $TMP/$NAME
+	for REF in "${!HASH[@]}"; do
+		sed -i "s/@$REF@/${HASH[$REF]}/g" $TMP/$NAME
+	done
+	HASH[$NAME]=$( sha1sum <$TMP/$NAME | cut -c1-16 )
+	gzip -9 -n -c $TMP/$NAME >$TMP/$NAME.gz
+done
+
+{
+	cat <<EOM
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  the static assets of the web interface -- generated by make-web-assets.sh
+  from web/, don't edit
+
+*/
+
+#ifndef __WEB_ASSETS_H__
+#define __WEB_ASSETS_H__ 1
+
+typedef struct _web_asset {
+  const char *path;
+  const char *type;
+  const char *etag;
+  const char *cache_control;
+  const uint8_t *data;        // gzip compressed
+  size_t length;
+} WEB_ASSET_T;
+
+EOM
+
+	for FILE in $FILES; do
+		NAME=$( basename $FILE )
+		ID=$( echo $NAME | tr -c 'a-zA-Z0-9\n' '_' )
+		echo "#define WEB_ASSET_$( echo $ID | tr a-z A-Z )_VERSION \"${HASH[$NAME]}\""
+		echo "static const uint8_t _web_asset_$ID[] PROGMEM = {"
+		od -An -v -tx1 $TMP/$NAME.gz | sed -e 's/ \([0-9a-f][0-9a-f]\)/0x\1, /g' -e 's/^/ /' -e 's/, $/,/'
+		echo "};"
+		echo
+	done
+
+	echo "static const WEB_ASSET_T _web_assets[] = {"
+	for FILE in $FILES; do
+		NAME=$( basename $FILE )
+		ID=$( echo $NAME | tr -c 'a-zA-Z0-9\n' '_' )
+		case $NAME in
+			*.css)  TYPE="text/css" ;;
+			*.js)   TYPE="application/javascript" ;;
+			*.html) TYPE="text/html" ;;
+			*.svg)  TYPE="image/svg+xml" ;;
+			*)      TYPE="application/octet-stream" ;;
+		esac
+		case $NAME in
+			index.html) URI="/" ;;
+			*.html)     URI="/${NAME%.html}" ;;
+			*)          URI="/$NAME" ;;
+		esac
+		case $NAME in
+			*.html) CACHE="no-cache" ;;
+			*)      CACHE="public, max-age=31536000, immutable" ;;
+		esac
+		echo "  { \"$URI\", \"$TYPE\", \"\\\"${HASH[$NAME]}\\\"\", \"$CACHE\", _web_asset_$ID, sizeof(_web_asset_$ID) },"
+		echo "$NAME: $( wc -c <$FILE ) bytes, $( wc -c <$TMP/$NAME.gz ) compressed" >&2
+	done
+	cat <<EOM
+};
+
+#endif
+
+/**/
+EOM
+} >$OUT
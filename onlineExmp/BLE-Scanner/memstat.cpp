@@ -0,0 +1,251 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module for the heap and allocation statistics
+
+  The counters are updated from the allocator, possibly in any task, so
+  they are atomic and nothing in here may allocate or log.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_MAIN
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include "config.h"
+#include "memstat.h"
+#include "util.h"
+#if defined(ESP32) && defined(CONFIG_HEAP_USE_HOOKS)
+#include <esp_heap_caps.h>
+#endif
+
+/*
+   the subsystem of the running code, per task
+*/
+static thread_local int _memstat_subsystem = MEMSTAT_OTHER;
+
+/*
+   the counters
+*/
+static std::atomic<unsigned long> _memstat_allocs[MEMSTAT_SUBSYSTEMS];
+static std::atomic<unsigned long> _memstat_frees[MEMSTAT_SUBSYSTEMS];
+static std::atomic<unsigned long> _memstat_bytes[MEMSTAT_SUBSYSTEMS];
+
+static const char *_memstat_names[MEMSTAT_SUBSYSTEMS] = {
+  "other", "bt", "scandev", "mqtt", "http", "ntp", "wifi",
+};
+
+/*
+   the samples of the heap
+*/
+static uint32_t _memstat_min_largest = UINT32_MAX;
+static unsigned long _memstat_last_sample = 0;
+
+/*
+   the scope
+*/
+MemStatScope::MemStatScope(int subsystem)
+{
+  _previous = _memstat_subsystem;
+  _memstat_subsystem = subsystem;
+}
+
+MemStatScope::~MemStatScope()
+{
+  _memstat_subsystem = _previous;
+}
+
+/*
+   count an allocation/free
+*/
+static inline void MemStatCountAlloc(size_t size)
+{
+  int subsystem = _memstat_subsystem;
+
+  _memstat_allocs[subsystem].fetch_add(1, std::memory_order_relaxed);
+  _memstat_bytes[subsystem].fetch_add(size, std::memory_order_relaxed);
+}
+
+static inline void MemStatCountFree(void)
+{
+  _memstat_frees[_memstat_subsystem].fetch_add(1, std::memory_order_relaxed);
+}
+
+#if defined(ESP32) && defined(CONFIG_HEAP_USE_HOOKS)
+/*
+   the hooks of the IDF heap
+*/
+extern "C" void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+  MemStatCountAlloc(size);
+}
+
+extern "C" void esp_heap_trace_free_hook(void *ptr)
+{
+  MemStatCountFree();
+}
+#elif !defined(ESP32) && defined(__GLIBC__)
+/*
+   the host replaces the allocator of the C library, which new/delete use
+   as well -- like the hooks of the IDF every malloc() is seen, the buffer
+   of a String too; a realloc() is a free and an allocation
+*/
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+extern "C" void *malloc(size_t size)
+{
+  void *ptr = __libc_malloc(size);
+
+  if (ptr)
+    MemStatCountAlloc(size);
+  return ptr;
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+  void *ptr = __libc_calloc(count, size);
+
+  if (ptr)
+    MemStatCountAlloc(count * size);
+  return ptr;
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+  void *resized = __libc_realloc(ptr, size);
+
+  if (ptr && (resized || !size))
+    MemStatCountFree();
+  if (resized)
+    MemStatCountAlloc(size);
+  return resized;
+}
+
+extern "C" void free(void *ptr)
+{
+  if (ptr)
+    MemStatCountFree();
+  __libc_free(ptr);
+}
+#else
+/*
+   new/delete -- without the hooks of the IDF (the prebuilt libraries of
+   the Arduino core don't enable them) malloc() and the buffers of String
+   are not seen
+*/
+static void *MemStatNew(size_t size, bool nothrow)
+{
+  void *ptr = malloc((size) ? size : 1);
+
+  if (!ptr) {
+    if (nothrow)
+      return NULL;
+#if __cpp_exceptions
+    throw std::bad_alloc();
+#else
+    abort();
+#endif
+  }
+  MemStatCountAlloc(size);
+  return ptr;
+}
+
+static void MemStatDelete(void *ptr)
+{
+  if (ptr) {
+    MemStatCountFree();
+    free(ptr);
+  }
+}
+
+void *operator new(size_t size) { return MemStatNew(size, false); }
+void *operator new[](size_t size) { return MemStatNew(size, false); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return MemStatNew(size, true); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return MemStatNew(size, true); }
+void operator delete(void *ptr) noexcept { MemStatDelete(ptr); }
+void operator delete[](void *ptr) noexcept { MemStatDelete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { MemStatDelete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { MemStatDelete(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { MemStatDelete(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { MemStatDelete(ptr); }
+#endif
+
+/*
+   setup
+*/
+void MemStatSetup(void)
+{
+  MemStatUpdate();
+}
+
+/*
+   sample the heap -- the minimum of the largest block is only as good as the sampling
+*/
+void MemStatUpdate(void)
+{
+  if (_memstat_last_sample && millis() - _memstat_last_sample < MEMSTAT_SAMPLE_INTERVAL)
+    return;
+  _memstat_last_sample = millis();
+
+  _memstat_min_largest = MIN(_memstat_min_largest, ESP.getMaxAllocHeap());
+}
+
+/*
+   get the name of a subsystem
+*/
+const char *MemStatName(int subsystem)
+{
+  return (subsystem >= 0 && subsystem < MEMSTAT_SUBSYSTEMS) ? _memstat_names[subsystem] : "?";
+}
+
+/*
+   get the allocations of a subsystem
+*/
+void MemStatAllocs(int subsystem, MEMSTAT_ALLOCS_T *allocs)
+{
+  if (subsystem < 0 || subsystem >= MEMSTAT_SUBSYSTEMS) {
+    *allocs = MEMSTAT_ALLOCS_T();
+    return;
+  }
+  allocs->allocs = _memstat_allocs[subsystem].load();
+  allocs->frees = _memstat_frees[subsystem].load();
+  allocs->bytes = _memstat_bytes[subsystem].load();
+}
+
+/*
+   reset the allocation counters
+*/
+void MemStatReset(void)
+{
+  for (int n = 0; n < MEMSTAT_SUBSYSTEMS; n++) {
+    _memstat_allocs[n] = 0;
+    _memstat_frees[n] = 0;
+    _memstat_bytes[n] = 0;
+  }
+}
+
+/*
+   get the heap
+*/
+void MemStatHeap(MEMSTAT_HEAP_T *heap)
+{
+  heap->size = ESP.getHeapSize();
+  heap->free = ESP.getFreeHeap();
+  heap->min_free = ESP.getMinFreeHeap();
+  heap->largest = ESP.getMaxAllocHeap();
+  heap->min_largest = MIN(_memstat_min_largest, heap->largest);
+  heap->fragmentation = (heap->free) ? 100 - (int) ((uint64_t) heap->largest * 100 / heap->free) : 0;
+}
+
+/**/
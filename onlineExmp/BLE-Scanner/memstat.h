@@ -0,0 +1,120 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module for the heap and allocation statistics
+
+  Every allocation is counted for the subsystem which is running when it
+  happens -- a subsystem marks its code with MEMSTAT_SCOPE(), everything
+  outside of a scope is counted as MEMSTAT_OTHER. In steady state the scan
+  callback, the machine table and the MQTT publishing must not allocate,
+  host/alloccheck.cpp verifies this.
+
+  On the ESP32 the allocations are counted by the heap hooks of the IDF
+  (CONFIG_HEAP_USE_HOOKS), which see malloc(), String and new alike.
+  Without the hooks -- the prebuilt libraries of the Arduino core don't
+  enable them -- only new/delete are counted, an allocation by malloc()
+  or of the buffer of a String is missed. The host replaces malloc()
+  itself and its String shim allocates where the one of the ESP32 does
+  (no small string optimization beyond its 10 characters), so the
+  allocation check of the host covers them.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __MEMSTAT_H__
+#define __MEMSTAT_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+   the subsystems
+*/
+#define MEMSTAT_OTHER           0
+#define MEMSTAT_BT              1
+#define MEMSTAT_SCANDEV         2
+#define MEMSTAT_MQTT            3
+#define MEMSTAT_HTTP            4
+#define MEMSTAT_NTP             5
+#define MEMSTAT_WIFI            6
+#define MEMSTAT_SUBSYSTEMS      7
+
+/*
+   the heap is sampled every ... ms
+*/
+#define MEMSTAT_SAMPLE_INTERVAL 1000
+
+/*
+   allocations of a subsystem -- frees are counted for the subsystem
+   which frees the memory, not for the one which allocated it
+*/
+typedef struct _memstat_allocs {
+  unsigned long allocs;
+  unsigned long frees;
+  unsigned long bytes;      // allocated
+} MEMSTAT_ALLOCS_T;
+
+/*
+   the heap
+*/
+typedef struct _memstat_heap {
+  uint32_t size;
+  uint32_t free;
+  uint32_t min_free;        // since the start
+  uint32_t largest;         // largest free block
+  uint32_t min_largest;     // since the start, of the samples
+  int fragmentation;        // in %, 100 - largest / free
+} MEMSTAT_HEAP_T;
+
+/*
+   the subsystem of the running code -- restores the previous one at the end of the scope
+*/
+class MemStatScope {
+  public:
+    MemStatScope(int subsystem);
+    ~MemStatScope();
+  private:
+    int _previous;
+};
+
+#define MEMSTAT_SCOPE(subsystem)  MemStatScope _memstat_scope(subsystem)
+
+/*
+   setup
+*/
+void MemStatSetup(void);
+
+/*
+   sample the heap
+*/
+void MemStatUpdate(void);
+
+/*
+   get the name of a subsystem
+*/
+const char *MemStatName(int subsystem);
+
+/*
+   get the allocations of a subsystem
+*/
+void MemStatAllocs(int subsystem, MEMSTAT_ALLOCS_T *allocs);
+
+/*
+   reset the allocation counters
+*/
+void MemStatReset(void);
+
+/*
+   get the heap
+*/
+void MemStatHeap(MEMSTAT_HEAP_T *heap);
+
+#endif
+
+/**/
@@ -12,11 +12,16 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_MQTT
+
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include "config.h"
+#include "wifiHandler.h"
 #include "mqtt.h"
 #include "util.h"
+#include "ntp.h"
+#include "memstat.h"
 #include "state.h"
 
 // WiFi client for MQTT (non-secure for lightweight operation)
@@ -30,12 +35,6 @@ static bool _connected = false;
 static unsigned long _lastConnectAttempt = 0;
 static unsigned long _lastPublish = 0;
 
-// Reconnect interval (ms)
-#define MQTT_RECONNECT_INTERVAL 5000
-
-// Topic prefix
-#define MQTT_TOPIC_PREFIX "laundry/machines/"
-
 /*
    MQTT callback (not used for this publish-only client)
 */
@@ -54,8 +53,16 @@ static bool mqttConnect()
     return true;
   }
 
+  /*
+     don't block on the broker while the WiFi is down
+  */
+  if (!WifiIsConnected()) {
+    return false;
+  }
+
   unsigned long now = millis();
-  if (now - _lastConnectAttempt < MQTT_RECONNECT_INTERVAL) {
+  // the first attempt is not delayed, even if we are just booted
+  if (_lastConnectAttempt && now - _lastConnectAttempt < MQTT_RECONNECT_INTERVAL) {
     return false;
   }
   _lastConnectAttempt = now;
@@ -110,6 +117,8 @@ void MqttSetup(void)
 */
 void MqttUpdate(void)
 {
+  MEMSTAT_SCOPE(MEMSTAT_MQTT);
+
   if (StateCheck(STATE_CONFIGURING))
     return;
 
@@ -123,11 +132,38 @@ void MqttUpdate(void)
   _mqttClient.loop();
 }
 
+/*
+   Build topic and JSON payload of a machine status message
+*/
+bool MqttBuildMachineStatus(char* topic, size_t topic_size, char* payload, size_t payload_size,
+                            const char* machineId, bool running, bool empty,
+                            uint64_t observed_us, uint64_t published_us)
+{
+  // Build topic: laundry/machines/{machineId}/status
+  int topic_len = snprintf(topic, topic_size, MQTT_TOPIC_PREFIX "%s/status", machineId);
+
+  // Build JSON payload (room mapping is done on backend)
+  // observedUs/publishedUs are epoch micro seconds, 0 if the clock is not synced yet
+  int payload_len = snprintf(payload, payload_size,
+                             "{\"machineId\":\"%s\",\"running\":%s,\"empty\":%s,\"observedUs\":%llu,\"publishedUs\":%llu}",
+                             machineId,
+                             running ? "true" : "false",
+                             empty ? "true" : "false",
+                             (unsigned long long) observed_us,
+                             (unsigned long long) published_us);
+
+  return topic_len > 0 && topic_len < (int) topic_size &&
+         payload_len > 0 && payload_len < (int) payload_size;
+}
+
 /*
    Publish machine status to MQTT broker
 */
-bool MqttPublishMachineStatus(const char* machineId, const char* roomName, bool running, bool empty)
+bool MqttPublishMachineStatus(const char* machineId, const char* roomName, bool running, bool empty,
+                              uint64_t observed_us)
 {
+  MEMSTAT_SCOPE(MEMSTAT_MQTT);
+
   if (!_mqttClient.connected()) {
     LogMsg("MQTT: Not connected, cannot publish");
     if (!mqttConnect()) {
@@ -135,25 +171,19 @@ bool MqttPublishMachineStatus(const char* machineId, const char* roomName, bool
     }
   }
 
-  // Build topic: laundry/machines/{machineId}/status
-  String topic = String(MQTT_TOPIC_PREFIX) + machineId + "/status";
+  char topic[MQTT_TOPIC_SIZE];
+  char payload[MQTT_PAYLOAD_SIZE];
 
-  // Build JSON payload (room mapping is done on backend)
-  String payload = "{";
-  payload += "\"machineId\":\"";
-  payload += machineId;
-  payload += "\",\"running\":";
-  payload += running ? "true" : "false";
-  payload += ",\"empty\":";
-  payload += empty ? "true" : "false";
-  payload += ",\"timestamp\":";
-  payload += String(millis());
-  payload += "}";
-
-  LogMsg("MQTT: Publishing to %s", topic.c_str());
-  LogMsg("MQTT: Payload: %s", payload.c_str());
-
-  bool success = _mqttClient.publish(topic.c_str(), payload.c_str(), false);
+  if (!MqttBuildMachineStatus(topic, sizeof(topic), payload, sizeof(payload),
+                              machineId, running, empty, observed_us, NtpGetTimeUs())) {
+    LogMsg("MQTT: Message for %s too long, cannot publish", machineId);
+    return false;
+  }
+
+  LogMsg("MQTT: Publishing to %s", topic);
+  LogMsg("MQTT: Payload: %s", payload);
+
+  bool success = _mqttClient.publish(topic, payload, false);
 
   if (success) {
     _lastPublish = millis();
@@ -15,8 +15,26 @@
 #ifndef __MQTT_H__
 #define __MQTT_H__ 1
 
+#include <stddef.h>
+#include <stdint.h>
 #include "config.h"
 
+/*
+   Topic prefix
+*/
+#define MQTT_TOPIC_PREFIX "laundry/machines/"
+
+/*
+   Reconnect interval (ms)
+*/
+#define MQTT_RECONNECT_INTERVAL 5000
+
+/*
+   Buffer sizes for a machine status message
+*/
+#define MQTT_TOPIC_SIZE   (sizeof(MQTT_TOPIC_PREFIX) + MACHINE_ID_MAX_LEN + sizeof("/status"))
+#define MQTT_PAYLOAD_SIZE 160
+
 /*
    Initialize the MQTT client
 */
@@ -29,9 +47,19 @@ void MqttUpdate(void);
 
 /*
    Publish machine status to MQTT broker
+   observed_us is the epoch time in us when the state was first seen (0 if unknown)
    Returns true if successful
 */
-bool MqttPublishMachineStatus(const char* machineId, const char* roomName, bool running, bool empty);
+bool MqttPublishMachineStatus(const char* machineId, const char* roomName, bool running, bool empty,
+                              uint64_t observed_us);
+
+/*
+   Build topic and JSON payload of a machine status message into the given buffers
+   Returns false if the buffers are too small
+*/
+bool MqttBuildMachineStatus(char* topic, size_t topic_size, char* payload, size_t payload_size,
+                            const char* machineId, bool running, bool empty,
+                            uint64_t observed_us, uint64_t published_us);
 
 /*
    Check if MQTT is connected
@@ -25,10 +25,17 @@
   see https://tools.ietf.org/rfc/rfc5905 for the NTP protocol reference.
 */
 
+#define LOG_MODULE  LOG_MODULE_NTP
+
+#include <atomic>
 #include "config.h"
 #include "wifiHandler.h"
 #include "ntp.h"
+#include "memstat.h"
 #include "util.h"
+#if defined(ESP32)
+#include <esp_timer.h>
+#endif
 
 /*
    NTP configuration
@@ -41,20 +48,86 @@ static CONFIG_NTP_T _config_ntp;
 */
 #define NTP_PACKET_SIZE 48
 
+/*
+**  offsets of the fields in the NTP packet
+*/
+#define NTP_OFFSET_STRATUM    1
+#define NTP_OFFSET_ORIGIN     24
+#define NTP_OFFSET_RECEIVE    32
+#define NTP_OFFSET_TRANSMIT   40
+
+/*
+**  seconds between Jan 1 1900 and Jan 1 1970
+**
+**  the offset is 70 y * ~365.242857142 d * 24 h * 60 m * 60 s
+*/
+#define NTP_UNIX_OFFSET       2208988800ULL
+
 /*
 **  NTP packet buffer
 */
 static byte _packetBuffer[NTP_PACKET_SIZE];
 
+/*
+   the servers to query
+*/
+typedef struct {
+  const char *name;
+  IPAddress ip;
+  bool resolved;
+  unsigned long lookup;   // time of the last lookup
+  bool pending;           // waiting for the reply of the current round
+  uint64_t sent;          // our transmit timestamp in NTP format, echoed in the reply
+} NTP_SERVER_T;
+
+static char _ntp_names[sizeof(_config_ntp.server)];
+static NTP_SERVER_T _ntp_servers[NTP_SERVERS_MAX];
+static int _ntp_server_count = 0;
+
+/*
+   the best sample of the current round
+*/
+static int _round_best = -1;
+static int64_t _round_offset = 0;
+static int64_t _round_delay = 0;
+static bool _round_active = false;
+static unsigned long _round_start = 0;
+static int64_t _round_poll = 0;       // local time of the last poll for the replies
+static unsigned long _round_interval = 0;
+
+/*
+   the disciplined clock
+
+   the time is base_epoch at the local time base_local, a pending
+   correction slew is applied with NTP_SLEW_RATE_PPM starting at slew_start
+
+   the clock is read by every task and rebased only by the loop, without a
+   lock: the loop writes the next correction into the other of two slots
+   and publishes it by _clk_seq -- a reader copies the slot of the sequence
+   and takes it if the sequence didn't move meanwhile, so it never waits
+   for the loop and never sees the base of one correction with the slew of
+   another (it only reads again if the clock was rebased during the copy)
+*/
+typedef struct {
+  int64_t base_epoch;
+  int64_t base_local;
+  int64_t slew;
+  int64_t slew_start;
+  bool synced;
+} NTP_CLOCK_T;
+
+static NTP_CLOCK_T _clk[2];
+static std::atomic<uint32_t> _clk_seq(0);
+
 /*
    some NTP configuration
 */
-static String _ntp_server = "";
-static IPAddress _ntp_ip(0, 0, 0, 0);
 static unsigned long _first_sync = 0;
 static unsigned long _last_sync = 0;
 static unsigned long _last_request = 0;
-static long _last_correction = 0;
+static int64_t _last_offset = 0;
+static int64_t _last_delay = 0;
+static const char *_last_server = "";
 
 /*
     some NTP statistics
@@ -63,126 +136,349 @@ static int _ntp_requests = 0;
 static int _ntp_replies_total = 0;
 static int _ntp_replies_good = 0;
 
-#if DBG_NTP
-static bool _ntp_received = false;
-#endif
-
 /*
 **  UDP instance to let us send and receive packets
 */
 static WiFiUDP _Udp;
 
 /*
-**  send an NTP request to the time server at the given address
-**
-**  NOTE: function is called asynchronous, so don't use LogMsg or Serial!
+**  get the local monotonic time in micro seconds
 */
-static void NtpSendRequest(void)
+int64_t NtpLocalUs(void)
 {
-  if (!_last_request || (millis() - _last_request > NTP_SYNC_INTERVAL * 1000) || millis() < _last_request) {
-    _last_request = millis();
-#if DBG_NTP
-    _ntp_received = false;
+#if defined(ESP32)
+  return esp_timer_get_time();
+#else
+  /*
+  **  without tasks -- the 32 bit micros() is extended by the caller only
+  */
+  static uint32_t last = 0;
+  static int64_t high = 0;
+  uint32_t us = micros();
+
+  if (us < last)
+    high += 1LL << 32;
+  last = us;
+  return high + us;
 #endif
-    memset(_packetBuffer, 0, NTP_PACKET_SIZE);
+}
 
-    _packetBuffer[0] = 0b11100011;// LI=3 (clock unsynchronized, 2 bit), Version=4 (3 bit), Mode=3 (=client, 3 bit)
-    _packetBuffer[1] = 0;         // Stratum, or type of clock
-    _packetBuffer[2] = NTP_POLL;  // Polling Interval
-    _packetBuffer[3] = 0xec;      // Peer Clock Precision=-20 (2 ^ -20 = ~ 1 microsecond)
-    // 8 bytes of zero for Root Delay & Root Dispersion
-    _packetBuffer[12]  = '1';
-    _packetBuffer[13]  = 'N';
-    _packetBuffer[14]  = '1';
-    _packetBuffer[15]  = '4';
+/*
+**  get a consistent copy of the clock
+*/
+static void NtpClockRead(NTP_CLOCK_T *clock)
+{
+  for (;;) {
+    uint32_t seq = _clk_seq.load(std::memory_order_acquire);
 
-    _Udp.begin(NTP_UDP_LOCAL_PORT);
+    *clock = _clk[seq & 1];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_clk_seq.load(std::memory_order_relaxed) == seq)
+      return;
+  }
+}
 
-    _Udp.beginPacket(_ntp_ip, NTP_UDP_PORT);
-    _Udp.write(_packetBuffer, NTP_PACKET_SIZE);
-    _Udp.endPacket();
+/*
+**  publish the next clock -- by the loop only
+*/
+static void NtpClockWrite(const NTP_CLOCK_T *clock)
+{
+  uint32_t seq = _clk_seq.load(std::memory_order_relaxed);
 
-    _ntp_requests++;
-  }
+  /*
+  **  the slot was the one of the sequence before -- a reader still copying it sees the sequence moved
+  */
+  std::atomic_thread_fence(std::memory_order_release);
+  _clk[(seq + 1) & 1] = *clock;
+  _clk_seq.store(seq + 1, std::memory_order_release);
+}
+
+/*
+**  get the part of the slew which is already applied at the given local time
+*/
+static int64_t NtpSlewApplied(const NTP_CLOCK_T *clock, int64_t local)
+{
+  int64_t slewed = (local - clock->slew_start) * NTP_SLEW_RATE_PPM / 1000000;
+
+  return (clock->slew < 0) ? -MIN(slewed, -clock->slew) : MIN(slewed, clock->slew);
+}
+
+/*
+**  get our clock in micro seconds at the given local time
+*/
+static int64_t NtpClockUs(const NTP_CLOCK_T *clock, int64_t local)
+{
+  return clock->base_epoch + (local - clock->base_local) + NtpSlewApplied(clock, local);
+}
+
+/*
+**  get our clock in micro seconds now
+*/
+static int64_t NtpNowUs(void)
+{
+  NTP_CLOCK_T clock;
+
+  NtpClockRead(&clock);
+  return NtpClockUs(&clock, NtpLocalUs());
+}
+
+/*
+**  convert between our clock in micro seconds and the 64 bit NTP format
+*/
+static uint64_t NtpFromUs(int64_t us)
+{
+  uint64_t secs = us / 1000000 + NTP_UNIX_OFFSET;
+  uint64_t frac = (((uint64_t) (us % 1000000) << 32) + 999999) / 1000000;
+
+  return (secs << 32) | (frac & 0xffffffff);
+}
+
+static int64_t NtpToUs(uint64_t ntp)
+{
+  uint64_t secs = ntp >> 32;
+  uint64_t frac = ntp & 0xffffffff;
+
+  /*
+  **  timestamps with the MSB cleared are in the era after 2036
+  */
+  if (!(secs & 0x80000000))
+    secs += 1ULL << 32;
+
+  return (int64_t) (secs - NTP_UNIX_OFFSET) * 1000000 + (int64_t) ((frac * 1000000) >> 32);
+}
+
+static uint64_t NtpGetField(int offset)
+{
+  uint64_t value = 0;
+
+  for (int n = 0; n < 8; n++)
+    value = (value << 8) | _packetBuffer[offset + n];
+  return value;
+}
+
+static void NtpSetField(int offset, uint64_t value)
+{
+  for (int n = 7; n >= 0; n--, value >>= 8)
+    _packetBuffer[offset + n] = value & 0xff;
+}
+
+/*
+**  send an NTP request to the given server
+*/
+static void NtpSendRequest(NTP_SERVER_T *server)
+{
+  memset(_packetBuffer, 0, NTP_PACKET_SIZE);
+
+  _packetBuffer[0] = 0b11100011;// LI=3 (clock unsynchronized, 2 bit), Version=4 (3 bit), Mode=3 (=client, 3 bit)
+  _packetBuffer[1] = 0;         // Stratum, or type of clock
+  _packetBuffer[2] = NTP_POLL;  // Polling Interval
+  _packetBuffer[3] = 0xec;      // Peer Clock Precision=-20 (2 ^ -20 = ~ 1 microsecond)
+  // 8 bytes of zero for Root Delay & Root Dispersion
+  _packetBuffer[12]  = '1';
+  _packetBuffer[13]  = 'N';
+  _packetBuffer[14]  = '1';
+  _packetBuffer[15]  = '4';
+
+  /*
+  **  our transmit timestamp (T1) is echoed as origin timestamp in the reply
+  */
+  server->sent = NtpFromUs(NtpNowUs());
+  NtpSetField(NTP_OFFSET_TRANSMIT, server->sent);
+
+  _Udp.beginPacket(server->ip, NTP_UDP_PORT);
+  _Udp.write(_packetBuffer, NTP_PACKET_SIZE);
+  _Udp.endPacket();
+
+  server->pending = true;
+  _ntp_requests++;
 }
 
 /*
 **  handle a received NTP reply
 **
-**  NOTE: function is called asynchronous, so don't use LogMsg or Serial!
+**  offset and delay are computed out of the four timestamps as in RFC 5905:
+**
+**    T1 = origin (our request), T2 = receive (server), T3 = transmit (server), T4 = our receive
+**
+**    offset = ((T2 - T1) + (T3 - T4)) / 2
+**    delay  = (T4 - T1) - (T3 - T2)
 */
-static time_t NtpReceiveReply(void)
+static void NtpReceiveReply(int64_t t4, int64_t latency)
 {
+  IPAddress from = _Udp.remoteIP();
+
   /*
   **  read the packet
   */
-  _Udp.read(_packetBuffer, NTP_PACKET_SIZE);
+  int len = _Udp.read(_packetBuffer, NTP_PACKET_SIZE);
   _ntp_replies_total++;
 
+  if (len < NTP_PACKET_SIZE)
+    return;
+
   /*
-  **  if the stratum field is 0, the answer is not what we expect
+  **  find the server we sent the request to
   */
-  if (_packetBuffer[1] == 0)     // Stratum, or type of clock
-    return 0;
+  uint64_t origin = NtpGetField(NTP_OFFSET_ORIGIN);
+  int n;
+
+  for (n = 0; n < _ntp_server_count; n++)
+    if (_ntp_servers[n].pending && _ntp_servers[n].sent == origin && _ntp_servers[n].ip == from)
+      break;
+  if (n >= _ntp_server_count)
+    return;
+  _ntp_servers[n].pending = false;
 
   /*
-  **  NTP time is in seconds since Jan 1 1900
+  **  the reply may have waited for this poll since the previous one -- T4 is that late at most
   */
-  unsigned long highWord = word(_packetBuffer[40], _packetBuffer[41]);
-  unsigned long lowWord = word(_packetBuffer[42], _packetBuffer[43]);
-  unsigned long ntpTime = highWord << 16 | lowWord;
+  if (latency > NTP_MAX_POLL_LATENCY) {
+#if DBG_NTP
+    DbgMsg("NTP: reply from %s dropped, polled %lld us after the previous poll", _ntp_servers[n].name, (long long) latency);
+#endif
+    return;
+  }
 
-  if (!ntpTime)
-    return 0;
+  /*
+  **  check leap indicator (3 = unsynchronized), mode (4 = server) and stratum (0 = kiss of death)
+  */
+  if ((_packetBuffer[0] >> 6) == 3 || (_packetBuffer[0] & 0x07) != 4)
+    return;
+  if (_packetBuffer[NTP_OFFSET_STRATUM] == 0 || _packetBuffer[NTP_OFFSET_STRATUM] > 15)
+    return;
+
+  uint64_t receive = NtpGetField(NTP_OFFSET_RECEIVE);
+  uint64_t transmit = NtpGetField(NTP_OFFSET_TRANSMIT);
+
+  if (!receive || !transmit)
+    return;
+
+  int64_t t1 = NtpToUs(origin);
+  int64_t t2 = NtpToUs(receive);
+  int64_t t3 = NtpToUs(transmit);
+  int64_t offset = ((t2 - t1) + (t3 - t4)) / 2;
+  int64_t delay = (t4 - t1) - (t3 - t2);
+
+#if DBG_NTP
+  DbgMsg("NTP: reply from %s: offset=%lld us  delay=%lld us", _ntp_servers[n].name, (long long) offset, (long long) delay);
+#endif
+
+  if (delay < 0 || delay > NTP_MAX_DELAY)
+    return;
+  _ntp_replies_good++;
 
   /*
-  **  now convert NTP time into UNIX time (seconds since Jan 1 1970)
-  **
-  **  the offset is 70 y * ~365.242857142 d * 24 h * 60 m * 60 s
+  **  the sample with the lowest delay has the lowest error
   */
-  ntpTime -= 2208988800UL;
+  if (_round_best < 0 || delay < _round_delay) {
+    _round_best = n;
+    _round_offset = offset;
+    _round_delay = delay;
+  }
+}
+
+/*
+**  correct our clock by the given offset
+*/
+static void NtpAdjust(int64_t offset)
+{
+  NTP_CLOCK_T clock = _clk[_clk_seq.load(std::memory_order_relaxed) & 1];
+  int64_t local = NtpLocalUs();
 
   /*
-  **  we only accecpt the time, when the delta is below our limit
+  **  rebase the clock to now, including the slew applied so far
   */
-  long delta = ntpTime - now();
-  if (_first_sync) {
+  clock.base_epoch = NtpClockUs(&clock, local);
+  clock.base_local = local;
+  clock.slew_start = local;
+
+  if (!_first_sync || offset > NTP_STEP_THRESHOLD || offset < -NTP_STEP_THRESHOLD) {
+    /*
+    **  step the clock
+    */
+    clock.base_epoch += offset;
+    clock.slew = 0;
+  }
+  else {
     /*
     **  this is an update, so drift the time
     */
-    ntpTime = now() + ((delta < 0) ? -1 : 1) * min((long) NTP_MAX_DRIFT,labs(delta));
+    clock.slew = offset;
   }
-  else
-    _first_sync = ntpTime;
-  _last_sync = ntpTime;
-  _last_correction = ntpTime - now();
-  _ntp_replies_good++;
+  clock.synced = true;
+  NtpClockWrite(&clock);
 
-#if DBG_NTP
-  _ntp_received = true;
-#endif
+  _last_sync = clock.base_epoch / 1000000;
+  if (!_first_sync)
+    _first_sync = _last_sync;
 
-  return ntpTime;
+  setTime(NtpGetTime());
 }
 
 /*
-**  sent an NTP request and wait for the answer
-**
-**  NOTE: function is called asynchronous, so don't use LogMsg or Serial!
-**
-**  NOTE: we will wait for a maximum of 200 * 10ms
+**  start a new query round to all resolved servers
 */
-static time_t NtpSync(void)
+static void NtpStartRound(void)
 {
-  NtpSendRequest();
-
-  for (int retry = 0; retry < 200; retry++) {
-    if (_Udp.parsePacket()) {
-      return NtpReceiveReply();
+  _last_request = millis();
+  _round_start = millis();
+  _round_best = -1;
+  _round_active = false;
+
+  _Udp.begin(NTP_UDP_LOCAL_PORT);
+  _round_poll = NtpLocalUs();
+
+  for (int n = 0; n < _ntp_server_count; n++) {
+    _ntp_servers[n].pending = false;
+    if (_ntp_servers[n].resolved) {
+      NtpSendRequest(&_ntp_servers[n]);
+      _round_active = true;
     }
-    delay(10);
   }
-  return 0;
+}
+
+/*
+**  finish the query round and use the best sample
+*/
+static void NtpFinishRound(void)
+{
+  _round_active = false;
+
+  if (_round_best < 0) {
+    LogMsg("NTP: no valid reply -- retrying in %d seconds", NTP_RETRY_INTERVAL);
+    _round_interval = NTP_RETRY_INTERVAL * 1000;
+
+    /*
+    **  resolve the silent servers again, the pool may have rotated
+    */
+    for (int n = 0; n < _ntp_server_count; n++)
+      if (_ntp_servers[n].pending)
+        _ntp_servers[n].resolved = false;
+    return;
+  }
+
+  _last_offset = _round_offset;
+  _last_delay = _round_delay;
+  _last_server = _ntp_servers[_round_best].name;
+  _round_interval = NTP_SYNC_INTERVAL * 1000UL;
+
+  NtpAdjust(_round_offset);
+
+  /*
+  **  the sign is printed apart, an offset between -1 ms and 0 has no negative milli seconds
+  */
+  LogMsg("NTP: synchronized with %s: offset=%s%ld.%03ld ms  delay=%ld.%03ld ms",
+         _last_server,
+         (_last_offset < 0) ? "-" : "", (long) (llabs(_last_offset) / 1000), (long) (llabs(_last_offset) % 1000),
+         (long) (_last_delay / 1000), (long) (_last_delay % 1000));
+}
+
+/*
+**  provide the time for the Time library
+*/
+static time_t NtpSyncProvider(void)
+{
+  return NtpGetTime();
 }
 
 /*
@@ -201,43 +497,82 @@ void NtpSetup(void)
     LogMsg("NTP: no server configured");
     return;
   }
-  LogMsg("NTP: setting up NTP, server=%s", _config_ntp.server);
+  LogMsg("NTP: setting up NTP, servers=%s", _config_ntp.server);
 
   /*
-     look up the ntpservers ip
+     split the server list -- the names are resolved in NtpUpdate()
   */
-  if (WiFi.hostByName(_config_ntp.server, _ntp_ip)) {
-    /*
-       we could resolve the ntp name
-    */
-#if DBG_NTP
-    DbgMsg("NTP: lookup of %s successful: %s", _config_ntp.server, IPAddressToString(_ntp_ip).c_str());
-#endif
-
-    /*
-        configure the cyclic update via the Time library
-    */
-    setSyncInterval((unsigned int) NTP_SYNC_INTERVAL);
-    setSyncProvider(NtpSync);
-  }
-#if DBG_NTP
-  else {
-    DbgMsg("NTP: lookup of %s failed", _config_ntp.server);
+  strncpy(_ntp_names, _config_ntp.server, sizeof(_ntp_names) - 1);
+  _ntp_server_count = 0;
+  for (char *name = strtok(_ntp_names, " ,"); name && _ntp_server_count < NTP_SERVERS_MAX; name = strtok(NULL, " ,")) {
+    memset(&_ntp_servers[_ntp_server_count], 0, sizeof(NTP_SERVER_T));
+    _ntp_servers[_ntp_server_count++].name = name;
   }
+
+  /*
+      configure the cyclic update via the Time library
+  */
+  setSyncInterval((unsigned int) 60);
+  setSyncProvider(NtpSyncProvider);
+
+#if defined(ESP32)
+  xTaskCreatePinnedToCore(NtpTask, "ntp", NTP_TASK_STACK, NULL, NTP_TASK_PRIORITY, NULL, NTP_TASK_CORE);
 #endif
 }
 
 /*
-**  update the NTP time
+**  resolve the servers, start the rounds and collect the replies
 */
-void NtpUpdate(void)
+static void NtpPoll(void)
 {
-  if (StateCheck(STATE_CONFIGURING))
+  if (StateCheck(STATE_CONFIGURING) || !WifiIsConnected())
+    return;
+
+  if (_round_active) {
+    /*
+    **  collect the replies -- T4 is taken for each one as it is read
+    */
+    int64_t poll = NtpLocalUs();
+    int64_t latency = poll - _round_poll;
+
+    _round_poll = poll;
+    while (_Udp.parsePacket())
+      NtpReceiveReply(NtpNowUs(), latency);
+
+    bool pending = false;
+    for (int n = 0; n < _ntp_server_count; n++)
+      pending |= _ntp_servers[n].pending;
+
+    if (!pending || millis() - _round_start > NTP_REPLY_TIMEOUT)
+      NtpFinishRound();
     return;
+  }
+
+  /*
+  **  look up the ntpservers ip -- one per call, hostByName() waits for the
+  **  resolver, which only holds the task of the NTP (no round is active)
+  */
+  for (int n = 0; n < _ntp_server_count; n++) {
+    if (!_ntp_servers[n].resolved && (!_ntp_servers[n].lookup || millis() - _ntp_servers[n].lookup > NTP_RETRY_INTERVAL * 1000)) {
+      _ntp_servers[n].lookup = millis();
+      if (WiFi.hostByName(_ntp_servers[n].name, _ntp_servers[n].ip)) {
+#if DBG_NTP
+        DbgMsg("NTP: lookup of %s successful: %s", _ntp_servers[n].name, IPAddressToString(_ntp_servers[n].ip).c_str());
+#endif
+        _ntp_servers[n].resolved = true;
+      }
+      else
+        LogMsg("NTP: lookup of %s failed", _ntp_servers[n].name);
+      return;
+    }
+  }
+
+  if (_ntp_server_count && (!_last_request || millis() - _last_request > _round_interval))
+    NtpStartRound();
 
 #if DBG_NTP
   static unsigned long _last_stats = 0;
-  
+
   if (millis() - _last_stats > NTP_SYNC_INTERVAL / 2 * 1000 || millis() < _last_stats) {
     /*
         print some stats
@@ -245,51 +580,63 @@ void NtpUpdate(void)
     _last_stats = millis();
     DbgMsg("NTP: stats: requests=%d  replies=%d  good replies=%d",_ntp_requests,_ntp_replies_total,_ntp_replies_good);
   }
-  
-  if (_ntp_received) {
-    /*
-    **  this section help to debug the incoming NTP packets
-    **  as inside the receiver function the DbgMsg or LogMsg calls
-    **  are not possible. Instead we use the flag _ntp_receive
-    **  whenever the received packet is valid
-    */
-    dump("NTP: packet received",(const void *) &_packetBuffer[0],NTP_PACKET_SIZE);
+#endif
+}
 
-    /*
-    **  NTP time is in seconds since Jan 1 1900
-    */
-    unsigned long highWord = word(_packetBuffer[40], _packetBuffer[41]);
-    unsigned long lowWord = word(_packetBuffer[42], _packetBuffer[43]);
-    unsigned long ntpTime = highWord << 16 | lowWord;
-    DbgMsg("NTP: packet received: highword=%lu  lowWord=%lu  ntpTime=%lu",highWord,lowWord,ntpTime);
-
-    if (ntpTime) {
-      /*
-      **  now convert NTP time into UNIX time (seconds since Jan 1 1970)
-      **
-      **  the offset is 70 y * ~365.242857142 d * 24 h * 60 m * 60 s
-      */
-      ntpTime -= 2208988800UL;
-      DbgMsg("NTP: packet received: ntpTime=%lu  now=%lu",ntpTime,now());
-
-      /*
-      **  we only accecpt the time, when the delta is below our limit
-      */
-      long delta = ntpTime - now();
-      if (_first_sync) {
-        /*
-        **  this is an update, so drift the time
-        */
-        ntpTime = now() + ((delta < 0) ? -1 : 1) * min((long) NTP_MAX_DRIFT,labs(delta));
-        DbgMsg("NTP: packet received: delta=%ld  _first_sync=%lu => ntpTime=%lu", delta,_first_sync,ntpTime);
-      }
-      DbgMsg("NTP: packet received: last_correction=%ld",_last_correction);
-    }
-    _ntp_received = false;
+#if defined(ESP32)
+/*
+**  the task of the NTP
+*/
+static void NtpTask(void *parameter)
+{
+  MEMSTAT_SCOPE(MEMSTAT_NTP);
+
+  for (;;) {
+    NtpPoll();
+    vTaskDelay(pdMS_TO_TICKS((_round_active) ? NTP_TASK_DELAY_ROUND : NTP_TASK_DELAY));
   }
+}
+#endif
+
+/*
+**  update the NTP time
+*/
+void NtpUpdate(void)
+{
+#if !defined(ESP32)
+  MEMSTAT_SCOPE(MEMSTAT_NTP);
+
+  NtpPoll();
 #endif
 }
 
+/*
+**  get the NTP time in seconds
+*/
+time_t NtpGetTime(void)
+{
+  return NtpGetTimeUs() / 1000000;
+}
+
+/*
+**  get the NTP time in micro seconds
+*/
+uint64_t NtpGetTimeUs(void)
+{
+  return NtpLocalToTimeUs(NtpLocalUs());
+}
+
+/*
+**  convert a local time into the NTP time in micro seconds
+*/
+uint64_t NtpLocalToTimeUs(int64_t local)
+{
+  NTP_CLOCK_T clock;
+
+  NtpClockRead(&clock);
+  return (clock.synced) ? NtpClockUs(&clock, local) : 0;
+}
+
 /*
    get the uptime
 */
@@ -319,7 +666,28 @@ time_t NtpLastSync(void)
 */
 long NtpLastCorrection(void)
 {
-  return _last_correction;
+  return _last_offset / 1000000;
+}
+
+/*
+   get the offset and round trip delay of the last selected sample
+*/
+int64_t NtpLastOffsetUs(void)
+{
+  return _last_offset;
+}
+
+int64_t NtpLastDelayUs(void)
+{
+  return _last_delay;
+}
+
+/*
+   get the name of the server of the last selected sample
+*/
+const char *NtpLastServer(void)
+{
+  return _last_server;
 }
 
 /*
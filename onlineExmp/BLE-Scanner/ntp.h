@@ -33,12 +33,23 @@
 /*
 **  local port to listen for UDP packets
 */
+#ifndef NTP_UDP_LOCAL_PORT
 #define NTP_UDP_LOCAL_PORT 8888
+#endif
 
 /*
-**  global port to receive the UDP packets from
+**  global port to receive the UDP packets from -- the host check uses an
+**  unprivileged one for its stand-in servers
 */
+#ifndef NTP_UDP_PORT
 #define NTP_UDP_PORT 123
+#endif
+
+/*
+**  the configured server string may hold a blank separated list of servers
+**  which are queried in parallel
+*/
+#define NTP_SERVERS_MAX     3
 
 /*
 **  NTP retry interval if failed
@@ -46,9 +57,30 @@
 #define NTP_RETRY_INTERVAL  5
 
 /*
-**  NTP drift maximum
+**  time to wait for the replies of a query round in milli seconds
+*/
+#define NTP_REPLY_TIMEOUT   1000
+
+/*
+**  replies with a round trip delay above this are dropped (micro seconds)
+*/
+#define NTP_MAX_DELAY       (500 * 1000LL)
+
+/*
+**  replies found by a poll later than this after the previous one are dropped
+**  (micro seconds) -- the reply may have waited as long, and T4 with it
+*/
+#define NTP_MAX_POLL_LATENCY (2 * 1000LL)
+
+/*
+**  offsets above this threshold are stepped, below they are slewed (micro seconds)
 */
-#define NTP_MAX_DRIFT       10
+#define NTP_STEP_THRESHOLD  (128 * 1000LL)
+
+/*
+**  maximum slew rate in parts per million
+*/
+#define NTP_SLEW_RATE_PPM   500
 
 /*
 **  NTP time sync interval
@@ -58,6 +90,16 @@
 #define NTP_POLL            (DBG_NTP ? 6 : 10)
 #define NTP_SYNC_INTERVAL   (1 << (NTP_POLL))
 
+/*
+**  the task of the NTP on the ESP32 -- above the loop, so a reply is taken
+**  within a tick of its arrival; the replies are polled every tick during
+**  a round, the task sleeps longer in between
+*/
+#define NTP_TASK_STACK      4096
+#define NTP_TASK_PRIORITY   2
+#define NTP_TASK_CORE       1
+#define NTP_TASK_DELAY      100     // ms between two polls, out of a round
+#define NTP_TASK_DELAY_ROUND 1      // ms between two polls during a round
 
 /*
 **  init the NTP functions
@@ -66,14 +108,38 @@ void NtpSetup(void);
 
 /*
 **  update the NTP time
+**
+**  on the ESP32 the servers are resolved and queried by the task of the
+**  NTP, so the loop never waits for the resolver and a reply is stamped
+**  when it arrives, not when the loop gets to it -- nothing to do here;
+**  elsewhere the requests are sent and the replies collected over several
+**  calls
 */
 void NtpUpdate(void);
 
 /*
-**  get the NTTP time
+**  get the NTTP time in seconds, 0 if not yet synchronized
 */
 time_t NtpGetTime(void);
 
+/*
+**  get the NTP time in micro seconds since Jan 1 1970, 0 if not yet synchronized
+**
+**  the clock is read without a lock, so any task may call it
+*/
+uint64_t NtpGetTimeUs(void);
+
+/*
+**  get the local monotonic time in micro seconds -- esp_timer_get_time(), to
+**  stamp an event cheaply and convert it into the NTP time later
+*/
+int64_t NtpLocalUs(void);
+
+/*
+**  convert a local time into the NTP time in micro seconds, 0 if not yet synchronized
+*/
+uint64_t NtpLocalToTimeUs(int64_t local);
+
 /*
    get the uptime in seconds since first ntp received
 */
@@ -94,6 +160,17 @@ time_t NtpLastSync(void);
 */
 long NtpLastCorrection(void);
 
+/*
+   get the offset and round trip delay of the last selected sample in micro seconds
+*/
+int64_t NtpLastOffsetUs(void);
+int64_t NtpLastDelayUs(void);
+
+/*
+   get the name of the server of the last selected sample
+*/
+const char *NtpLastServer(void);
+
 /*
    get some stats
 */
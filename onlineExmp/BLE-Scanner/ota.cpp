@@ -0,0 +1,537 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module for the firmware upgrade (OTA)
+
+  The inflate is the one of the ROM (miniz), its window is allocated for
+  the time of the upgrade only.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#define LOG_MODULE  LOG_MODULE_OTA
+
+#include <Update.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <mbedtls/sha256.h>
+#include "rom/miniz.h"
+#include "config.h"
+#include "ota.h"
+#include "mqtt.h"
+#include "state.h"
+#include "wifiHandler.h"
+#include "util.h"
+
+/*
+   formats of the upload
+*/
+#define OTA_FORMAT_UNKNOWN      0
+#define OTA_FORMAT_PLAIN        1
+#define OTA_FORMAT_GZIP         2
+
+/*
+   magic of an ESP32 image and of gzip
+*/
+#define OTA_IMAGE_MAGIC         0xe9
+#define OTA_GZIP_ID1            0x1f
+#define OTA_GZIP_ID2            0x8b
+#define OTA_GZIP_DEFLATE        8
+
+/*
+   the flags of the gzip header
+*/
+#define OTA_GZIP_FHCRC          0x02
+#define OTA_GZIP_FEXTRA         0x04
+#define OTA_GZIP_FNAME          0x08
+#define OTA_GZIP_FCOMMENT       0x10
+#define OTA_GZIP_FRESERVED      0xe0
+
+/*
+   the parts of a gzip file, in this order
+*/
+enum OTA_GZIP {
+  OTA_GZIP_HEADER = 0,
+  OTA_GZIP_EXTRA_LEN,
+  OTA_GZIP_EXTRA,
+  OTA_GZIP_NAME,
+  OTA_GZIP_COMMENT,
+  OTA_GZIP_HCRC,
+  OTA_GZIP_DATA,
+  OTA_GZIP_TRAILER,
+};
+
+#define OTA_GZIP_HEADER_SIZE    10
+#define OTA_GZIP_TRAILER_SIZE   8
+
+/*
+   the state of the inflate -- about 43 kB, so it is allocated
+*/
+typedef struct _ota_inflate {
+  tinfl_decompressor inflator;
+  uint8_t window[OTA_WINDOW_SIZE];
+} OTA_INFLATE_T;
+
+/*
+   the upgrade in progress -- only used by the task of the web server
+*/
+static OTA_INFLATE_T *_ota_inflate = NULL;
+static size_t _ota_window = 0;
+static int _ota_format = OTA_FORMAT_UNKNOWN;
+static int _ota_gzip = OTA_GZIP_HEADER;
+static uint8_t _ota_flags = 0;
+static uint8_t _ota_buffer[OTA_GZIP_HEADER_SIZE];
+static size_t _ota_count = 0;
+static size_t _ota_skip = 0;
+static uint32_t _ota_crc = 0;
+static mbedtls_sha256_context _ota_sha256;
+static char _ota_expected[64 + 1];
+static char _ota_hash[64 + 1];
+static const char *_ota_error = "no image uploaded";
+static unsigned long _ota_start = 0;
+static unsigned long _ota_inflate_us = 0;
+static unsigned long _ota_flash_us = 0;
+static OTA_STATS_T _ota_stats;
+
+/*
+   the pending image
+*/
+static bool _ota_pending = false;
+static bool _ota_scanned = false;
+static char _ota_previous[sizeof(((esp_partition_t *) NULL)->label)];
+
+#if CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+/*
+   the image is confirmed by the health check, not by the startup of the core
+*/
+extern "C" bool verifyRollbackLater(void)
+{
+  return true;
+}
+#endif
+
+/*
+   free the state of the upgrade
+*/
+static void OtaFree(void)
+{
+  if (_ota_inflate) {
+    free(_ota_inflate);
+    _ota_inflate = NULL;
+  }
+  mbedtls_sha256_free(&_ota_sha256);
+}
+
+/*
+   let the upgrade fail
+*/
+static bool OtaFail(const char *error)
+{
+  if (!_ota_error) {
+    _ota_error = error;
+    LogMsg("OTA: upgrade failed: %s", error);
+  }
+  if (Update.isRunning())
+    Update.abort();
+  OtaFree();
+  return false;
+}
+
+/*
+   write the image to the flash
+*/
+static bool OtaFlash(const uint8_t *data, size_t length)
+{
+  unsigned long start = micros();
+
+  mbedtls_sha256_update(&_ota_sha256, data, length);
+  _ota_crc = esp_rom_crc32_le(_ota_crc, data, length);
+  _ota_stats.written += length;
+  if (Update.write((uint8_t *) data, length) != length)
+    return OtaFail(Update.errorString());
+
+  _ota_flash_us += micros() - start;
+  return true;
+}
+
+/*
+   skip to the next part of the gzip file which is present
+*/
+static void OtaGzipNext(void)
+{
+  do
+    _ota_gzip++;
+  while ((_ota_gzip == OTA_GZIP_EXTRA_LEN && !(_ota_flags & OTA_GZIP_FEXTRA)) ||
+         (_ota_gzip == OTA_GZIP_EXTRA && !_ota_skip) ||
+         (_ota_gzip == OTA_GZIP_NAME && !(_ota_flags & OTA_GZIP_FNAME)) ||
+         (_ota_gzip == OTA_GZIP_COMMENT && !(_ota_flags & OTA_GZIP_FCOMMENT)) ||
+         (_ota_gzip == OTA_GZIP_HCRC && !(_ota_flags & OTA_GZIP_FHCRC)));
+  _ota_count = 0;
+}
+
+/*
+   consume the gzip header -- it may be split over several chunks
+*/
+static bool OtaGzipHeader(const uint8_t **data, size_t *length)
+{
+  while (*length && _ota_gzip < OTA_GZIP_DATA) {
+    uint8_t c = *(*data)++;
+
+    (*length)--;
+    switch (_ota_gzip) {
+      case OTA_GZIP_HEADER:
+        _ota_buffer[_ota_count++] = c;
+        if (_ota_count == OTA_GZIP_HEADER_SIZE) {
+          if (_ota_buffer[0] != OTA_GZIP_ID1 || _ota_buffer[1] != OTA_GZIP_ID2 ||
+              _ota_buffer[2] != OTA_GZIP_DEFLATE || (_ota_buffer[3] & OTA_GZIP_FRESERVED))
+            return OtaFail("invalid gzip header");
+          _ota_flags = _ota_buffer[3];
+          OtaGzipNext();
+        }
+        break;
+      case OTA_GZIP_EXTRA_LEN:
+        _ota_skip |= c << (8 * _ota_count++);
+        if (_ota_count == 2)
+          OtaGzipNext();
+        break;
+      case OTA_GZIP_EXTRA:
+        if (++_ota_count == _ota_skip)
+          OtaGzipNext();
+        break;
+      case OTA_GZIP_NAME:
+      case OTA_GZIP_COMMENT:
+        if (!c)
+          OtaGzipNext();
+        break;
+      case OTA_GZIP_HCRC:
+        if (++_ota_count == 2)
+          OtaGzipNext();
+        break;
+    }
+  }
+  return true;
+}
+
+/*
+   inflate the compressed data through the window
+*/
+static bool OtaGzipInflate(const uint8_t **data, size_t *length)
+{
+  tinfl_status status;
+
+  do {
+    size_t in = *length;
+    size_t out = OTA_WINDOW_SIZE - _ota_window;
+    unsigned long start = micros();
+
+    status = tinfl_decompress(&_ota_inflate->inflator, *data, &in,
+                              _ota_inflate->window, &_ota_inflate->window[_ota_window], &out,
+                              TINFL_FLAG_HAS_MORE_INPUT);
+    _ota_inflate_us += micros() - start;
+    *data += in;
+    *length -= in;
+
+    if (status < TINFL_STATUS_DONE)
+      return OtaFail("invalid compressed data");
+    if (out && !OtaFlash(&_ota_inflate->window[_ota_window], out))
+      return false;
+    _ota_window = (_ota_window + out) & (OTA_WINDOW_SIZE - 1);
+  } while (status == TINFL_STATUS_HAS_MORE_OUTPUT || (status == TINFL_STATUS_NEEDS_MORE_INPUT && *length));
+
+  if (status == TINFL_STATUS_DONE) {
+    /*
+       the inflate may have read ahead into the trailer -- the whole bytes left in its bit buffer
+    */
+    tinfl_decompressor *inflator = &_ota_inflate->inflator;
+
+    _ota_gzip = OTA_GZIP_TRAILER;
+    for (_ota_count = 0; _ota_count < inflator->m_num_bits / 8 && _ota_count < OTA_GZIP_TRAILER_SIZE; _ota_count++)
+      _ota_buffer[_ota_count] = inflator->m_bit_buf >> ((inflator->m_num_bits & 7) + 8 * _ota_count);
+  }
+  return true;
+}
+
+/*
+   collect the trailer -- CRC32 and size of the image
+*/
+static bool OtaGzipTrailer(const uint8_t **data, size_t *length)
+{
+  while (*length) {
+    if (_ota_count == OTA_GZIP_TRAILER_SIZE)
+      return OtaFail("data after the compressed image");
+    _ota_buffer[_ota_count++] = *(*data)++;
+    (*length)--;
+  }
+  return true;
+}
+
+/*
+   the running image is confirmed
+*/
+static void OtaConfirm(void)
+{
+  Preferences prefs;
+
+#if CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+  esp_ota_mark_app_valid_cancel_rollback();
+#endif
+  prefs.begin(OTA_NVS_NAMESPACE, false);
+  prefs.clear();
+  prefs.end();
+  _ota_pending = false;
+  LogMsg("OTA: the image passed the health check after %lu ms", millis());
+}
+
+/*
+   boot the previous image
+*/
+static void OtaRollback(const char *reason)
+{
+  Preferences prefs;
+
+  LogMsg("OTA: %s -- rolling back to %s", reason, _ota_previous);
+  prefs.begin(OTA_NVS_NAMESPACE, false);
+  prefs.clear();
+  prefs.end();
+  LogFlush();
+
+#if CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+  esp_ota_mark_app_invalid_rollback_and_reboot();
+#endif
+  const esp_partition_t *previous = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, _ota_previous);
+
+  if (!previous || esp_ota_set_boot_partition(previous) != ESP_OK) {
+    LogMsg("OTA: rollback failed -- keeping the image");
+    _ota_pending = false;
+    return;
+  }
+  ESP.restart();
+}
+
+/*
+   setup -- check the pending image after the boot
+*/
+void OtaSetup(void)
+{
+  Preferences prefs;
+  const esp_partition_t *running = esp_ota_get_running_partition();
+
+  prefs.begin(OTA_NVS_NAMESPACE, false);
+  String previous = prefs.getString("previous", "");
+
+  if (!previous.length()) {
+    prefs.end();
+    return;
+  }
+  if (previous == running->label) {
+    /*
+       the bootloader rolled back already
+    */
+    LogMsg("OTA: the new image was rolled back -- running %s", running->label);
+    prefs.clear();
+    prefs.end();
+    return;
+  }
+
+  int boots = prefs.getUChar("boots", 0) + 1;
+
+  prefs.putUChar("boots", boots);
+  prefs.end();
+
+  strncpy(_ota_previous, previous.c_str(), sizeof(_ota_previous) - 1);
+  _ota_pending = true;
+  LogMsg("OTA: the image in %s is pending -- boot %d of %d", running->label, boots, OTA_BOOTS_MAX);
+
+  if (boots > OTA_BOOTS_MAX)
+    OtaRollback("too many boots");
+}
+
+/*
+   do the health check of a pending image
+*/
+void OtaUpdate(void)
+{
+  if (!_ota_pending)
+    return;
+
+  if (StateCheck(STATE_PAUSING))
+    _ota_scanned = true;
+
+  if (WifiIsConnected() && MqttIsConnected() && _ota_scanned)
+    OtaConfirm();
+  else if (millis() > OTA_HEALTH_TIMEOUT)
+    OtaRollback("health check failed");
+}
+
+/*
+   start an upgrade
+*/
+bool OtaBegin(const char *sha256)
+{
+  OtaFree();
+
+  _ota_window = 0;
+  _ota_format = OTA_FORMAT_UNKNOWN;
+  _ota_gzip = OTA_GZIP_HEADER;
+  _ota_flags = 0;
+  _ota_count = 0;
+  _ota_skip = 0;
+  _ota_crc = 0;
+  _ota_hash[0] = '\0';
+  _ota_error = NULL;
+  _ota_start = millis();
+  _ota_inflate_us = 0;
+  _ota_flash_us = 0;
+  _ota_stats = OTA_STATS_T();
+
+  if (sha256 && *sha256 && strlen(sha256) != sizeof(_ota_expected) - 1)
+    return OtaFail("invalid SHA-256");
+  strncpy(_ota_expected, (sha256) ? sha256 : "", sizeof(_ota_expected) - 1);
+
+  mbedtls_sha256_init(&_ota_sha256);
+  mbedtls_sha256_starts(&_ota_sha256, 0);
+
+  if (!Update.begin(UPDATE_SIZE_UNKNOWN))
+    return OtaFail(Update.errorString());
+  return true;
+}
+
+/*
+   pass the next chunk of the upload
+*/
+bool OtaWrite(const uint8_t *data, size_t length)
+{
+  if (_ota_error)
+    return false;
+  _ota_stats.received += length;
+
+  if (_ota_format == OTA_FORMAT_UNKNOWN && length) {
+    if (data[0] == OTA_IMAGE_MAGIC)
+      _ota_format = OTA_FORMAT_PLAIN;
+    else if (data[0] == OTA_GZIP_ID1) {
+      if (!(_ota_inflate = (OTA_INFLATE_T *) malloc(sizeof(OTA_INFLATE_T))))
+        return OtaFail("out of memory");
+      tinfl_init(&_ota_inflate->inflator);
+      _ota_format = OTA_FORMAT_GZIP;
+      _ota_stats.compressed = true;
+    }
+    else
+      return OtaFail("unknown image format");
+  }
+
+  if (_ota_format == OTA_FORMAT_PLAIN)
+    return OtaFlash(data, length);
+
+  if (!OtaGzipHeader(&data, &length))
+    return false;
+  if (_ota_gzip == OTA_GZIP_DATA && !OtaGzipInflate(&data, &length))
+    return false;
+  if (_ota_gzip == OTA_GZIP_TRAILER && !OtaGzipTrailer(&data, &length))
+    return false;
+  return true;
+}
+
+/*
+   finish the upgrade
+*/
+bool OtaEnd(void)
+{
+  if (_ota_error)
+    return false;
+  if (_ota_format == OTA_FORMAT_UNKNOWN)
+    return OtaFail("empty upload");
+
+  if (_ota_format == OTA_FORMAT_GZIP) {
+    if (_ota_gzip != OTA_GZIP_TRAILER || _ota_count != OTA_GZIP_TRAILER_SIZE)
+      return OtaFail("truncated compressed image");
+
+    uint32_t crc = _ota_buffer[0] | (_ota_buffer[1] << 8) | (_ota_buffer[2] << 16) | ((uint32_t) _ota_buffer[3] << 24);
+    uint32_t size = _ota_buffer[4] | (_ota_buffer[5] << 8) | (_ota_buffer[6] << 16) | ((uint32_t) _ota_buffer[7] << 24);
+
+    if (crc != _ota_crc || size != (uint32_t) _ota_stats.written)
+      return OtaFail("CRC or size mismatch of the compressed image");
+  }
+
+  uint8_t hash[32];
+
+  mbedtls_sha256_finish(&_ota_sha256, hash);
+  for (int n = 0; n < 32; n++)
+    sprintf(&_ota_hash[n * 2], "%02x", hash[n]);
+  if (_ota_expected[0] && strcasecmp(_ota_expected, _ota_hash))
+    return OtaFail("SHA-256 mismatch");
+
+  if (!Update.end(true))
+    return OtaFail(Update.errorString());
+
+  /*
+     the new image is pending until it passes the health check
+  */
+  Preferences prefs;
+
+  prefs.begin(OTA_NVS_NAMESPACE, false);
+  prefs.putString("previous", esp_ota_get_running_partition()->label);
+  prefs.putUChar("boots", 0);
+  prefs.end();
+
+  _ota_stats.time = millis() - _ota_start;
+  _ota_stats.inflate = _ota_inflate_us / 1000;
+  _ota_stats.flash = _ota_flash_us / 1000;
+  OtaFree();
+
+  LogMsg("OTA: %lu bytes %sreceived in %lu ms (%lu kB/s), %lu bytes written (%lu kB/s)",
+         _ota_stats.received, (_ota_stats.compressed) ? "compressed " : "", _ota_stats.time,
+         _ota_stats.received / MAX(1, _ota_stats.time),
+         _ota_stats.written, _ota_stats.written / MAX(1, _ota_stats.time));
+  LogMsg("OTA: inflate %lu ms, flash %lu ms, SHA-256 %s", _ota_stats.inflate, _ota_stats.flash, _ota_hash);
+  return true;
+}
+
+/*
+   abort the upgrade
+*/
+void OtaAbort(void)
+{
+  OtaFail("upload aborted");
+}
+
+/*
+   the error of the last upgrade
+*/
+const char *OtaError(void)
+{
+  return _ota_error;
+}
+
+/*
+   the SHA-256 of the last image
+*/
+const char *OtaHash(void)
+{
+  return _ota_hash;
+}
+
+/*
+   the running image is pending
+*/
+bool OtaPending(void)
+{
+  return _ota_pending;
+}
+
+/*
+   get the statistics of the last upgrade
+*/
+void OtaStats(OTA_STATS_T *stats)
+{
+  *stats = _ota_stats;
+}
+
+/**/
@@ -0,0 +1,120 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  module for the firmware upgrade (OTA)
+
+  The image is passed in chunks as it is received. It is either the plain
+  image (as exported by the Arduino IDE) or the image compressed with
+  gzip (gzip -9 -n BLE-Scanner.ino.bin). A compressed image is inflated
+  on the fly through a window of OTA_WINDOW_SIZE bytes, the SHA-256 of
+  the inflated image is computed while it is written to the flash and is
+  compared with the expected one, if given.
+
+  After the reboot into the new image, the image is pending: it has to
+  pass the health check -- WiFi and MQTT are connected and a scan is
+  complete -- within OTA_HEALTH_TIMEOUT, and it must not crash more than
+  OTA_BOOTS_MAX times in a row. Otherwise the gateway boots back into
+  the previous image. If the bootloader supports the rollback
+  (CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE) this is done by the bootloader,
+  otherwise by resetting the boot partition.
+
+  This file is part of BLE-Scanner.
+
+  BLE-Scanner is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+*/
+
+#ifndef __OTA_H__
+#define __OTA_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+   the window of the inflate -- the max. distance of deflate
+*/
+#define OTA_WINDOW_SIZE         32768
+
+/*
+   the new image has to be healthy within ... ms after the boot
+*/
+#define OTA_HEALTH_TIMEOUT      (5 * 60 * 1000)
+
+/*
+   max. number of boots of a pending image
+*/
+#define OTA_BOOTS_MAX           3
+
+/*
+   the pending state in the NVS
+*/
+#define OTA_NVS_NAMESPACE       "ota"
+
+/*
+   the statistics of the last upgrade -- all times in milli seconds
+*/
+typedef struct _ota_stats {
+  bool compressed;
+  unsigned long received;   // bytes of the upload
+  unsigned long written;    // bytes of the image
+  unsigned long time;       // from the first to the last chunk
+  unsigned long inflate;    // time spent in the inflate
+  unsigned long flash;      // time spent in writing the flash
+} OTA_STATS_T;
+
+/*
+   setup -- check the pending image after the boot
+*/
+void OtaSetup(void);
+
+/*
+   do the health check of a pending image
+*/
+void OtaUpdate(void);
+
+/*
+   start an upgrade -- sha256 is the expected hash of the image in hex or NULL
+*/
+bool OtaBegin(const char *sha256);
+
+/*
+   pass the next chunk of the upload
+*/
+bool OtaWrite(const uint8_t *data, size_t length);
+
+/*
+   finish the upgrade -- the image is verified and activated for the next boot
+*/
+bool OtaEnd(void);
+
+/*
+   abort the upgrade
+*/
+void OtaAbort(void);
+
+/*
+   the error of the last upgrade, NULL if there was none
+*/
+const char *OtaError(void);
+
+/*
+   the SHA-256 of the last image in hex
+*/
+const char *OtaHash(void);
+
+/*
+   the running image is pending
+*/
+bool OtaPending(void);
+
+/*
+   get the statistics of the last upgrade
+*/
+void OtaStats(OTA_STATS_T *stats);
+
+#endif
+
+/**/
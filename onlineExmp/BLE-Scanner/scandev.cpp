@@ -12,16 +12,30 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_SCANDEV
+
+#include <atomic>
+#include <mutex>
 #include "config.h"
 #include "state.h"
 #include "bluetooth.h"
 #include "mqtt.h"
+#include "memstat.h"
+#include "history.h"
+#include "ntp.h"
 #include "util.h"
 #include "scandev.h"
 
-// Array of tracked machines
+// Array of tracked machines -- written by the BLE task and the loop, read by the web server task
 static SCANDEV_MACHINE_T _machines[SCANDEV_MAX_MACHINES];
 static int _machine_count = 0;
+static std::mutex _machines_mutex;
+
+// Name of the gateway for the JSON, a copy of the config taken at the setup
+static char _gateway[sizeof(_config.device.name)];
+
+// Version of the table, incremented on every change -- the scan callback runs in the BLE task
+static std::atomic<uint32_t> _table_version(0);
 
 // Minimum time between API posts for same machine (seconds)
 #define MIN_POST_INTERVAL 5
@@ -29,6 +43,16 @@ static int _machine_count = 0;
 // Time after which a machine is considered absent (seconds)
 #define ABSENCE_TIMEOUT(cfg) ((cfg).bluetooth.absence_cycles * ((cfg).bluetooth.scan_time + (cfg).bluetooth.pause_time))
 
+/*
+   the state of a machine in the history
+*/
+static uint8_t ScanDevHistoryState(const SCANDEV_MACHINE_T *machine)
+{
+  return ((machine->running) ? HISTORY_RUNNING : 0) |
+         ((machine->empty) ? HISTORY_EMPTY : 0) |
+         ((machine->present) ? HISTORY_PRESENT : 0);
+}
+
 /*
    Find a machine by address, or return NULL if not found
 */
@@ -72,9 +96,14 @@ static SCANDEV_MACHINE_T* findEmptySlot()
    Add or update a laundry machine
 */
 bool ScanDevAddMachine(const BLEAddress addr, const char* machineId, 
-                       const char* roomName, bool running, bool empty, int rssi)
+                       const char* roomName, bool running, bool empty, int rssi,
+                       uint64_t seen_us)
 {
+  MEMSTAT_SCOPE(MEMSTAT_SCANDEV);
+
+  std::lock_guard<std::mutex> lock(_machines_mutex);
   SCANDEV_MACHINE_T* machine = findMachineById(machineId);
+  bool isNew = !machine;
   
   if (!machine) {
     // New machine - find empty slot
@@ -94,6 +123,7 @@ bool ScanDevAddMachine(const BLEAddress addr, const char* machineId,
     }
     machine->prev_running = !running; // Force initial post
     machine->prev_empty = !empty;
+    machine->remaining = -1;
     _machine_count++;
     
     LogMsg("SCANDEV: New machine added: %s (Room: %s, total: %d)", 
@@ -102,13 +132,15 @@ bool ScanDevAddMachine(const BLEAddress addr, const char* machineId,
   
   // Check if state changed
   bool stateChanged = (machine->running != running) || (machine->empty != empty);
+  bool returned = !machine->present;
   
   // Update machine data
   machine->addr = addr;
   machine->running = running;
   machine->empty = empty;
   machine->rssi = rssi;
-  machine->last_seen = now();
+  machine->last_seen = (seen_us) ? seen_us / 1000000 : now();
+  machine->last_seen_us = seen_us;
   machine->present = true;
   
   // Update room name if provided
@@ -118,6 +150,7 @@ bool ScanDevAddMachine(const BLEAddress addr, const char* machineId,
   
   // Mark for posting if state changed
   if (stateChanged) {
+    machine->changed_us = seen_us;
     machine->state_changed = true;
     machine->post_pending = true;
     LogMsg("SCANDEV: Machine %s state changed - Running: %d->%d, Empty: %d->%d",
@@ -125,17 +158,39 @@ bool ScanDevAddMachine(const BLEAddress addr, const char* machineId,
     machine->prev_running = running;
     machine->prev_empty = empty;
   }
+
+  if (isNew || stateChanged || returned) {
+    machine->version = ++_table_version;
+    HistoryRecord(machine->machineId, seen_us / 1000000, ScanDevHistoryState(machine));
+  }
   
   return true;
 }
 
+/*
+   Set the minutes remaining of a machine -- a new estimate is a change of the table, not of the state
+*/
+void ScanDevSetRemaining(const char *machineId, int remaining)
+{
+  std::lock_guard<std::mutex> lock(_machines_mutex);
+  SCANDEV_MACHINE_T* machine = findMachineById(machineId);
+
+  if (!machine || machine->remaining == remaining)
+    return;
+  machine->remaining = remaining;
+  machine->version = ++_table_version;
+}
+
 /*
    Setup
 */
 void ScanDevSetup(void)
 {
+  std::lock_guard<std::mutex> lock(_machines_mutex);
+
   memset(_machines, 0, sizeof(_machines));
   _machine_count = 0;
+  strncpy(_gateway, _config.device.name, sizeof(_gateway) - 1);
   LogMsg("SCANDEV: Initialized machine tracking (max %d machines)", SCANDEV_MAX_MACHINES);
 }
 
@@ -144,8 +199,11 @@ void ScanDevSetup(void)
 */
 void ScanDevUpdate(void)
 {
+  MEMSTAT_SCOPE(MEMSTAT_SCANDEV);
+
   time_t currentTime = now();
   int absence_timeout = ABSENCE_TIMEOUT(_config);
+  std::unique_lock<std::mutex> lock(_machines_mutex);
   
   for (int i = 0; i < SCANDEV_MAX_MACHINES; i++) {
     if (!_machines[i].in_use) continue;
@@ -157,21 +215,34 @@ void ScanDevUpdate(void)
       LogMsg("SCANDEV: Machine %s went absent (not seen for %ld seconds)",
              machine->machineId, currentTime - machine->last_seen);
       machine->present = false;
+      machine->version = ++_table_version;
+      HistoryRecord(machine->machineId, NtpGetTime(), ScanDevHistoryState(machine));
       // Don't post absence - the API will detect offline via lastUpdate timeout
     }
     
     // Publish to MQTT if pending and enough time has passed
-    if (machine->post_pending && machine->present) {
+    // while the broker is not reachable the pending flags act as outbox
+    if (machine->post_pending && machine->present && MqttIsConnected()) {
       if (currentTime - machine->last_posted >= MIN_POST_INTERVAL) {
-        LogMsg("SCANDEV: Publishing status for %s to MQTT", machine->machineId);
-        
-        if (MqttPublishMachineStatus(machine->machineId, machine->roomName, machine->running, machine->empty)) {
-          machine->post_pending = false;
-          machine->state_changed = false;
+        // the publish goes to the network -- the table isn't locked meanwhile, so it works on a copy
+        SCANDEV_MACHINE_T posted = *machine;
+
+        LogMsg("SCANDEV: Publishing status for %s to MQTT", posted.machineId);
+        lock.unlock();
+        bool published = MqttPublishMachineStatus(posted.machineId, posted.roomName, posted.running, posted.empty, posted.changed_us);
+        lock.lock();
+
+        if (published) {
+          // a state received meanwhile is still pending
+          if (machine->in_use && !strcmp(machine->machineId, posted.machineId) &&
+              machine->running == posted.running && machine->empty == posted.empty) {
+            machine->post_pending = false;
+            machine->state_changed = false;
+          }
           machine->last_posted = currentTime;
-          LogMsg("SCANDEV: Successfully published status for %s", machine->machineId);
+          LogMsg("SCANDEV: Successfully published status for %s", posted.machineId);
         } else {
-          LogMsg("SCANDEV: Failed to publish status for %s - will retry", machine->machineId);
+          LogMsg("SCANDEV: Failed to publish status for %s - will retry", posted.machineId);
         }
       }
     }
@@ -183,48 +254,137 @@ void ScanDevUpdate(void)
 */
 int ScanDevGetCount(void)
 {
+  std::lock_guard<std::mutex> lock(_machines_mutex);
+
   return _machine_count;
 }
 
 /*
-   Return machine list as HTML
+   Get count of machines with a pending publish
 */
-void ScanDevListHTML(void (*callback)(const String& content))
+int ScanDevGetPendingCount(void)
 {
-  (*callback)("<p>Tracked Laundry Machines: " + String(_machine_count) +
-              " @ " + String(TimeToString(now())) + "</p>" +
-              "<table class='btscanlist'>"
-              "<tr>"
-              "<th>Machine ID</th>"
-              "<th>Running</th>"
-              "<th>Empty</th>"
-              "<th>Present</th>"
-              "<th>RSSI [dBm]</th>"
-              "<th>Last Seen</th>"
-              "<th>Last Posted</th>"
-              "</tr>");
+  std::lock_guard<std::mutex> lock(_machines_mutex);
+  int pending = 0;
 
-  bool foundAny = false;
   for (int i = 0; i < SCANDEV_MAX_MACHINES; i++) {
-    if (!_machines[i].in_use) continue;
-    foundAny = true;
-    
-    SCANDEV_MACHINE_T* m = &_machines[i];
-    (*callback)("<tr>"
-                "<td>" + String(m->machineId) + "</td>"
-                "<td>" + String(m->running ? "YES" : "NO") + "</td>"
-                "<td>" + String(m->empty ? "YES" : "NO") + "</td>"
-                "<td>" + String(m->present ? "✅" : "❌") + "</td>"
-                "<td>" + String(m->rssi) + "</td>"
-                "<td>" + String(TimeToString(m->last_seen)) + "</td>"
-                "<td>" + String(m->last_posted ? TimeToString(m->last_posted) : "-") + "</td>"
-                "</tr>");
+    if (_machines[i].in_use && _machines[i].post_pending) {
+      pending++;
+    }
   }
-  
-  if (!foundAny) {
-    (*callback)("<tr>"
-                "<td colspan=7>No machines detected yet</td>"
-                "</tr>");
+  return pending;
+}
+
+/*
+   Write the minutes remaining -- "remaining" is at most that many minutes, the saturated estimate is
+   sent as "remainingOver" instead, none without an estimate
+*/
+static void ScanDevRemainingJSON(JSON_WRITER_T *json, const SCANDEV_MACHINE_T *machine)
+{
+  if (machine->remaining == SCANDEV_REMAINING_OVER)
+    JsonInt(json, "remainingOver", SCANDEV_REMAINING_MAX);
+  else if (machine->remaining >= 0)
+    JsonInt(json, "remaining", machine->remaining);
+}
+
+/*
+   Write a machine as JSON
+*/
+void ScanDevMachineJSON(JSON_WRITER_T *json, const char *key, const SCANDEV_MACHINE_T *machine)
+{
+  JsonObjectBegin(json, key);
+  JsonString(json, "machineId", machine->machineId);
+  if (machine->roomName[0])
+    JsonString(json, "room", machine->roomName);
+  JsonBool(json, "running", machine->running);
+  JsonBool(json, "empty", machine->empty);
+  JsonBool(json, "present", machine->present);
+  ScanDevRemainingJSON(json, machine);
+  JsonInt(json, "rssi", machine->rssi);
+  JsonUInt(json, "lastSeen", machine->last_seen);
+  JsonUInt(json, "lastSeenUs", machine->last_seen_us);
+  JsonUInt(json, "changedUs", machine->changed_us);
+  JsonUInt(json, "lastPosted", machine->last_posted);
+  JsonBool(json, "pending", machine->post_pending);
+  JsonUInt(json, "version", machine->version);
+  JsonObjectEnd(json);
+}
+
+/*
+   Write the compact change of a machine as JSON
+*/
+void ScanDevDeltaJSON(JSON_WRITER_T *json, const SCANDEV_MACHINE_T *machine)
+{
+  JsonObjectBegin(json, NULL);
+  JsonString(json, "machineId", machine->machineId);
+  JsonBool(json, "running", machine->running);
+  JsonBool(json, "empty", machine->empty);
+  JsonBool(json, "present", machine->present);
+  ScanDevRemainingJSON(json, machine);
+  JsonUInt(json, "changedUs", machine->changed_us);
+  JsonUInt(json, "version", machine->version);
+  JsonObjectEnd(json);
+}
+
+/*
+   Write the machine list as JSON -- a machine at a time is copied out of the table, so the
+   table isn't locked while the JSON goes to the network
+*/
+void ScanDevListJSON(JSON_WRITER_T *json)
+{
+  SCANDEV_MACHINE_T machine;
+  int index = 0;
+
+  JsonObjectBegin(json, NULL);
+  JsonUInt(json, "version", _table_version);
+  JsonString(json, "gateway", _gateway);
+  JsonUInt(json, "time", now());
+  JsonInt(json, "count", ScanDevGetCount());
+  JsonArrayBegin(json, "machines");
+  while (ScanDevGetChanged(0, &index, &machine))
+    ScanDevMachineJSON(json, NULL, &machine);
+  JsonArrayEnd(json);
+  JsonObjectEnd(json);
+}
+
+/*
+   Find a machine by its ID
+*/
+bool ScanDevGetMachine(const char *machineId, SCANDEV_MACHINE_T *machine)
+{
+  std::lock_guard<std::mutex> lock(_machines_mutex);
+  const SCANDEV_MACHINE_T *found = findMachineById(machineId);
+
+  if (!found)
+    return false;
+  *machine = *found;
+  return true;
+}
+
+/*
+   Iterate over the machines changed after the version
+*/
+bool ScanDevGetChanged(uint32_t since, int *index, SCANDEV_MACHINE_T *machine)
+{
+  std::lock_guard<std::mutex> lock(_machines_mutex);
+
+  while (*index < SCANDEV_MAX_MACHINES) {
+    const SCANDEV_MACHINE_T *found = &_machines[(*index)++];
+
+    if (found->in_use && found->version > since) {
+      *machine = *found;
+      return true;
+    }
   }
-  (*callback)("</table>");
+  return false;
+}
+
+/*
+   Get the version of the table
+*/
+uint32_t ScanDevGetVersion(void)
+{
+  return _table_version;
 }
+
+/**/
@@ -16,12 +16,22 @@
 #define __SCANDEV_H__ 1
 
 #include "config.h"
+#include "json.h"
 #include "bluetooth.h"
 
 /*
-   Maximum number of machines to track
+   Maximum number of machines to track (the host build overrides this for benchmarks)
 */
+#ifndef SCANDEV_MAX_MACHINES
 #define SCANDEV_MAX_MACHINES    50
+#endif
+
+/*
+   the minutes remaining of a sensor are sent in steps of 5 min up to 150 min, the last step is saturated:
+   the cycle has more than SCANDEV_REMAINING_MAX minutes left
+*/
+#define SCANDEV_REMAINING_MAX   150
+#define SCANDEV_REMAINING_OVER  (SCANDEV_REMAINING_MAX + 1)
 
 /*
    Struct to hold a laundry machine's status
@@ -36,9 +46,13 @@ typedef struct _scandev_machine {
   bool running;
   bool empty;
   int rssi;
+  int remaining;            // Minutes remaining of the cycle estimated by the sensor (at most), -1 if none,
+                            // SCANDEV_REMAINING_OVER if more than SCANDEV_REMAINING_MAX
   
   // Tracking
   time_t last_seen;
+  uint64_t last_seen_us;    // Epoch time in us of the last advertisement (0 if not synced)
+  uint64_t changed_us;      // Epoch time in us when the current state was first observed
   bool present;
   
   // API posting
@@ -52,18 +66,51 @@ typedef struct _scandev_machine {
   
   // List management
   bool in_use;
+  uint32_t version;         // Table version of the last change of this machine
 } SCANDEV_MACHINE_T;
 
 /*
    Add or update a laundry machine in the list
+
+   seen_us is the epoch time in us when the advertisement was received
 */
 bool ScanDevAddMachine(const BLEAddress addr, const char* machineId, 
-                       const char* roomName, bool running, bool empty, int rssi);
+                       const char* roomName, bool running, bool empty, int rssi,
+                       uint64_t seen_us);
+
+/*
+   Set the minutes remaining of the cycle of a machine, -1 if the sensor has no estimate
+*/
+void ScanDevSetRemaining(const char *machineId, int remaining);
+
+/*
+   Write the machine list/a machine as JSON -- key is the key of the machine object or NULL
+*/
+void ScanDevListJSON(JSON_WRITER_T *json);
+void ScanDevMachineJSON(JSON_WRITER_T *json, const char *key, const SCANDEV_MACHINE_T *machine);
 
 /*
-   Return the machine list as HTML for web interface
+   Write the compact change of a machine as JSON -- ID, state, presence and version
 */
-void ScanDevListHTML(void (*callback)(const String& content));
+void ScanDevDeltaJSON(JSON_WRITER_T *json, const SCANDEV_MACHINE_T *machine);
+
+/*
+   Copy a machine by its ID, returns false if not found -- the table is shared with
+   the BLE task and the loop, so it isn't handed out by pointer
+*/
+bool ScanDevGetMachine(const char *machineId, SCANDEV_MACHINE_T *machine);
+
+/*
+   Copy the next machine changed after the version -- index starts with 0,
+   returns false at the end
+*/
+bool ScanDevGetChanged(uint32_t since, int *index, SCANDEV_MACHINE_T *machine);
+
+/*
+   Get the version of the table -- it is incremented on every new machine,
+   state change and absence flip, the machine keeps the version of its last change
+*/
+uint32_t ScanDevGetVersion(void);
 
 /*
    Setup the scan device tracking
@@ -80,5 +127,10 @@ void ScanDevUpdate(void);
 */
 int ScanDevGetCount(void);
 
+/*
+   Get count of machines with a pending publish
+*/
+int ScanDevGetPendingCount(void);
+
 #endif
 
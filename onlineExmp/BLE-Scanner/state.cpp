@@ -23,6 +23,8 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_STATE
+
 #include "config.h"
 #include "bluetooth.h"
 #include "state.h"
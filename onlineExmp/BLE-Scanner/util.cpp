@@ -23,6 +23,8 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_UTIL
+
 #include "util.h"
 #include "config.h"
 
@@ -125,7 +127,7 @@ void dump(String title, const void *addr, const int len)
     while (dump_hex.length() < BYTES_PER_ROW * 3 + 1)
       dump_hex += " ";
     String dump = title + ": " + dump_offset + dump_hex + "  " + dump_ascii;
-    LogMsg(dump.c_str());
+    LogMsg("%s", dump.c_str());
   }
 }
 
@@ -149,21 +151,46 @@ const char *TimeToString(time_t t)
 }
 
 /*
-**  log a smessage to serial
+   the ETag of a version of the machine table
+*/
+const char *EtagOfVersion(char *etag, int size, uint32_t boot_id, uint32_t version)
+{
+  snprintf(etag, size, "W/\"%08lx-%lu\"", (unsigned long) boot_id, (unsigned long) version);
+  return etag;
+}
+
+/*
+   check an If-None-Match header against an ETag
 */
-void LogMsg(const char *fmt, ...)
+bool EtagMatch(const char *if_none_match, const char *etag)
 {
-  va_list args;
-  char msg[256];
-
-  va_start(args, fmt);
-  vsnprintf(msg, sizeof(msg) - 1, fmt, args);
-  va_end(args);
-
-  if (Serial) {
-    Serial.print(TimeToString(now()));
-    Serial.print(": ");
-    Serial.println(msg);
-    Serial.flush();
+  /*
+     the weak comparison ignores the W/ of both
+  */
+  if (!strncmp(etag, "W/", 2))
+    etag += 2;
+
+  size_t length = strlen(etag);
+
+  for (const char *p = if_none_match; p && *p; ) {
+    while (*p == ' ' || *p == '\t' || *p == ',')
+      p++;
+    if (*p == '*')
+      return true;
+    if (!strncmp(p, "W/", 2))
+      p += 2;
+
+    const char *end = strchr(p, ',');
+
+    if (!end)
+      end = p + strlen(p);
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t'))
+      end--;
+    if ((size_t) (end - p) == length && !strncmp(p, etag, length))
+      return true;
+    p = strchr(p, ',');
   }
-}/**/
+  return false;
+}
+
+/**/
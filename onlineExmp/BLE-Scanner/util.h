@@ -28,15 +28,7 @@
 
 #include <TimeLib.h>
 #include "wifiHandler.h"
-
-#if DBG
-/*
-**  debug message
-*/
-#define DbgMsg  LogMsg
-#else
-#define DbgMsg(...)
-#endif
+#include "logger.h"
 
 /*
    compute the distance out of the RSSI value
@@ -94,9 +86,16 @@ void dump(String title, const void *addr, const int len);
 const char *TimeToString(time_t t);
 
 /*
-**  log a smessage to serial
+   the ETag of a version of the machine table -- weak, as the body changes
+   beside the version (the RSSI, the last seen time, the time of the server)
+*/
+const char *EtagOfVersion(char *etag, int size, uint32_t boot_id, uint32_t version);
+
+/*
+   check an If-None-Match header against an ETag -- the weak comparison of
+   RFC 7232, the header may be a list of ETags or "*"
 */
-void LogMsg(const char *fmt, ...);
+bool EtagMatch(const char *if_none_match, const char *etag);
 
 #endif
 
@@ -23,6 +23,8 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_WATCHDOG
+
 #include "watchdog.h"
 #include "util.h"
 #if defined(ESP32)
@@ -51,6 +53,7 @@ void WatchdogSetup(int timeout)
   }
   if (rc != ESP_OK) {
     LogMsg("WATCHDOG: configuration of watchdog failed -- restarting");
+    LogFlush();
     ESP.restart();
   }
 
@@ -0,0 +1,75 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  the machine list of the main page -- loads /api/machines once and
+  follows the changes on /api/events
+*/
+
+var machines = {};
+
+function text(id, value) {
+  document.getElementById(id).textContent = value;
+}
+
+function time(us) {
+  return (us > 0) ? new Date(us / 1000).toLocaleTimeString() : '-';
+}
+
+function remaining(m) {
+  if (!m.running) return '-';
+  if (m.remainingOver >= 0) return '> ' + m.remainingOver + ' min';
+  return (m.remaining >= 0) ? '≤ ' + m.remaining + ' min' : '-';
+}
+
+function render(changed) {
+  var body = document.getElementById('machines');
+  var ids = Object.keys(machines).sort();
+
+  body.textContent = '';
+  ids.forEach(function (id) {
+    var m = machines[id];
+    var row = body.insertRow();
+
+    [m.machineId, m.running ? 'YES' : 'NO', m.empty ? 'YES' : 'NO',
+     remaining(m), m.present ? '✅' : '❌',
+     m.rssi, time(m.changedUs)].forEach(function (value) {
+      row.insertCell().textContent = value;
+    });
+    row.className = (m.present ? '' : 'absent') + (id === changed ? ' changed' : '');
+  });
+  text('summary', 'Tracked Laundry Machines: ' + ids.length);
+}
+
+function follow(version) {
+  var events = new EventSource('/api/events?since=' + version);
+
+  events.onopen = function () {
+    text('live', 'live');
+    document.getElementById('live').className = 'live';
+  };
+  events.onerror = function () {
+    text('live', 'offline');
+    document.getElementById('live').className = 'offline';
+  };
+  events.addEventListener('machine', function (e) {
+    var delta = JSON.parse(e.data);
+    var m = machines[delta.machineId] || { rssi: '-' };
+
+    delete m.remaining;   // only sent while the sensor has an estimate
+    delete m.remainingOver;
+    Object.keys(delta).forEach(function (key) { m[key] = delta[key]; });
+    machines[delta.machineId] = m;
+    render(delta.machineId);
+  });
+}
+
+fetch('/api/machines').then(function (response) {
+  return response.json();
+}).then(function (table) {
+  text('gateway', table.gateway);
+  table.machines.forEach(function (m) { machines[m.machineId] = m; });
+  render();
+  follow(table.version);
+}).catch(function () {
+  text('summary', 'The machine list is not available');
+});
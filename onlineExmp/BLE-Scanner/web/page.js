@@ -0,0 +1,192 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  the pages besides the main page -- the shells are static assets, the
+  data is loaded from /api/info and /api/machines
+*/
+
+function text(id, value) {
+  var element = document.getElementById(id);
+
+  if (element)
+    element.textContent = value;
+}
+
+function time(seconds) {
+  return (seconds > 0) ? new Date(seconds * 1000).toLocaleString() : '-';
+}
+
+function section(table, title) {
+  var th = document.createElement('th');
+
+  th.colSpan = 2;
+  th.textContent = title;
+  table.insertRow().appendChild(th);
+}
+
+function row(table, label, value) {
+  var tr = table.insertRow();
+
+  tr.insertCell().textContent = label;
+  tr.insertCell().textContent = value;
+}
+
+/*
+   the system information
+*/
+function info(i) {
+  var t = document.getElementById('info');
+
+  if (!t)
+    return;
+
+  section(t, 'Device');
+  row(t, 'SW Version', i.device.version);
+  row(t, 'SW Build Date', i.device.build);
+  row(t, 'Device Name', i.device.name);
+  row(t, 'Machines Tracked', i.device.machines);
+
+  section(t, 'WiFi');
+  row(t, 'SSID', i.wifi.ssid);
+  row(t, 'Channel', i.wifi.channel);
+  row(t, 'RSSI', i.wifi.quality + ' % (' + i.wifi.rssi + ' dBm)');
+  row(t, 'MAC', i.wifi.mac);
+  row(t, 'IP Address', i.wifi.ip);
+  row(t, 'State', i.wifi.state);
+  row(t, 'Connects / Attempts', i.wifi.connects + ' / ' + i.wifi.attempts);
+  row(t, 'Last Connect Time', i.wifi.connectTime + ' ms' + (i.wifi.pinned ? ' (pinned)' : ''));
+  row(t, 'Outages', i.wifi.disconnects + ' (last reason ' + i.wifi.lastReason + ')');
+  row(t, 'Outage Last / Max / Total', i.wifi.lastOutage + ' / ' + i.wifi.maxOutage + ' / ' + i.wifi.totalOutage + ' ms');
+
+  section(t, 'MQTT');
+  row(t, 'Broker', i.mqtt.broker + ':' + i.mqtt.port);
+  row(t, 'Status', i.mqtt.status);
+  row(t, 'Topic Prefix', i.mqtt.topic);
+
+  section(t, 'Target Devices');
+  row(t, 'Device Name', i.target.name);
+  row(t, 'Manufacturer ID', '0x' + i.target.manufacturer.toString(16));
+
+  section(t, 'Time');
+  row(t, 'NTP Server', i.time.server);
+  row(t, 'NTP Offset / Delay', i.time.offsetUs + ' / ' + i.time.delayUs + ' us (' + i.time.lastServer + ')');
+  row(t, 'Current Time', i.time.now);
+  row(t, 'Uptime', i.time.uptime);
+
+  section(t, 'Bluetooth Scanning');
+  row(t, 'Scan Duration', i.bluetooth.scanTime + ' s');
+  row(t, 'Pause Between Scans', i.bluetooth.pauseTime + ' s');
+  row(t, 'Absence Timeout Cycles', i.bluetooth.absenceCycles);
+  row(t, 'Capture', i.capture.mode + ': ' + i.capture.captured + ' captured / ' + i.capture.dropped + ' dropped / ' +
+      i.capture.bytes + ' bytes');
+  row(t, 'History', i.history.transitions + ' transitions / ' + i.history.dropped + ' dropped / ' +
+      i.history.machines + ' machines / ' + i.history.blocks + ' blocks written');
+
+  section(t, 'Firmware');
+  row(t, 'Version', i.device.version + (i.firmware.pending ? ' (pending)' : ''));
+  row(t, 'Last Upgrade', i.firmware.received + (i.firmware.compressed ? ' compressed' : '') + ' / ' +
+      i.firmware.written + ' bytes in ' + i.firmware.time + ' ms');
+  row(t, 'Inflate / Flash', i.firmware.inflate + ' / ' + i.firmware.flash + ' ms');
+
+  section(t, 'Web Server');
+  row(t, 'Requests / Slow', i.http.requests + ' / ' + i.http.slow);
+  row(t, 'Handler Time Avg / Max', i.http.avgUs + ' / ' + i.http.maxUs + ' us');
+
+  section(t, 'Memory');
+  row(t, 'Free Heap / Size', i.memory.free + ' / ' + i.memory.size + ' bytes');
+  row(t, 'Min. Free Heap', i.memory.minFree + ' bytes');
+  row(t, 'Largest Free Block / Min.', i.memory.largest + ' / ' + i.memory.minLargest + ' bytes');
+  row(t, 'Fragmentation', i.memory.fragmentation + ' %');
+  i.memory.allocs.forEach(function (a) {
+    row(t, 'Allocations ' + a.name, a.allocs + ' allocs / ' + a.frees + ' frees / ' + a.bytes + ' bytes');
+  });
+
+  section(t, 'Log');
+  row(t, 'Messages Written / Dropped', i.log.written + ' / ' + i.log.dropped);
+}
+
+/*
+   the tracked machines
+*/
+function machines(i) {
+  var body = document.getElementById('machines');
+
+  if (!body)
+    return;
+
+  text('target', i.target.name + ' (0x' + i.target.manufacturer.toString(16) + ')');
+  text('broker', i.mqtt.broker + ':' + i.mqtt.port + ' (' + i.mqtt.status + ')');
+  fetch('/api/machines').then(function (response) {
+    return response.json();
+  }).then(function (table) {
+    text('summary', 'Tracked Laundry Machines: ' + table.count + ' @ ' + time(table.time));
+    table.machines.forEach(function (m) {
+      var tr = body.insertRow();
+
+      [m.machineId, m.running ? 'YES' : 'NO', m.empty ? 'YES' : 'NO', m.present ? '✅' : '❌', m.rssi,
+       time(m.lastSeen), time(m.lastPosted)].forEach(function (value) {
+        tr.insertCell().textContent = value;
+      });
+    });
+    if (!table.machines.length) {
+      var cell = body.insertRow().insertCell();
+
+      cell.colSpan = 7;
+      cell.textContent = 'No machines detected yet';
+    }
+  }).catch(function () {
+    text('summary', 'The machine list is not available');
+  });
+}
+
+/*
+   the upgrade -- the form is posted by fetch(), the result is JSON
+*/
+function upgrade() {
+  var form = document.getElementById('upgrade');
+
+  if (!form)
+    return;
+
+  form.addEventListener('submit', function (e) {
+    var url = '/upgrade' + (form.sha256.value ? '?sha256=' + encodeURIComponent(form.sha256.value) : '');
+
+    e.preventDefault();
+    text('msg', 'Uploading ...');
+    fetch(url, { method: 'POST', body: new FormData(form) }).then(function (response) {
+      return response.json();
+    }).then(function (result) {
+      text('msg', (result.error) ? 'Upgrade failed: ' + result.error :
+                  'Upgrade succeeded, SHA-256 ' + result.sha256 + '. Device will restart now.');
+    }).catch(function () {
+      text('msg', 'Upgrade failed');
+    });
+  });
+}
+
+/*
+   the restart -- the page is reached by the confirmed button of the main page
+*/
+function restart() {
+  if (!document.getElementById('restart'))
+    return;
+
+  fetch('/api/restart', { method: 'POST' }).then(function (response) {
+    text('restart', (response.ok) ? 'Device will restart now.' : 'Restart failed');
+  }).catch(function () {
+    text('restart', 'Restart failed');
+  });
+}
+
+upgrade();
+restart();
+fetch('/api/info').then(function (response) {
+  return response.json();
+}).then(function (i) {
+  text('gateway', i.device.name);
+  text('version', i.device.version);
+  info(i);
+  machines(i);
+}).catch(function () {
+  text('gateway', 'The device information is not available');
+});
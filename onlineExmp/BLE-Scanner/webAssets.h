@@ -0,0 +1,522 @@
+/*
+  BLE-Scanner - Laundry Machine Monitor
+
+  the static assets of the web interface -- generated by make-web-assets.sh
+  from web/, don't edit
+
+*/
+
+#ifndef __WEB_ASSETS_H__
+#define __WEB_ASSETS_H__ 1
+
+typedef struct _web_asset {
+  const char *path;
+  const char *type;
+  const char *etag;
+  const char *cache_control;
+  const uint8_t *data;        // gzip compressed
+  size_t length;
+} WEB_ASSET_T;
+
+#define WEB_ASSET_APP_JS_VERSION "755779f33fddea1d"
+static const uint8_t _web_asset_app_js[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x56, 0xcd, 0x8e, 0xdb, 0x36,
+ 0x10, 0xbe, 0xeb, 0x29, 0xa6, 0x27, 0x49, 0x49, 0x2c, 0x6f, 0xaf, 0x11, 0xbc, 0x0b, 0x24, 0xf5,
+ 0x21, 0xc5, 0x66, 0x17, 0xa8, 0xd3, 0x43, 0xb1, 0xd8, 0x03, 0x57, 0x1c, 0xdb, 0x4c, 0x28, 0xd2,
+ 0x20, 0x29, 0xbb, 0xc6, 0x66, 0x8f, 0x3d, 0x14, 0xe8, 0x23, 0xb4, 0xb7, 0x3e, 0x59, 0x9e, 0xa4,
+ 0xc3, 0x1f, 0xd9, 0xb2, 0x6a, 0x03, 0x45, 0x4f, 0x16, 0x87, 0xdf, 0x7c, 0xf3, 0x3f, 0xf4, 0xf4,
+ 0x55, 0x06, 0xf0, 0xee, 0x76, 0x3e, 0x59, 0x34, 0x4c, 0x29, 0x34, 0x30, 0x81, 0x5b, 0xd6, 0x29,
+ 0x6e, 0xf6, 0xf0, 0x91, 0x35, 0x6b, 0xa1, 0x10, 0x3e, 0x6a, 0x25, 0x9c, 0x36, 0x19, 0x01, 0xdd,
+ 0x1a, 0xa1, 0x4d, 0x62, 0x29, 0xac, 0x03, 0xbd, 0x4c, 0x32, 0xa1, 0x60, 0xc3, 0x56, 0x08, 0x93,
+ 0x09, 0x48, 0xcd, 0xb8, 0x85, 0x29, 0xdb, 0x88, 0x69, 0xc2, 0x5a, 0xd0, 0xaa, 0x41, 0x60, 0x8a,
+ 0x13, 0xc7, 0x52, 0x4b, 0xa9, 0x77, 0x36, 0xe8, 0x35, 0x6b, 0xa6, 0x56, 0xe1, 0x3a, 0xe2, 0x71,
+ 0x8b, 0xca, 0xd9, 0xec, 0xd5, 0x34, 0xcb, 0xb6, 0xcc, 0xc0, 0x41, 0x7d, 0x06, 0xcf, 0x2f, 0x75,
+ 0x96, 0x2d, 0x3b, 0xd5, 0x38, 0x41, 0x60, 0x87, 0xbf, 0xba, 0x42, 0xf0, 0x37, 0xb0, 0x65, 0xb2,
+ 0xc3, 0x12, 0x9e, 0x89, 0x97, 0xeb, 0xa6, 0x6b, 0x49, 0xbd, 0x5a, 0xa1, 0x9b, 0x4b, 0xf4, 0x9f,
+ 0xef, 0xf6, 0x1f, 0x38, 0xc1, 0xca, 0xca, 0xe3, 0xdf, 0x6b, 0xe5, 0x48, 0x46, 0x5c, 0x41, 0xa9,
+ 0xce, 0x5e, 0x86, 0x84, 0xa2, 0xc5, 0xa2, 0xb3, 0x91, 0xc9, 0xa0, 0xeb, 0x8c, 0x02, 0x3a, 0xc3,
+ 0x35, 0x5c, 0x95, 0x70, 0x03, 0x0a, 0x77, 0xf0, 0x03, 0x73, 0x1e, 0x02, 0x53, 0xf8, 0xfe, 0xea,
+ 0xea, 0x8a, 0x38, 0xf5, 0xad, 0x6e, 0x98, 0xc4, 0x4f, 0xa4, 0xba, 0x70, 0x46, 0xa8, 0x55, 0x51,
+ 0xc2, 0x5b, 0xc8, 0x27, 0xf9, 0x29, 0xb5, 0x41, 0x9f, 0x1d, 0x7f, 0xdd, 0x46, 0x7a, 0xb1, 0x84,
+ 0xe2, 0xbb, 0xb6, 0x32, 0x9d, 0xf2, 0xd2, 0xb2, 0x37, 0x17, 0x14, 0xe3, 0x2d, 0x5d, 0xf6, 0x4a,
+ 0xf7, 0x5b, 0xaa, 0xc9, 0xf5, 0xcc, 0xbb, 0xd1, 0xe3, 0xae, 0x21, 0x87, 0xd7, 0x30, 0xc6, 0xbc,
+ 0x26, 0x69, 0x2b, 0x54, 0xe0, 0xe8, 0x03, 0x18, 0x60, 0x12, 0xc7, 0x0d, 0xe4, 0xdf, 0x7e, 0xff,
+ 0x7b, 0x4c, 0x70, 0x50, 0x3e, 0xef, 0xbf, 0xe2, 0x68, 0x8a, 0x58, 0x2a, 0x1e, 0x43, 0xf0, 0xc5,
+ 0x79, 0xd2, 0x7c, 0x4f, 0xc9, 0xbc, 0x94, 0xf6, 0xbc, 0x2f, 0x5e, 0x5e, 0xd6, 0x49, 0x43, 0x70,
+ 0x5f, 0xc9, 0xfb, 0xa7, 0xcf, 0xd8, 0xb8, 0xea, 0x0b, 0xee, 0x6d, 0xd1, 0x63, 0xca, 0xca, 0x6a,
+ 0xe3, 0x0a, 0x42, 0x12, 0xd4, 0x13, 0x8f, 0x2a, 0x96, 0xc7, 0xd4, 0x70, 0x5b, 0x2d, 0xb5, 0x99,
+ 0x93, 0x52, 0x71, 0x70, 0xcf, 0xd7, 0x37, 0xf8, 0x14, 0x6d, 0xb4, 0x84, 0xee, 0x59, 0x1f, 0x04,
+ 0x7f, 0xac, 0x0f, 0x37, 0x46, 0xef, 0xe8, 0x2e, 0x90, 0x0b, 0x65, 0xd1, 0xb8, 0x9f, 0xf4, 0x2e,
+ 0x59, 0x04, 0x78, 0x68, 0xab, 0xa4, 0xf5, 0x81, 0xba, 0xea, 0x50, 0x1c, 0x9f, 0xaf, 0x5f, 0xe6,
+ 0x8b, 0x90, 0x97, 0xbb, 0xfb, 0xdc, 0xdf, 0x60, 0xbb, 0x71, 0xfb, 0xb1, 0x3c, 0x70, 0x9c, 0x54,
+ 0xda, 0x43, 0x37, 0x06, 0xad, 0xf7, 0xdf, 0x27, 0xfd, 0xcf, 0xdf, 0x02, 0xf8, 0xdb, 0x5f, 0x7f,
+ 0xf4, 0x68, 0x32, 0x62, 0xad, 0x78, 0x13, 0x5b, 0xaf, 0xad, 0x52, 0x7e, 0x7f, 0xb6, 0xe5, 0xe3,
+ 0x99, 0x20, 0x07, 0x7d, 0x1e, 0x2c, 0xe9, 0x5d, 0x0a, 0xe2, 0x3d, 0x4a, 0x59, 0x5c, 0x68, 0x70,
+ 0x8f, 0x7c, 0x29, 0xe3, 0xaf, 0xd7, 0x68, 0x24, 0xb3, 0xf6, 0x8e, 0xb5, 0x48, 0x90, 0xe2, 0xc4,
+ 0xbd, 0xe0, 0x1b, 0x7b, 0xf2, 0xc7, 0xbc, 0xa4, 0x6e, 0xa0, 0xa4, 0xc2, 0x6c, 0x36, 0x4b, 0xf3,
+ 0xc9, 0x3d, 0xa4, 0xff, 0x0e, 0xd0, 0x58, 0xd3, 0xc8, 0x1d, 0x66, 0x31, 0xb7, 0x5d, 0xdb, 0x32,
+ 0xb3, 0xa7, 0x14, 0xe5, 0x9f, 0x0c, 0x6b, 0xbe, 0x90, 0xd2, 0x68, 0x8f, 0xd8, 0xb7, 0xa1, 0xed,
+ 0x7c, 0x11, 0x25, 0xaa, 0x95, 0x5b, 0x97, 0xa7, 0x7d, 0x16, 0xf7, 0x42, 0x41, 0xbd, 0x6c, 0xe9,
+ 0x78, 0xec, 0xb3, 0xb8, 0x13, 0xc8, 0x65, 0x3f, 0x84, 0x73, 0x7f, 0x58, 0xe8, 0xce, 0x34, 0x58,
+ 0xe4, 0x83, 0x95, 0x71, 0x63, 0x05, 0x6d, 0x98, 0x99, 0x37, 0xd0, 0x13, 0x84, 0xca, 0xc6, 0xdb,
+ 0x4a, 0x2b, 0xbd, 0x41, 0x45, 0x1c, 0xc7, 0x8c, 0xf6, 0xc9, 0x8c, 0xee, 0x4b, 0xb1, 0x45, 0xef,
+ 0x7b, 0xf8, 0x4d, 0x29, 0xbb, 0xd8, 0xd9, 0x11, 0x74, 0x92, 0xce, 0x28, 0x0b, 0x49, 0xa9, 0x87,
+ 0x66, 0xd1, 0x18, 0x6d, 0xfe, 0x83, 0x5d, 0xbd, 0x5c, 0x4a, 0xca, 0xd1, 0xff, 0x32, 0xdd, 0xeb,
+ 0x8e, 0xad, 0x33, 0xce, 0x43, 0xba, 0x6e, 0x69, 0x51, 0x23, 0x79, 0x72, 0x18, 0x49, 0x32, 0x78,
+ 0xf4, 0x07, 0x87, 0xd3, 0xc3, 0x51, 0x3a, 0x46, 0x9c, 0x3f, 0x2e, 0xee, 0xef, 0xaa, 0x0d, 0x33,
+ 0x16, 0x0b, 0xac, 0x38, 0x73, 0xac, 0xac, 0xcf, 0x4f, 0x58, 0x50, 0x38, 0x8e, 0xce, 0x23, 0x7c,
+ 0xfd, 0x0a, 0xcf, 0xe0, 0x1b, 0x3b, 0x6c, 0x12, 0xef, 0x4f, 0x0c, 0x08, 0x25, 0x3a, 0x1c, 0xee,
+ 0x9c, 0x9a, 0xa4, 0xd3, 0x29, 0x6d, 0x7e, 0xb9, 0x87, 0xd0, 0x86, 0xbb, 0xb5, 0x90, 0x18, 0x5e,
+ 0x05, 0x3a, 0xd2, 0x3a, 0x80, 0x35, 0xb3, 0xf4, 0x64, 0x00, 0x5a, 0x9a, 0x10, 0xda, 0xbd, 0x17,
+ 0x78, 0xfc, 0xf2, 0x8b, 0xce, 0x0d, 0x17, 0x4b, 0xf0, 0xab, 0x3c, 0x33, 0x48, 0x74, 0x4b, 0x01,
+ 0x43, 0xfb, 0x40, 0x1f, 0x8f, 0x7e, 0x7d, 0x79, 0x60, 0x38, 0xd4, 0x87, 0x59, 0xb9, 0x1c, 0x1d,
+ 0x45, 0x9e, 0xc6, 0x29, 0x2e, 0xc5, 0x11, 0xe0, 0x30, 0x15, 0xbe, 0xaf, 0xd1, 0x91, 0xe1, 0xfc,
+ 0xe4, 0x19, 0xa4, 0xca, 0x51, 0x7c, 0x6a, 0xe0, 0x0e, 0x8d, 0xe0, 0x46, 0xd3, 0x20, 0x9f, 0x3c,
+ 0x3c, 0xbd, 0xb0, 0xfa, 0x6c, 0xb5, 0xf2, 0x2b, 0xea, 0xe5, 0x5f, 0x7a, 0x8e, 0x3d, 0xc9, 0xa4,
+ 0x14, 0x1b, 0x69, 0x45, 0x19, 0xda, 0x31, 0x3f, 0x7f, 0xe1, 0xaa, 0x4a, 0xe7, 0x38, 0xa1, 0x41,
+ 0xd2, 0x3b, 0x71, 0x26, 0x29, 0x6d, 0x48, 0x49, 0x1f, 0x75, 0x3b, 0x8e, 0x38, 0x25, 0x26, 0xc5,
+ 0x1c, 0xbe, 0xd3, 0xb0, 0x46, 0xe6, 0xe3, 0xc4, 0x91, 0xa3, 0x0d, 0x73, 0x27, 0xdc, 0x43, 0x27,
+ 0x87, 0x4b, 0x62, 0xfc, 0x4f, 0x42, 0x58, 0x50, 0xda, 0x01, 0xdb, 0x32, 0x21, 0x3d, 0x6b, 0x1e,
+ 0xe8, 0xea, 0xec, 0x1f, 0xf7, 0xbc, 0xd8, 0xed, 0xa1, 0x08, 0x00, 0x00,
+};
+
+#define WEB_ASSET_PAGE_JS_VERSION "6cec812233310cc1"
+static const uint8_t _web_asset_page_js[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x18, 0xcb, 0x72, 0xe3, 0xb8,
+ 0xf1, 0xee, 0xaf, 0x40, 0x0e, 0x5b, 0x14, 0x67, 0x65, 0xca, 0xbb, 0x55, 0xd9, 0xad, 0xb2, 0x6b,
+ 0xb3, 0xf1, 0xb3, 0xc6, 0x29, 0xbf, 0x62, 0xc9, 0x99, 0x4a, 0xa5, 0x72, 0x80, 0x48, 0x48, 0x42,
+ 0x86, 0x24, 0x38, 0x00, 0x28, 0x59, 0xbb, 0x35, 0xc7, 0xbd, 0xed, 0x27, 0x24, 0x3f, 0xb7, 0x5f,
+ 0x92, 0x6e, 0x00, 0x24, 0x01, 0x92, 0xf2, 0x8c, 0x0f, 0x16, 0xd1, 0x2f, 0x74, 0x37, 0xfa, 0x05,
+ 0xcc, 0xde, 0x1d, 0x11, 0x72, 0x71, 0x77, 0x7d, 0x3c, 0x4f, 0x69, 0x59, 0x32, 0x49, 0x8e, 0xc9,
+ 0x1d, 0xad, 0xcb, 0x4c, 0xee, 0xc9, 0x3d, 0x4d, 0x37, 0xbc, 0x64, 0xe4, 0x5e, 0x94, 0x5c, 0x0b,
+ 0x79, 0x04, 0x84, 0x7a, 0xc3, 0x48, 0x45, 0xd7, 0x4c, 0x91, 0x25, 0x53, 0x3c, 0x83, 0x5f, 0x84,
+ 0x14, 0x94, 0x97, 0x06, 0x4c, 0x8e, 0x8f, 0x0d, 0x40, 0x6d, 0x58, 0x9e, 0x2b, 0x42, 0x25, 0x7c,
+ 0x6a, 0xaa, 0x79, 0x4a, 0xa8, 0x52, 0x4c, 0xab, 0x29, 0x62, 0x41, 0x4c, 0x46, 0x35, 0x25, 0x5c,
+ 0x91, 0x5c, 0xd0, 0x8c, 0x65, 0x64, 0x25, 0x45, 0x41, 0x66, 0xb4, 0xe2, 0x33, 0x5e, 0xae, 0x04,
+ 0xa1, 0x65, 0x66, 0x57, 0x85, 0x55, 0x40, 0x1d, 0xbd, 0x9b, 0x1d, 0x1d, 0xad, 0xea, 0x32, 0xd5,
+ 0x5c, 0x94, 0x44, 0xb3, 0x57, 0x3d, 0xe1, 0xd9, 0x94, 0x6c, 0x69, 0x5e, 0xb3, 0x98, 0xfc, 0x0a,
+ 0x02, 0xb7, 0x54, 0x12, 0x96, 0xb3, 0x82, 0x95, 0x9a, 0xfc, 0x44, 0x32, 0x91, 0xd6, 0xf8, 0x99,
+ 0xac, 0x99, 0xbe, 0xb6, 0xd0, 0x8b, 0xfd, 0x6d, 0x06, 0x4c, 0xf1, 0x19, 0x5a, 0xc1, 0x57, 0x64,
+ 0xe2, 0xa8, 0x63, 0x58, 0x92, 0x86, 0x35, 0x41, 0xd1, 0x97, 0xa2, 0xd4, 0x56, 0x8c, 0x91, 0x7f,
+ 0x76, 0xf4, 0xd9, 0xdf, 0x9b, 0x17, 0x6c, 0xa2, 0x58, 0x2a, 0xca, 0x4c, 0xd9, 0x9d, 0x25, 0xd3,
+ 0xb5, 0x2c, 0x49, 0x03, 0x24, 0x7f, 0x21, 0x27, 0x31, 0xf9, 0x99, 0x94, 0x6c, 0x47, 0xae, 0xa8,
+ 0x6e, 0x89, 0xc9, 0x3b, 0xf2, 0xdd, 0xc9, 0xc9, 0x49, 0x9c, 0x68, 0x71, 0x27, 0x52, 0x9a, 0xb3,
+ 0xb9, 0x96, 0xbc, 0x5c, 0x4f, 0x62, 0x72, 0x4a, 0xa2, 0xe3, 0x28, 0xdc, 0x05, 0x78, 0xf0, 0x77,
+ 0xa2, 0xe9, 0x32, 0x67, 0xe0, 0x33, 0xae, 0x73, 0xcf, 0x4e, 0xbd, 0xf1, 0x4d, 0x4c, 0x25, 0x83,
+ 0x6d, 0x9c, 0x95, 0x93, 0x48, 0x6f, 0x22, 0x6b, 0xa3, 0xde, 0x24, 0xa9, 0xc8, 0xe7, 0x15, 0x2d,
+ 0x81, 0xfa, 0xfb, 0x33, 0x0b, 0x09, 0xed, 0x33, 0x72, 0x0d, 0x06, 0xf7, 0x49, 0x78, 0xa9, 0x98,
+ 0xd4, 0xcf, 0x62, 0x37, 0x89, 0x13, 0x5a, 0x55, 0xac, 0xcc, 0x2e, 0x37, 0x3c, 0xcf, 0x26, 0x7a,
+ 0x13, 0x87, 0xea, 0x49, 0x20, 0x71, 0xaa, 0xe5, 0x74, 0xc9, 0xf2, 0xc1, 0x49, 0x68, 0x89, 0xd2,
+ 0xfb, 0x42, 0xad, 0x5a, 0xd2, 0x81, 0x2e, 0x21, 0x42, 0x60, 0xa3, 0x50, 0x23, 0x23, 0xee, 0xec,
+ 0x8b, 0x64, 0xdd, 0xc1, 0xcc, 0x30, 0x7a, 0x6d, 0xc8, 0xed, 0x95, 0x66, 0x05, 0xc1, 0x00, 0x92,
+ 0x05, 0x45, 0x3d, 0x31, 0x6a, 0x5a, 0x9d, 0x11, 0x3e, 0xe1, 0x9e, 0x8a, 0x6f, 0x84, 0x49, 0x84,
+ 0xc4, 0x51, 0x17, 0x2a, 0x7f, 0x72, 0x51, 0x62, 0x8f, 0xda, 0x80, 0xdb, 0x13, 0x9a, 0x92, 0xe8,
+ 0x8a, 0x6d, 0x79, 0xca, 0x90, 0x9e, 0x58, 0xd7, 0x00, 0x6c, 0xfe, 0x81, 0xfc, 0x83, 0x49, 0x05,
+ 0x24, 0xd1, 0x94, 0xf0, 0x24, 0x33, 0x24, 0xc9, 0xd6, 0x82, 0xfa, 0x94, 0x17, 0x35, 0xb8, 0xd9,
+ 0x44, 0x8b, 0x4f, 0xbc, 0x44, 0x68, 0x40, 0x6a, 0x37, 0x22, 0x0f, 0xb4, 0x08, 0x08, 0x4b, 0x58,
+ 0x07, 0x74, 0x2e, 0x6f, 0x15, 0x59, 0x48, 0x9a, 0x7e, 0x64, 0x99, 0x4f, 0xdc, 0xa4, 0x54, 0x3c,
+ 0x30, 0xe3, 0x03, 0xbf, 0xe1, 0x3d, 0x23, 0xe6, 0xb7, 0x57, 0x86, 0x77, 0xc7, 0x57, 0x3c, 0x51,
+ 0x8a, 0x87, 0xea, 0x5c, 0x6e, 0xb0, 0x60, 0xe4, 0x1d, 0x45, 0x6a, 0x01, 0x01, 0xd1, 0x33, 0x08,
+ 0xe9, 0x28, 0x3e, 0xd5, 0x34, 0xe7, 0x7a, 0x4f, 0xbe, 0x25, 0x11, 0xf9, 0x86, 0x4c, 0x22, 0xf8,
+ 0x70, 0x18, 0x09, 0xe2, 0x0d, 0x38, 0xbb, 0x28, 0xe2, 0x50, 0x8d, 0xfb, 0xf3, 0xcb, 0x4e, 0x02,
+ 0xe8, 0x1f, 0x20, 0x6f, 0x9f, 0xc8, 0x79, 0x96, 0x49, 0xa6, 0x54, 0x47, 0xc3, 0xab, 0xd0, 0x0c,
+ 0xdd, 0x78, 0xd6, 0xda, 0x81, 0xcb, 0xd0, 0x10, 0x01, 0x6a, 0xa7, 0x5a, 0x91, 0x19, 0x39, 0xd7,
+ 0x10, 0x44, 0x95, 0xf6, 0x84, 0xa5, 0x0d, 0x12, 0x95, 0x9b, 0x11, 0x4f, 0x65, 0xea, 0x68, 0x03,
+ 0x59, 0x77, 0x54, 0x69, 0xe2, 0x04, 0x92, 0x05, 0x2f, 0xd8, 0x40, 0x12, 0x02, 0x8d, 0xb0, 0x42,
+ 0xa1, 0xb0, 0x89, 0xc3, 0x56, 0x1c, 0xb0, 0x19, 0x54, 0x8e, 0x88, 0x4c, 0xec, 0x77, 0x1c, 0x61,
+ 0x6d, 0x88, 0xe2, 0x40, 0xfe, 0x63, 0xad, 0xb1, 0xfc, 0x76, 0x52, 0x33, 0xae, 0x02, 0x15, 0x27,
+ 0x39, 0x6a, 0x00, 0x45, 0x41, 0x41, 0xd4, 0x7b, 0xda, 0x22, 0xf8, 0xd9, 0x42, 0x81, 0xac, 0xe7,
+ 0x62, 0x2b, 0x95, 0x18, 0xe5, 0x67, 0x50, 0xf7, 0x5f, 0xe1, 0xff, 0x42, 0x68, 0xea, 0x1d, 0x2e,
+ 0xf2, 0x3b, 0xb2, 0x81, 0x27, 0x0a, 0xfa, 0x7a, 0x08, 0xa5, 0x51, 0x8a, 0x87, 0x04, 0xa3, 0x87,
+ 0xa1, 0x77, 0xff, 0xf7, 0xc5, 0x22, 0x54, 0xe8, 0x42, 0x8a, 0x8f, 0x4c, 0x9a, 0xdd, 0x8b, 0x4f,
+ 0x5a, 0x27, 0x4b, 0xb3, 0x46, 0x09, 0xa7, 0x56, 0xb8, 0x81, 0x56, 0x42, 0xea, 0xc1, 0x51, 0xd7,
+ 0xaa, 0x63, 0x53, 0x66, 0x1d, 0x90, 0x2c, 0x44, 0x05, 0xed, 0xe8, 0x49, 0xb2, 0x15, 0x7f, 0xed,
+ 0x08, 0x35, 0x42, 0x87, 0x8a, 0x2d, 0xa8, 0x84, 0xda, 0x40, 0x6c, 0xe2, 0xa9, 0xe8, 0xcd, 0x6c,
+ 0xd4, 0x86, 0x76, 0x2c, 0x1b, 0xcb, 0x7a, 0x45, 0x53, 0x28, 0x1d, 0x60, 0x80, 0x49, 0xa8, 0xe8,
+ 0xe4, 0xd5, 0x1a, 0xe1, 0x58, 0x0a, 0x8f, 0x02, 0x34, 0x71, 0x9d, 0xe1, 0xbb, 0x1f, 0xe2, 0x11,
+ 0x85, 0x30, 0xa2, 0x02, 0xf1, 0x0f, 0x8b, 0x27, 0x32, 0x67, 0x72, 0xeb, 0xbc, 0x85, 0x0d, 0x2a,
+ 0x51, 0x66, 0x3d, 0x20, 0x7b, 0x5c, 0xad, 0xa0, 0x09, 0xc3, 0xf9, 0x5c, 0xb1, 0x9c, 0xee, 0x3b,
+ 0x72, 0x61, 0xe0, 0x2f, 0x61, 0x88, 0x1b, 0x4c, 0x86, 0x84, 0x0e, 0x51, 0xab, 0x26, 0x61, 0x0d,
+ 0x0a, 0xe3, 0xc1, 0xee, 0x3b, 0x12, 0x4f, 0x97, 0xb5, 0x94, 0x58, 0xaa, 0xdb, 0x04, 0x30, 0x2c,
+ 0xa5, 0xd8, 0x05, 0x54, 0x2f, 0x95, 0x0e, 0xf0, 0xb5, 0x59, 0x0f, 0x8d, 0xbe, 0x80, 0x6a, 0xaf,
+ 0x85, 0x80, 0xbe, 0x67, 0x66, 0x14, 0x70, 0x4e, 0xaf, 0x4e, 0x01, 0x94, 0x5c, 0xd5, 0xd2, 0x54,
+ 0x7d, 0x23, 0x6e, 0xd9, 0x70, 0x24, 0x0a, 0x70, 0x6d, 0xc6, 0xf5, 0x4e, 0xf0, 0x89, 0xd6, 0x8a,
+ 0x91, 0x0b, 0xa6, 0x77, 0x8c, 0x95, 0x46, 0xb6, 0xea, 0x71, 0x57, 0x48, 0x71, 0x88, 0xfd, 0x7c,
+ 0xa9, 0x58, 0x09, 0x11, 0x80, 0x78, 0x51, 0x43, 0xd6, 0xef, 0xd3, 0x9c, 0xf5, 0x25, 0x50, 0x4b,
+ 0x64, 0x71, 0xa1, 0x8f, 0x68, 0x85, 0x27, 0x6e, 0xe8, 0x53, 0xfb, 0x9d, 0x14, 0x22, 0x33, 0x5b,
+ 0x9d, 0xba, 0x43, 0x68, 0xe0, 0xee, 0x37, 0x33, 0x6a, 0xb4, 0x8b, 0x59, 0x8f, 0x2a, 0x93, 0x02,
+ 0xda, 0xb6, 0x25, 0x6a, 0xbe, 0x0d, 0x8d, 0xe9, 0x5e, 0xc4, 0xa3, 0x5c, 0xee, 0x35, 0xb3, 0xa7,
+ 0x6a, 0xbe, 0x42, 0xbb, 0xde, 0x73, 0x05, 0xd3, 0x9e, 0x8d, 0x8f, 0x8d, 0xfd, 0x4e, 0xb4, 0x04,
+ 0xe7, 0x70, 0xf4, 0xaf, 0x65, 0xf3, 0xd7, 0x8d, 0x1a, 0x0d, 0xed, 0x97, 0xd5, 0x68, 0x28, 0x9b,
+ 0x66, 0x64, 0x2b, 0x43, 0xb3, 0xe8, 0xcb, 0x5b, 0xe6, 0x22, 0xfd, 0xe8, 0xb4, 0xb5, 0x9f, 0x3b,
+ 0xc9, 0xa1, 0xf6, 0x96, 0x23, 0x95, 0xe4, 0x86, 0xcb, 0x62, 0x07, 0x63, 0x67, 0x68, 0xd1, 0xe1,
+ 0x56, 0x6c, 0x0b, 0xf0, 0xca, 0x71, 0x25, 0x38, 0xf4, 0x40, 0x78, 0xb9, 0x2a, 0x6c, 0x17, 0xa3,
+ 0x65, 0xd8, 0x54, 0xca, 0x97, 0x6a, 0x2d, 0x61, 0x7e, 0x35, 0x62, 0x5b, 0x11, 0x92, 0xa5, 0x8c,
+ 0x6f, 0x8d, 0xf9, 0xbe, 0xe4, 0x54, 0x14, 0x15, 0x76, 0x29, 0x57, 0xe2, 0xbb, 0xa5, 0x93, 0xde,
+ 0xe5, 0x5e, 0xeb, 0xa5, 0x96, 0xd7, 0x99, 0xdb, 0x9d, 0x17, 0x4c, 0x33, 0xce, 0x47, 0x2d, 0x8d,
+ 0xf6, 0xba, 0x4a, 0xd8, 0x20, 0xcb, 0x55, 0x0e, 0x0d, 0x0f, 0x64, 0xdf, 0x40, 0xca, 0x6e, 0x42,
+ 0x65, 0xb9, 0x43, 0xfa, 0x89, 0xdf, 0x22, 0x57, 0x48, 0x7f, 0xb8, 0x68, 0x7f, 0x60, 0xcb, 0xa6,
+ 0xf0, 0x84, 0x1d, 0x9f, 0x7d, 0xaa, 0x99, 0x32, 0xdd, 0x74, 0x9e, 0x8b, 0x9d, 0x0d, 0x23, 0xad,
+ 0x2b, 0xf0, 0x8c, 0x43, 0xf8, 0xbb, 0x19, 0x8c, 0xca, 0x7b, 0x95, 0xe1, 0x3d, 0x5c, 0x01, 0x72,
+ 0xa8, 0x2c, 0x26, 0xf5, 0xce, 0xb7, 0x6b, 0xdb, 0x94, 0x3a, 0x51, 0x74, 0xbb, 0x7e, 0x19, 0x91,
+ 0x03, 0x7d, 0xa8, 0x2d, 0x56, 0x63, 0x6d, 0x86, 0x15, 0x18, 0xd7, 0xc1, 0x4e, 0x37, 0x92, 0x31,
+ 0xf2, 0x9e, 0xd1, 0x0a, 0xd5, 0xe5, 0xbf, 0xd8, 0xc3, 0x2c, 0x0c, 0x61, 0xb2, 0x42, 0x9c, 0xbf,
+ 0x89, 0x83, 0x2b, 0xa0, 0x3b, 0x94, 0x3c, 0xf7, 0xbc, 0x4c, 0x48, 0x2b, 0xd4, 0x97, 0x56, 0xf0,
+ 0xf2, 0xa6, 0x11, 0x38, 0xc2, 0x78, 0x87, 0xbd, 0x00, 0x82, 0xca, 0xd0, 0x5c, 0x60, 0x9c, 0xa3,
+ 0xd1, 0x20, 0xcd, 0x97, 0x91, 0x3b, 0xa2, 0x11, 0xa5, 0x40, 0xfc, 0x9d, 0x87, 0x1d, 0xd9, 0xe1,
+ 0x46, 0xd2, 0x35, 0xce, 0xb8, 0x5d, 0x99, 0x6c, 0xed, 0xf4, 0x10, 0x76, 0x36, 0xb3, 0x9c, 0x2d,
+ 0x05, 0xcd, 0x41, 0x21, 0x95, 0xc0, 0x68, 0x7d, 0x0d, 0x59, 0x3a, 0x69, 0xa7, 0xea, 0x09, 0xb5,
+ 0x13, 0xb5, 0x57, 0x14, 0x91, 0x92, 0xda, 0xc2, 0x80, 0xfa, 0x51, 0xd3, 0x10, 0xa7, 0xf0, 0x6b,
+ 0x65, 0x18, 0xf1, 0xee, 0x73, 0xe6, 0x28, 0xd0, 0xcf, 0x16, 0x61, 0xbf, 0x1a, 0xf8, 0x68, 0x95,
+ 0xfa, 0x3c, 0x3c, 0xd7, 0x3b, 0xd1, 0x6b, 0x08, 0xf7, 0x90, 0x59, 0xe6, 0x92, 0xfa, 0xc1, 0x65,
+ 0x0e, 0xb4, 0x3c, 0x5b, 0x88, 0x8c, 0xd9, 0xb9, 0x58, 0x07, 0x39, 0xd5, 0x78, 0x12, 0xe1, 0xae,
+ 0x60, 0xc5, 0xbd, 0xdb, 0x85, 0xb6, 0x93, 0x34, 0xf1, 0x6f, 0xa4, 0xad, 0x17, 0x1a, 0xa0, 0x7f,
+ 0xbf, 0x58, 0x8a, 0x6c, 0xff, 0xd6, 0x15, 0xa3, 0xe1, 0xf1, 0xaf, 0x19, 0xc8, 0x33, 0xb8, 0x69,
+ 0x98, 0xdb, 0x6e, 0x64, 0x27, 0x85, 0xfe, 0x9c, 0x61, 0x07, 0xbe, 0xaf, 0x9d, 0x26, 0xbc, 0x3e,
+ 0x6d, 0x85, 0x2e, 0xbf, 0x7a, 0xc8, 0xb2, 0x1b, 0x79, 0x40, 0x3b, 0x58, 0x79, 0x12, 0x57, 0x4c,
+ 0x43, 0x60, 0x44, 0xc1, 0xb5, 0x3d, 0x82, 0x7b, 0xdb, 0x86, 0x95, 0x5e, 0xb8, 0x40, 0xc9, 0xab,
+ 0x20, 0x32, 0x58, 0x1b, 0x35, 0xf6, 0xf2, 0xdc, 0x80, 0x93, 0xff, 0xc0, 0x78, 0x3a, 0x71, 0xc7,
+ 0xdc, 0xe7, 0x35, 0xf7, 0xc9, 0x86, 0xd1, 0x1a, 0xa0, 0xea, 0xa2, 0xa0, 0xa6, 0x53, 0x45, 0xee,
+ 0xaa, 0xd3, 0x7f, 0xbb, 0x50, 0xb6, 0x93, 0xda, 0xbb, 0x68, 0x2a, 0xea, 0xd2, 0x9a, 0xf2, 0x57,
+ 0x0b, 0xc5, 0xcb, 0xbc, 0x45, 0x99, 0xc1, 0xc3, 0x6c, 0xdc, 0xdc, 0x86, 0x1b, 0x23, 0x46, 0x82,
+ 0xbe, 0x68, 0xb4, 0xf0, 0x6e, 0xbb, 0x78, 0x76, 0x83, 0xcb, 0x2e, 0xfe, 0xfd, 0xab, 0x68, 0x44,
+ 0xdd, 0x66, 0x53, 0x52, 0x24, 0xb2, 0x36, 0x13, 0x0c, 0x76, 0x81, 0x7f, 0x5e, 0xcf, 0x4d, 0xf5,
+ 0x7f, 0x78, 0x8c, 0x10, 0x83, 0x97, 0x89, 0xfd, 0x08, 0x1c, 0x1b, 0x05, 0x0e, 0x53, 0x80, 0xf9,
+ 0xe3, 0xbf, 0xbf, 0x19, 0xcc, 0x1f, 0xff, 0xfb, 0xdd, 0xa0, 0xf0, 0xd6, 0x34, 0x75, 0x1b, 0x59,
+ 0x73, 0x0a, 0x37, 0x98, 0xb1, 0x32, 0x9e, 0xfa, 0x90, 0x27, 0x01, 0xd7, 0xe3, 0x2c, 0xfe, 0xf7,
+ 0x88, 0x39, 0xde, 0xe5, 0xdd, 0x09, 0xfa, 0x9a, 0xcb, 0xb7, 0x25, 0xfd, 0xec, 0x7c, 0xd6, 0xfc,
+ 0xda, 0xeb, 0x72, 0xe8, 0xc0, 0x9c, 0x95, 0x6b, 0xbd, 0x09, 0x7d, 0x96, 0x82, 0xe4, 0x11, 0xaf,
+ 0x05, 0xfb, 0xb6, 0x2e, 0x44, 0x62, 0xef, 0x31, 0xe3, 0xc7, 0x33, 0x1f, 0x1e, 0x2a, 0x17, 0x3d,
+ 0x88, 0x6e, 0x90, 0xc8, 0x98, 0x86, 0x2a, 0x01, 0x41, 0xb1, 0x87, 0xd4, 0x71, 0x7a, 0xda, 0xd0,
+ 0x82, 0x0a, 0x15, 0xb8, 0xe0, 0x70, 0x58, 0x99, 0xd7, 0x2d, 0xfb, 0x0c, 0x96, 0xc3, 0x3c, 0x82,
+ 0x8f, 0x56, 0xa5, 0xd0, 0x84, 0x6e, 0x29, 0xcf, 0xd1, 0xcc, 0xae, 0x28, 0x05, 0xf5, 0xa2, 0xb6,
+ 0xa3, 0x41, 0xf3, 0x1e, 0x86, 0x6f, 0x12, 0xc8, 0x5a, 0x99, 0x53, 0x80, 0x72, 0xe6, 0xf2, 0x25,
+ 0x36, 0x0f, 0x62, 0x18, 0xff, 0x75, 0x6e, 0x64, 0xff, 0x6d, 0xfe, 0xf8, 0x10, 0xd4, 0x16, 0x27,
+ 0x68, 0xd2, 0x55, 0x16, 0x23, 0xeb, 0x8d, 0xca, 0xe2, 0x38, 0xfc, 0xc2, 0x82, 0x2c, 0x83, 0xc2,
+ 0x82, 0xc0, 0x84, 0x66, 0xd9, 0xf5, 0x16, 0x58, 0xef, 0xc0, 0x36, 0x56, 0x32, 0x89, 0xc6, 0x2f,
+ 0x0b, 0x8e, 0x95, 0xa6, 0xf3, 0x4e, 0x1b, 0x1c, 0xb8, 0x7d, 0x2d, 0xf1, 0xe0, 0xa2, 0x59, 0xb3,
+ 0x0d, 0xce, 0x39, 0x46, 0x94, 0xda, 0xd0, 0xef, 0xff, 0xfc, 0x43, 0x62, 0xc2, 0x03, 0x63, 0xf5,
+ 0x67, 0x0b, 0xf8, 0x09, 0x29, 0x60, 0x04, 0x86, 0xc9, 0xf6, 0xe5, 0xf9, 0xf6, 0x12, 0xe6, 0x1e,
+ 0x51, 0xe2, 0x4b, 0xd5, 0x80, 0x27, 0xb6, 0x83, 0x90, 0x3b, 0x75, 0x86, 0x61, 0x8f, 0x9a, 0x5d,
+ 0xb1, 0x15, 0x05, 0xe7, 0x4c, 0x9a, 0xe4, 0x34, 0x27, 0x54, 0xa8, 0x75, 0x64, 0x2e, 0x10, 0xf8,
+ 0x80, 0x88, 0xd9, 0x94, 0x24, 0x49, 0xe4, 0x28, 0xac, 0x67, 0x41, 0xcd, 0x29, 0xf9, 0x95, 0x14,
+ 0x4c, 0x6f, 0x44, 0x06, 0x82, 0x9f, 0x1e, 0xe7, 0x0b, 0x60, 0xc1, 0x80, 0x3b, 0x35, 0x8f, 0x73,
+ 0x37, 0xb0, 0xff, 0x15, 0xd5, 0xd4, 0x28, 0x12, 0x8f, 0xd4, 0x9b, 0x7e, 0xad, 0x7a, 0xab, 0x5a,
+ 0x91, 0x71, 0x7e, 0xd0, 0xbb, 0xe3, 0xf6, 0x35, 0x77, 0xc8, 0x84, 0x49, 0x29, 0x24, 0x3e, 0x17,
+ 0x46, 0x6e, 0x96, 0x24, 0x2b, 0x88, 0x2b, 0x96, 0xd9, 0xaa, 0xe5, 0x13, 0x91, 0xd3, 0x36, 0x3d,
+ 0xbb, 0xbf, 0x96, 0x4b, 0xd5, 0x69, 0xca, 0x58, 0xc6, 0xa0, 0xc2, 0xcc, 0xdf, 0x9f, 0x1f, 0x83,
+ 0x4f, 0x7d, 0x01, 0xd6, 0xcb, 0x58, 0xf8, 0x12, 0x77, 0x95, 0x25, 0x3b, 0x0e, 0xf9, 0x07, 0x68,
+ 0xe8, 0x19, 0x1a, 0x02, 0x7a, 0xd7, 0x7a, 0xef, 0x8d, 0xe4, 0x18, 0x38, 0xdf, 0xd7, 0x38, 0x0a,
+ 0x0a, 0xc1, 0x20, 0x1f, 0x9a, 0xad, 0x5c, 0x3e, 0x98, 0xb7, 0x62, 0x08, 0x77, 0xc9, 0x20, 0xb7,
+ 0x6c, 0x42, 0x20, 0x38, 0x15, 0x25, 0x4e, 0x9f, 0x08, 0xa8, 0xb5, 0x86, 0xbd, 0xc5, 0x2a, 0x7c,
+ 0x5f, 0x0e, 0x52, 0xc3, 0xc9, 0x74, 0xfa, 0x99, 0x40, 0x3f, 0x98, 0x14, 0x8e, 0x16, 0xa6, 0xf8,
+ 0x41, 0x1a, 0x78, 0x8d, 0xab, 0xa1, 0x1a, 0x46, 0xce, 0x57, 0xc4, 0x87, 0x75, 0x4e, 0x27, 0xa2,
+ 0x25, 0x48, 0xc4, 0x47, 0x73, 0xc4, 0x07, 0x5d, 0x8f, 0x81, 0xff, 0xec, 0x00, 0xbe, 0x37, 0xbf,
+ 0x58, 0xa8, 0xba, 0xcd, 0x0e, 0xf0, 0x9b, 0x53, 0x68, 0x4b, 0xc8, 0xd9, 0x51, 0xeb, 0xb2, 0xb3,
+ 0x23, 0xdf, 0x6e, 0xfb, 0xde, 0xf9, 0xb6, 0x81, 0x87, 0x82, 0x7f, 0xe8, 0x18, 0x37, 0x05, 0x59,
+ 0x15, 0xd7, 0x70, 0xbd, 0xd8, 0xb9, 0xc7, 0x86, 0xfe, 0x7b, 0xa5, 0xa5, 0xd8, 0xbe, 0xfd, 0x4e,
+ 0xea, 0x1e, 0x6e, 0xf1, 0xd3, 0x9b, 0xb3, 0xcc, 0xbe, 0xe3, 0xce, 0xe9, 0xef, 0x6b, 0x6a, 0xb8,
+ 0x15, 0xec, 0xbf, 0x0e, 0x8f, 0x56, 0x72, 0xf4, 0xd8, 0xff, 0x01, 0xbf, 0x45, 0x51, 0xe1, 0x11,
+ 0x19, 0x00, 0x00,
+};
+
+#define WEB_ASSET_STYLES_CSS_VERSION "a9f234665c4c0c3c"
+static const uint8_t _web_asset_styles_css[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x54, 0xd1, 0x8e, 0x9b, 0x30,
+ 0x10, 0x7c, 0xbf, 0xaf, 0xb0, 0x14, 0x55, 0x6a, 0xa5, 0x03, 0x99, 0x90, 0x53, 0x23, 0xa3, 0x7e,
+ 0x49, 0xd5, 0x07, 0x1b, 0x2f, 0x60, 0x05, 0x6c, 0x64, 0x2f, 0xb9, 0x4b, 0xab, 0xfb, 0xf7, 0xda,
+ 0x98, 0x04, 0x42, 0x92, 0x53, 0xaf, 0xf8, 0x05, 0x98, 0x9d, 0xdd, 0x9d, 0xb1, 0xd7, 0x0d, 0x76,
+ 0xed, 0x33, 0x11, 0x46, 0x9e, 0xc8, 0x1f, 0x22, 0x78, 0x79, 0xa8, 0xad, 0x19, 0xb4, 0x64, 0x9b,
+ 0x6a, 0x7c, 0x0a, 0xf2, 0xfe, 0x34, 0x81, 0x1d, 0xb7, 0xb5, 0xd2, 0x2c, 0xb3, 0xd0, 0x15, 0xa4,
+ 0xe7, 0x52, 0x2a, 0x5d, 0x33, 0x5a, 0x90, 0xca, 0x68, 0x4c, 0x2a, 0xde, 0xa9, 0xf6, 0xc4, 0x1c,
+ 0xd7, 0x2e, 0x71, 0x60, 0x95, 0x27, 0x96, 0xa6, 0x35, 0x96, 0x6d, 0xb6, 0x34, 0xac, 0x82, 0x20,
+ 0xbc, 0x61, 0xc2, 0x5b, 0x55, 0x6b, 0x56, 0x82, 0x46, 0xb0, 0x13, 0xd3, 0xa9, 0xdf, 0x30, 0x25,
+ 0x7d, 0x7f, 0x52, 0xba, 0x1f, 0xd0, 0xd7, 0x7a, 0x55, 0x12, 0x1b, 0x96, 0x51, 0xfa, 0xe5, 0x36,
+ 0x4a, 0x98, 0xb7, 0xf0, 0x19, 0xaa, 0xfb, 0x77, 0x2b, 0xc1, 0x26, 0xfe, 0x57, 0x41, 0x92, 0x57,
+ 0x10, 0x07, 0x85, 0xc9, 0x23, 0x7c, 0xca, 0xfe, 0x13, 0x4f, 0x3d, 0xfc, 0xb0, 0x5c, 0x2a, 0xf3,
+ 0xeb, 0x52, 0x69, 0x3b, 0xd5, 0x17, 0x03, 0xa2, 0xd1, 0xc1, 0x89, 0x91, 0xc8, 0x08, 0x2d, 0xce,
+ 0x39, 0x02, 0x63, 0x70, 0xfe, 0x4f, 0x9a, 0xc7, 0x36, 0x66, 0xaf, 0xc8, 0x26, 0xdb, 0xef, 0x33,
+ 0xc1, 0xcf, 0x9a, 0xc9, 0xc5, 0xbc, 0x56, 0x69, 0x48, 0x1a, 0x50, 0x75, 0x83, 0x8c, 0x6c, 0xd3,
+ 0xdd, 0xc8, 0x9c, 0x05, 0x91, 0x2c, 0x8d, 0x95, 0x63, 0x17, 0x24, 0x0a, 0x3e, 0x0b, 0x41, 0xeb,
+ 0xdd, 0x54, 0xa8, 0x8c, 0x4e, 0xe4, 0x60, 0x79, 0x78, 0x09, 0xe5, 0x5f, 0x9c, 0x37, 0xf3, 0x31,
+ 0x54, 0x0e, 0xd6, 0x85, 0x1e, 0x7a, 0xa3, 0xa2, 0xcb, 0xa6, 0xe7, 0xa5, 0xc2, 0x13, 0xa3, 0xe9,
+ 0x7e, 0x96, 0xc8, 0x1a, 0x73, 0x04, 0xeb, 0x85, 0x9e, 0x51, 0xdf, 0x0a, 0x0d, 0x70, 0xda, 0x00,
+ 0x97, 0x23, 0x72, 0x67, 0xc3, 0x3c, 0x5c, 0xfa, 0xe6, 0xfd, 0xd7, 0x35, 0xde, 0x42, 0x85, 0x05,
+ 0x91, 0xca, 0xf5, 0x2d, 0x3f, 0x31, 0xa5, 0x47, 0xd9, 0xa2, 0x35, 0xe5, 0xe1, 0x72, 0x0c, 0xe8,
+ 0xf8, 0x14, 0xa4, 0x53, 0x3a, 0x89, 0x6a, 0xf3, 0x1d, 0xed, 0xc7, 0x6d, 0x49, 0x3b, 0x57, 0xdf,
+ 0xaf, 0x37, 0x71, 0x05, 0xe4, 0xdf, 0xf3, 0x6c, 0x32, 0xee, 0x35, 0xba, 0x29, 0x4c, 0x2b, 0xe7,
+ 0x63, 0xf8, 0xe2, 0x5d, 0x24, 0xb1, 0x7f, 0x09, 0x47, 0xa5, 0x2b, 0xe3, 0x13, 0x2e, 0xce, 0xe8,
+ 0x74, 0x76, 0xe7, 0xdd, 0x74, 0x41, 0x76, 0xc4, 0xae, 0xbc, 0x5f, 0x24, 0x40, 0x4b, 0xb0, 0xb9,
+ 0x1e, 0x0a, 0xb2, 0x29, 0x69, 0x58, 0xf7, 0x5a, 0x59, 0x31, 0xa5, 0x67, 0x2e, 0x27, 0xa3, 0x33,
+ 0xda, 0x84, 0xa2, 0x70, 0x1b, 0xc9, 0x2a, 0x65, 0x1d, 0x26, 0x65, 0xa3, 0xda, 0x0b, 0xeb, 0xc3,
+ 0xd4, 0xcf, 0xe4, 0xa6, 0xc9, 0xb3, 0xd6, 0xdd, 0x64, 0xe9, 0x8c, 0x33, 0x8d, 0x4d, 0xcc, 0xfd,
+ 0x15, 0x8e, 0xa0, 0xbf, 0xad, 0x15, 0x55, 0x34, 0xac, 0xc7, 0x24, 0x23, 0xa5, 0xe7, 0x5c, 0x53,
+ 0x2e, 0x57, 0x43, 0x2a, 0xd0, 0x95, 0xdc, 0xef, 0xb7, 0xc3, 0xff, 0x37, 0x7c, 0x91, 0xe3, 0xf3,
+ 0x9e, 0xaf, 0xc8, 0x1f, 0xdb, 0xbe, 0x0e, 0xf6, 0x46, 0xde, 0x29, 0xbe, 0xf6, 0xf2, 0x2a, 0xe4,
+ 0x13, 0x76, 0x3e, 0xe2, 0xfd, 0xb3, 0xa3, 0x68, 0x53, 0x2e, 0x5c, 0x98, 0xb6, 0x51, 0xd7, 0x34,
+ 0x0d, 0x9c, 0x86, 0x75, 0x27, 0xb6, 0x6c, 0xb8, 0xae, 0x41, 0xc6, 0xe0, 0xd5, 0x55, 0x9e, 0x8b,
+ 0xc8, 0x68, 0xd5, 0x11, 0xe6, 0x54, 0xf9, 0x6e, 0x5f, 0xed, 0xc4, 0x08, 0x98, 0xaa, 0x0a, 0x53,
+ 0xbb, 0x28, 0x93, 0x6d, 0xf7, 0xdb, 0xf1, 0xc6, 0x48, 0x2b, 0x63, 0x70, 0x7d, 0x25, 0xd8, 0xb0,
+ 0x0d, 0x23, 0x5a, 0x5b, 0x00, 0x2d, 0xea, 0xb5, 0x11, 0x8b, 0xdc, 0x16, 0xe4, 0x2d, 0x3e, 0xe7,
+ 0xff, 0x0b, 0x41, 0xa2, 0xdd, 0xba, 0x83, 0x06, 0x00, 0x00,
+};
+
+#define WEB_ASSET_CONFIG_HTML_VERSION "dc53fffe700b219a"
+static const uint8_t _web_asset_config_html[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6d, 0x54, 0x4b, 0x73, 0xda, 0x30,
+ 0x10, 0xbe, 0xe7, 0x57, 0xa8, 0xd3, 0x83, 0x2f, 0x80, 0x03, 0xa4, 0x99, 0x94, 0xda, 0xee, 0x10,
+ 0x70, 0x3a, 0x4c, 0xc3, 0xa3, 0xd8, 0x69, 0x26, 0x27, 0x8f, 0x90, 0xd7, 0x58, 0x8d, 0x90, 0x3c,
+ 0x92, 0x0c, 0xe5, 0xdf, 0x77, 0x65, 0x43, 0x19, 0x3a, 0xbd, 0xb0, 0xda, 0x65, 0xf7, 0xdb, 0xc7,
+ 0xb7, 0xeb, 0xe0, 0xc3, 0x74, 0x39, 0x49, 0xdf, 0x56, 0x31, 0x29, 0xed, 0x4e, 0x44, 0x37, 0xc1,
+ 0x59, 0x00, 0xcd, 0x51, 0xec, 0xc0, 0x52, 0xc2, 0x4a, 0xaa, 0x0d, 0xd8, 0xd0, 0xab, 0x6d, 0xd1,
+ 0x7d, 0xf0, 0xce, 0x66, 0x49, 0x77, 0x10, 0x7a, 0x7b, 0x0e, 0x87, 0x4a, 0x69, 0xeb, 0x11, 0xa6,
+ 0xa4, 0x05, 0x89, 0x6e, 0x07, 0x9e, 0xdb, 0x32, 0xcc, 0x61, 0xcf, 0x19, 0x74, 0x1b, 0xa5, 0xc3,
+ 0x25, 0xb7, 0x9c, 0x8a, 0xae, 0x61, 0x54, 0x40, 0xd8, 0xef, 0xd4, 0x06, 0x74, 0xa3, 0xd0, 0x0d,
+ 0xea, 0x52, 0x39, 0x50, 0xcb, 0xad, 0x80, 0xe8, 0x99, 0xd6, 0x32, 0xd7, 0x47, 0x92, 0x30, 0x2a,
+ 0x25, 0xe8, 0xc0, 0x6f, 0xcd, 0x37, 0x81, 0xe0, 0xf2, 0x9d, 0x94, 0x1a, 0x8a, 0xd0, 0xf3, 0x8d,
+ 0x3d, 0x0a, 0x30, 0x3d, 0x66, 0xcc, 0xd7, 0x7d, 0x48, 0x3f, 0x17, 0x83, 0xe1, 0xdd, 0xfd, 0xfd,
+ 0x27, 0x76, 0xc7, 0x6e, 0xd9, 0x90, 0x79, 0x44, 0x83, 0x08, 0xbd, 0xd6, 0xa7, 0x04, 0xc0, 0xd2,
+ 0xec, 0xb1, 0xc2, 0x52, 0x2d, 0xfc, 0xb6, 0x3e, 0xc6, 0xb8, 0x64, 0x86, 0x69, 0x5e, 0x59, 0x62,
+ 0x34, 0x43, 0xb8, 0x8a, 0x6e, 0xa1, 0xf7, 0xcb, 0x61, 0xdd, 0x33, 0x60, 0x0f, 0xfd, 0xc1, 0x60,
+ 0x38, 0x1c, 0xf6, 0x6f, 0x19, 0xeb, 0x7b, 0x24, 0x87, 0x02, 0x74, 0x14, 0xf8, 0x6d, 0x00, 0x46,
+ 0xfa, 0xa7, 0xd1, 0x6c, 0x54, 0x7e, 0x44, 0x91, 0xf3, 0x3d, 0x61, 0x82, 0x1a, 0x13, 0x9e, 0xfa,
+ 0xbf, 0xb2, 0x39, 0x5f, 0x0c, 0xc7, 0x79, 0x0e, 0xff, 0x76, 0x36, 0xa7, 0xac, 0xe4, 0x12, 0x2e,
+ 0x1d, 0xe2, 0x7f, 0xe8, 0x30, 0x20, 0x3c, 0x0f, 0xb7, 0xd4, 0xc2, 0x81, 0x1e, 0x31, 0x5f, 0x39,
+ 0x70, 0xb9, 0x10, 0xe9, 0x0a, 0xcf, 0xdb, 0x99, 0xad, 0x2b, 0xbf, 0x8a, 0x82, 0x4d, 0x34, 0x51,
+ 0xb2, 0xe0, 0xdb, 0x5a, 0x53, 0xcb, 0x95, 0x24, 0xdc, 0x10, 0xe4, 0x29, 0x67, 0x2a, 0x87, 0x3c,
+ 0xf0, 0x37, 0x08, 0x51, 0x35, 0x8e, 0xa9, 0x72, 0x04, 0xca, 0x2d, 0x10, 0xe4, 0xd0, 0x72, 0xb9,
+ 0x35, 0x1d, 0x02, 0x39, 0xb7, 0xc4, 0x96, 0x40, 0x0a, 0x25, 0x84, 0x3a, 0xa0, 0x91, 0x70, 0x49,
+ 0x02, 0x17, 0x1b, 0xb1, 0x06, 0xb5, 0x57, 0x06, 0x7e, 0xa3, 0x8e, 0x5a, 0x9c, 0x5a, 0x90, 0x66,
+ 0xa0, 0xed, 0x14, 0xbb, 0x54, 0xf0, 0xad, 0x1c, 0x09, 0x28, 0xec, 0x17, 0xaf, 0xe1, 0xc6, 0xd5,
+ 0xf3, 0xca, 0x9f, 0xf8, 0xc8, 0xa5, 0x26, 0xaf, 0xb3, 0xa7, 0x59, 0x96, 0x24, 0xb3, 0x69, 0xa7,
+ 0x7d, 0xae, 0xc6, 0x49, 0xf2, 0xba, 0x5c, 0x4f, 0x03, 0x1f, 0x3d, 0xcf, 0xee, 0xf3, 0x1f, 0x69,
+ 0xda, 0xba, 0xbb, 0x57, 0xf6, 0xb8, 0x5e, 0x7e, 0x8f, 0xd7, 0x9d, 0x56, 0x59, 0x2d, 0xd7, 0xe9,
+ 0xe9, 0xf9, 0x92, 0x5c, 0xac, 0xff, 0x83, 0x69, 0xc6, 0x88, 0x1d, 0xb4, 0x50, 0x8f, 0x69, 0x96,
+ 0x4c, 0xc6, 0x8b, 0x2c, 0x9d, 0xcd, 0xe3, 0x8e, 0xd3, 0x56, 0x63, 0x04, 0xb8, 0xa8, 0xe3, 0xc7,
+ 0x24, 0x5e, 0x4c, 0xe2, 0x6c, 0xf2, 0x36, 0x79, 0x8e, 0x93, 0x2b, 0xa0, 0x94, 0xea, 0x2d, 0xd8,
+ 0x16, 0x26, 0x1d, 0xaf, 0xbf, 0xc5, 0x69, 0x36, 0x8d, 0x7f, 0xce, 0xd0, 0x79, 0x31, 0x76, 0xd1,
+ 0x27, 0xdb, 0x7c, 0xbc, 0x78, 0x79, 0x1a, 0x4f, 0xd2, 0x97, 0x75, 0xbc, 0xce, 0x66, 0xe7, 0x5a,
+ 0xfc, 0x5a, 0xb4, 0xd3, 0x2e, 0x41, 0xe2, 0xfe, 0x31, 0xb5, 0xab, 0xb8, 0x00, 0x42, 0x65, 0x4e,
+ 0xea, 0x4a, 0x28, 0x9a, 0xb7, 0xe3, 0xe6, 0x7a, 0x77, 0xa0, 0x1a, 0x7a, 0xed, 0x50, 0x4f, 0xf4,
+ 0x22, 0x99, 0x85, 0xd2, 0x3b, 0x42, 0x99, 0x23, 0x12, 0xf7, 0xd1, 0x23, 0x78, 0x60, 0xa5, 0xca,
+ 0x43, 0x0f, 0x0b, 0xf2, 0xb0, 0xb6, 0xda, 0x5a, 0x25, 0xa3, 0x39, 0x45, 0x92, 0xe6, 0x20, 0x6b,
+ 0x2c, 0xb1, 0xb5, 0x04, 0xbe, 0x0b, 0x8c, 0x82, 0xea, 0x6a, 0x49, 0x0a, 0xa5, 0x6c, 0xbb, 0x74,
+ 0xee, 0x87, 0x9e, 0x8e, 0xa6, 0xb4, 0xb6, 0x32, 0x23, 0xdf, 0x17, 0xb8, 0x86, 0x5d, 0xdc, 0x43,
+ 0xd0, 0xbd, 0x3d, 0x68, 0x06, 0xa2, 0x47, 0xab, 0x0a, 0x4f, 0xa4, 0xe9, 0x3e, 0xf4, 0xb2, 0x8d,
+ 0xa0, 0xf2, 0xdd, 0x3b, 0xb3, 0xcd, 0x94, 0x50, 0x7a, 0xf4, 0x91, 0x52, 0x8a, 0x44, 0xff, 0x73,
+ 0x9b, 0x24, 0x30, 0x15, 0x95, 0x6e, 0x6d, 0x11, 0xc8, 0xf0, 0xa6, 0x1e, 0x67, 0x41, 0x41, 0x2f,
+ 0xdd, 0x9d, 0xc5, 0xe9, 0x5e, 0xfc, 0xf6, 0x03, 0xf3, 0x07, 0x32, 0xc7, 0xc0, 0xcf, 0x78, 0x04,
+ 0x00, 0x00,
+};
+
+#define WEB_ASSET_INDEX_HTML_VERSION "b10a5eb1ba870d7a"
+static const uint8_t _web_asset_index_html[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x54, 0x5d, 0x4f, 0xdb, 0x30,
+ 0x14, 0x7d, 0xe7, 0x57, 0x78, 0xec, 0xc1, 0x9b, 0x44, 0x9b, 0x41, 0xf9, 0x18, 0x90, 0x04, 0x6d,
+ 0xc0, 0x24, 0x24, 0xa6, 0x21, 0xca, 0x1e, 0xa6, 0x69, 0x9a, 0x6e, 0xed, 0x9b, 0xc6, 0x23, 0xb1,
+ 0x23, 0xfb, 0xa6, 0x5d, 0xfe, 0xfd, 0xae, 0x9b, 0xb4, 0x1d, 0x1a, 0x93, 0x78, 0x89, 0x73, 0xaf,
+ 0xcf, 0xfd, 0x3a, 0xf6, 0x71, 0xfa, 0xea, 0xea, 0xcb, 0xe5, 0xc3, 0xb7, 0xbb, 0x6b, 0x51, 0x52,
+ 0x5d, 0xe5, 0x3b, 0xe9, 0x7a, 0x41, 0xd0, 0xbc, 0xd4, 0x48, 0x20, 0x54, 0x09, 0x3e, 0x20, 0x65,
+ 0xb2, 0xa5, 0x62, 0xf4, 0x5e, 0xae, 0xdd, 0x16, 0x6a, 0xcc, 0xe4, 0xc2, 0xe0, 0xb2, 0x71, 0x9e,
+ 0xa4, 0x50, 0xce, 0x12, 0x5a, 0x86, 0x2d, 0x8d, 0xa6, 0x32, 0xd3, 0xb8, 0x30, 0x0a, 0x47, 0x2b,
+ 0x63, 0xcf, 0x58, 0x43, 0x06, 0xaa, 0x51, 0x50, 0x50, 0x61, 0xb6, 0xbf, 0xd7, 0x06, 0xf4, 0x2b,
+ 0x03, 0x66, 0x6c, 0x5b, 0x17, 0x93, 0x92, 0xa1, 0x0a, 0xf3, 0x5b, 0x68, 0xad, 0xf6, 0x9d, 0x98,
+ 0x2a, 0xb0, 0x16, 0x7d, 0x9a, 0xf4, 0xee, 0x9d, 0xb4, 0x32, 0xf6, 0x51, 0x94, 0x1e, 0x8b, 0x4c,
+ 0x26, 0x81, 0xba, 0x0a, 0xc3, 0x58, 0x85, 0x70, 0xb1, 0xc8, 0xe0, 0xb4, 0x38, 0x98, 0x1c, 0x1e,
+ 0x1f, 0x1f, 0xa9, 0x43, 0xf5, 0x4e, 0x4d, 0x94, 0x14, 0x1e, 0xab, 0x4c, 0xf6, 0x98, 0x12, 0x91,
+ 0x5b, 0xa3, 0xae, 0xe1, 0x56, 0x09, 0x7f, 0x53, 0xc2, 0x31, 0xb1, 0x58, 0x50, 0xde, 0x34, 0x24,
+ 0x82, 0x57, 0x9c, 0x0e, 0x9a, 0x66, 0xfc, 0x2b, 0xa6, 0x3a, 0x39, 0x3a, 0x3a, 0x39, 0x39, 0x2d,
+ 0x26, 0x93, 0x42, 0x6b, 0x84, 0x7d, 0x2d, 0x85, 0xc6, 0x02, 0x7d, 0x9e, 0x26, 0x3d, 0x9e, 0x03,
+ 0x93, 0x81, 0x99, 0x99, 0xd3, 0x1d, 0x2f, 0xda, 0x2c, 0x84, 0xaa, 0x20, 0x84, 0x6c, 0x18, 0xff,
+ 0x89, 0x2f, 0x62, 0x39, 0x9c, 0xe9, 0x9c, 0x6c, 0x06, 0xfb, 0x0c, 0xaa, 0x34, 0x16, 0xb7, 0x03,
+ 0xf2, 0x1e, 0x03, 0x0e, 0x84, 0xd1, 0xd9, 0x1c, 0x08, 0x97, 0xd0, 0x71, 0xbd, 0xf2, 0x20, 0xd6,
+ 0xe2, 0x4c, 0xbc, 0x34, 0x79, 0x1a, 0x1a, 0xb0, 0x11, 0x10, 0xda, 0xba, 0x06, 0xdf, 0xe5, 0xb7,
+ 0x0e, 0xb4, 0xb1, 0x73, 0x31, 0x1e, 0x8f, 0xb9, 0x37, 0xde, 0xcc, 0xc5, 0x06, 0x53, 0x99, 0x05,
+ 0xe6, 0x83, 0x37, 0x4d, 0x9a, 0xc8, 0x6c, 0x64, 0x79, 0x68, 0x49, 0xce, 0x88, 0x79, 0xb7, 0x95,
+ 0x09, 0xb4, 0x22, 0x7d, 0x35, 0x4e, 0x4a, 0x3c, 0x23, 0x95, 0xf9, 0xba, 0xb7, 0x9b, 0x2b, 0xe6,
+ 0xbd, 0x5c, 0xb9, 0xee, 0x5b, 0x6b, 0xb9, 0xd2, 0xc6, 0xbe, 0xae, 0x1b, 0xea, 0xb6, 0xbb, 0x58,
+ 0x83, 0x79, 0xb2, 0x7f, 0xe7, 0x31, 0x30, 0x0d, 0x5b, 0xc4, 0x74, 0x7a, 0x23, 0xbe, 0xeb, 0x8f,
+ 0xf5, 0x8f, 0x8d, 0xeb, 0xb2, 0x04, 0x3b, 0x47, 0xdd, 0xdb, 0x49, 0x2c, 0x9d, 0xd0, 0xc0, 0x2a,
+ 0x45, 0x5a, 0xe3, 0x10, 0x75, 0xdf, 0x49, 0x88, 0x7b, 0x03, 0xd5, 0xc9, 0x6a, 0x8c, 0x15, 0x1f,
+ 0x3b, 0x69, 0xe1, 0x7c, 0x2d, 0x40, 0x91, 0x71, 0x96, 0x0f, 0x70, 0x8d, 0x96, 0x82, 0x6f, 0x66,
+ 0xe9, 0x74, 0x26, 0xe7, 0x7c, 0xec, 0x79, 0x3a, 0x6b, 0x89, 0x9c, 0xdd, 0x4c, 0xde, 0x5b, 0x73,
+ 0x8f, 0x68, 0x67, 0x73, 0x99, 0x3f, 0x78, 0x50, 0x8f, 0xa8, 0xd7, 0x27, 0x12, 0xd2, 0xa4, 0x47,
+ 0x70, 0xcd, 0x98, 0x3e, 0x7f, 0xa6, 0x90, 0xb1, 0x85, 0x7b, 0xbe, 0x48, 0x3e, 0xed, 0x02, 0x61,
+ 0x2d, 0x6e, 0x6c, 0x8c, 0x80, 0x88, 0x7f, 0x41, 0xbe, 0xb6, 0x99, 0x7b, 0xbe, 0x22, 0xff, 0x49,
+ 0xf9, 0xc9, 0xf8, 0x7a, 0x09, 0x1e, 0xc5, 0xd7, 0x1e, 0xf6, 0x82, 0x84, 0xcc, 0x3e, 0x41, 0x54,
+ 0xe3, 0xdf, 0x09, 0x85, 0xb3, 0xa1, 0x9d, 0xd5, 0x86, 0xb2, 0x5d, 0x8f, 0xd4, 0x7a, 0x1b, 0xb5,
+ 0x5a, 0x70, 0xf2, 0x37, 0xf2, 0x03, 0x67, 0xef, 0x5c, 0x2b, 0x42, 0xcb, 0x3f, 0xe4, 0xc4, 0x10,
+ 0x2f, 0xf8, 0x40, 0x44, 0xaf, 0xe0, 0x0b, 0xf9, 0xf6, 0x7c, 0xf7, 0x3f, 0x54, 0x7a, 0xd4, 0x91,
+ 0xc8, 0xfb, 0x3e, 0xe8, 0xd9, 0xf6, 0xb6, 0x62, 0x28, 0x9c, 0xa3, 0x5e, 0x0c, 0xf1, 0x03, 0x83,
+ 0x96, 0x4b, 0xa2, 0x26, 0x9c, 0x25, 0x49, 0xc5, 0xf2, 0x18, 0xb1, 0x3e, 0xd0, 0x8f, 0x17, 0xe8,
+ 0x15, 0x56, 0x63, 0x56, 0x25, 0x2b, 0x17, 0xfc, 0x3c, 0x3e, 0x3d, 0x3f, 0x67, 0x15, 0xd8, 0x47,
+ 0x29, 0x56, 0xaa, 0xce, 0xa4, 0x72, 0x95, 0xf3, 0x67, 0xaf, 0x01, 0xe0, 0x5c, 0xfe, 0xfb, 0x64,
+ 0xc0, 0x56, 0x3b, 0xeb, 0x65, 0x7d, 0x87, 0xfa, 0xe7, 0xed, 0x0f, 0x81, 0x04, 0xcb, 0xac, 0xf6,
+ 0x04, 0x00, 0x00,
+};
+
+#define WEB_ASSET_INFO_HTML_VERSION "fb5be1f9420f633c"
+static const uint8_t _web_asset_info_html[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x5d, 0x52, 0xc1, 0x92, 0xd3, 0x30,
+ 0x0c, 0xbd, 0xef, 0x57, 0x98, 0xd9, 0x83, 0x2f, 0xdb, 0x66, 0x9b, 0x2c, 0x9d, 0xdd, 0x25, 0x0e,
+ 0x07, 0xe0, 0x46, 0x07, 0x66, 0xe0, 0xc2, 0x89, 0x51, 0x15, 0xa5, 0x31, 0xeb, 0xda, 0x19, 0x5b,
+ 0x6d, 0xe9, 0xdf, 0x23, 0x27, 0x29, 0x65, 0xb9, 0x44, 0xd1, 0xb3, 0xde, 0xb3, 0x9e, 0xe4, 0xfa,
+ 0xcd, 0xc7, 0x2f, 0x1f, 0xbe, 0xff, 0xf8, 0xfa, 0x49, 0xf5, 0xbc, 0x77, 0xcd, 0x4d, 0x7d, 0x09,
+ 0x04, 0xad, 0x84, 0x3d, 0x31, 0x28, 0xec, 0x21, 0x26, 0x62, 0xa3, 0x0f, 0xdc, 0x2d, 0x1e, 0xf5,
+ 0x05, 0xf6, 0xb0, 0x27, 0xa3, 0x8f, 0x96, 0x4e, 0x43, 0x88, 0xac, 0x15, 0x06, 0xcf, 0xe4, 0xa5,
+ 0xec, 0x64, 0x5b, 0xee, 0x4d, 0x4b, 0x47, 0x8b, 0xb4, 0x18, 0x93, 0x3b, 0xeb, 0x2d, 0x5b, 0x70,
+ 0x8b, 0x84, 0xe0, 0xc8, 0xac, 0xee, 0x0e, 0x89, 0xe2, 0x98, 0xc0, 0x56, 0x72, 0x1f, 0xb2, 0x28,
+ 0x5b, 0x76, 0xd4, 0x7c, 0x86, 0x83, 0x6f, 0xe3, 0x59, 0x7d, 0x43, 0xf0, 0x9e, 0x62, 0x5d, 0x4c,
+ 0xf0, 0x4d, 0xed, 0xac, 0x7f, 0x51, 0x7d, 0xa4, 0xce, 0xe8, 0x22, 0xf1, 0xd9, 0x51, 0x5a, 0x62,
+ 0x4a, 0xef, 0x8f, 0x06, 0x9e, 0xba, 0xb2, 0x7a, 0x58, 0xaf, 0xdf, 0xe2, 0x03, 0xde, 0x63, 0x85,
+ 0x5a, 0x45, 0x72, 0x46, 0x4f, 0x35, 0x3d, 0x91, 0xb4, 0xc6, 0xe7, 0x41, 0x5a, 0x65, 0xfa, 0xcd,
+ 0x85, 0x70, 0xf2, 0x65, 0x09, 0xa3, 0x1d, 0x58, 0xa5, 0x88, 0x22, 0x37, 0xc0, 0x8e, 0x96, 0xbf,
+ 0xb2, 0xd6, 0x1a, 0x09, 0x1f, 0x57, 0x65, 0x59, 0x55, 0xd5, 0xea, 0x1e, 0x71, 0xa5, 0x55, 0x4b,
+ 0x1d, 0xc5, 0xa6, 0x2e, 0x26, 0x82, 0x30, 0x8b, 0x79, 0x34, 0xdb, 0xd0, 0x9e, 0x25, 0xb4, 0xf6,
+ 0xa8, 0xd0, 0x41, 0x4a, 0x66, 0xf6, 0xff, 0x0a, 0xcb, 0xb5, 0x42, 0x97, 0x79, 0x56, 0x7f, 0x9d,
+ 0x6d, 0x00, 0x7b, 0xeb, 0xe9, 0xea, 0x50, 0xce, 0xa4, 0xa0, 0x54, 0xb6, 0x35, 0x3b, 0x60, 0x3a,
+ 0xc1, 0x59, 0xee, 0xeb, 0xcb, 0x7c, 0x97, 0x28, 0xbd, 0xd2, 0xd3, 0xd6, 0x77, 0xd3, 0xb0, 0xf2,
+ 0xe0, 0x2e, 0x60, 0x1e, 0x75, 0xc6, 0xb3, 0x42, 0xfe, 0x11, 0xfa, 0x78, 0x7e, 0x55, 0x18, 0x9a,
+ 0xba, 0x0b, 0x71, 0xaf, 0x00, 0xd9, 0x06, 0x2f, 0x96, 0xb5, 0x92, 0x1d, 0xf6, 0xa1, 0x35, 0x7a,
+ 0x27, 0x03, 0x6a, 0xea, 0xed, 0x81, 0x39, 0xf8, 0x66, 0x03, 0xd6, 0xab, 0x0d, 0xf9, 0x43, 0x5d,
+ 0xcc, 0x48, 0x5d, 0x64, 0x62, 0x23, 0x0a, 0xff, 0xf6, 0xd1, 0x85, 0xc0, 0x93, 0xaf, 0xfc, 0x81,
+ 0x79, 0x2f, 0x3d, 0xf3, 0x90, 0x9e, 0x8b, 0xc2, 0x89, 0xd3, 0x85, 0x58, 0xa5, 0xb8, 0x3c, 0x52,
+ 0x44, 0x72, 0x4b, 0x18, 0x06, 0xd9, 0x02, 0xc4, 0x5d, 0x7e, 0x46, 0x3f, 0xb7, 0x0e, 0xfc, 0x8b,
+ 0x56, 0xe3, 0x86, 0x8c, 0xc6, 0xe0, 0x42, 0x7c, 0xbe, 0x05, 0x80, 0x77, 0xfa, 0xff, 0xf5, 0xab,
+ 0x3a, 0x0d, 0xe0, 0xb3, 0x2f, 0x11, 0x4a, 0x76, 0xec, 0x27, 0x23, 0x12, 0xe0, 0xea, 0xee, 0x12,
+ 0xe6, 0x95, 0x14, 0xd3, 0x1b, 0xfe, 0x03, 0x30, 0x31, 0x42, 0xce, 0xdb, 0x02, 0x00, 0x00,
+};
+
+#define WEB_ASSET_MACHINES_HTML_VERSION "87330706753fd9f9"
+static const uint8_t _web_asset_machines_html[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6d, 0x54, 0x4b, 0x4f, 0xdc, 0x30,
+ 0x10, 0xbe, 0xf3, 0x2b, 0x5c, 0xf5, 0xe0, 0x0b, 0x9b, 0xb0, 0xbb, 0x14, 0x51, 0x9a, 0xa4, 0x12,
+ 0x85, 0x03, 0x12, 0xa8, 0x94, 0xe5, 0x52, 0x55, 0x55, 0x35, 0x71, 0x26, 0x1b, 0x97, 0xc4, 0x8e,
+ 0xec, 0xc9, 0x42, 0xfe, 0x7d, 0xc7, 0x79, 0xec, 0x0a, 0xca, 0x25, 0xa3, 0x79, 0xcf, 0x37, 0xf3,
+ 0x39, 0xc9, 0x87, 0xab, 0xef, 0xdf, 0x1e, 0x7f, 0xde, 0x5f, 0x8b, 0x8a, 0x9a, 0x3a, 0x3b, 0x4a,
+ 0x66, 0x81, 0x50, 0xb0, 0x68, 0x90, 0x40, 0xa8, 0x0a, 0x9c, 0x47, 0x4a, 0x65, 0x47, 0xe5, 0xe2,
+ 0x5c, 0xce, 0x66, 0x03, 0x0d, 0xa6, 0x72, 0xa7, 0xf1, 0xb9, 0xb5, 0x8e, 0xa4, 0x50, 0xd6, 0x10,
+ 0x1a, 0x0e, 0x7b, 0xd6, 0x05, 0x55, 0x69, 0x81, 0x3b, 0xad, 0x70, 0x31, 0x28, 0xc7, 0xda, 0x68,
+ 0xd2, 0x50, 0x2f, 0xbc, 0x82, 0x1a, 0xd3, 0xe5, 0x71, 0xe7, 0xd1, 0x0d, 0x0a, 0xe4, 0xac, 0x1b,
+ 0x1b, 0x8a, 0x92, 0xa6, 0x1a, 0xb3, 0x5b, 0xe8, 0x4c, 0xe1, 0x7a, 0xb1, 0x51, 0x60, 0x0c, 0xba,
+ 0x24, 0x1e, 0xcd, 0x47, 0x49, 0xad, 0xcd, 0x93, 0xa8, 0x1c, 0x96, 0xa9, 0x8c, 0x3d, 0xf5, 0x35,
+ 0xfa, 0x48, 0x79, 0xff, 0x75, 0x97, 0xc2, 0xe7, 0x72, 0xb5, 0x3e, 0x3d, 0x3b, 0xfb, 0xa4, 0x4e,
+ 0xd5, 0x89, 0x5a, 0x2b, 0x29, 0x1c, 0xd6, 0xa9, 0x1c, 0x63, 0x2a, 0x44, 0x1e, 0x8d, 0xfa, 0x96,
+ 0x47, 0x25, 0x7c, 0xa1, 0x98, 0x73, 0x42, 0x33, 0xaf, 0x9c, 0x6e, 0x49, 0x78, 0xa7, 0xb8, 0x5c,
+ 0x0b, 0x5b, 0x8c, 0xfe, 0x86, 0x5a, 0x67, 0x0a, 0xd5, 0xf9, 0x72, 0xb5, 0x5a, 0xaf, 0xd7, 0xcb,
+ 0x13, 0xa5, 0x96, 0x52, 0x14, 0x58, 0xa2, 0xcb, 0x92, 0x78, 0x4c, 0xe0, 0xcc, 0x78, 0x5a, 0x4d,
+ 0x6e, 0x8b, 0x9e, 0x45, 0xa1, 0x77, 0x42, 0xd5, 0xe0, 0x7d, 0x3a, 0xe1, 0x7f, 0x65, 0x0b, 0xb1,
+ 0x9c, 0xce, 0xfb, 0x5c, 0xef, 0x91, 0xdd, 0x81, 0xaa, 0xb4, 0xc1, 0x03, 0x42, 0xf6, 0x71, 0xc0,
+ 0x4a, 0xe8, 0x22, 0xdd, 0x02, 0xe1, 0x33, 0xf4, 0xdc, 0xaf, 0x5a, 0x85, 0x5e, 0x5c, 0x89, 0x45,
+ 0x9b, 0x25, 0x79, 0x36, 0x84, 0x6b, 0xb3, 0x15, 0xa5, 0x75, 0x17, 0x49, 0x9c, 0x67, 0x22, 0xf1,
+ 0x2d, 0x98, 0x90, 0x45, 0xe0, 0xb6, 0x48, 0x61, 0x48, 0x36, 0xb0, 0x68, 0xe7, 0x9c, 0xbb, 0x1f,
+ 0x8f, 0x8f, 0xe2, 0xd2, 0xd9, 0x27, 0x7c, 0x9b, 0x92, 0x0f, 0xc6, 0xff, 0x52, 0x66, 0xb7, 0xef,
+ 0x9a, 0x06, 0x5c, 0x9f, 0xdd, 0x5a, 0x28, 0x42, 0xcf, 0x28, 0x8a, 0x5e, 0x85, 0x52, 0xb8, 0xdb,
+ 0x84, 0x51, 0xe6, 0xc4, 0x97, 0x34, 0xb5, 0xf6, 0x34, 0x9c, 0x71, 0xd8, 0x4f, 0x42, 0x5c, 0x9c,
+ 0xaa, 0x6c, 0x06, 0x7b, 0x73, 0xc5, 0x97, 0xac, 0x06, 0xd3, 0x43, 0x37, 0xe0, 0xd8, 0xeb, 0xd7,
+ 0x4d, 0x4b, 0xfd, 0x5e, 0xbb, 0x77, 0xe8, 0x79, 0x8b, 0x87, 0xe8, 0xcd, 0xe6, 0x46, 0xfc, 0x2a,
+ 0x2e, 0x9b, 0xdf, 0x7b, 0xd3, 0x2d, 0x78, 0x12, 0x1b, 0x44, 0xf3, 0xda, 0x72, 0x6f, 0x3d, 0x61,
+ 0x31, 0xda, 0xe2, 0xd0, 0x3e, 0xa6, 0xe9, 0x54, 0x14, 0x6e, 0x15, 0x60, 0x35, 0xe3, 0x34, 0x3e,
+ 0xf8, 0xa6, 0xfb, 0xc5, 0x03, 0x94, 0x11, 0x3d, 0x6f, 0xb6, 0x11, 0xa0, 0x48, 0x5b, 0xc3, 0xac,
+ 0x98, 0x83, 0xa5, 0x60, 0xba, 0x57, 0xb6, 0x48, 0x25, 0x2f, 0x59, 0xf2, 0x5a, 0x3b, 0x22, 0x6b,
+ 0xf6, 0xe0, 0x47, 0x6d, 0xeb, 0x78, 0x9e, 0x7c, 0x2b, 0xb3, 0x07, 0x2c, 0x19, 0x41, 0xc5, 0xdb,
+ 0x1e, 0x1c, 0xdc, 0x29, 0x54, 0xcd, 0x92, 0xf6, 0xbd, 0x16, 0xef, 0x97, 0xe6, 0xa5, 0x69, 0x23,
+ 0xee, 0xd0, 0x74, 0xef, 0x56, 0x39, 0xb0, 0xab, 0xb4, 0x96, 0x46, 0x76, 0x85, 0x0f, 0x4c, 0xaf,
+ 0xa3, 0x22, 0x6a, 0xfd, 0x45, 0x1c, 0xd7, 0xcc, 0xb7, 0x05, 0x13, 0x0e, 0x5d, 0xb4, 0x43, 0xa7,
+ 0xb0, 0x8e, 0xa0, 0x6d, 0xf9, 0x2d, 0x0c, 0x64, 0x49, 0xe5, 0x9f, 0xbc, 0x06, 0xf3, 0x24, 0xc5,
+ 0xf0, 0x4e, 0x52, 0xa9, 0x6c, 0xcd, 0xbc, 0xfa, 0x08, 0x00, 0x5f, 0xe4, 0xdb, 0x47, 0x78, 0xa0,
+ 0x0d, 0x17, 0xf2, 0x7a, 0x98, 0x67, 0x22, 0x03, 0x1c, 0x58, 0x3a, 0x8b, 0x79, 0xb1, 0xe3, 0x9f,
+ 0xe4, 0x1f, 0x6a, 0x35, 0x85, 0xc3, 0x61, 0x04, 0x00, 0x00,
+};
+
+#define WEB_ASSET_RESTART_HTML_VERSION "13d639fb46b6e5b0"
+static const uint8_t _web_asset_restart_html[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x65, 0x52, 0xc1, 0x72, 0xd3, 0x30,
+ 0x10, 0xbd, 0xf7, 0x2b, 0xc4, 0x70, 0xd0, 0xa5, 0xb1, 0x1b, 0xbb, 0x64, 0x4a, 0xb1, 0xc2, 0x01,
+ 0xb8, 0xc1, 0xc0, 0x00, 0x97, 0x9e, 0x98, 0xcd, 0x7a, 0x6d, 0x8b, 0x2a, 0x92, 0x47, 0xda, 0x38,
+ 0xf8, 0xef, 0x59, 0xc5, 0x09, 0x9d, 0xd2, 0x8b, 0xde, 0xec, 0x6a, 0xf7, 0xed, 0xdb, 0x27, 0x35,
+ 0xaf, 0x3e, 0x7e, 0xfd, 0xf0, 0xf3, 0xe1, 0xdb, 0x27, 0x35, 0xf0, 0xde, 0x6d, 0xaf, 0x9a, 0x0b,
+ 0x10, 0xb4, 0x02, 0x7b, 0x62, 0x50, 0x38, 0x40, 0x4c, 0xc4, 0x46, 0x1f, 0xb8, 0x5b, 0xdd, 0xe9,
+ 0x4b, 0xda, 0xc3, 0x9e, 0x8c, 0x9e, 0x2c, 0x1d, 0xc7, 0x10, 0x59, 0x2b, 0x0c, 0x9e, 0xc9, 0x4b,
+ 0xd9, 0xd1, 0xb6, 0x3c, 0x98, 0x96, 0x26, 0x8b, 0xb4, 0x3a, 0x05, 0xd7, 0xd6, 0x5b, 0xb6, 0xe0,
+ 0x56, 0x09, 0xc1, 0x91, 0x59, 0x5f, 0x1f, 0x12, 0xc5, 0x53, 0x00, 0x3b, 0x89, 0x7d, 0xc8, 0xa4,
+ 0x6c, 0xd9, 0xd1, 0xf6, 0x33, 0x1c, 0x7c, 0x1b, 0x67, 0xf5, 0x03, 0xc1, 0x7b, 0x8a, 0x4d, 0xb9,
+ 0xa4, 0xaf, 0x1a, 0x67, 0xfd, 0xa3, 0x1a, 0x22, 0x75, 0x46, 0x97, 0x89, 0x67, 0x47, 0xa9, 0xc0,
+ 0x94, 0xde, 0x4f, 0x06, 0xde, 0x76, 0x55, 0x7d, 0xbb, 0xd9, 0xbc, 0xc1, 0x5b, 0xbc, 0xc1, 0x1a,
+ 0xb5, 0x8a, 0xe4, 0x8c, 0x5e, 0x6a, 0x06, 0x22, 0x91, 0xc6, 0xf3, 0x28, 0x52, 0x99, 0xfe, 0x70,
+ 0x29, 0x3d, 0x79, 0x58, 0xc2, 0x68, 0x47, 0x56, 0x29, 0xa2, 0xd0, 0x8d, 0xd0, 0x53, 0xf1, 0x3b,
+ 0x73, 0x6d, 0x90, 0xf0, 0x6e, 0x5d, 0x55, 0x75, 0x5d, 0xaf, 0x6f, 0x10, 0xd7, 0x5a, 0xb5, 0xd4,
+ 0x51, 0xdc, 0x36, 0xe5, 0xd2, 0x20, 0x9d, 0xe5, 0xd9, 0x9a, 0x5d, 0x68, 0x67, 0x81, 0xd6, 0x4e,
+ 0x0a, 0x1d, 0xa4, 0x64, 0xce, 0xfb, 0x3f, 0xcb, 0xe5, 0x5a, 0x69, 0x17, 0x3f, 0xeb, 0x7f, 0x9b,
+ 0x7d, 0x01, 0x1c, 0xac, 0xa7, 0xa7, 0x0d, 0xe5, 0x4e, 0x0a, 0x2a, 0x65, 0x5b, 0xd3, 0x03, 0xd3,
+ 0x11, 0x66, 0x99, 0x37, 0x54, 0x79, 0x96, 0x30, 0x3d, 0xe3, 0xd3, 0xfb, 0xd4, 0xeb, 0x5c, 0x18,
+ 0x29, 0x31, 0x44, 0xde, 0x7e, 0x5f, 0xd0, 0xfa, 0x5e, 0x15, 0x45, 0xf1, 0xb2, 0xa1, 0x0b, 0x81,
+ 0x17, 0x01, 0xf9, 0x80, 0xb3, 0x81, 0x03, 0xf3, 0x98, 0xee, 0xcb, 0xd2, 0x89, 0xa4, 0x95, 0x68,
+ 0xa2, 0x58, 0x4c, 0x14, 0x91, 0x5c, 0x01, 0xe3, 0x28, 0x76, 0x41, 0xec, 0xf3, 0x7b, 0xff, 0xda,
+ 0x39, 0xf0, 0x8f, 0x5a, 0x9d, 0xac, 0x34, 0x1a, 0x83, 0x0b, 0xf1, 0xfe, 0x35, 0x00, 0xbc, 0xd3,
+ 0xff, 0xbf, 0x93, 0x6a, 0xd2, 0x08, 0x3e, 0x2b, 0x13, 0xa2, 0x64, 0x83, 0xcf, 0x96, 0x49, 0x46,
+ 0x00, 0x9e, 0x16, 0xb9, 0xc0, 0xd9, 0xbb, 0x72, 0xf9, 0x6c, 0x7f, 0x01, 0x73, 0xf0, 0x14, 0x1a,
+ 0x84, 0x02, 0x00, 0x00,
+};
+
+#define WEB_ASSET_UPGRADE_HTML_VERSION "7fbe870dba7b22eb"
+static const uint8_t _web_asset_upgrade_html[] PROGMEM = {
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6d, 0x54, 0x51, 0x6f, 0xd3, 0x30,
+ 0x10, 0x7e, 0xdf, 0xaf, 0x30, 0x42, 0xc2, 0x43, 0xa2, 0xcd, 0xda, 0x6e, 0xd5, 0xd8, 0x92, 0x20,
+ 0x04, 0x4c, 0x3c, 0x30, 0x81, 0x34, 0x78, 0xe0, 0x09, 0x5d, 0x9c, 0x4b, 0x62, 0xe6, 0xd8, 0x96,
+ 0xed, 0xb4, 0x2b, 0xbf, 0x9e, 0x73, 0xe2, 0xa6, 0x1a, 0xe2, 0x25, 0x17, 0xdb, 0x77, 0xf7, 0xdd,
+ 0x7d, 0xf7, 0xd9, 0xf9, 0x8b, 0x8f, 0x5f, 0x3f, 0x7c, 0xff, 0xf9, 0xed, 0x13, 0xeb, 0x42, 0xaf,
+ 0xca, 0xb3, 0xfc, 0x68, 0x10, 0x6a, 0x32, 0x3d, 0x06, 0x60, 0xa2, 0x03, 0xe7, 0x31, 0x14, 0x7c,
+ 0x08, 0xcd, 0xe2, 0x9a, 0x1f, 0xb7, 0x35, 0xf4, 0x58, 0xf0, 0x9d, 0xc4, 0xbd, 0x35, 0x2e, 0x70,
+ 0x26, 0x8c, 0x0e, 0xa8, 0xc9, 0x6d, 0x2f, 0xeb, 0xd0, 0x15, 0x35, 0xee, 0xa4, 0xc0, 0xc5, 0xb8,
+ 0x78, 0x23, 0xb5, 0x0c, 0x12, 0xd4, 0xc2, 0x0b, 0x50, 0x58, 0xac, 0xde, 0x0c, 0x1e, 0xdd, 0xb8,
+ 0x80, 0x8a, 0xd6, 0xda, 0xc4, 0xa4, 0x41, 0x06, 0x85, 0xe5, 0x17, 0x18, 0x74, 0xed, 0x0e, 0xec,
+ 0x41, 0x80, 0xd6, 0xe8, 0xf2, 0x6c, 0xda, 0x3e, 0xcb, 0x95, 0xd4, 0x8f, 0xac, 0x73, 0xd8, 0x14,
+ 0x3c, 0xf3, 0xe1, 0xa0, 0xd0, 0x2f, 0x85, 0xf7, 0xef, 0x76, 0x05, 0xbc, 0x6d, 0xd6, 0x9b, 0xcb,
+ 0xed, 0xf6, 0x4a, 0x5c, 0x8a, 0x0b, 0xb1, 0x11, 0x9c, 0x39, 0x54, 0x05, 0x9f, 0x7c, 0x3a, 0x44,
+ 0x2a, 0x2d, 0x1c, 0x2c, 0x95, 0x1a, 0xf0, 0x29, 0x64, 0x14, 0x13, 0xc1, 0xbc, 0x70, 0xd2, 0x06,
+ 0xe6, 0x9d, 0xa0, 0x74, 0x16, 0x5a, 0x5c, 0xfe, 0x8e, 0xb9, 0xb6, 0x02, 0xc5, 0xf5, 0x6a, 0xbd,
+ 0xde, 0x6c, 0x36, 0xab, 0x0b, 0x21, 0x56, 0x9c, 0xd5, 0xd8, 0xa0, 0x2b, 0xf3, 0x6c, 0x0a, 0xa0,
+ 0xc8, 0x2c, 0x51, 0x53, 0x99, 0xfa, 0x40, 0xa6, 0x96, 0x3b, 0x26, 0x14, 0x78, 0x5f, 0xa4, 0xfe,
+ 0x9f, 0xed, 0x45, 0x5f, 0x0a, 0x27, 0x3e, 0x37, 0x73, 0x67, 0xf7, 0x20, 0x3a, 0xa9, 0xf1, 0xd4,
+ 0x21, 0x9d, 0x91, 0xc3, 0x9a, 0xc9, 0xba, 0x68, 0x21, 0xe0, 0x1e, 0x0e, 0x84, 0xd7, 0xad, 0x23,
+ 0x16, 0x65, 0x22, 0xd3, 0x48, 0x54, 0x35, 0x4d, 0x20, 0xb2, 0x80, 0x2d, 0xea, 0x11, 0xbe, 0x7c,
+ 0xa5, 0x2b, 0x6f, 0x6f, 0x7f, 0xd8, 0xd6, 0x11, 0x06, 0xab, 0x0e, 0xac, 0x91, 0x0a, 0xd9, 0x60,
+ 0x95, 0x81, 0x7a, 0x3a, 0xcb, 0xb3, 0x2a, 0x26, 0x99, 0x63, 0x1a, 0xe3, 0xfa, 0x88, 0x32, 0xa4,
+ 0x18, 0x1a, 0x63, 0x67, 0xea, 0x82, 0x5b, 0xe3, 0x89, 0x24, 0x10, 0x41, 0x1a, 0x4d, 0x74, 0xa4,
+ 0x63, 0xce, 0x50, 0x8b, 0x89, 0xb9, 0x7e, 0x50, 0x41, 0x5a, 0x70, 0x21, 0x8b, 0x29, 0x16, 0x35,
+ 0x04, 0x88, 0x24, 0xda, 0xb1, 0x8e, 0x3b, 0xe9, 0xfa, 0x3d, 0x38, 0x64, 0x77, 0x84, 0x1f, 0x21,
+ 0xd9, 0xb9, 0x55, 0x20, 0x35, 0x33, 0x8e, 0xb5, 0x7f, 0xa4, 0x25, 0x61, 0xf4, 0xd6, 0xa1, 0xf7,
+ 0x58, 0xbf, 0x26, 0xff, 0xc8, 0x86, 0xd4, 0x76, 0x08, 0x49, 0x40, 0xcd, 0x3e, 0xd6, 0x7d, 0x9c,
+ 0xd1, 0xf4, 0x4f, 0xf1, 0x02, 0x3b, 0xa3, 0x88, 0xbb, 0x82, 0x3f, 0xcb, 0x1f, 0x61, 0x33, 0x3b,
+ 0x63, 0x3f, 0x7c, 0x7e, 0xbf, 0x58, 0x5f, 0x6d, 0x47, 0x54, 0xd3, 0xb0, 0xd0, 0x21, 0x93, 0x3d,
+ 0x4d, 0x93, 0x9d, 0x1b, 0x1b, 0xbb, 0x01, 0xf5, 0x3f, 0x48, 0xdf, 0x01, 0x05, 0x71, 0xd6, 0xc3,
+ 0x93, 0x42, 0xdd, 0x92, 0x58, 0xb7, 0x97, 0xcf, 0x31, 0x53, 0xde, 0x19, 0xad, 0x1a, 0x42, 0x30,
+ 0x3a, 0x85, 0xcf, 0xfc, 0x4c, 0x25, 0xfb, 0xa1, 0xea, 0x65, 0xd4, 0xff, 0x38, 0x71, 0x9e, 0x5c,
+ 0x5b, 0x87, 0xa8, 0xab, 0x96, 0x97, 0x0f, 0x81, 0x78, 0x63, 0x29, 0x86, 0x0a, 0x1d, 0x8f, 0x63,
+ 0xde, 0x48, 0xe5, 0x68, 0x4f, 0xd3, 0x3d, 0x09, 0x87, 0xf7, 0xbe, 0xe5, 0x71, 0x56, 0x64, 0xcb,
+ 0xa3, 0x0e, 0x6c, 0x39, 0x8d, 0x70, 0x9e, 0x14, 0x9f, 0x47, 0xd8, 0x92, 0xcc, 0xcb, 0x54, 0x66,
+ 0x79, 0x1f, 0xd9, 0xbf, 0x47, 0x3d, 0xcc, 0x70, 0x09, 0x6d, 0x64, 0xed, 0x04, 0xd2, 0x18, 0x13,
+ 0x26, 0x75, 0xc6, 0x0f, 0xa4, 0xdb, 0xd5, 0x85, 0x60, 0xfd, 0x4d, 0x96, 0x29, 0xd2, 0xeb, 0x82,
+ 0x04, 0x8b, 0x6e, 0xb9, 0x43, 0x27, 0x50, 0x2d, 0xc1, 0x5a, 0x6a, 0x1a, 0x5c, 0x1b, 0x1f, 0x83,
+ 0x5f, 0x95, 0x02, 0xfd, 0xc8, 0xd9, 0x78, 0xcf, 0x0a, 0x2e, 0x8c, 0x32, 0xee, 0xe6, 0x25, 0x00,
+ 0xdc, 0xf2, 0x7f, 0x2f, 0x31, 0xcb, 0xbd, 0x05, 0x1d, 0xbb, 0xa1, 0x44, 0x5e, 0x8e, 0xf5, 0xc4,
+ 0x1d, 0x32, 0x70, 0x52, 0xf9, 0xd1, 0xa4, 0x8b, 0x95, 0x4d, 0x2f, 0xd1, 0x5f, 0x43, 0x6a, 0x24,
+ 0x4f, 0xa1, 0x04, 0x00, 0x00,
+};
+
+static const WEB_ASSET_T _web_assets[] = {
+  { "/app.js", "application/javascript", "\"755779f33fddea1d\"", "public, max-age=31536000, immutable", _web_asset_app_js, sizeof(_web_asset_app_js) },
+  { "/page.js", "application/javascript", "\"6cec812233310cc1\"", "public, max-age=31536000, immutable", _web_asset_page_js, sizeof(_web_asset_page_js) },
+  { "/styles.css", "text/css", "\"a9f234665c4c0c3c\"", "public, max-age=31536000, immutable", _web_asset_styles_css, sizeof(_web_asset_styles_css) },
+  { "/config", "text/html", "\"dc53fffe700b219a\"", "no-cache", _web_asset_config_html, sizeof(_web_asset_config_html) },
+  { "/", "text/html", "\"b10a5eb1ba870d7a\"", "no-cache", _web_asset_index_html, sizeof(_web_asset_index_html) },
+  { "/info", "text/html", "\"fb5be1f9420f633c\"", "no-cache", _web_asset_info_html, sizeof(_web_asset_info_html) },
+  { "/machines", "text/html", "\"87330706753fd9f9\"", "no-cache", _web_asset_machines_html, sizeof(_web_asset_machines_html) },
+  { "/restart", "text/html", "\"13d639fb46b6e5b0\"", "no-cache", _web_asset_restart_html, sizeof(_web_asset_restart_html) },
+  { "/upgrade", "text/html", "\"7fbe870dba7b22eb\"", "no-cache", _web_asset_upgrade_html, sizeof(_web_asset_upgrade_html) },
+};
+
+#endif
+
+/**/
@@ -23,9 +23,12 @@
 
 */
 
+#define LOG_MODULE  LOG_MODULE_WIFI
+
 #include "config.h"
 #include "watchdog.h"
 #include "wifiHandler.h"
+#include "memstat.h"
 #include "state.h"
 #include "util.h"
 
@@ -33,6 +36,91 @@ WiFiClient _wifiClient;
 static DNSServer *_dns_server = NULL;
 static char _AP_SSID[64] = "";
 
+/*
+   the state of the connection, only changed in the main loop
+*/
+static int _wifi_state = WIFI_STATE_IDLE;
+static unsigned long _wifi_attempt_start = 0;
+static unsigned long _wifi_backoff_start = 0;
+static unsigned long _wifi_backoff = 0;
+static unsigned long _wifi_outage_start = 0;
+static WIFI_STATS_T _wifi_stats;
+
+/*
+   the access point we were connected to -- used for a fast reconnect
+*/
+static uint8_t _wifi_bssid[MAC_ADDR_LEN];
+static int _wifi_channel = 0;
+static bool _wifi_bssid_valid = false;
+static int _wifi_pinned_failures = 0;
+
+/*
+   flags set by the WiFi event handler
+*/
+static volatile bool _wifi_event_got_ip = false;
+static volatile bool _wifi_event_disconnected = false;
+static volatile int _wifi_event_reason = 0;
+
+/*
+   handle the events of the WiFi stack
+
+   NOTE: function is called asynchronous, so don't use LogMsg or Serial!
+*/
+static void WifiEvent(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      _wifi_event_got_ip = true;
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      _wifi_event_reason = info.wifi_sta_disconnected.reason;
+      _wifi_event_disconnected = true;
+      break;
+    default:
+      break;
+  }
+}
+
+/*
+   start a connection attempt
+
+   if we know the access point from the last connection, we will
+   skip the scan and connect directly to its BSSID and channel
+*/
+static void WifiConnect(void)
+{
+  _wifi_event_got_ip = _wifi_event_disconnected = false;
+  _wifi_attempt_start = millis();
+  _wifi_stats.attempts++;
+  _wifi_stats.pinned = _wifi_bssid_valid && _wifi_pinned_failures < WIFI_PINNED_RETRIES;
+
+#if DBG_WIFI
+  DbgMsg("WIFI: connecting to %s (attempt %lu, %s)", _config.wifi.ssid, _wifi_stats.attempts,
+         (_wifi_stats.pinned) ? "pinned" : "scanning");
+#endif
+
+  if (_wifi_stats.pinned)
+    WiFi.begin(_config.wifi.ssid, _config.wifi.psk, _wifi_channel, _wifi_bssid);
+  else
+    WiFi.begin(_config.wifi.ssid, _config.wifi.psk);
+  _wifi_state = WIFI_STATE_CONNECTING;
+}
+
+/*
+   a connection attempt failed -- wait before the next attempt
+*/
+static void WifiBackoff(void)
+{
+  if (_wifi_stats.pinned && ++_wifi_pinned_failures >= WIFI_PINNED_RETRIES)
+    LogMsg("WIFI: pinned access point not reachable -- falling back to scan");
+
+  _wifi_backoff = (_wifi_backoff) ? MIN(2 * _wifi_backoff, (unsigned long) WIFI_BACKOFF_MAX) : WIFI_BACKOFF_MIN;
+  _wifi_backoff_start = millis();
+  _wifi_state = WIFI_STATE_BACKOFF;
+
+  LogMsg("WIFI: connection attempt failed (reason %d) -- retrying in %lu ms", _wifi_stats.last_reason, _wifi_backoff);
+}
+
 /*
    setup wifi
 */
@@ -78,12 +166,29 @@ bool WifiSetup(void)
     DbgMsg("WIFI: SSID=%s  PSK=%s", _config.wifi.ssid, _config.wifi.psk);
 #endif
 
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(_config.wifi.ssid, _config.wifi.psk);
+    if (_wifi_state == WIFI_STATE_IDLE) {
+      /*
+         we do the reconnects on our own
+      */
+      WiFi.mode(WIFI_STA);
+      WiFi.setAutoReconnect(false);
+      WiFi.onEvent(WifiEvent);
+      WifiConnect();
+    }
 
     LogMsg("WIFI: waiting to connect to %s ...", _config.wifi.ssid);
+
+    /*
+       during the setup we wait for the first connection
+    */
+    unsigned long start = millis();
+
+    while (!WifiUpdate() && millis() - start < WIFI_CONNECT_TIMEOUT * 1000) {
+      delay(100);
+      WatchdogUpdate();
+    }
   }
-  return WifiUpdate();
+  return WifiIsConnected();
 }
 
 /*
@@ -91,6 +196,8 @@ bool WifiSetup(void)
 */
 bool WifiUpdate(void)
 {
+  MEMSTAT_SCOPE(MEMSTAT_WIFI);
+
   if (StateCheck(STATE_CONFIGURING)) {
     /*
        we are in configuration mode
@@ -99,39 +206,133 @@ bool WifiUpdate(void)
     */
     if (_dns_server)
       _dns_server->processNextRequest();
+    return false;
   }
-  else {
-    /*
-       normal operation mode
-    */
-    if (WiFi.status() != WL_CONNECTED) {
-      /*
-         wait to connect
-      */
-      int timeout = WIFI_CONNECT_TIMEOUT;
 
-#if DBG_WIFI
-      DbgMsg("WIFI: status is not connected ... waiting for %d seconds for connection",WIFI_CONNECT_TIMEOUT);
-#endif
-      while (WiFi.status() != WL_CONNECTED) {
-        delay(1000);
-        WatchdogUpdate();
-        if (--timeout <= 0) {
-          LogMsg("WIFI: giving up after %d seconds", WIFI_CONNECT_TIMEOUT);
-          return false;
-        }
-      }
+  /*
+     normal operation mode -- process the events of the WiFi stack
+  */
+  unsigned long now = millis();
+
+  if (_wifi_event_disconnected) {
+    _wifi_event_disconnected = false;
+    _wifi_stats.last_reason = _wifi_event_reason;
 
+    if (_wifi_state == WIFI_STATE_CONNECTED) {
       /*
-         up an running
+         we lost the link -- reconnect immediately to the same access point
       */
-      IPAddress ip = WiFi.localIP();
-      LogMsg("WIFI: connected to %s with local IP address %s", _config.wifi.ssid, IPAddressToString(ip).c_str());
+      _wifi_outage_start = now;
+      _wifi_stats.disconnects++;
+      _wifi_backoff = 0;
+      _wifi_pinned_failures = 0;
+      LogMsg("WIFI: connection lost (reason %d) -- reconnecting", _wifi_stats.last_reason);
+      WifiConnect();
+    }
+    else if (_wifi_state == WIFI_STATE_CONNECTING)
+      WifiBackoff();
+  }
+
+  if (_wifi_event_got_ip && _wifi_state == WIFI_STATE_CONNECTING) {
+    /*
+       up an running
+    */
+    _wifi_event_got_ip = false;
+    _wifi_state = WIFI_STATE_CONNECTED;
+    _wifi_backoff = 0;
+    _wifi_pinned_failures = 0;
 
-      return true;
+    /*
+       remember the access point for a fast reconnect
+    */
+    memcpy(_wifi_bssid, WiFi.BSSID(), sizeof(_wifi_bssid));
+    _wifi_channel = WiFi.channel();
+    _wifi_bssid_valid = true;
+
+    _wifi_stats.connects++;
+    _wifi_stats.last_connect_time = now - _wifi_attempt_start;
+    if (_wifi_outage_start) {
+      _wifi_stats.last_outage = now - _wifi_outage_start;
+      _wifi_stats.total_outage += _wifi_stats.last_outage;
+      _wifi_stats.max_outage = MAX(_wifi_stats.max_outage, _wifi_stats.last_outage);
+      _wifi_outage_start = 0;
     }
+
+    LogMsg("WIFI: connected to %s (%s, channel %d) with local IP address %s after %lu ms",
+           _config.wifi.ssid, AddressToString(_wifi_bssid, sizeof(_wifi_bssid), false, ':'), _wifi_channel,
+           IPAddressToString(WiFi.localIP()).c_str(), _wifi_stats.last_connect_time);
+    if (_wifi_stats.disconnects)
+      LogMsg("WIFI: outage lasted %lu ms", _wifi_stats.last_outage);
+  }
+
+  switch (_wifi_state) {
+    case WIFI_STATE_CONNECTING:
+      if (now - _wifi_attempt_start > WIFI_CONNECT_TIMEOUT * 1000) {
+        /*
+           give up this attempt
+        */
+        WiFi.disconnect();
+        WifiBackoff();
+      }
+      break;
+    case WIFI_STATE_BACKOFF:
+      if (now - _wifi_backoff_start >= _wifi_backoff)
+        WifiConnect();
+      break;
+    case WIFI_STATE_CONNECTED:
+      if (WiFi.status() != WL_CONNECTED) {
+        /*
+           lost the link without getting an event
+        */
+        _wifi_event_reason = 0;
+        _wifi_event_disconnected = true;
+      }
+      break;
+  }
+  return _wifi_state == WIFI_STATE_CONNECTED;
+}
+
+/*
+   check if the WiFi is connected
+*/
+bool WifiIsConnected(void)
+{
+  return _wifi_state == WIFI_STATE_CONNECTED;
+}
+
+/*
+   get the state of the WiFi connection as string
+*/
+const char *WifiGetStateString(void)
+{
+  switch (_wifi_state) {
+    case WIFI_STATE_CONNECTING:
+      return "Connecting";
+    case WIFI_STATE_CONNECTED:
+      return "Connected";
+    case WIFI_STATE_BACKOFF:
+      return "Waiting to reconnect";
+    default:
+      return "Idle";
+  }
+}
+
+/*
+   get the WiFi connection statistics
+*/
+void WifiStats(WIFI_STATS_T *stats)
+{
+  if (!stats)
+    return;
+
+  *stats = _wifi_stats;
+  if (_wifi_outage_start) {
+    /*
+       we are in an outage right now
+    */
+    stats->last_outage = millis() - _wifi_outage_start;
+    stats->max_outage = MAX(stats->max_outage, stats->last_outage);
   }
-  return true;
 }
 
 /*
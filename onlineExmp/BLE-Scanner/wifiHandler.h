@@ -48,10 +48,49 @@ extern WiFiClient _wifiClient;
 /*
    timeout to connect to the configured Wifi
 
-   when timeout is reached, we will give up -- the device will enter the configuration mode
+   when timeout is reached, the connection attempt is aborted and retried after the backoff time
 */
 #define WIFI_CONNECT_TIMEOUT          30
 
+/*
+   backoff between failed connection attempts in milli seconds
+
+   the first reconnect after losing the link is done immediately, every
+   failed attempt doubles the backoff until the maximum is reached
+*/
+#define WIFI_BACKOFF_MIN              1000
+#define WIFI_BACKOFF_MAX              (60 * 1000)
+
+/*
+   number of failed attempts on the pinned BSSID/channel before we fall back to a full scan
+*/
+#define WIFI_PINNED_RETRIES           2
+
+/*
+   states of the WiFi connection
+*/
+enum WIFI_STATE {
+  WIFI_STATE_IDLE = 0,
+  WIFI_STATE_CONNECTING,
+  WIFI_STATE_CONNECTED,
+  WIFI_STATE_BACKOFF,
+};
+
+/*
+   WiFi connection statistics -- all times in milli seconds
+*/
+typedef struct _wifi_stats {
+  unsigned long attempts;           // number of connection attempts
+  unsigned long connects;           // number of successful connections
+  unsigned long disconnects;        // number of lost connections
+  unsigned long last_connect_time;  // time from starting the attempt to getting the IP address
+  unsigned long last_outage;        // duration of the last (or current) outage
+  unsigned long max_outage;         // longest outage seen
+  unsigned long total_outage;       // sum of all outages
+  int last_reason;                  // reason code of the last disconnect
+  bool pinned;                      // the last attempt used the pinned BSSID/channel
+} WIFI_STATS_T;
+
 /*
    port for the DNS
 */
@@ -69,9 +108,26 @@ bool WifiSetup(void);
 
 /*
    do Wifi updates
+
+   this will never block, it returns true if we are connected
 */
 bool WifiUpdate(void);
 
+/*
+   check if the WiFi is connected
+*/
+bool WifiIsConnected(void);
+
+/*
+   get the state of the WiFi connection as string
+*/
+const char *WifiGetStateString(void);
+
+/*
+   get the WiFi connection statistics
+*/
+void WifiStats(WIFI_STATS_T *stats);
+
 /*
    return the SSID
 */
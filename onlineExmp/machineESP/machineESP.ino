@@ -1,6 +1,8 @@
 #include <Wire.h>
 #include <BLEDevice.h>
 #include <BLEAdvertising.h>
+#include <Preferences.h>
+#include <LaundryDetector.h>
 
 #define MPU_ADDR 0x68 // I2C address from datasheet (AD0 should be logic low, wire to GND)
 // x high 3B, x low 3C, y high 3D, y low 3E, z high 3F, z low 40
@@ -12,42 +14,46 @@
 // ACCEL_SCALE = 0      1    2    3
 // Range is   +- 2g     4g   8g   16g
 // sens (LSB/g)= 16384  8192 4096 2048
-static const int LSB_SENS_TABLE[4] {16384, 8192, 4096, 2048};
+static constexpr int LSB_SENS_TABLE[4] {16384, 8192, 4096, 2048};
 #define ACCEL_SCALE 3
-const float LSB_SENS = LSB_SENS_TABLE[ACCEL_SCALE];
 
+// The MPU samples at MPU_FIFO_RATE (200 Hz) into its FIFO, which is drained every FIFO_DRAIN_TIME ms in one burst
+#define FIFO_DRAIN_TIME 250
+MpuFifo fifo;
+int16_t lastSample[3];
+
+// Detector of the running/empty state out of the vibration (libraries/LaundryDetector), with the defaults of ActivityConfig:
+// 20 samples × 50 ms = 1 s of activity averaged over 15 s for running (> 3), 0.2 s of small activity for the door latch (0.45/0.9)
+// Each sample of 50 ms is made of the 10 samples of the FIFO, their magnitude is taken from the raw values in fixed point
+typedef SensorConfig<MachineEspConfig, MPU_FIFO_RATE / 20, LSB_SENS_TABLE[ACCEL_SCALE]> FifoConfig;
+ActivityDetector<FifoConfig> detector;
+
+// Calibration of the thresholds to this machine (libraries/LaundryDetector/ActivityCalibration.h), derived after
+// 30 min at rest and 15 min running. Its estimates are kept in the NVS, saved when the machine stops
+#define CALIBRATION_NVS_NAMESPACE "calibration"
+ActivityCalibration<> calibration;
+
+// Vibration bands of the raw samples (libraries/LaundryDetector/VibrationBands.h): the drum at 1, 2, 3 and 5 Hz and the
+// spin at 12 and 16 Hz over blocks of 1 s. Once they are still for 3 s the detector stops the machine without waiting for its average
+typedef SensorBandConfig<MPU_FIFO_RATE, LSB_SENS_TABLE[ACCEL_SCALE]> FifoBandConfig;
+VibrationBands<FifoBandConfig> bands;
+
+// Phase of the cycle and the minutes remaining (libraries/LaundryDetector/CycleTracker.h), matched against the
+// programmes learned on this machine. The templates are kept in the NVS, saved when a cycle was learned
+#define CYCLE_NVS_NAMESPACE "cycles"
+CycleTracker<> cycle;
+
+// Recording of the raw samples for trace-replay on the host (libraries/LaundryDetector/extras/host):
+// TRACE_SERIAL as TRCH:/TRC: lines between the output (about 2.5 KB/s), TRACE_FLASH into TRACE_FILE (about 20 minutes)
+#define TRACE_MODE TRACE_OFF
+#if TRACE_MODE == TRACE_FLASH
+#include <LittleFS.h>
+File traceFile;
+#endif
+TraceRecorder trace;
 bool empty = true; //Two status booleans sent to website
 bool running = false;
-bool dooropened = false; //Two door latch booleans to help determine if clothes have been taken out
-bool doorclosed = false;
-const int WINDOW = 20;   // 20 samples × 50 ms = 1 second, used to make activity variable
-const int WINDOWTWO = 15;   // 15 samples of activity variable = 15 seconds of data
-const int WINDOWTHREE = 4;   // 4 samples × 50 ms = 0.2, used to make activity small variable, shorter time frame here to detect quick things like door latch
-int idx = 0; //Index variables to store array values
-int idxtwo = 0;
-int idxthree = 0;
-int activitysmallIdx = 0;
-int quiettime = 0; //Time between door opening and door opening, used to detect each event properly (seperatly) and to catch niche cases
-int doorCooldown = 0; //Used to stop door opening from becoming true due to the closing vibration in the case where the user is closing the door right after opening it
-
-float
-  mpu_a_x,
-  mpu_a_y,
-  mpu_a_z,
-  mpu_a_mag,
-  prev_mag = 0.0,
-  activitysmall = 0,
-  activity = 0,
-  deltas[WINDOW], //Arrays that hold the values which make up the activity variables
-  deltastwo[WINDOWTHREE],
-  activities[WINDOWTWO], //Used to caluclates avg of last 15 seconds of activity
-  DYRERONTHRESHHOLD = 3, //Thresholds
-  DOOROPENINGCHANGE = 0.45,
-  DOORCLOSINGCHANGE = 0.9,
-  activitysmallHistory[6], //Holds history of last six small acitivties to capture the small activity 0.3s ago (6 x 50ms)
-  avg15 = 0, //Average activity over last 15 seconds (easier way just always keep track of the average)
-  sum15 = 0 //used to calucate a new average every second
-;
+
 
 // Machine identification
 const char* machineId = "a1-m1"; // e.g., "a1-m1", "a2-m5", "b1-m3"
@@ -75,28 +81,26 @@ void setup() {
   // Check free heap
   Serial.printf("[DEBUG] Free heap: %d bytes\n", ESP.getFreeHeap());
 
-  // Initialize arrays
-  Serial.println("[INIT] Initializing sensor arrays...");
-  for (int i = 0; i < WINDOW; i++) {
-    deltas[i] = 0.0;
-  }
-  for (int i = 0; i < WINDOWTWO; i++) {
-    activities[i] = 0.0;
-  }
-  for (int i = 0; i < WINDOWTHREE; i++) {
-    deltastwo[i] = 0.0;
-  }
-  for (int i = 0; i < 6; i++) {
-    activitysmallHistory[i] = 0.0;
-  }
-
   // Initialize I2C for accelerometer
   Serial.println("[INIT] Setting up I2C (SDA=21, SCL=22)...");
+  Wire.setBufferSize(MPU_FIFO_BURST);
   Wire.begin(21, 22);
 
   // Initialize accelerometer
   Serial.println("[INIT] Configuring MPU-6050 accelerometer...");
   setup_mpu();
+  if (!fifo.begin(mpu_read, mpu_write)) {
+    Serial.println("[INIT] Failed to start the FIFO of the MPU-6050");
+  }
+
+  // Restore the calibration of this machine
+  load_calibration();
+  load_cycles();
+
+  // Start the recording of the samples
+  if (TRACE_MODE != TRACE_OFF && !trace.begin(trace_write, 3, MPU_FIFO_RATE, LSB_SENS_TABLE[ACCEL_SCALE])) {
+    Serial.println("[INIT] Failed to start the recording of the samples");
+  }
 
   // Initialize BLE
   Serial.printf("[DEBUG] Free heap before BLE init: %d bytes\n", ESP.getFreeHeap());
@@ -125,88 +129,49 @@ void setup() {
 }
 
 void loop() {
-
-  record_mpu_accel();
-  mpu_a_mag = sqrt(mpu_a_x * mpu_a_x + mpu_a_y * mpu_a_y + mpu_a_z * mpu_a_z);
-
-  float delta = abs(mpu_a_mag - prev_mag);
-  prev_mag = mpu_a_mag;
-
-  activity -= deltas[idx]; //Minusing the delta 20 samples ago to keep the activity limited to just the most recent 20 samples
-  deltas[idx] = delta; //record the delta now (to delete in 20 samples from now)
-  activity += delta; //add it to variable
-  idx = (idx + 1) % WINDOW; //increment index
-
-  activitysmall -= deltastwo[idxthree];
-  deltastwo[idxthree] = delta;
-  activitysmall += delta;
-  idxthree = (idxthree + 1) % WINDOWTHREE;
-
-  activitysmallHistory[activitysmallIdx] = activitysmall; //Store the value of small acitivty so later we can compre the old one (0.3s ago) to the current
-  activitysmallIdx = (activitysmallIdx + 1) % 6; //increment index
-
-  if (idx == 0){ //Once every second, do this:
-    sum15 -= activities[idxtwo];
-    activities[idxtwo] = activity;
-    sum15 += activities[idxtwo]; //sum15 holds sum of last 15 activities recorded
-    idxtwo = (idxtwo + 1) % WINDOWTWO;
-
-    avg15 = sum15 / WINDOWTWO;
-    bool wasRunning = running;
-
-    if (avg15 > DYRERONTHRESHHOLD){
-      if (!wasRunning) {
-        Serial.println("[STATE] Machine started running!");
-      }
-      running = true;
-      empty = false;
-      dooropened = false;
-      doorclosed = false;
-    }
-    else {
-      if (wasRunning) {
-        Serial.println("[STATE] Machine stopped");
-      }
-      running = false;
-    }
+  unsigned events = 0, cycleEvents = 0;
+  bool calibrated = false;
+
+  // All samples since the last drain, in one burst, the calibration learns from every window of the detector.
+  // The frames lost by an overflow are held as the last sample, so the windows of the detector stay a second of time
+  auto sample = [&](int16_t a_x_raw, int16_t a_y_raw, int16_t a_z_raw) {
+    trace.add(a_x_raw, a_y_raw, a_z_raw);
+    if (bands.update(a_x_raw, a_y_raw, a_z_raw) & BANDS_BLOCK) detector.setStill(bands.still());
+    unsigned sampleEvents = detector.updateRaw(a_x_raw, a_y_raw, a_z_raw);
+    if (sampleEvents & ACTIVITY_TICK) calibrated |= calibration.update(detector);
+    if (sampleEvents & ACTIVITY_TICK) cycleEvents |= cycle.update(detector);
+    events |= sampleEvents;
+    lastSample[0] = a_x_raw;
+    lastSample[1] = a_y_raw;
+    lastSample[2] = a_z_raw;
+  };
+
+  fifo.drain(sample, esp_timer_get_time());
+  if (fifo.lost()) {
+    MPU_FIFO_STATS_T stats;
+
+    fifo.stats(&stats);
+    Serial.printf("[MPU] FIFO overflow, %u samples lost (%lu overflows, %lu samples in %lu drains)\n", fifo.lost(),
+                  stats.overflows, stats.frames, stats.drains);
+    for (unsigned n = 0; n < fifo.lost(); n++) sample(lastSample[0], lastSample[1], lastSample[2]);
   }
 
-  float activitysmall6ago = activitysmallHistory[activitysmallIdx]; //This stores value of small acitivty change from 0.3 seconds ago to compare it to current small activity change to see if door opened/closed
-  //As idxthree was incremented before this, it now points to the item of the array that was recorded last, 6 cycles ago (0.3s)
-
-  //Detect door opening when machine is stopped and not empty (with cooldown**)
-  if (running == false && empty == false && dooropened == false && doorCooldown == 0){
-      if (activitysmall > (activitysmall6ago + DOOROPENINGCHANGE)) {
-        dooropened = true;
-        Serial.println("[DOOR] Door opened!");
-      }
-      quiettime = 0; // reset timer after opening event
-  }
-  // Detect door closing after it has been opened
-  if (running == false && empty == false && dooropened == true && doorclosed == false){
-      if (activitysmall > (activitysmall6ago + DOORCLOSINGCHANGE) && quiettime > 40) {
-        doorclosed = true;
-        Serial.printf("[DOOR] Door closed (quiet time: %d cycles)\n", quiettime);
-      }
-      quiettime++; // count time between open and close
-      if (quiettime > 2400) empty = true; //Machine is empty because door has been left open for > 2 minutes
-  }
-  // Decide if machine is empty based on open–close duration
-  if (dooropened == true && doorclosed == true){
-      if (quiettime > 80) {
-        empty = true;
-        Serial.println("[STATE] Machine is now EMPTY (clothes removed)");
-      }
-      else{ //Niche case, door was closed too fast, user is just checking if clothes are inside, not actually taking them out
-        Serial.println("[DOOR] Quick open/close detected - user just checking");
-        dooropened = false; doorclosed = false;
-        doorCooldown = 20; //**so that it doesn't go back to first if statement right away so that condition won't be incorrectly satisfied
-      }
-  }
-
-  //20 -> 0, one second cooldown for niche case
-  if (doorCooldown > 0) {
-  doorCooldown--;
+  running = detector.running();
+  empty = detector.empty();
+  if (events & ACTIVITY_STARTED) Serial.println("[STATE] Machine started running!");
+  if (events & ACTIVITY_STOPPED) Serial.println("[STATE] Machine stopped");
+  if (events & ACTIVITY_DOOR_OPENED) Serial.println("[DOOR] Door opened!");
+  if (events & ACTIVITY_DOOR_CLOSED) Serial.printf("[DOOR] Door closed (quiet time: %u cycles)\n", detector.quiet());
+  if (events & ACTIVITY_EMPTIED) Serial.println("[STATE] Machine is now EMPTY (clothes removed)");
+  if (events & ACTIVITY_CHECKED) Serial.println("[DOOR] Quick open/close detected - user just checking");
+  if (calibrated) print_thresholds("[CALIBRATION] Derived for this machine");
+  if (calibrated || (events & ACTIVITY_STOPPED)) save_calibration();
+  if ((cycleEvents & CYCLE_MINUTE) && cycle.remaining() != CYCLE_UNKNOWN)
+    Serial.printf("[CYCLE] Phase %u/%u of programme %d, about %u min remaining\n", cycle.phase() + 1, CYCLE_PHASES,
+                  cycle.match(), cycle.remaining());
+  if (cycleEvents & CYCLE_LEARNED) {
+    Serial.printf("[CYCLE] Learned, %u programmes\n", cycle.templates());
+    save_cycles();
   }
 
   // Update BLE advertisement periodically based on running state
@@ -219,7 +184,7 @@ void loop() {
   }
 
   print_accels();
-  delay(50);
+  delay(FIFO_DRAIN_TIME);
 }
 
 void setup_mpu() {
@@ -230,49 +195,99 @@ void setup_mpu() {
   write_to(ACCEL_SCALE_REG, ACCEL_SCALE);
 }
 
-void read_from(const byte from_register, const int num_bytes, byte read_data[]) {
+bool read_from(const byte from_register, const int num_bytes, byte read_data[]) {
   // First send address of register from which to read
   Wire.beginTransmission(MPU_ADDR);
   Wire.write(from_register);
   // Keep control of bus to immediately read data
-  Wire.endTransmission(false);
+  if (Wire.endTransmission(false) != 0) return false;
 
-  Wire.requestFrom(MPU_ADDR, num_bytes, true); // Releases bus after
+  if ((int) Wire.requestFrom(MPU_ADDR, num_bytes, true) != num_bytes) return false; // Releases bus after
   for (int i = 0; Wire.available(); ++i) {
     read_data[i] = Wire.read();
   }
-  return;
+  return true;
 }
 
-void write_to(const byte to_register, const byte write_value) {
+bool write_to(const byte to_register, const byte write_value) {
   Wire.beginTransmission(MPU_ADDR);
   // First send address of register to which to write
   Wire.write(to_register);
   Wire.write(write_value);
-  Wire.endTransmission(true);
-  return;
+  return Wire.endTransmission(true) == 0;
 }
 
-void record_mpu_accel() {
-  // x high byte 3B, x low 3C, y high 3D, y low 3E, z high 3F, z low 40
-  // ACCEL_REG is 3B
-  byte buffer[6];
-  read_from(ACCEL_REG, 6, buffer);
-  int16_t a_x_raw = (buffer[0] << 8) | buffer[1];
-  int16_t a_y_raw = (buffer[2] << 8) | buffer[3];
-  int16_t a_z_raw = (buffer[4] << 8) | buffer[5];
-  // Combine high byte and low byte into 16-bit accel value, then divide by LSB sensitivity to get accel in g-forces
-  // Also factor in offsets
-  mpu_a_x = a_x_raw / LSB_SENS;
-  mpu_a_y = a_y_raw / LSB_SENS;
-  mpu_a_z = a_z_raw / LSB_SENS;
+// Access to the registers for the FIFO
+bool mpu_read(uint8_t reg, uint8_t *data, size_t length) {
+  return read_from(reg, length, data);
+}
+
+bool mpu_write(uint8_t reg, uint8_t value) {
+  return write_to(reg, value);
+}
+
+// Restore the estimates of the calibration from the NVS, the thresholds of the configuration until it is derived
+void load_calibration() {
+  Preferences prefs;
+  ACTIVITY_CALIBRATION_T saved;
+
+  prefs.begin(CALIBRATION_NVS_NAMESPACE, true);
+  bool restored = prefs.getBytes("estimates", &saved, sizeof(saved)) == sizeof(saved) && calibration.restore(&saved);
+  prefs.end();
+
+  if (restored) {
+    calibration.apply(detector);
+  }
+  print_thresholds((restored) ? "[CALIBRATION] Restored" : "[CALIBRATION] Learning");
+}
+
+void save_calibration() {
+  Preferences prefs;
+  ACTIVITY_CALIBRATION_T saved;
+
+  calibration.save(&saved);
+  prefs.begin(CALIBRATION_NVS_NAMESPACE, false);
+  prefs.putBytes("estimates", &saved, sizeof(saved));
+  prefs.end();
+}
+
+// Restore the templates of the programmes from the NVS after a power cycle
+void load_cycles() {
+  Preferences prefs;
+  static CYCLE_TEMPLATES_T saved;
+
+  prefs.begin(CYCLE_NVS_NAMESPACE, true);
+  bool restored = prefs.getBytes("templates", &saved, sizeof(saved)) == sizeof(saved) && cycle.restore(&saved);
+  prefs.end();
+
+  Serial.printf("[CYCLE] %s, %u programmes\n", (restored) ? "Restored" : "Learning", cycle.templates());
+}
+
+void save_cycles() {
+  Preferences prefs;
+  static CYCLE_TEMPLATES_T saved;
+
+  cycle.save(&saved);
+  prefs.begin(CYCLE_NVS_NAMESPACE, false);
+  prefs.putBytes("templates", &saved, sizeof(saved));
+  prefs.end();
+}
+
+void print_thresholds(const char *what) {
+  ACTIVITY_THRESHOLDS_T thresholds;
+
+  detector.thresholds(&thresholds);
+  Serial.printf("%s - running above %.2f g, stopped below %.2f g, door %.2f/%.2f g%s\n", what,
+                (float) thresholds.running / ACTIVITY_UNITS_PER_G, (float) thresholds.stopped / ACTIVITY_UNITS_PER_G,
+                (float) thresholds.opening / ACTIVITY_UNITS_PER_G, (float) thresholds.closing / ACTIVITY_UNITS_PER_G,
+                calibration.calibrated() ? " (calibrated)" : "");
 }
 
 void updateAdvertisement() {
   // Create manufacturer data packet
-  // Format: Company ID (2 bytes) + Machine ID (16 bytes, null-padded) + Status (1 byte)
-  // Total: 19 bytes (room mapping is done on backend based on machineId prefix)
-  const int MANUF_DATA_LEN = 2 + MACHINE_ID_MAX_LEN + 1;
+  // Format: Company ID (2 bytes) + Machine ID (16 bytes, null-padded) + Thresholds (3 bytes) + Status (1 byte)
+  // Total: 22 bytes (room mapping is done on backend based on machineId prefix), the status byte stays the last one
+  const int MANUF_DATA_LEN = 2 + MACHINE_ID_MAX_LEN + 3 + 1;
   uint8_t manufData[MANUF_DATA_LEN];
   memset(manufData, 0, MANUF_DATA_LEN);
 
@@ -285,8 +300,17 @@ void updateAdvertisement() {
   if (idLen > MACHINE_ID_MAX_LEN) idLen = MACHINE_ID_MAX_LEN;
   memcpy(&manufData[2], machineId, idLen);
 
-  // Status byte (bit 0: running, bit 1: empty)
-  manufData[2 + MACHINE_ID_MAX_LEN] = (running ? 0x01 : 0x00) | (empty ? 0x02 : 0x00);
+  // Thresholds of the detector: running and stopped in 1/16 g, the door closing in 1/64 g
+  ACTIVITY_THRESHOLDS_T thresholds;
+  detector.thresholds(&thresholds);
+  manufData[2 + MACHINE_ID_MAX_LEN] = CalibrationByte(thresholds.running, CALIBRATION_BYTE_RUNNING);
+  manufData[2 + MACHINE_ID_MAX_LEN + 1] = CalibrationByte(thresholds.stopped, CALIBRATION_BYTE_RUNNING);
+  manufData[2 + MACHINE_ID_MAX_LEN + 2] = CalibrationByte(thresholds.closing, CALIBRATION_BYTE_DOOR);
+
+  // Status byte (bit 0: running, bit 1: empty, bit 2: the thresholds are calibrated, bits 3-7: the minutes remaining
+  // of the cycle in steps of 5 min, 0 without an estimate)
+  manufData[MANUF_DATA_LEN - 1] = (running ? 0x01 : 0x00) | (empty ? 0x02 : 0x00) | (calibration.calibrated() ? 0x04 : 0x00) |
+                                  (CycleRemainingBits(cycle.remaining()) << 3);
 
   BLEAdvertisementData advData;
   String mfgData;
@@ -314,12 +338,33 @@ void updateAdvertisement() {
     Serial.print(mpu_a_z);
     Serial.print(' '); */
     Serial.print("change over last second:");
-    Serial.print(activity);
+    Serial.print(detector.activity());
     Serial.print(' ');
     Serial.print("mpu_a_mag:");
-    Serial.print(mpu_a_mag);
+    Serial.print(detector.magnitude());
     Serial.println();
     Serial.print("Running:");
     Serial.println(running ? 1 : 0);
     Serial.println();
   }
+
+// Output of the recording, false if the block is lost
+bool trace_write(const uint8_t *data, size_t length, bool header) {
+#if TRACE_MODE == TRACE_FLASH
+  if (header) {
+    traceFile = (LittleFS.begin(true)) ? LittleFS.open(TRACE_FILE, "w") : File();
+  }
+  if (!traceFile || traceFile.size() + length > TRACE_FILE_MAX) {
+    return false;
+  }
+  bool written = traceFile.write(data, length) == length;
+  traceFile.flush();
+  return written;
+#else
+  char line[TRACE_LINE_MAX];
+
+  TraceLine(line, data, length, header);
+  Serial.println(line);
+  return true;
+#endif
+}